@@ -21,6 +21,7 @@
  *                                                                                                *
  * ============================================================================================== */
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <string>
@@ -134,6 +135,7 @@ int main(int argc, char** argv) {
     uint32_t blocks = 1000;
     std::string format{"table"};
     std::string algo{"CNX-v1"};
+    uint32_t batch = 0;
     const uint32_t size = 410;
     // clang-format off
     cliOptions.add_options("benchmark")
@@ -150,6 +152,9 @@ int main(int argc, char** argv) {
 
         ("a,algorithm", "algorithm to benchmark",
             cxxopts::value<std::string>(algo)->default_value(algo))
+
+        ("n,nonces", "additionally benchmarks the batch api hashing this many nonces per call, 0 to disable",
+            cxxopts::value<uint32_t>(batch)->default_value(std::to_string(batch)))
     ;
     // clang-format on
 
@@ -183,37 +188,63 @@ int main(int argc, char** argv) {
     const auto blockData = generate_random_blocks(blocks * maxThreadUsage, size);
     BencharkSummary summary;
 
-    for (threads = minThreadUsage; threads <= maxThreadUsage; ++threads) {
-      logger(Logging::Trace) << "starting benchmark using " << threads << " threads\n";
-      BenchmarkResult result{blocks, size, threads, algo};
-      std::vector<std::thread> worker;
-      worker.reserve(threads);
-
-      for (size_t i = 0; i < threads; ++i) {
-        worker.emplace_back([&blockData, &result, i, blocks, size, hashAlgo]() {
-          result.ThreadResults[i].start();
-          auto data = reinterpret_cast<const Xi::Byte*>(blockData.data());
-          for (size_t j = 0; j < blocks; ++j) {
-            Crypto::Hash hash;
-            (*hashAlgo)(Xi::ConstByteSpan{data + (i * blocks + j) * size, size}, hash);
-          }
-          result.ThreadResults[i].stop();
-        });
+    const auto runSingle = [&blockData, blocks, size, hashAlgo](BenchmarkTimeSpan& timing, size_t thread) {
+      timing.start();
+      auto data = reinterpret_cast<const Xi::Byte*>(blockData.data());
+      for (size_t j = 0; j < blocks; ++j) {
+        Crypto::Hash hash;
+        (*hashAlgo)(Xi::ConstByteSpan{data + (thread * blocks + j) * size, size}, hash);
       }
-      for (size_t i = 0; i < worker.size(); ++i) {
-        worker[i].join();
+      timing.stop();
+    };
+
+    // The batch api keeps the first block of the thread as template and hashes it with nonces taken from the random
+    // data, resembling the workload of a miner.
+    const auto runBatch = [&blockData, blocks, size, batch, hashAlgo](BenchmarkTimeSpan& timing, size_t thread) {
+      const size_t nonceSize = 4;
+      std::vector<Crypto::Hash> hashes(batch);
+      timing.start();
+      auto data = reinterpret_cast<const Xi::Byte*>(blockData.data());
+      const Xi::ConstByteSpan blob{data + thread * blocks * size, size};
+      for (size_t j = 0; j < blocks; j += batch) {
+        const size_t count = std::min<size_t>(batch, blocks - j);
+        hashAlgo->batch(blob, 0, Xi::ConstByteSpan{data + (thread * blocks + j) * size, count * nonceSize},
+                        Xi::Span<Crypto::Hash>{hashes.data(), count});
+      }
+      timing.stop();
+    };
+
+    std::vector<std::pair<std::string, std::function<void(BenchmarkTimeSpan&, size_t)>>> variants{};
+    variants.emplace_back(algo, runSingle);
+    if (batch > 0) {
+      variants.emplace_back(algo + " x" + std::to_string(batch), runBatch);
+    }
+
+    for (threads = minThreadUsage; threads <= maxThreadUsage; ++threads) {
+      for (const auto& variant : variants) {
+        logger(Logging::Trace) << "starting benchmark '" << variant.first << "' using " << threads << " threads\n";
+        BenchmarkResult result{blocks, size, threads, variant.first};
+        std::vector<std::thread> worker;
+        worker.reserve(threads);
+
+        for (size_t i = 0; i < threads; ++i) {
+          worker.emplace_back([&result, &variant, i]() { variant.second(result.ThreadResults[i], i); });
+        }
+        for (size_t i = 0; i < worker.size(); ++i) {
+          worker[i].join();
+        }
+        summary.Benchmarks.push_back(result);
+        logger(Logging::Trace) << "Block Size       : " << size;
+        logger(Logging::Trace) << "Hashes Per Thread: " << blocks;
+        logger(Logging::Trace) << "Slowest          : " << result.worstDuration().count() << "ns";
+        logger(Logging::Trace) << "Best             : " << result.bestDuration().count() << "ns";
+        logger(Logging::Trace) << "Average          : " << result.averageDuration().count() << "ns";
+        logger(Logging::Trace) << "Total Hashes     : " << result.totalHashes();
+        logger(Logging::Trace) << "Slowest Hashrate : " << result.worstHashrate() << "H/s";
+        logger(Logging::Trace) << "Best    Hashrate : " << result.bestHashrate() << "H/s";
+        logger(Logging::Trace) << "Average Hashrate : " << result.averageHashrate() << "H/s";
+        logger(Logging::Trace) << "Total   Hashrate : " << result.totalHashrate() << "H/s\n\n";
       }
-      summary.Benchmarks.push_back(result);
-      logger(Logging::Trace) << "Block Size       : " << size;
-      logger(Logging::Trace) << "Hashes Per Thread: " << blocks;
-      logger(Logging::Trace) << "Slowest          : " << result.worstDuration().count() << "ns";
-      logger(Logging::Trace) << "Best             : " << result.bestDuration().count() << "ns";
-      logger(Logging::Trace) << "Average          : " << result.averageDuration().count() << "ns";
-      logger(Logging::Trace) << "Total Hashes     : " << result.totalHashes();
-      logger(Logging::Trace) << "Slowest Hashrate : " << result.worstHashrate() << "H/s";
-      logger(Logging::Trace) << "Best    Hashrate : " << result.bestHashrate() << "H/s";
-      logger(Logging::Trace) << "Average Hashrate : " << result.averageHashrate() << "H/s";
-      logger(Logging::Trace) << "Total   Hashrate : " << result.totalHashrate() << "H/s\n\n";
     }
 
     logger() << formatterSearch->second(summary);
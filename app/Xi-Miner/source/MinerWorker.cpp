@@ -23,7 +23,9 @@
 
 #include "MinerWorker.h"
 
+#include <array>
 #include <chrono>
+#include <cstring>
 
 #include <Xi/ExternalIncludePush.h>
 #include <boost/endian/conversion.hpp>
@@ -115,18 +117,22 @@ void XiMiner::MinerWorker::mineLoop() {
     }
 
     const uint32_t batchSize = 50;
-    for (uint32_t i = 0; i < batchSize; ++i) {
-      auto ec = Xi::Crypto::Random::generate(block.ProofOfWork->nonceSpan());
-      if (ec != Xi::Crypto::Random::RandomError::Success) {
-        m_observer.notify(&Observer::onError, "random generation failed.");
-        std::this_thread::sleep_for(std::chrono::milliseconds{100});
-        break;
-      }
+    std::array<Crypto::Hash, batchSize> hashes{};
+    std::array<Xi::Byte, batchSize * CryptoNote::BlockNonce::bytes()> nonces{};
+    auto ec = Xi::Crypto::Random::generate(Xi::ByteSpan{nonces.data(), nonces.size()});
+    if (ec != Xi::Crypto::Random::RandomError::Success) {
+      m_observer.notify(&Observer::onError, "random generation failed.");
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+      continue;
+    }
 
-      Crypto::Hash h;
-      (*algo)(Xi::ConstByteSpan{block.ProofOfWork->data(), block.ProofOfWork->size()}, h);
-      if (CryptoNote::check_hash(h, block.Difficutly)) {
-        std::memcpy(block.Template.nonce.data(), block.ProofOfWork->nonceSpan().data(),
+    const size_t nonceOffset =
+        static_cast<size_t>(block.ProofOfWork->nonceData() - block.ProofOfWork->data());
+    algo->batch(Xi::ConstByteSpan{block.ProofOfWork->data(), block.ProofOfWork->size()}, nonceOffset,
+                Xi::ConstByteSpan{nonces.data(), nonces.size()}, Xi::Span<Crypto::Hash>{hashes.data(), hashes.size()});
+    for (uint32_t i = 0; i < batchSize; ++i) {
+      if (CryptoNote::check_hash(hashes[i], block.Difficutly)) {
+        std::memcpy(block.Template.nonce.data(), nonces.data() + i * CryptoNote::BlockNonce::bytes(),
                     CryptoNote::BlockNonce::bytes());
         m_observer.notify(&Observer::onBlockFound, block.Template);
       }
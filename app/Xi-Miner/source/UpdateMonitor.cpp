@@ -25,6 +25,7 @@
 
 #include <utility>
 #include <stdexcept>
+#include <algorithm>
 
 #include <Common/StringTools.h>
 #include <Rpc/JsonRpc.h>
@@ -97,6 +98,29 @@ Xi::Result<std::string> XiMiner::UpdateMonitor::getBlockTemplateState() {
   XI_ERROR_CATCH();
 }
 
+Xi::Result<std::string> XiMiner::UpdateMonitor::waitBlockTemplateState(std::chrono::milliseconds timeout) {
+  XI_ERROR_TRY();
+  m_logger(Logging::Trace) << "wait for block template state change";
+  CryptoNote::RpcCommands::WaitBlockTemplateState::request request;
+  CryptoNote::RpcCommands::WaitBlockTemplateState::response response;
+  request.template_state = m_blockTemplateState;
+  request.timeout = static_cast<uint32_t>(timeout.count());
+  try {
+    CryptoNote::JsonRpc::invokeJsonRpcCommand(m_http, CryptoNote::RpcCommands::WaitBlockTemplateState::identifier(),
+                                              request, response);
+  } catch (const CryptoNote::JsonRpc::JsonRpcError &e) {
+    if (e.code != CryptoNote::JsonRpc::errMethodNotFound) {
+      throw;
+    }
+    m_logger(Logging::Warning) << "node does not support waiting for block templates, falling back to polling";
+    m_longPolling = false;
+    return getBlockTemplateState();
+  }
+  m_logger(Logging::Trace) << "block template state: " << response.template_state;
+  return success(std::move(response.template_state));
+  XI_ERROR_CATCH();
+}
+
 Xi::Result<XiMiner::MinerBlockTemplate> XiMiner::UpdateMonitor::getBlockTemplate() {
   XI_ERROR_TRY();
   m_logger(Logging::Trace) << "request block template state";
@@ -123,19 +147,32 @@ Xi::Result<XiMiner::MinerBlockTemplate> XiMiner::UpdateMonitor::getBlockTemplate
 }
 
 void XiMiner::UpdateMonitor::updateLoop() {
+  // Bounds a single wait on the node, shutdown joins this thread and has to wait for an outstanding request.
+  const std::chrono::milliseconds maximumWait{5000};
+
   while (m_keepRunning) {
     try {
       const auto now = std::chrono::high_resolution_clock::now();
-      if (now < m_lastPoll + pollInterval()) {
-        std::this_thread::sleep_for((now + pollInterval()) - m_lastPoll);
-        continue;
-      }
-      if (now < m_lastUpdate + 10 * pollInterval()) {
-        const auto nodeState = getBlockTemplateState().takeOrThrow();
+      if (m_longPolling && !m_blockTemplateState.empty() && now < m_lastUpdate + 10 * pollInterval()) {
+        const auto remaining =
+            std::chrono::duration_cast<std::chrono::milliseconds>(m_lastUpdate + 10 * pollInterval() - now);
+        const auto nodeState = waitBlockTemplateState(std::min(remaining, maximumWait)).takeOrThrow();
+        m_lastPoll = std::chrono::high_resolution_clock::now();
         if (nodeState == m_blockTemplateState) {
-          m_lastPoll = std::chrono::high_resolution_clock::now();
           continue;
         }
+      } else {
+        if (now < m_lastPoll + pollInterval()) {
+          std::this_thread::sleep_for((now + pollInterval()) - m_lastPoll);
+          continue;
+        }
+        if (now < m_lastUpdate + 10 * pollInterval()) {
+          const auto nodeState = getBlockTemplateState().takeOrThrow();
+          if (nodeState == m_blockTemplateState) {
+            m_lastPoll = std::chrono::high_resolution_clock::now();
+            continue;
+          }
+        }
       }
       m_logger(Logging::Debugging) << "template updated, polling...";
       auto block = getBlockTemplate().takeOrThrow();
@@ -75,6 +75,8 @@ class UpdateMonitor {
                 Logging::ILogger& logger);
 
   Xi::Result<std::string> getBlockTemplateState();
+  /// Blocks on the node until the template state differs from the current one, falls back to polling for old nodes.
+  Xi::Result<std::string> waitBlockTemplateState(std::chrono::milliseconds timeout);
   Xi::Result<MinerBlockTemplate> getBlockTemplate();
 
   void updateLoop();
@@ -90,6 +92,7 @@ class UpdateMonitor {
   std::chrono::high_resolution_clock::time_point m_lastPoll{std::chrono::high_resolution_clock::time_point::min()};
   std::chrono::high_resolution_clock::time_point m_lastUpdate{std::chrono::high_resolution_clock::time_point::min()};
   std::string m_blockTemplateState{""};
+  bool m_longPolling{true};
   std::atomic_bool m_keepRunning{true};
   Xi::Http::Client m_http;
 };
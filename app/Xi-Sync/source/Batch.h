@@ -27,6 +27,7 @@
 
 #include <Serialization/ISerializer.h>
 #include <CryptoNoteCore/CryptoNote.h>
+#include <CryptoNoteCore/CachedBlock.h>
 #include <CryptoNoteCore/CryptoNoteSerialization.h>
 
 #include "BatchInfo.h"
@@ -35,6 +36,8 @@ namespace XiSync {
 struct Batch {
   BatchInfo Info;
   std::vector<CryptoNote::RawBlock> Blocks;
+  /// Parsed block templates of Blocks, filled by the reader and not part of the dump.
+  std::vector<CryptoNote::CachedBlock> CachedBlocks;
 
   KV_BEGIN_SERIALIZATION
   KV_MEMBER(Info)
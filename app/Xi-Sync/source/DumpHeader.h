@@ -29,7 +29,8 @@
 
 namespace XiSync {
 struct DumpHeader {
-  uint8_t Version = 1;
+  /// 1: batches stored sequentially, 2: trailing batch index with optionally compressed batches.
+  uint8_t Version = 2;
 
   KV_BEGIN_SERIALIZATION
   KV_MEMBER(Version)
@@ -0,0 +1,81 @@
+/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include <Xi/Global.hh>
+#include <Xi/Byte.hh>
+#include <Xi/Crypto/Hash/Crc.hpp>
+#include <Serialization/ISerializer.h>
+#include <Serialization/SerializationOverloads.h>
+
+#include "BatchInfo.h"
+
+namespace XiSync {
+enum struct BatchCompression : uint8_t {
+  None = 0,
+  LZ4 = 1,
+};
+
+/*!
+ * \brief Locates a batch within a v2 dump file.
+ *
+ * The payload is the binary serialization of the batch blocks, compressed according to Compression. Info.BinarySize
+ * is the size of the decompressed payload, the checksum covers the bytes stored in the file.
+ */
+struct BatchIndexEntry {
+  BatchInfo Info;
+  uint64_t Offset;
+  uint64_t StoredSize;
+  uint8_t Compression;
+  Xi::Crypto::Hash::Crc::Hash32 Checksum;
+
+  KV_BEGIN_SERIALIZATION
+  KV_MEMBER(Info)
+  KV_MEMBER(Offset)
+  KV_MEMBER(StoredSize)
+  KV_MEMBER(Compression)
+  KV_MEMBER(Checksum)
+  KV_END_SERIALIZATION
+};
+
+/*!
+ * \brief Trailing index of a v2 dump file, batches are ordered by their start index.
+ *
+ * The index is followed by a fixed size trailer, the magic bytes and the little endian offset of the index. Readers
+ * locate the index from the end of the file without touching any batch.
+ */
+struct DumpIndex {
+  std::vector<BatchIndexEntry> Batches;
+
+  KV_BEGIN_SERIALIZATION
+  KV_MEMBER(Batches)
+  KV_END_SERIALIZATION
+};
+
+static inline constexpr Xi::ByteArray<8> DumpIndexMagic{{'X', 'I', 'S', 'Y', 'N', 'C', 'I', 'X'}};
+static inline constexpr size_t DumpTrailerSize = DumpIndexMagic.size() + sizeof(uint64_t);
+}  // namespace XiSync
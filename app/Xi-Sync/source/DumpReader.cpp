@@ -24,11 +24,30 @@
 #include "DumpReader.h"
 
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <thread>
 #include <utility>
 #include <stdexcept>
 
+#include <lz4.h>
+
+#include <Xi/Exceptional.hpp>
+#include <Xi/Endianess/Little.hh>
+#include <Common/ByteSpanInputStream.hpp>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+
 #include "DumpHeader.h"
 
+namespace {
+// clang-format off
+XI_DECLARE_EXCEPTIONAL_CATEGORY(InvalidDump)
+XI_DECLARE_EXCEPTIONAL_INSTANCE(CorruptedIndex, "the batch index of the dump is corrupted", InvalidDump)
+XI_DECLARE_EXCEPTIONAL_INSTANCE(CorruptedBatch, "a batch of the dump is corrupted", InvalidDump)
+XI_DECLARE_EXCEPTIONAL_INSTANCE(InvalidRawBlock, "a raw block of the dump cannot be deserialized", InvalidDump)
+// clang-format on
+}  // namespace
+
 Xi::Result<std::unique_ptr<XiSync::DumpReader>> XiSync::DumpReader::open(const std::string &file,
                                                                          XiSync::DumpReader::Visitor &visitor) {
   XI_ERROR_TRY();
@@ -36,20 +55,20 @@ Xi::Result<std::unique_ptr<XiSync::DumpReader>> XiSync::DumpReader::open(const s
   XI_ERROR_CATCH();
 }
 
+XiSync::DumpReader::~DumpReader() {
+  // Workers decode from the mapping, it must outlive them.
+  for (auto &pending : m_pending) {
+    pending.wait();
+  }
+}
+
 Xi::Result<bool> XiSync::DumpReader::next() {
   XI_ERROR_TRY();
-  BatchInfo nfo;
-  m_serializer(nfo, "");
-  if (m_visitor.onInfo(nfo) == Visitor::BatchCommand::Skip) {
-    m_stdStream.ignore(static_cast<int64_t>(nfo.BinarySize));
+  if (m_version == 1) {
+    return success(nextSequential());
   } else {
-    assert(m_visitor.onInfo(nfo) == Visitor::BatchCommand::Read);
-    Batch batch;
-    batch.Info = std::move(nfo);
-    m_serializer(batch.Blocks, "");
-    m_visitor.onBatch(std::move(batch));
+    return success(nextIndexed());
   }
-  return success(m_stdStream.peek() != EOF && !m_stdStream.eof());
   XI_ERROR_CATCH();
 }
 
@@ -61,17 +80,133 @@ Xi::Result<void> XiSync::DumpReader::readAll() {
   XI_ERROR_CATCH();
 }
 
+size_t XiSync::DumpReader::concurrency() const { return m_concurrency; }
+
+void XiSync::DumpReader::setConcurrency(size_t concurrency) { m_concurrency = std::max<size_t>(concurrency, 1); }
+
 XiSync::DumpReader::DumpReader(const std::string &file, XiSync::DumpReader::Visitor &visitor)
     : m_visitor{visitor},
       m_stdStream{file, std::ios::binary | std::ios::in},
       m_streamWrapper{m_stdStream},
-      m_serializer{m_streamWrapper} {
+      m_serializer{m_streamWrapper},
+      m_concurrency{std::max<size_t>(std::thread::hardware_concurrency(), 1)} {
   if (!m_stdStream.good()) {
     throw std::runtime_error{std::string{"unable to open dump file: "} + file};
   }
   DumpHeader header;
   m_serializer(header, "");
-  if (header.Version != 1) {
+  if (header.Version != 1 && header.Version != 2) {
     throw std::runtime_error{std::string{"unsupported dump file version: "} + std::to_string(header.Version)};
   }
+  m_version = header.Version;
+  if (m_version == 2) {
+    m_stdStream.close();
+    loadIndex(file);
+  }
+}
+
+bool XiSync::DumpReader::nextSequential() {
+  BatchInfo nfo;
+  m_serializer(nfo, "");
+  if (m_visitor.onInfo(nfo) == Visitor::BatchCommand::Skip) {
+    m_stdStream.ignore(static_cast<int64_t>(nfo.BinarySize));
+  } else {
+    assert(m_visitor.onInfo(nfo) == Visitor::BatchCommand::Read);
+    Batch batch;
+    batch.Info = std::move(nfo);
+    m_serializer(batch.Blocks, "");
+    cacheBlocks(batch);
+    m_visitor.onBatch(std::move(batch));
+  }
+  return m_stdStream.peek() != EOF && !m_stdStream.eof();
+}
+
+bool XiSync::DumpReader::nextIndexed() {
+  while (m_pending.size() < concurrency() && m_cursor < m_index.Batches.size()) {
+    const auto &entry = m_index.Batches[m_cursor++];
+    if (m_visitor.onInfo(entry.Info) == Visitor::BatchCommand::Read) {
+      m_pending.emplace_back(async::spawn([this, &entry]() { return decodeBatch(entry); }));
+    }
+  }
+
+  if (!m_pending.empty()) {
+    auto batch = m_pending.front().get();
+    m_pending.pop_front();
+    m_visitor.onBatch(std::move(batch));
+  }
+  return !m_pending.empty() || m_cursor < m_index.Batches.size();
+}
+
+void XiSync::DumpReader::loadIndex(const std::string &file) {
+  m_mapping.open(file);
+  if (!m_mapping.is_open()) {
+    throw std::runtime_error{std::string{"unable to map dump file: "} + file};
+  }
+
+  const auto size = static_cast<uint64_t>(m_mapping.size());
+  const auto data = reinterpret_cast<const Xi::Byte *>(m_mapping.data());
+  Xi::exceptional_if<CorruptedIndexError>(size < DumpTrailerSize, "dump is too small to contain a batch index");
+
+  const auto trailer = data + size - DumpTrailerSize;
+  Xi::exceptional_if_not<CorruptedIndexError>(
+      std::memcmp(trailer, DumpIndexMagic.data(), DumpIndexMagic.size()) == 0, "dump index magic mismatch");
+  uint64_t indexOffset = 0;
+  std::memcpy(&indexOffset, trailer + DumpIndexMagic.size(), sizeof(indexOffset));
+  indexOffset = Xi::Endianess::little(indexOffset);
+  Xi::exceptional_if<CorruptedIndexError>(indexOffset > size - DumpTrailerSize, "dump index offset out of range");
+
+  Common::ByteSpanInputStream stream{Xi::ConstByteSpan{data + indexOffset, size - DumpTrailerSize - indexOffset}};
+  CryptoNote::BinaryInputStreamSerializer serializer{stream};
+  Xi::exceptional_if_not<CorruptedIndexError>(serializer(m_index, ""), "dump index deserialization failed");
+  for (const auto &entry : m_index.Batches) {
+    Xi::exceptional_if<CorruptedIndexError>(
+        entry.Offset > indexOffset || entry.StoredSize > indexOffset - entry.Offset, "batch out of range");
+  }
+}
+
+XiSync::Batch XiSync::DumpReader::decodeBatch(const BatchIndexEntry &entry) const {
+  const auto data = reinterpret_cast<const Xi::Byte *>(m_mapping.data()) + entry.Offset;
+  Xi::ConstByteSpan payload{data, entry.StoredSize};
+  Xi::exceptional_if_not<CorruptedBatchError>(Xi::Crypto::Hash::crc32(payload) == entry.Checksum,
+                                              "batch checksum mismatch");
+
+  CryptoNote::BinaryArray decompressed{};
+  if (entry.Compression == static_cast<uint8_t>(BatchCompression::LZ4)) {
+    Xi::exceptional_if<CorruptedBatchError>(entry.Info.BinarySize > static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE) ||
+                                                entry.StoredSize > static_cast<uint64_t>(LZ4_MAX_INPUT_SIZE),
+                                            "compressed batch too large");
+    decompressed.resize(entry.Info.BinarySize);
+    const int decompressedSize = LZ4_decompress_safe(
+        reinterpret_cast<const char *>(payload.data()), reinterpret_cast<char *>(decompressed.data()),
+        static_cast<int>(payload.size()), static_cast<int>(decompressed.size()));
+    Xi::exceptional_if<CorruptedBatchError>(decompressedSize < 0 ||
+                                                static_cast<uint64_t>(decompressedSize) != entry.Info.BinarySize,
+                                            "batch decompression failed");
+    payload = Xi::ConstByteSpan{decompressed.data(), decompressed.size()};
+  } else {
+    Xi::exceptional_if_not<CorruptedBatchError>(entry.Compression == static_cast<uint8_t>(BatchCompression::None),
+                                                "unknown batch compression");
+  }
+
+  Batch batch{};
+  batch.Info = entry.Info;
+  Common::ByteSpanInputStream stream{payload};
+  CryptoNote::BinaryInputStreamSerializer serializer{stream};
+  Xi::exceptional_if_not<CorruptedBatchError>(serializer(batch.Blocks, ""), "batch deserialization failed");
+  Xi::exceptional_if_not<CorruptedBatchError>(batch.Blocks.size() == batch.Info.Count, "batch block count mismatch");
+  cacheBlocks(batch);
+  return batch;
+}
+
+void XiSync::DumpReader::cacheBlocks(XiSync::Batch &batch) {
+  batch.CachedBlocks.reserve(batch.Blocks.size());
+  for (const auto &rawBlock : batch.Blocks) {
+    CryptoNote::BlockTemplate blockTemplate;
+    if (!CryptoNote::fromBinaryArray(blockTemplate, rawBlock.blockTemplate)) {
+      Xi::exceptional<InvalidRawBlockError>();
+    }
+    batch.CachedBlocks.emplace_back(std::move(blockTemplate));
+    // Hashing is part of the work moved off the importing thread.
+    XI_UNUSED_REVAL(batch.CachedBlocks.back().getBlockHash());
+  }
 }
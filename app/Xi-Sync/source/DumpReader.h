@@ -25,6 +25,10 @@
 
 #include <fstream>
 #include <memory>
+#include <deque>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <async++.h>
 
 #include <Xi/Global.hh>
 #include <Xi/Result.h>
@@ -32,6 +36,7 @@
 #include <Serialization/BinaryInputStreamSerializer.h>
 
 #include "Batch.h"
+#include "DumpIndex.h"
 
 namespace XiSync {
 class DumpReader final {
@@ -53,18 +58,41 @@ class DumpReader final {
  public:
   XI_DELETE_COPY(DumpReader);
   XI_DELETE_MOVE(DumpReader);
-  ~DumpReader() = default;
+  ~DumpReader();
 
+  /*!
+   * \brief next passes the next batch requested by the visitor.
+   *
+   * For indexed (v2) dumps skipped batches are never touched and up to concurrency() requested batches are
+   * decompressed and parsed on worker threads ahead of the visitor.
+   */
   Xi::Result<bool> next();
   Xi::Result<void> readAll();
 
+  size_t concurrency() const;
+  void setConcurrency(size_t concurrency);
+
  private:
   DumpReader(const std::string& file, Visitor& visitor);
 
+  bool nextSequential();
+  bool nextIndexed();
+
+  void loadIndex(const std::string& file);
+  Batch decodeBatch(const BatchIndexEntry& entry) const;
+  static void cacheBlocks(Batch& batch);
+
  private:
   Visitor& m_visitor;
   std::ifstream m_stdStream;
   Common::StdInputStream m_streamWrapper;
   CryptoNote::BinaryInputStreamSerializer m_serializer;
+  uint8_t m_version;
+
+  boost::iostreams::mapped_file_source m_mapping;
+  DumpIndex m_index;
+  size_t m_cursor = 0;
+  size_t m_concurrency;
+  std::deque<async::task<Batch>> m_pending;
 };
 }  // namespace XiSync
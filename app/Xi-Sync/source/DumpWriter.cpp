@@ -26,7 +26,10 @@
 #include <stdexcept>
 #include <numeric>
 
+#include <lz4.h>
+
 #include <Xi/Exceptional.hpp>
+#include <Xi/Endianess/Little.hh>
 #include <Common/VectorOutputStream.h>
 #include <CryptoNoteCore/CryptoNoteTools.h>
 
@@ -40,6 +43,7 @@ XI_DECLARE_EXCEPTIONAL_INSTANCE(InsufficientBlocks, "you need to provide at leas
 XI_DECLARE_EXCEPTIONAL_INSTANCE(TooManyBlocks, "you may not exceed a height of 2^32-1", InvalidWrite);
 XI_DECLARE_EXCEPTIONAL_INSTANCE(InvalidRawBlock, "provided raw black cannot be deserialized", InvalidWrite);
 XI_DECLARE_EXCEPTIONAL_INSTANCE(StreamCorrupted, "stream corrupted while writing", InvalidWrite);
+XI_DECLARE_EXCEPTIONAL_INSTANCE(AlreadyFinished, "the batch index was already written", InvalidWrite);
 // clang-format on
 }  // namespace
 
@@ -53,8 +57,15 @@ uint32_t XiSync::DumpWriter::checkpointsDensity() const { return m_checkpointDen
 
 void XiSync::DumpWriter::setCheckpointsDensity(uint32_t density) { m_checkpointDensity = density; }
 
+XiSync::BatchCompression XiSync::DumpWriter::compression() const { return m_compression; }
+
+void XiSync::DumpWriter::setCompression(XiSync::BatchCompression compression) { m_compression = compression; }
+
 Xi::Result<void> XiSync::DumpWriter::write(uint32_t startIndex, std::vector<CryptoNote::RawBlock> blockBatch) {
   XI_ERROR_TRY();
+  if (m_finished) {
+    Xi::exceptional<AlreadyFinishedError>();
+  }
   if (blockBatch.empty()) {
     Xi::exceptional<InsufficientBlocksError>();
   }
@@ -84,16 +95,52 @@ Xi::Result<void> XiSync::DumpWriter::write(uint32_t startIndex, std::vector<Cryp
     batch.Info.BinarySize = preSerializedRawBlocks.size();
   }
 
-  if (!m_serializer(batch.Info, "")) {
-    throw std::runtime_error{"block serialization failed"};
+  BatchIndexEntry entry{};
+  entry.Info = std::move(batch.Info);
+  entry.Offset = m_offset;
+  entry.Compression = static_cast<uint8_t>(BatchCompression::None);
+  if (compression() == BatchCompression::LZ4) {
+    auto compressed = compress(preSerializedRawBlocks);
+    if (!compressed.empty()) {
+      preSerializedRawBlocks = std::move(compressed);
+      entry.Compression = static_cast<uint8_t>(BatchCompression::LZ4);
+    }
   }
+  entry.StoredSize = preSerializedRawBlocks.size();
+  entry.Checksum = Xi::Crypto::Hash::crc32(preSerializedRawBlocks);
+
   m_stdStream.write(reinterpret_cast<char *>(preSerializedRawBlocks.data()),
                     static_cast<int64_t>(preSerializedRawBlocks.size()));
 
   if (!m_stdStream.good()) {
     Xi::exceptional<StreamCorruptedError>();
   }
+  m_offset += entry.StoredSize;
+  m_index.Batches.emplace_back(std::move(entry));
+
+  return Xi::success();
+  XI_ERROR_CATCH();
+}
+
+Xi::Result<void> XiSync::DumpWriter::finish() {
+  XI_ERROR_TRY();
+  if (m_finished) {
+    Xi::exceptional<AlreadyFinishedError>();
+  }
+  m_finished = true;
+
+  if (!m_serializer(m_index, "")) {
+    throw std::runtime_error{"batch index serialization failed"};
+  }
+  const uint64_t indexOffset = Xi::Endianess::little(m_offset);
+  m_stdStream.write(reinterpret_cast<const char *>(DumpIndexMagic.data()),
+                    static_cast<int64_t>(DumpIndexMagic.size()));
+  m_stdStream.write(reinterpret_cast<const char *>(&indexOffset), static_cast<int64_t>(sizeof(indexOffset)));
+  m_stdStream.flush();
 
+  if (!m_stdStream.good()) {
+    Xi::exceptional<StreamCorruptedError>();
+  }
   return Xi::success();
   XI_ERROR_CATCH();
 }
@@ -109,6 +156,7 @@ XiSync::DumpWriter::DumpWriter(const std::string &file)
   if (!m_serializer(header, "")) {
     throw std::runtime_error{"header serialization failed."};
   }
+  m_offset = static_cast<uint64_t>(m_stdStream.tellp());
 }
 
 Crypto::Hash XiSync::DumpWriter::checkBlock(const CryptoNote::RawBlock &block) const {
@@ -119,3 +167,21 @@ Crypto::Hash XiSync::DumpWriter::checkBlock(const CryptoNote::RawBlock &block) c
   CryptoNote::CachedBlock cb{bt};
   return cb.getBlockHash();
 }
+
+CryptoNote::BinaryArray XiSync::DumpWriter::compress(const CryptoNote::BinaryArray &payload) const {
+  if (payload.size() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+    return CryptoNote::BinaryArray{};
+  }
+  const int payloadSize = static_cast<int>(payload.size());
+  CryptoNote::BinaryArray reval{};
+  reval.resize(static_cast<size_t>(LZ4_compressBound(payloadSize)));
+  const int compressedSize = LZ4_compress_default(reinterpret_cast<const char *>(payload.data()),
+                                                  reinterpret_cast<char *>(reval.data()), payloadSize,
+                                                  static_cast<int>(reval.size()));
+  // Incompressible batches are stored as they are.
+  if (compressedSize <= 0 || static_cast<size_t>(compressedSize) >= payload.size()) {
+    return CryptoNote::BinaryArray{};
+  }
+  reval.resize(static_cast<size_t>(compressedSize));
+  return reval;
+}
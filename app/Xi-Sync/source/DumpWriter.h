@@ -34,6 +34,8 @@
 #include <CryptoNoteCore/CachedBlock.h>
 #include <CryptoNoteCore/Blockchain/RawBlock.h>
 
+#include "DumpIndex.h"
+
 namespace XiSync {
 class DumpWriter final {
  public:
@@ -47,17 +49,33 @@ class DumpWriter final {
   uint32_t checkpointsDensity() const;
   void setCheckpointsDensity(uint32_t density);
 
+  BatchCompression compression() const;
+  void setCompression(BatchCompression compression);
+
   Xi::Result<void> write(uint32_t startIndex, std::vector<CryptoNote::RawBlock> blockBatch);
 
+  /*!
+   * \brief finish appends the batch index, no batches may be written afterwards.
+   *
+   * A writer destroyed without finish, e.g. while unwinding from a failed export, leaves the dump without an index
+   * and readers reject it as incomplete.
+   */
+  Xi::Result<void> finish();
+
  private:
   DumpWriter(const std::string& file);
 
   Crypto::Hash checkBlock(const CryptoNote::RawBlock& block) const;
+  CryptoNote::BinaryArray compress(const CryptoNote::BinaryArray& payload) const;
 
  private:
   std::ofstream m_stdStream;
   Common::StdOutputStream m_streamWrapper;
   CryptoNote::BinaryOutputStreamSerializer m_serializer;
   uint32_t m_checkpointDensity = 100;
+  BatchCompression m_compression = BatchCompression::None;
+  DumpIndex m_index;
+  uint64_t m_offset = 0;
+  bool m_finished = false;
 };
 }  // namespace XiSync
@@ -23,6 +23,10 @@
 
 #include "Importer.h"
 
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+
 #include <Xi/Exceptional.hpp>
 
 namespace {
@@ -31,7 +35,14 @@ XI_DECLARE_EXCEPTIONAL_INSTANCE(InvalidBlock, "a block in the dump file is inval
 }  // namespace
 
 XiSync::Importer::Importer(CryptoNote::ICore &core, CryptoNote::Checkpoints &checkpoints, Logging::ILogger &logger)
-    : m_core{core}, m_checkpoints{checkpoints}, m_logger{logger, "Sync-Importer"} {}
+    : m_core{core},
+      m_checkpoints{checkpoints},
+      m_logger{logger, "Sync-Importer"},
+      m_start{std::chrono::steady_clock::now()} {
+  if (m_checkpoints.isTrustedImport()) {
+    m_logger(Logging::Info) << "Trusted import enabled, ring signatures within the checkpoint zone are not verified.";
+  }
+}
 
 XiSync::DumpReader::Visitor::BatchCommand XiSync::Importer::onInfo(const XiSync::BatchInfo &info) {
   auto currentTopIndex = m_core.getTopBlockIndex();
@@ -49,13 +60,40 @@ void XiSync::Importer::onBatch(XiSync::Batch batch) {
     m_checkpoints.addCheckpoint(checkpoint.first, checkpoint.second);
   }
 
-  for (uint32_t index = 0; index < batch.Blocks.size(); ++index) {
-    if (currentTopIndex >= batch.Info.StartIndex + index) {
-      continue;
-    }
-    auto res = m_core.addBlock(std::move(batch.Blocks[index]));
+  assert(batch.CachedBlocks.size() == batch.Blocks.size());
+  size_t offset = 0;
+  if (currentTopIndex >= batch.Info.StartIndex) {
+    offset = std::min<size_t>(currentTopIndex - batch.Info.StartIndex + 1, batch.Blocks.size());
+  }
+  if (offset == batch.Blocks.size()) {
+    return;
+  }
+
+  // The remaining blocks are imported as one batch, the core validates them ahead while committing in order.
+  std::vector<CryptoNote::CachedBlock> cachedBlocks{std::make_move_iterator(batch.CachedBlocks.begin() + offset),
+                                                    std::make_move_iterator(batch.CachedBlocks.end())};
+  std::vector<CryptoNote::RawBlock> rawBlocks{std::make_move_iterator(batch.Blocks.begin() + offset),
+                                              std::make_move_iterator(batch.Blocks.end())};
+  std::error_code failure{};
+  const auto batchStart = std::chrono::steady_clock::now();
+  const auto onBlockProcessed = [&failure](size_t, const std::error_code &res) {
     if (res != CryptoNote::error::AddBlockErrorCondition::BLOCK_ADDED) {
-      Xi::exceptional<InvalidBlockError>(std::string{"block is invalid: "} + res.message());
+      failure = res;
+      return false;
     }
+    return true;
+  };
+  const auto added = m_core.addBlocks(cachedBlocks, std::move(rawBlocks), onBlockProcessed);
+  if (failure) {
+    Xi::exceptional<InvalidBlockError>(std::string{"block is invalid: "} + failure.message());
   }
+
+  m_importedBlocks += added;
+  const auto now = std::chrono::steady_clock::now();
+  const auto batchTime = std::chrono::duration_cast<std::chrono::milliseconds>(now - batchStart).count();
+  const auto totalTime = std::chrono::duration_cast<std::chrono::seconds>(now - m_start).count();
+  m_logger(Logging::Info) << "Imported blocks up to " << m_core.getTopBlockIndex() << ", " << added << " blocks in "
+                          << batchTime << "ms, " << m_importedBlocks << " blocks in " << totalTime << "s ("
+                          << (totalTime > 0 ? m_importedBlocks / static_cast<size_t>(totalTime) : m_importedBlocks)
+                          << " blocks/s)";
 }
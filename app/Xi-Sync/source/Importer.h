@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+
 #include <Logging/ILogger.h>
 #include <Logging/LoggerRef.h>
 #include <CryptoNoteCore/ICore.h>
@@ -43,5 +46,8 @@ class Importer : public DumpReader::Visitor {
   CryptoNote::ICore& m_core;
   CryptoNote::Checkpoints& m_checkpoints;
   Logging::LoggerRef m_logger;
+
+  std::chrono::steady_clock::time_point m_start;
+  size_t m_importedBlocks = 0;
 };
 }  // namespace XiSync
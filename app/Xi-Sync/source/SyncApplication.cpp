@@ -96,15 +96,19 @@ void SyncApplication::import() {
 void SyncApplication::localExport() {
   auto writer = DumpWriter::open(Options.DumpFile).takeOrThrow();
   writer->setCheckpointsDensity(Options.CheckpointsDensity);
+  writer->setCompression(Options.Compress ? BatchCompression::LZ4 : BatchCompression::None);
   LocalExporter exporter{*core(), *writer, logger()};
   exporter.exportBlocks(0, std::numeric_limits<uint32_t>::max(), Options.BatchSize).throwOnError();
+  writer->finish().throwOnError();
 }
 
 void SyncApplication::remoteExport() {
   auto writer = DumpWriter::open(Options.DumpFile).takeOrThrow();
   writer->setCheckpointsDensity(Options.CheckpointsDensity);
+  writer->setCompression(Options.Compress ? BatchCompression::LZ4 : BatchCompression::None);
   auto rpc = rpcNode(false);
   rpc->init().get().throwOnError();
   RemoteExporter exporter{*rpc, *writer, logger()};
   exporter.exportBlocks(0, std::numeric_limits<uint32_t>::max(), Options.BatchSize).throwOnError();
+  writer->finish().throwOnError();
 }
@@ -49,6 +49,7 @@ void XiSync::SyncOptions::loadEnvironment(Xi::App::Environment &env) {
     (CheckpointsDensity, "SYNC_DENSITY")
     (UseRemote, "SYNC_REMOTE")
     (TruncFile, "SYNC_TRUNC")
+    (Compress, "SYNC_COMPRESS")
   ;
   // clang-format on
 }
@@ -76,6 +77,9 @@ void XiSync::SyncOptions::emplaceOptions(cxxopts::Options &options) {
 
     ("t,trunc", "overrites the export file if present.",
       cxxopts::value<bool>(TruncFile)->default_value(TruncFile ? "true" : "false")->implicit_value("true"))
+
+    ("c,compress", "compresses every exported batch using lz4.",
+      cxxopts::value<bool>(Compress)->default_value(Compress ? "true" : "false")->implicit_value("true"))
   ;
   // clang-format on
 }
@@ -103,6 +107,9 @@ bool XiSync::SyncOptions::evaluateParsedOptions(const cxxopts::Options &options,
     if (result.count("checkpoints-density") > 0) {
       Xi::exceptional<UnexpectedFlagError>("you may only specify the checkpoints-density flag on exports.");
     }
+    if (result.count("compress") > 0) {
+      Xi::exceptional<UnexpectedFlagError>("you may only specify the compress flag on exports.");
+    }
     if (BatchSize < 10) {
       Xi::exceptional<InvalidBatchSizeError>();
     }
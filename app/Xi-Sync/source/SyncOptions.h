@@ -46,6 +46,7 @@ class SyncOptions {
   uint32_t CheckpointsDensity = 100;
   bool TruncFile = false;
   bool UseRemote = false;
+  bool Compress = false;
 
   void loadEnvironment(Xi::App::Environment& env);
   void emplaceOptions(cxxopts::Options& options);
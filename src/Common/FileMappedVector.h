@@ -289,6 +289,8 @@ class FileMappedVector : public EnableIfPod<T>::type {
   uint8_t* suffix();
   uint64_t suffixSize() const;
   void resizeSuffix(uint64_t newSuffixSize);
+  // Grows the file in place instead of copying it, a torn append only leaves garbage at the end of the suffix.
+  void appendSuffix(const uint8_t* data, uint64_t size);
 
   void rename(const std::string& newPath, std::error_code& ec);
   void rename(const std::string& newPath);
@@ -735,6 +737,25 @@ void FileMappedVector<T>::resizeSuffix(uint64_t newSuffixSize) {
   }
 }
 
+template <class T>
+void FileMappedVector<T>::appendSuffix(const uint8_t* data, uint64_t size) {
+  assert(isOpened());
+
+  if (size == 0) {
+    return;
+  }
+
+  if (m_file.path() != m_path) {
+    throw std::runtime_error("Vector is mapped to a .bak file due to earlier errors");
+  }
+
+  const uint64_t offset = m_file.size();
+  m_file.resize(offset + size);
+  m_suffixSize += size;
+  std::copy(data, data + size, m_file.data() + offset);
+  m_file.flush(m_file.data() + offset, size);
+}
+
 template <class T>
 void FileMappedVector<T>::rename(const std::string& newPath, std::error_code& ec) {
   m_file.rename(newPath, ec);
@@ -35,6 +35,16 @@ CryptoNote::CommonBlockchainCache::CommonBlockchainCache(Logging::ILogger& logge
     : m_logger(logger, "CommonBlockchainCache"), m_currency(currency) {
 }
 
+void CryptoNote::CommonBlockchainCache::beginBatchedPush() {
+}
+
+void CryptoNote::CommonBlockchainCache::commitBatchedPush() {
+}
+
+CryptoNote::BlockchainReadCacheStatistics CryptoNote::CommonBlockchainCache::getReadCacheStatistics() const {
+  return BlockchainReadCacheStatistics{};
+}
+
 bool CryptoNote::CommonBlockchainCache::isTransactionSpendTimeUnlocked(uint64_t unlockTime) const {
   return isTransactionSpendTimeUnlocked(unlockTime, getTopBlockIndex());
 }
@@ -42,6 +42,11 @@ class CommonBlockchainCache : public IBlockchainCache {
   virtual ~CommonBlockchainCache() override = default;
 
   // ------------------------------------------ IBlockchainCache ------------------------------------------------------
+  /// The in memory cache has nothing to batch, storage backed caches override these.
+  void beginBatchedPush() override;
+  void commitBatchedPush() override;
+  BlockchainReadCacheStatistics getReadCacheStatistics() const override;
+
   [[nodiscard]] bool isTransactionSpendTimeUnlocked(uint64_t unlockTime) const override;
   [[nodiscard]] bool isTransactionSpendTimeUnlocked(uint64_t unlockTime, uint32_t blockIndex) const override;
   [[nodiscard]] bool isTransactionSpendTimeUnlocked(uint64_t unlockTime, uint32_t blockIndex,
@@ -0,0 +1,174 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Xi/Global.hh>
+#include <Xi/Concurrent/ReadersWriterLock.h>
+
+#include "CryptoNoteCore/Blockchain/ReadCacheStatistics.h"
+
+namespace CryptoNote {
+
+/*!
+ * \brief The KeyOutputColumnIndex class keeps the block index and unlock time of every global key output in memory.
+ *
+ * Outputs are stored per amount in two packed columns addressed by the global output index. Columns are loaded lazily
+ * from the storage on first access and maintained by the owning cache afterwards, thus answering mixin availability
+ * and unlock queries without touching the database.
+ */
+class KeyOutputColumnIndex {
+ public:
+  using Amount = uint64_t;
+  using GlobalOutputIndex = uint32_t;
+
+  struct Column {
+    std::vector<uint32_t> blockIndices;
+    std::vector<uint64_t> unlockTimes;
+
+    size_t size() const {
+      return blockIndices.size();
+    }
+
+    void reserve(size_t count) {
+      blockIndices.reserve(count);
+      unlockTimes.reserve(count);
+    }
+
+    void push_back(uint32_t blockIndex, uint64_t unlockTime) {
+      blockIndices.push_back(blockIndex);
+      unlockTimes.push_back(unlockTime);
+    }
+
+    void truncate(size_t count) {
+      if (count < size()) {
+        blockIndices.resize(count);
+        unlockTimes.resize(count);
+      }
+    }
+
+    /// Number of outputs included until the given block index (inclusive), block indices are non decreasing.
+    uint64_t countUntil(uint32_t blockIndex) const {
+      auto end = std::upper_bound(blockIndices.begin(), blockIndices.end(), blockIndex);
+      return static_cast<uint64_t>(std::distance(blockIndices.begin(), end));
+    }
+
+    size_t memoryUsage() const {
+      return blockIndices.capacity() * sizeof(uint32_t) + unlockTimes.capacity() * sizeof(uint64_t);
+    }
+  };
+
+  /// Reads the complete column of an amount from the storage.
+  using loader = std::function<Column(Amount)>;
+
+ public:
+  explicit KeyOutputColumnIndex(loader load) : m_load{std::move(load)} {
+  }
+  XI_DELETE_COPY(KeyOutputColumnIndex);
+  XI_DELETE_MOVE(KeyOutputColumnIndex);
+  ~KeyOutputColumnIndex() = default;
+
+  /*!
+   * \brief visit calls the visitor with the column of the given amount, loading it first if not yet present.
+   *
+   * The visitor runs under a shared lock and must not call back into the index.
+   */
+  template <typename _VisitorT>
+  auto visit(Amount amount, _VisitorT&& visitor) const -> decltype(visitor(std::declval<const Column&>())) {
+    {
+      XI_CONCURRENT_LOCK_READ(m_guard);
+      auto search = m_columns.find(amount);
+      if (search != m_columns.end()) {
+        return visitor(search->second);
+      }
+    }
+
+    XI_CONCURRENT_LOCK_WRITE(m_guard);
+    auto search = m_columns.find(amount);
+    if (search == m_columns.end()) {
+      search = m_columns.emplace(amount, m_load(amount)).first;
+    }
+    return visitor(search->second);
+  }
+
+  /*!
+   * \brief append adds a new output to an already loaded column.
+   *
+   * Columns not loaded yet are left untouched, they will read the output from the storage once requested. A column
+   * out of sync with the given global index is dropped and reloaded lazily.
+   */
+  void append(Amount amount, GlobalOutputIndex globalIndex, uint32_t blockIndex, uint64_t unlockTime) {
+    XI_CONCURRENT_LOCK_WRITE(m_guard);
+    auto search = m_columns.find(amount);
+    if (search == m_columns.end()) {
+      return;
+    }
+    if (search->second.size() != globalIndex) {
+      m_columns.erase(search);
+      return;
+    }
+    search->second.push_back(blockIndex, unlockTime);
+  }
+
+  /// Drops all outputs of the amount with a global index greater or equal to count.
+  void truncate(Amount amount, GlobalOutputIndex count) {
+    XI_CONCURRENT_LOCK_WRITE(m_guard);
+    auto search = m_columns.find(amount);
+    if (search != m_columns.end()) {
+      search->second.truncate(count);
+    }
+  }
+
+  void clear() {
+    XI_CONCURRENT_LOCK_WRITE(m_guard);
+    m_columns.clear();
+  }
+
+  /// Reports the outputs and bytes held for every loaded amount.
+  std::vector<KeyOutputIndexUsage> usage() const {
+    XI_CONCURRENT_LOCK_READ(m_guard);
+    std::vector<KeyOutputIndexUsage> reval{};
+    reval.reserve(m_columns.size());
+    for (const auto& column : m_columns) {
+      reval.push_back(KeyOutputIndexUsage{column.first, column.second.size(), column.second.memoryUsage()});
+    }
+    std::sort(reval.begin(), reval.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.amount < rhs.amount; });
+    return reval;
+  }
+
+ private:
+  loader m_load;
+  Xi::Concurrent::ReadersWriterLock m_guard;
+  mutable std::unordered_map<Amount, Column> m_columns;
+};
+
+}  // namespace CryptoNote
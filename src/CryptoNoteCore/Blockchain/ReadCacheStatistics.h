@@ -0,0 +1,77 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include <Xi/Global.hh>
+
+#include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+/*!
+ * \brief The KeyOutputIndexUsage struct reports the in memory key output index footprint of a single amount.
+ */
+struct KeyOutputIndexUsage {
+  uint64_t amount{0};
+  uint64_t outputs{0};
+  uint64_t bytes{0};
+
+  [[nodiscard]] bool serialize(ISerializer& s) {
+    XI_RETURN_EC_IF_NOT(s(amount, "amount"), false);
+    XI_RETURN_EC_IF_NOT(s(outputs, "outputs"), false);
+    XI_RETURN_EC_IF_NOT(s(bytes, "bytes"), false);
+    return true;
+  }
+};
+
+/*!
+ * \brief The BlockchainReadCacheStatistics struct reports the efficiency of the decoded block and transaction caches
+ * kept in front of the blockchain storage.
+ */
+struct BlockchainReadCacheStatistics {
+  uint64_t blockHits{0};
+  uint64_t blockMisses{0};
+  uint64_t blockCacheSize{0};  ///< Accounted bytes currently held by the raw block cache.
+  uint64_t transactionHits{0};
+  uint64_t transactionMisses{0};
+  uint64_t transactionCacheSize{0};  ///< Accounted bytes currently held by the transaction info cache.
+  std::vector<KeyOutputIndexUsage> keyOutputIndex{};  ///< Loaded key output columns, ordered by amount.
+
+  [[nodiscard]] bool serialize(ISerializer& s) {
+    XI_RETURN_EC_IF_NOT(s(blockHits, "block_hits"), false);
+    XI_RETURN_EC_IF_NOT(s(blockMisses, "block_misses"), false);
+    XI_RETURN_EC_IF_NOT(s(blockCacheSize, "block_cache_size"), false);
+    XI_RETURN_EC_IF_NOT(s(transactionHits, "transaction_hits"), false);
+    XI_RETURN_EC_IF_NOT(s(transactionMisses, "transaction_misses"), false);
+    XI_RETURN_EC_IF_NOT(s(transactionCacheSize, "transaction_cache_size"), false);
+    XI_RETURN_EC_IF_NOT(s(keyOutputIndex, "key_output_index"), false);
+    return true;
+  }
+};
+
+}  // namespace CryptoNote
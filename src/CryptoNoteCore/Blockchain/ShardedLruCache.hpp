@@ -0,0 +1,175 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <Xi/Global.hh>
+
+namespace CryptoNote {
+
+/*!
+ * \brief The ShardedLruCache class is a bounded, thread safe least recently used cache.
+ *
+ * Keys are distributed over independently locked shards, each evicting its least recently used entries once the
+ * accounted size of its values exceeds its share of the capacity. Values are accounted using the provided size
+ * function, thus the capacity is usually given in bytes.
+ */
+template <typename _KeyT, typename _ValueT, typename _HashT = std::hash<_KeyT>>
+class ShardedLruCache {
+ public:
+  using key_type = _KeyT;
+  using value_type = _ValueT;
+  using size_function = std::function<size_t(const value_type&)>;
+
+ public:
+  ShardedLruCache(size_t capacity, size_t shardCount, size_function sizeOf)
+      : m_shardCount{shardCount > 0 ? shardCount : 1},
+        m_shardCapacity{capacity / m_shardCount},
+        m_shards{new Shard[m_shardCount]},
+        m_sizeOf{std::move(sizeOf)} {
+  }
+  XI_DELETE_COPY(ShardedLruCache);
+  XI_DELETE_MOVE(ShardedLruCache);
+  ~ShardedLruCache() = default;
+
+  /// Returns a copy of the cached value and marks it as most recently used, counts a hit or a miss.
+  std::optional<value_type> get(const key_type& key) {
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock{shard.guard};
+    auto search = shard.index.find(key);
+    if (search == shard.index.end()) {
+      m_misses.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, search->second);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return search->second->value;
+  }
+
+  /// Inserts or replaces the value, values larger than a shard are not cached at all.
+  void put(const key_type& key, value_type value) {
+    const size_t size = m_sizeOf(value);
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock{shard.guard};
+    eraseEntry(shard, key);
+    if (size > m_shardCapacity) {
+      return;
+    }
+    shard.entries.push_front(Entry{key, std::move(value), size});
+    shard.index.emplace(key, shard.entries.begin());
+    shard.size += size;
+    m_size.fetch_add(size, std::memory_order_relaxed);
+    while (shard.size > m_shardCapacity) {
+      eraseEntry(shard, shard.entries.back().key);
+    }
+  }
+
+  void erase(const key_type& key) {
+    auto& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock{shard.guard};
+    eraseEntry(shard, key);
+  }
+
+  /// Erases all entries for whose value the predicate returns true, visits every shard.
+  template <typename _PredicateT>
+  void eraseIf(_PredicateT predicate) {
+    for (size_t i = 0; i < m_shardCount; ++i) {
+      auto& shard = m_shards[i];
+      std::lock_guard<std::mutex> lock{shard.guard};
+      for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+        if (predicate(it->key, it->value)) {
+          auto key = (it++)->key;
+          eraseEntry(shard, key);
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+
+  void clear() {
+    eraseIf([](const key_type&, const value_type&) { return true; });
+  }
+
+  uint64_t hits() const {
+    return m_hits.load(std::memory_order_relaxed);
+  }
+  uint64_t misses() const {
+    return m_misses.load(std::memory_order_relaxed);
+  }
+  /// Sum of the accounted sizes of all cached values.
+  uint64_t size() const {
+    return m_size.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    key_type key;
+    value_type value;
+    size_t size;
+  };
+  using entry_list = std::list<Entry>;
+
+  struct Shard {
+    std::mutex guard;
+    entry_list entries;
+    std::unordered_map<key_type, typename entry_list::iterator, _HashT> index;
+    size_t size{0};
+  };
+
+  Shard& shardOf(const key_type& key) {
+    return m_shards[_HashT{}(key) % m_shardCount];
+  }
+
+  void eraseEntry(Shard& shard, const key_type& key) {
+    auto search = shard.index.find(key);
+    if (search == shard.index.end()) {
+      return;
+    }
+    shard.size -= search->second->size;
+    m_size.fetch_sub(search->second->size, std::memory_order_relaxed);
+    shard.entries.erase(search->second);
+    shard.index.erase(search);
+  }
+
+ private:
+  const size_t m_shardCount;
+  const size_t m_shardCapacity;
+  std::unique_ptr<Shard[]> m_shards;
+  size_function m_sizeOf;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+  std::atomic<uint64_t> m_size{0};
+};
+
+}  // namespace CryptoNote
@@ -215,6 +215,10 @@ const std::unordered_map<uint32_t, RawBlock>& BlockchainReadResult::getRawBlocks
   return state.rawBlocks;
 }
 
+std::unordered_map<uint32_t, RawBlock> BlockchainReadResult::takeRawBlocks() {
+  return std::move(state.rawBlocks);
+}
+
 const std::pair<uint32_t, bool>& BlockchainReadResult::getLastBlockIndex() const {
   return state.lastBlockIndex;
 }
@@ -252,7 +256,7 @@ const KeyOutputKeyResult& BlockchainReadResult::getKeyOutputInfo() const {
   return state.keyOutputKeys;
 }
 
-void BlockchainReadBatch::submitRawResult(const std::vector<std::string>& values,
+void BlockchainReadBatch::submitRawResult(const std::vector<Xi::ConstByteSpan>& values,
                                           const std::vector<bool>& resultStates) {
   assert(state.size() == values.size());
   assert(values.size() == resultStates.size());
@@ -104,6 +104,7 @@ class BlockchainReadResult {
   const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex>&
   getKeyOutputGlobalIndexesForAmounts() const;
   const std::unordered_map<uint32_t, RawBlock>& getRawBlocks() const;
+  std::unordered_map<uint32_t, RawBlock> takeRawBlocks();
   const std::pair<uint32_t, bool>& getLastBlockIndex() const;
   const std::unordered_map<uint64_t, uint32_t>& getClosestTimestampBlockIndex() const;
   uint32_t getKeyOutputAmountsCount() const;
@@ -146,7 +147,7 @@ class BlockchainReadBatch : public IReadBatch {
                                             IBlockchainCache::GlobalOutputIndex globalIndex);
 
   std::vector<std::string> getRawKeys() const override;
-  void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override;
+  void submitRawResult(const std::vector<Xi::ConstByteSpan>& values, const std::vector<bool>& resultStates) override;
 
   BlockchainReadResult extractResult();
 
@@ -34,6 +34,18 @@ bool Checkpoints::isEnabled() const {
 void Checkpoints::setEnabled(bool useCheckpoints) {
   m_enabled = useCheckpoints;
 }
+
+bool Checkpoints::isTrustedImport() const {
+  return m_trustedImport;
+}
+
+void Checkpoints::setTrustedImport(bool trustedImport) {
+  m_trustedImport = trustedImport;
+}
+
+bool Checkpoints::isTrustedZone(uint32_t index) const {
+  return m_trustedImport && isInCheckpointZone(index);
+}
 //---------------------------------------------------------------------------
 bool Checkpoints::addCheckpoint(uint32_t index, const std::string &hash_str) {
   auto hashParseResult = Crypto::Hash::fromString(hash_str);
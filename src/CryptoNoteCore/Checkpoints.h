@@ -40,6 +40,18 @@ class Checkpoints {
   bool isEnabled() const;
   void setEnabled(bool useCheckpoints);
 
+  /*!
+   * \brief isTrustedImport Blocks within the checkpoint zone skip ring signature verification.
+   *
+   * Structural, accounting and key image checks are still applied. The checkpointed block hashes
+   * commit to every transaction, thus the signatures may only be skipped if the checkpoints are
+   * trusted.
+   */
+  bool isTrustedImport() const;
+  void setTrustedImport(bool trustedImport);
+  /// True if the block at index is within the checkpoint zone and trusted import is enabled.
+  bool isTrustedZone(uint32_t index) const;
+
   bool addCheckpoint(uint32_t index, const std::string& hash_str);
   bool addCheckpoint(uint32_t index, const Crypto::Hash& hash);
   bool loadCheckpointsFromFile(const std::string& fileName);
@@ -53,6 +65,7 @@ class Checkpoints {
 
  private:
   bool m_enabled = false;
+  bool m_trustedImport = false;
   std::map<uint32_t, Crypto::Hash> points;
   Logging::LoggerRef logger;
 };
@@ -6,7 +6,9 @@
 // Please see the included LICENSE file for more information.
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <optional>
 #include <set>
 #include <unordered_set>
 
@@ -22,9 +24,11 @@
 
 #include "Core.h"
 #include "Common/ShuffleGenerator.h"
+#include "Common/ScopeExit.h"
 #include "Common/Math.h"
 #include "Common/MemoryInputStream.h"
 #include "CryptoNoteTools.h"
+#include "CheckDifficulty.h"
 #include "CryptoNoteFormatUtils.h"
 #include "BlockchainCache.h"
 #include "BlockchainStorage.h"
@@ -177,6 +181,27 @@ const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::
 
 }  // namespace
 
+struct Core::PreparedBlock {
+  bool isPrepared = false;
+
+  bool isExtracted = false;
+  std::vector<CachedTransaction> transactions{};
+  uint64_t cumulativeSize = 0;
+
+  /// Empty if the block is in the checkpoint zone or the proof of work blob could not be computed.
+  std::optional<Crypto::Hash> proofOfWorkHash{};
+
+  /// The chain position assumed for the transfer pre validation, reevaluated once the block is added.
+  bool hasContext = false;
+  uint32_t previousBlockIndex = 0;
+  uint64_t timestamp = 0;
+
+  bool isTransfersPrevalidated = false;
+  std::vector<TransferValidationState> transferValidations{};
+  std::vector<TransferValidationCache> transferCaches{};
+  std::vector<std::error_code> transferResults{};
+};
+
 Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints& checkpoints, System::Dispatcher& dispatcher,
            bool isLightNode, std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory,
            std::unique_ptr<IMainChainStorage>&& mainchainStorage)
@@ -202,8 +227,8 @@ Core::~Core() {
   contextGroup.wait();
 }
 
-Xi::Concurrent::RecursiveLock::lock_t Core::lock() const {
-  return Xi::Concurrent::RecursiveLock::lock_t{m_access};
+Xi::Concurrent::RecursiveReadersWriterLock::write_lock_t Core::lock() const {
+  return Xi::Concurrent::RecursiveReadersWriterLock::write_lock_t{m_access};
 }
 
 bool Core::addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) {
@@ -294,7 +319,7 @@ uint32_t Core::getTopBlockIndex() const {
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return chainsLeaves[0]->getTopBlockIndex();
 }
 
@@ -303,7 +328,7 @@ Crypto::Hash Core::getTopBlockHash() const {
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return chainsLeaves[0]->getTopBlockHash();
 }
 
@@ -312,7 +337,7 @@ BlockVersion Core::getTopBlockVersion() const {
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   return chainsLeaves[0]->getTopBlockVersion();
 }
@@ -323,7 +348,7 @@ Crypto::Hash Core::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(blockIndex <= getTopBlockIndex());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return chainsLeaves[0]->getBlockHash(blockIndex);
 }
 
@@ -332,7 +357,7 @@ uint32_t Core::getBlockIndexByHash(const Hash hash) const {
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   const auto cache = findSegmentContainingBlock(hash);
   XI_RETURN_EC_IF(cache == nullptr, INVALID_BLOCK_INDEX);
   return cache->getBlockIndex(hash);
@@ -344,13 +369,13 @@ uint64_t Core::getBlockTimestampByIndex(uint32_t blockIndex) const {
   assert(blockIndex <= getTopBlockIndex());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return chainsLeaves[0]->getCurrentTimestamp(blockIndex);
 }
 
 std::optional<BlockSource> Core::hasBlock(const Crypto::Hash& blockHash) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   bool isMainChain = false;
   if (findSegmentContainingBlock(blockHash, &isMainChain) == nullptr) {
     return std::nullopt;
@@ -365,7 +390,7 @@ std::optional<CoreBlockInfo> Core::getBlockByIndex(uint32_t index) const {
   assert(index <= getTopBlockIndex());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   IBlockchainCache* segment = findMainChainSegmentContainingBlock(index);
   assert(segment != nullptr);
 
@@ -381,7 +406,7 @@ std::optional<CoreBlockInfo> Core::getBlockByHash(const Crypto::Hash& blockHash)
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   bool isMainChain = false;
   IBlockchainCache* segment = findSegmentContainingBlock(blockHash, &isMainChain);
   if (segment == nullptr) {
@@ -395,7 +420,7 @@ std::optional<CoreBlockInfo> Core::getBlockByHash(const Crypto::Hash& blockHash)
 
 std::vector<Crypto::Hash> Core::buildSparseChain() const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   Crypto::Hash topBlockHash = chainsLeaves[0]->getTopBlockHash();
   return doBuildSparseChain(topBlockHash);
 }
@@ -405,7 +430,7 @@ std::vector<RawBlock> Core::getBlocks(uint32_t minIndex, uint32_t count) const {
   assert(!chainsLeaves.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   std::vector<RawBlock> blocks;
   if (count > 0) {
     auto cache = chainsLeaves[0];
@@ -442,30 +467,50 @@ void Core::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<R
 void Core::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<RawBlock>& blocks,
                      std::vector<Crypto::Hash>& missedHashes, uint64_t maxBlobSize) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   uint64_t cumulativeBlobSize = 0;
   blocks.reserve(blockHashes.size());
+
+  // Consecutive blocks of the same segment are read within one batch and moved into the response as they are.
+  IBlockchainCache* pendingSegment = nullptr;
+  BlockHeightVector pendingHeights{};
+  const auto flushPending = [&]() {
+    if (pendingHeights.empty()) {
+      return true;
+    }
+    auto segmentBlocks = mainChainSet.count(pendingSegment) > 0 ? getMainChainBlocks(*pendingSegment, pendingHeights)
+                                                                 : pendingSegment->getBlocks(pendingHeights);
+    pendingHeights.clear();
+    for (auto& block : segmentBlocks) {
+      cumulativeBlobSize += block.blockTemplate.size();
+      for (const auto& txBlob : block.transactions) {
+        cumulativeBlobSize += txBlob.size();
+      }
+      if (cumulativeBlobSize > maxBlobSize) {
+        return false;
+      }
+      blocks.emplace_back(std::move(block));
+    }
+    return true;
+  };
+
   for (const auto& hash : blockHashes) {
     IBlockchainCache* blockchainSegment = findSegmentContainingBlock(hash);
+    if (blockchainSegment != pendingSegment && !flushPending()) {
+      return;
+    }
+    pendingSegment = blockchainSegment;
+
     if (blockchainSegment == nullptr) {
       missedHashes.push_back(hash);
     } else {
       uint32_t blockIndex = blockchainSegment->getBlockIndex(hash);
       assert(blockIndex <= blockchainSegment->getTopBlockIndex());
       assert(hash == blockchainSegment->getBlockHash(blockIndex));
-
-      auto block = blockchainSegment->getBlockByIndex(blockIndex);
-      cumulativeBlobSize += block.blockTemplate.size();
-      for (const auto& txBlob : block.transactions) {
-        cumulativeBlobSize += txBlob.size();
-      }
-      if (cumulativeBlobSize > maxBlobSize) {
-        return;
-      } else {
-        blocks.emplace_back(std::move(block));
-      }
+      pendingHeights.emplace_back(BlockHeight::fromIndex(blockIndex));
     }
   }
+  XI_UNUSED_REVAL(flushPending());
 }
 
 bool Core::queryBlocks(const std::vector<Crypto::Hash>& blockHashes, uint64_t timestamp, uint32_t& startIndex,
@@ -474,7 +519,7 @@ bool Core::queryBlocks(const std::vector<Crypto::Hash>& blockHashes, uint64_t ti
   assert(!chainsLeaves.empty());
   assert(!chainsStorage.empty());
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   try {
     IBlockchainCache* mainChain = chainsLeaves[0];
     currentIndex = mainChain->getTopBlockIndex();
@@ -512,7 +557,7 @@ bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, ui
   assert(!chainsStorage.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   try {
     IBlockchainCache* mainChain = chainsLeaves[0];
@@ -563,7 +608,7 @@ bool Core::queryBlocksDetailed(const std::vector<Crypto::Hash>& knownBlockHashes
   assert(!chainsStorage.empty());
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   try {
     IBlockchainCache* mainChain = chainsLeaves[0];
@@ -612,7 +657,7 @@ bool Core::queryBlocksDetailed(const std::vector<Crypto::Hash>& knownBlockHashes
 
 void Core::getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
                            std::vector<Crypto::Hash>& missedHashes, bool poolOnly) const {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   assert(!chainsLeaves.empty());
   assert(!chainsStorage.empty());
@@ -655,7 +700,7 @@ void Core::getTransactions(const std::vector<Crypto::Hash>& transactionHashes, s
 
 uint64_t Core::getBlockDifficulty(uint32_t blockIndex) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   IBlockchainCache* mainChain = chainsLeaves[0];
   auto difficulties = mainChain->getLastCumulativeDifficulties(2, blockIndex, addGenesisBlock);
   if (difficulties.size() == 2) {
@@ -668,7 +713,7 @@ uint64_t Core::getBlockDifficulty(uint32_t blockIndex) const {
 
 uint64_t Core::getDifficultyForNextBlock() const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   const IBlockchainCache* mainChain = chainsLeaves[0];
   uint32_t topBlockIndex = mainChain->getTopBlockIndex();
@@ -683,7 +728,7 @@ Xi::Result<std::vector<Crypto::Hash>> Core::findBlockchainSupplement(const std::
   assert(!remoteBlockIds.empty());
   assert(remoteBlockIds.back() == getBlockHashByIndex(0));
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   totalBlockCount = getTopBlockIndex() + 1;
   startBlockIndex = (uint32_t)-1;
@@ -697,10 +742,14 @@ Xi::Result<std::vector<Crypto::Hash>> Core::findBlockchainSupplement(const std::
 }
 
 std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) {
+  PreparedBlock prepared{};
+  return addPreparedBlock(cachedBlock, std::move(rawBlock), prepared);
+}
+
+std::error_code Core::addPreparedBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock, PreparedBlock& prepared) {
   throwIfNotInitialized();
 
-  XI_CONCURRENT_RLOCK(m_access);
-  XI_UNUSED_REVAL(transactionPool().acquireExclusiveAccess());
+  XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(m_access);
 
   const auto& blockTemplate = cachedBlock.getBlock();
   const auto& previousBlockHash = blockTemplate.previousBlockHash;
@@ -756,7 +805,14 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 
   std::vector<CachedTransaction> transactions;
   uint64_t cumulativeSize = 0;
-  if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize, blockTemplate.version)) {
+  if (prepared.isPrepared) {
+    if (!prepared.isExtracted) {
+      logger(Logging::Debugging) << "Couldn't deserialize raw block transactions in block " << blockStr;
+      return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
+    }
+    transactions = std::move(prepared.transactions);
+    cumulativeSize = prepared.cumulativeSize;
+  } else if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize, blockTemplate.version)) {
     logger(Logging::Debugging) << "Couldn't deserialize raw block transactions in block " << blockStr;
     return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
   }
@@ -820,7 +876,10 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
       }
     }
 
-    if (!m_currency.checkProofOfWork(cachedBlock, currentDifficulty)) {
+    const bool isProofOfWorkValid = prepared.proofOfWorkHash
+                                        ? check_hash(*prepared.proofOfWorkHash, currentDifficulty)
+                                        : m_currency.checkProofOfWork(cachedBlock, currentDifficulty);
+    if (!isProofOfWorkValid) {
       logger(Logging::Warning) << "Proof of work too weak for block " << blockStr;
       return error::BlockValidationError::PROOF_OF_WORK_TOO_WEAK;
     }
@@ -851,39 +910,48 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   transferContext.previousBlockIndex = previousBlockIndex;
   transferContext.timestamp = blockTimestamp;
   transferContext.inCheckpointRange = checkpoints.isInCheckpointZone(blockIndex);
+  transferContext.skipSignatures = checkpoints.isTrustedZone(blockIndex);
   transferContext.minimumMixin = currency().mixinLowerBound(blockTemplate.version);
   transferContext.maximumMixin = currency().mixinUpperBound(blockTemplate.version);
   transferContext.upgradeMixin = currency().transaction(blockTemplate.version).mixin().upgradeSize();
   std::vector<TransferValidationState> transferValidations{};
-  transferValidations.resize(transactions.size(), TransferValidationState{});
   std::vector<TransferValidationCache> transferCaches{};
-  transferCaches.resize(transactions.size(), TransferValidationCache{});
   std::vector<std::error_code> transferResults{};
-  transferResults.resize(transactions.size(), std::error_code{});
 
 #define XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION 1
 
+  if (prepared.isTransfersPrevalidated && prepared.previousBlockIndex == previousBlockIndex &&
+      prepared.timestamp == blockTimestamp) {
+    transferValidations = std::move(prepared.transferValidations);
+    transferCaches = std::move(prepared.transferCaches);
+    transferResults = std::move(prepared.transferResults);
+  } else {
+    transferValidations.resize(transactions.size(), TransferValidationState{});
+    transferCaches.resize(transactions.size(), TransferValidationCache{});
+    transferResults.resize(transactions.size(), std::error_code{});
+
 #if defined(XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION)
-  async::parallel_for(async::irange(0ULL, transactions.size()),
-                      [&](auto i)
+    async::parallel_for(async::irange(0ULL, transactions.size()),
+                        [&](auto i)
 #else
-  for (size_t i = 0; i < transactions.size(); ++i)
+    for (size_t i = 0; i < transactions.size(); ++i)
 #endif
-                      {
-                        const auto ec = preValidateTransfer(transactions[i], transferContext, transferCaches[i],
-                                                            transferValidations[i]);
-                        if (ec) {
-                          logger(Logging::Debugging) << "Failed to validate transaction "
-                                                     << transactions[i].getTransactionHash() << ": " << ec.message();
+                        {
+                          const auto ec = preValidateTransfer(transactions[i], transferContext, transferCaches[i],
+                                                              transferValidations[i]);
+                          if (ec) {
+                            logger(Logging::Debugging) << "Failed to validate transaction "
+                                                       << transactions[i].getTransactionHash() << ": " << ec.message();
 #if !defined(XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION)
-                          return ec;
+                            return ec;
 #endif
+                          }
+                          transferResults[i] = ec;
                         }
-                        transferResults[i] = ec;
-                      }
 #if defined(XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION)
-  );
+    );
 #endif
+  }
 
   uint64_t cumulativeFee = 0;
   for (size_t i = 0; i < transactions.size(); ++i) {
@@ -915,6 +983,20 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return ec;
   }
 
+  // Rings of a block commonly share keys, their decompressed tables are computed once for the whole block.
+  Crypto::RingSignatureVerifier ringSignatureVerifier{};
+  if (!transferContext.skipSignatures) {
+    registerRingSignatureKeys(transfersInfo, ringSignatureVerifier);
+  }
+#if defined(XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION)
+  async::parallel_for(async::irange(size_t{0}, ringSignatureVerifier.keyCount()),
+                      [&](auto i) { ringSignatureVerifier.prepare(i); });
+#else
+  for (size_t i = 0; i < ringSignatureVerifier.keyCount(); ++i) {
+    ringSignatureVerifier.prepare(i);
+  }
+#endif
+
 #if defined(XI_EXPERIMENTAL_PARALLEL_TRANSFER_VALIDATION)
   async::parallel_for(async::irange(0ULL, transactions.size()),
                       [&](auto i)
@@ -922,8 +1004,8 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   for (size_t i = 0; i < transactions.size(); ++i)
 #endif
                       {
-                        const auto ec =
-                            postValidateTransfer(transactions[i], transferContext, transferCaches[i], transfersInfo);
+                        const auto ec = postValidateTransfer(transactions[i], transferContext, transferCaches[i],
+                                                             transfersInfo, std::addressof(ringSignatureVerifier));
                         if (ec) {
                           logger(Logging::Debugging) << "Failed to validate transaction "
                                                      << transactions[i].getTransactionHash() << ": " << ec.message();
@@ -964,6 +1046,10 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::BlockValidationError::BLOCK_REWARD_MISMATCH;
   }
 
+  // Validation only reads the chain state and runs concurrently with readers, they are excluded from here on.
+  // Readers take the pool lock while holding a shared core lock, hence the pool is always locked after the core.
+  XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
+  XI_UNUSED_REVAL(transactionPool().acquireExclusiveAccess());
   auto ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE;
 
   if (m_isLightNode) {
@@ -1087,7 +1173,7 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 }  // namespace CryptoNote
 
 void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
   assert(mainChainStorage->getBlockCount() > splitBlockIndex);
 
   auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
@@ -1102,7 +1188,7 @@ void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& ne
 
 void Core::notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex,
                            const CachedBlock& cachedBlock, const IBlockchainCache& cache) {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
   switch (opResult) {
     case error::AddBlockErrorCode::ADDED_TO_MAIN:
       notifyObservers(makeNewBlockMessage(previousBlockIndex + 1, cachedBlock.getBlockHash()));
@@ -1136,12 +1222,180 @@ std::error_code Core::addBlock(RawBlock&& rawBlock) {
   return addBlock(cachedBlock, std::move(rawBlock));
 }
 
+size_t Core::addBlocks(const std::vector<CachedBlock>& cachedBlocks, std::vector<RawBlock>&& rawBlocks,
+                       const std::function<bool(size_t, const std::error_code&)>& onBlockProcessed) {
+  throwIfNotInitialized();
+  assert(cachedBlocks.size() == rawBlocks.size());
+
+  std::vector<PreparedBlock> preparedBlocks{};
+  preparedBlocks.resize(cachedBlocks.size());
+
+  // The chain position of every block is derived from the parent of the first one, as long as the batch forms a
+  // chain. The segment is kept alive for the pre validation, which only uses it as part of its context.
+  std::shared_ptr<IBlockchainCache> segment{};
+  if (!cachedBlocks.empty()) {
+    XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
+    const auto& previousBlockHash = cachedBlocks.front().getBlock().previousBlockHash;
+    const auto cache = findSegmentContainingBlock(previousBlockHash);
+    const auto search = std::find_if(chainsStorage.begin(), chainsStorage.end(),
+                                     [cache](const auto& iSegment) { return iSegment.get() == cache; });
+    if (cache != nullptr && search != chainsStorage.end()) {
+      segment = *search;
+      uint32_t previousBlockIndex = cache->getBlockIndex(previousBlockHash);
+      uint64_t previousTimestamp = cache->getCurrentTimestamp(previousBlockIndex);
+      for (size_t i = 0; i < cachedBlocks.size(); ++i) {
+        const auto& blockTemplate = cachedBlocks[i].getBlock();
+        if (i > 0 && blockTemplate.previousBlockHash != cachedBlocks[i - 1].getBlockHash()) {
+          break;
+        }
+        auto& prepared = preparedBlocks[i];
+        if (!blockTemplate.timestamp.tryApply(previousTimestamp, prepared.timestamp)) {
+          break;
+        }
+        prepared.hasContext = true;
+        prepared.previousBlockIndex = previousBlockIndex;
+        previousTimestamp = prepared.timestamp;
+        previousBlockIndex += 1;
+      }
+    }
+  }
+
+  std::atomic_bool isCancelled{false};
+  std::vector<async::task<void>> preparations{};
+  preparations.reserve(cachedBlocks.size());
+  Tools::ScopeExit preparationsGuard{[&]() {
+    isCancelled = true;
+    for (auto& preparation : preparations) {
+      if (preparation.valid()) {
+        preparation.wait();
+      }
+    }
+  }};
+
+  for (size_t i = 0; i < cachedBlocks.size(); ++i) {
+    preparations.emplace_back(async::spawn([&, i]() {
+      if (!isCancelled) {
+        prepareBlock(cachedBlocks[i], rawBlocks[i], segment.get(), preparedBlocks[i]);
+      }
+    }));
+  }
+
+  // Trusted checkpoint imports bundle the database writes of consecutive blocks, the batch is committed as soon as a
+  // block leaves the trusted zone and once all blocks are processed.
+  IBlockchainCache* database = nullptr;
+  {
+    XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
+    database = chainsStorage.empty() ? nullptr : chainsStorage.front().get();
+  }
+  bool isPushBatched = false;
+  const auto commitBatchedPush = [&]() {
+    if (isPushBatched) {
+      isPushBatched = false;
+      XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
+      database->commitBatchedPush();
+    }
+  };
+  Tools::ScopeExit batchedPushGuard{[&]() {
+    try {
+      commitBatchedPush();
+    } catch (const std::exception& e) {
+      logger(Logging::Error) << "Batched block push failed: " << e.what();
+    }
+  }};
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t processed = 0;
+  while (processed < cachedBlocks.size()) {
+    preparations[processed].get();
+    const auto& prepared = preparedBlocks[processed];
+    const auto blockIndex =
+        prepared.hasContext ? prepared.previousBlockIndex + 1 : cachedBlocks[processed].getBlockIndex();
+    if (checkpoints.isTrustedZone(blockIndex)) {
+      if (!isPushBatched && database != nullptr) {
+        XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
+        database->beginBatchedPush();
+        isPushBatched = true;
+      }
+    } else {
+      commitBatchedPush();
+    }
+    const auto ec = addPreparedBlock(cachedBlocks[processed], std::move(rawBlocks[processed]), preparedBlocks[processed]);
+    preparedBlocks[processed] = PreparedBlock{};
+    if (!onBlockProcessed(processed++, ec)) {
+      break;
+    }
+  }
+  commitBatchedPush();
+
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  logger(Logging::Debugging) << "Processed " << processed << " blocks in " << elapsed << "ms ("
+                             << (elapsed > 0 ? processed * 1000 / static_cast<size_t>(elapsed) : processed)
+                             << " blocks/s)";
+  return processed;
+}
+
+void Core::prepareBlock(const CachedBlock& cachedBlock, const RawBlock& rawBlock, const IBlockchainCache* segment,
+                        PreparedBlock& prepared) {
+  const auto& blockTemplate = cachedBlock.getBlock();
+  prepared.isPrepared = true;
+  if (rawBlock.transactions.size() != blockTemplate.transactionHashes.size()) {
+    return;
+  }
+
+  prepared.isExtracted =
+      extractTransactions(rawBlock.transactions, prepared.transactions, prepared.cumulativeSize, blockTemplate.version);
+  if (!prepared.isExtracted) {
+    return;
+  }
+  for (const auto& transaction : prepared.transactions) {
+    XI_UNUSED_REVAL(transaction.getTransactionHash());
+  }
+
+  const auto blockIndex = prepared.hasContext ? prepared.previousBlockIndex + 1 : cachedBlock.getBlockIndex();
+  if (!checkpoints.isInCheckpointZone(blockIndex)) {
+    try {
+      prepared.proofOfWorkHash = m_currency.proofOfWorkHash(cachedBlock);
+    } catch (const std::exception& e) {
+      logger(Logging::Debugging) << "Proof of work precomputation failed: " << e.what();
+      prepared.proofOfWorkHash = std::nullopt;
+    }
+  }
+
+  if (!prepared.hasContext || segment == nullptr) {
+    return;
+  }
+
+  TransferValidationContext transferContext{currency(), *segment};
+  transferContext.blockVersion = blockTemplate.version;
+  transferContext.previousBlockIndex = prepared.previousBlockIndex;
+  transferContext.timestamp = prepared.timestamp;
+  transferContext.inCheckpointRange = checkpoints.isInCheckpointZone(blockIndex);
+  transferContext.minimumMixin = currency().mixinLowerBound(blockTemplate.version);
+  transferContext.maximumMixin = currency().mixinUpperBound(blockTemplate.version);
+  transferContext.upgradeMixin = currency().transaction(blockTemplate.version).mixin().upgradeSize();
+
+  const auto& transactions = prepared.transactions;
+  prepared.transferValidations.resize(transactions.size(), TransferValidationState{});
+  prepared.transferCaches.resize(transactions.size(), TransferValidationCache{});
+  prepared.transferResults.resize(transactions.size(), std::error_code{});
+  for (size_t i = 0; i < transactions.size(); ++i) {
+    const auto ec = preValidateTransfer(transactions[i], transferContext, prepared.transferCaches[i],
+                                        prepared.transferValidations[i]);
+    if (ec) {
+      logger(Logging::Debugging) << "Failed to validate transaction " << transactions[i].getTransactionHash() << ": "
+                                 << ec.message();
+    }
+    prepared.transferResults[i] = ec;
+  }
+  prepared.isTransfersPrevalidated = true;
+}
+
 Xi::Result<std::vector<Crypto::Hash>> Core::addBlock(LiteBlock block, std::vector<CachedTransaction> txs) {
   XI_ERROR_TRY();
   throwIfNotInitialized();
 
-  XI_CONCURRENT_RLOCK(m_access);
-  XI_UNUSED_REVAL(transactionPool().acquireExclusiveAccess());
+  XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(m_access);
 
   BlockTemplate blockTemplate;
   if (!fromBinaryArray(blockTemplate, std::move(block.blockTemplate))) {
@@ -1208,8 +1462,7 @@ Xi::Result<std::vector<Crypto::Hash>> Core::addBlock(LiteBlock block, std::vecto
 std::error_code Core::submitBlock(BinaryArray&& rawBlockTemplate) {
   throwIfNotInitialized();
 
-  XI_CONCURRENT_RLOCK(m_access);
-  XI_UNUSED_REVAL(transactionPool().acquireExclusiveAccess());
+  XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(m_access);
 
   BlockTemplate blockTemplate;
   bool result = fromBinaryArray(blockTemplate, rawBlockTemplate);
@@ -1233,7 +1486,7 @@ std::error_code Core::submitBlock(BinaryArray&& rawBlockTemplate) {
 bool Core::getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
                                        std::vector<uint32_t>& globalIndexes) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   IBlockchainCache* segment = chainsLeaves[0];
 
   bool found = false;
@@ -1260,7 +1513,7 @@ bool Core::getTransactionGlobalIndexes(const Crypto::Hash& transactionHash,
 bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_t>& globalIndexes,
                             std::vector<Crypto::PublicKey>& publicKeys) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   if (count == 0) {
     return true;
@@ -1302,7 +1555,7 @@ bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_
 
 uint64_t Core::getCurrentRequiredMixin(uint64_t amount) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   const auto& mixinConfig = currency().transaction(getTopBlockVersion()).mixin();
   const auto threshold = mixinConfig.maximum() * mixinConfig.upgradeSize() + 1;
@@ -1327,7 +1580,7 @@ bool Core::getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<C
                           std::vector<Transaction>& addedTransactions,
                           std::vector<Crypto::Hash>& deletedTransactions) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::vector<Crypto::Hash> newTransactions;
   getTransactionPoolDifference(knownHashes, newTransactions, deletedTransactions);
@@ -1343,7 +1596,7 @@ bool Core::getPoolChanges(const Crypto::Hash& lastBlockHash, const std::vector<C
 bool Core::getPoolChanges(const Hash& lastBlockHash, const std::vector<Hash>& knownHashes,
                           std::vector<BinaryArray>& addedTransactions, std::vector<Hash>& deletedTransactions) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::vector<Crypto::Hash> newTransactions;
   getTransactionPoolDifference(knownHashes, newTransactions, deletedTransactions);
@@ -1360,7 +1613,7 @@ bool Core::getPoolChangesLite(const Crypto::Hash& lastBlockHash, const std::vect
                               std::vector<TransactionPrefixInfo>& addedTransactions,
                               std::vector<Crypto::Hash>& deletedTransactions) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::vector<Crypto::Hash> newTransactions;
   getTransactionPoolDifference(knownHashes, newTransactions, deletedTransactions);
@@ -1380,7 +1633,7 @@ bool Core::getPoolChangesLite(const Crypto::Hash& lastBlockHash, const std::vect
 bool Core::getBlockTemplate(BlockTemplate& b, const AccountPublicAddress& adr, uint64_t& difficulty,
                             uint32_t& index) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   XI_UNUSED_REVAL(transactionPool().acquireExclusiveAccess());
 
   index = getTopBlockIndex() + 1;
@@ -1481,7 +1734,7 @@ bool Core::getBlockTemplate(BlockTemplate& b, const AccountPublicAddress& adr, u
 }
 
 CoreStatistics Core::getCoreStatistics() const {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   CoreStatistics result;
   result.transactionPoolSize = transactionPool().size();
   auto txHash = transactionPool().stateHash();
@@ -1490,6 +1743,11 @@ CoreStatistics Core::getCoreStatistics() const {
   result.alternativeBlockCount = getAlternativeBlockCount();
   auto hash = getTopBlockHash();
   result.topBlockHashString = hash.toString();
+  IBlockchainCache* root = chainsLeaves[0];
+  while (root->getParent() != nullptr) {
+    root = root->getParent();
+  }
+  result.readCache = root->getReadCacheStatistics();
   return result;
 }
 
@@ -1499,14 +1757,14 @@ bool Core::isPruned() const {
 
 size_t Core::getBlockchainTransactionCount() const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   IBlockchainCache* mainChain = chainsLeaves[0];
   return mainChain->getTransactionCount();
 }
 
 size_t Core::getAlternativeBlockCount() const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   using Ptr = decltype(chainsStorage)::value_type;
   return std::accumulate(chainsStorage.begin(), chainsStorage.end(), size_t(0), [&](size_t sum, const Ptr& ptr) {
@@ -1517,14 +1775,14 @@ size_t Core::getAlternativeBlockCount() const {
 uint64_t Core::getTotalGeneratedAmount() const {
   assert(!chainsLeaves.empty());
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   return chainsLeaves[0]->getAlreadyGeneratedCoins();
 }
 
 std::vector<BlockTemplate> Core::getAlternativeBlocks() const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::vector<BlockTemplate> alternativeBlocks;
   for (auto& cache : chainsStorage) {
@@ -1758,7 +2016,7 @@ const Currency& Core::getCurrency() const {
 bool Core::save() {
   try {
     throwIfNotInitialized();
-    XI_CONCURRENT_RLOCK(m_access);
+    XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
 
     deleteAlternativeChains();
     mergeMainChainSegments();
@@ -1776,7 +2034,7 @@ bool Core::load() {
     if (initialized) {
       return false;
     }
-    XI_CONCURRENT_RLOCK(m_access);
+    XI_CONCURRENT_RECURSIVE_LOCK_WRITE(m_access);
 
     XI_RETURN_EC_IF_NOT(initRootSegment(), false);
 
@@ -1999,8 +2257,30 @@ BlockTemplate Core::restoreBlockTemplate(IBlockchainCache* blockchainCache, uint
   return block;
 }
 
+RawBlockVector Core::getMainChainBlocks(const IBlockchainCache& segment, ConstBlockHeightSpan heights) const {
+  // main chain blocks are decoded straight from the pinned storage blob, instead of being read from the database
+  const uint32_t storageCount = mainChainStorage->getBlockCount();
+  RawBlockVector reval{};
+  reval.reserve(heights.size());
+  for (const auto& height : heights) {
+    const uint32_t index = height.toIndex();
+    const auto blob = index < storageCount ? mainChainStorage->getBlockBlobByIndex(index) : std::nullopt;
+    if (!blob.has_value()) {
+      return segment.getBlocks(heights);
+    }
+
+    RawBlock block{};
+    BinarySpanInputSerializer serializer{blob->span()};
+    if (!serialize(block, serializer) || !serializer.isEndOfStream()) {
+      throw std::runtime_error{"Main chain storage block " + std::to_string(index) + " is corrupted."};
+    }
+    reval.emplace_back(std::move(block));
+  }
+  return reval;
+}
+
 std::vector<Crypto::Hash> Core::doBuildSparseChain(const Crypto::Hash& blockHash) const {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   IBlockchainCache* chain = findSegmentContainingBlock(blockHash);
 
   uint32_t blockIndex = chain->getBlockIndex(blockHash);
@@ -2207,7 +2487,7 @@ size_t Core::calculateCumulativeBlocksizeLimit(uint32_t height) const {
 void Core::fillBlockTemplate(BlockTemplate& block, uint32_t index, size_t fullRewardZone, size_t maxCumulativeSize,
                              size_t& transactionsSize, uint64_t& fee) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   transactionsSize = 0;
   fee = 0;
@@ -2223,47 +2503,47 @@ void Core::fillBlockTemplate(BlockTemplate& block, uint32_t index, size_t fullRe
   size_t cumulativeSize = 0;
 
   const EligibleIndex blockIndex{index, block.timestamp.apply(previousTimestamp)};
-  // We assume eligible transactions are ordered, such that the first transactions are most profitible. Using this
-  // we now implement a greedy search algorithm to fill the transaction.
-  std::vector<CachedTransaction> poolTransactions = m_transactionPool->eligiblePoolTransactions(blockIndex);
+  // The pool visits eligible transactions ordered, such that the first transactions are most profitible. Using this
+  // we now implement a greedy search algorithm to fill the transaction and stop as soon as the block is full.
   BlockInfo nfo{block, index - 1};
   BlockTransactionValidator sanity{nfo, checkpoints, *mainChain(), currency()};
   size_t departedTransactions = 0;
 
   // Assumption Reward(iter) >= Reward(iter++), TransactionPriorityComperator
-  for (auto iter = poolTransactions.begin(); iter != poolTransactions.end(); ++iter) {
+  m_transactionPool->forEachEligibleTransaction(blockIndex, [&](const CachedTransaction& transaction) {
     // The transation binary array is included in the body and the hash in the header, both are part of the block size
-    const size_t iSize = iter->getBlobSize();
+    const size_t iSize = transaction.getBlobSize();
     if (cumulativeSize + iSize > maxCumulativeSize) {
-      break;
+      return false;
     }
-    const uint64_t iFee = iter->getTransactionFee();
+    const uint64_t iFee = transaction.getTransactionFee();
     if (cumulativeSize + iSize > fullRewardZone) {
       // Lets reevaluate if its still plausible to add transactions.
       if (iFee == 0) {
-        break;
+        return false;
       }
 
       uint64_t newReward = 0;
       m_currency.getBlockReward(index, block.version, fullRewardZone, cumulativeSize + iSize, generatedCoins,
                                 fee + iFee, newReward, emissionChange);
       if (newReward < currentReward) {
-        break;
+        return false;
       }
     }
 
-    if (const auto ec = sanity.validate(iter->getTransaction()); ec.isError()) {
-      logger(Logging::Warning) << "A pool transaction is not valid to be mined: " << iter->getTransactionHash();
+    if (const auto ec = sanity.validate(transaction.getTransaction()); ec.isError()) {
+      logger(Logging::Warning) << "A pool transaction is not valid to be mined: " << transaction.getTransactionHash();
       departedTransactions += 1;
-      continue;
+      return true;
     }
 
     // If we land here all checks have passed and we can add the transaction
     fee += iFee;
     cumulativeSize += iSize;
-    block.transactionHashes.emplace_back(iter->getTransactionHash());
+    block.transactionHashes.emplace_back(transaction.getTransactionHash());
     transactionsSize += iSize;
-  }
+    return true;
+  });
 
   if (departedTransactions > 0) {
     m_transactionPool->sanityCheck(std::numeric_limits<uint64_t>::max());
@@ -2375,7 +2655,7 @@ void Core::mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* s
 
 std::optional<BlockDetails> Core::getBlockDetails(const uint32_t blockHeight) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   IBlockchainCache* segment = findSegmentContainingBlock(blockHeight);
   if (segment == nullptr) {
@@ -2387,7 +2667,7 @@ std::optional<BlockDetails> Core::getBlockDetails(const uint32_t blockHeight) co
 
 std::optional<BlockDetails> Core::getBlockDetails(const Crypto::Hash& blockHash) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   IBlockchainCache* segment = findSegmentContainingBlock(blockHash);
   if (segment == nullptr) {
@@ -2482,7 +2762,7 @@ std::optional<BlockDetails> Core::getBlockDetails(const Crypto::Hash& blockHash)
 
 TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHash) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   IBlockchainCache* segment = findSegmentContainingTransaction(transactionHash);
   bool foundInPool = m_transactionPool->checkIfTransactionPresent(transactionHash);
@@ -2633,7 +2913,7 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
 
 std::vector<Crypto::Hash> Core::getAlternativeBlockHashesByIndex(uint32_t blockIndex) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::vector<Crypto::Hash> alternativeBlockHashes;
   for (size_t chain = 1; chain < chainsLeaves.size(); ++chain) {
@@ -2657,7 +2937,7 @@ std::vector<Crypto::Hash> Core::getAlternativeBlockHashesByIndex(uint32_t blockI
 
 std::vector<Crypto::Hash> Core::getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   logger(Logging::Debugging) << "getBlockHashesByTimestamps request with timestamp " << timestampBegin
                              << " and seconds count " << secondsCount;
@@ -2676,7 +2956,7 @@ std::vector<Crypto::Hash> Core::getBlockHashesByTimestamps(uint64_t timestampBeg
 
 std::vector<Crypto::Hash> Core::getTransactionHashesByPaymentId(const PaymentId& paymentId) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   logger(Logging::Debugging) << "getTransactionHashesByPaymentId request with paymentId " << paymentId;
 
@@ -2695,7 +2975,7 @@ SegmentReferenceVector<BlockHash> Core::queryBlockSegments(ConstBlockHashSpan ha
   using segment_reference = SegmentReference<BlockHash>;
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::map<const IBlockchainCache*, segment_reference> references{};
   std::set<BlockHash> processed{};
@@ -2731,7 +3011,7 @@ SegmentReferenceVector<BlockHeight> Core::queryBlockSegments(ConstBlockHeightSpa
   using segment_reference = SegmentReference<BlockHeight>;
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::map<const IBlockchainCache*, segment_reference> references{};
   std::set<BlockHeight> processed{};
@@ -2770,7 +3050,7 @@ SegmentReferenceVector<TransactionHash> Core::queryTransactionSegments(ConstTran
   using segment_reference = SegmentReference<TransactionHash>;
 
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
 
   std::map<const IBlockchainCache*, segment_reference> references{};
   std::set<BlockHash> processed{};
@@ -2850,7 +3130,7 @@ IBlockchainCache* Core::findSegmentContainingTransaction(const Crypto::Hash& tra
 
 bool Core::hasTransaction(const Crypto::Hash& transactionHash) const {
   throwIfNotInitialized();
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return findSegmentContainingTransaction(transactionHash) != nullptr ||
          m_transactionPool->checkIfTransactionPresent(transactionHash);
 }
@@ -2888,7 +3168,7 @@ void Core::updateBlockMedianSize() {
 }
 
 BlockHeight Core::get_current_blockchain_height() const {
-  XI_CONCURRENT_RLOCK(m_access);
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(m_access);
   return BlockHeight::fromIndex(getTopBlockIndex());
 }
 
@@ -12,7 +12,7 @@
 #include <string>
 
 #include <Xi/Result.h>
-#include <Xi/Concurrent/RecursiveLock.h>
+#include <Xi/Concurrent/RecursiveReadersWriterLock.h>
 
 #include <Common/ObserverManager.h>
 #include <Logging/LoggerMessage.h>
@@ -48,7 +48,7 @@ class Core : public ICore, public ICoreInformation, ITransactionPoolObserver {
        std::unique_ptr<IMainChainStorage>&& mainChainStorage);
   virtual ~Core() override;
 
-  virtual Xi::Concurrent::RecursiveLock::lock_t lock() const override;
+  virtual Xi::Concurrent::RecursiveReadersWriterLock::write_lock_t lock() const override;
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override;
   virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) override;
 
@@ -112,6 +112,8 @@ class Core : public ICore, public ICoreInformation, ITransactionPoolObserver {
 
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) override;
   virtual std::error_code addBlock(RawBlock&& rawBlock) override;
+  virtual size_t addBlocks(const std::vector<CachedBlock>& cachedBlocks, std::vector<RawBlock>&& rawBlocks,
+                           const std::function<bool(size_t, const std::error_code&)>& onBlockProcessed) override;
   virtual Xi::Result<std::vector<Crypto::Hash>> addBlock(LiteBlock rawLiteBlock,
                                                          std::vector<CachedTransaction> txs) override;
 
@@ -193,7 +195,7 @@ class Core : public ICore, public ICoreInformation, ITransactionPoolObserver {
   bool initialized;
 
   time_t start_time;
-  Xi::Concurrent::RecursiveLock m_access;
+  Xi::Concurrent::RecursiveReadersWriterLock m_access;
   size_t blockMedianSize;
 
   void throwIfNotInitialized() const;
@@ -202,6 +204,19 @@ class Core : public ICore, public ICoreInformation, ITransactionPoolObserver {
                            std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize,
                            BlockVersion blockVersion);
 
+  /// Results of the validation steps of a block that do not depend on the chain state.
+  struct PreparedBlock;
+
+  /*!
+   * \brief prepareBlock runs all validation steps of a block not requiring the chain state
+   * \param segment The segment the block is expected to be added to, may be null if unknown
+   *
+   * Thread safe, may be called for several blocks concurrently.
+   */
+  void prepareBlock(const CachedBlock& cachedBlock, const RawBlock& rawBlock, const IBlockchainCache* segment,
+                    PreparedBlock& prepared);
+  std::error_code addPreparedBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock, PreparedBlock& prepared);
+
   Xi::Result<uint32_t> findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const;
   std::vector<Crypto::Hash> getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const;
 
@@ -222,6 +237,7 @@ class Core : public ICore, public ICoreInformation, ITransactionPoolObserver {
                                                      bool* isMainChain = nullptr) const;
 
   BlockTemplate restoreBlockTemplate(IBlockchainCache* blockchainCache, uint32_t blockIndex) const;
+  RawBlockVector getMainChainBlocks(const IBlockchainCache& segment, ConstBlockHeightSpan heights) const;
   std::vector<Crypto::Hash> doBuildSparseChain(const Crypto::Hash& blockHash) const;
 
   RawBlock getRawBlock(IBlockchainCache* segment, uint32_t blockIndex) const;
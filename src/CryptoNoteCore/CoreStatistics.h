@@ -23,6 +23,7 @@
 #include <Xi/Global.hh>
 
 #include "Serialization/ISerializer.h"
+#include "CryptoNoteCore/Blockchain/ReadCacheStatistics.h"
 
 namespace CryptoNote {
 
@@ -32,6 +33,7 @@ struct CoreStatistics {
   uint64_t blockchainHeight;
   uint64_t alternativeBlockCount;
   std::string topBlockHashString;
+  BlockchainReadCacheStatistics readCache;
 
   bool serialize(ISerializer& s) {
     XI_RETURN_EC_IF_NOT(s(transactionPoolSize, "tx_pool_size"), false);
@@ -39,6 +41,7 @@ struct CoreStatistics {
     XI_RETURN_EC_IF_NOT(s(blockchainHeight, "blockchain_height"), false);
     XI_RETURN_EC_IF_NOT(s(alternativeBlockCount, "alternative_blocks"), false);
     XI_RETURN_EC_IF_NOT(s(topBlockHashString, "top_block_id_str"), false);
+    XI_RETURN_EC_IF_NOT(s(readCache, "read_cache"), false);
     return true;
   }
 };
@@ -25,6 +25,7 @@
 #include "Common/VectorOutputStream.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinarySpanInputSerializer.hpp"
 #include <Xi/Config.h>
 #include "CryptoNoteSerialization.h"
 
@@ -62,14 +63,13 @@ template <>
 template <class T>
 [[nodiscard]] T fromBinaryArray(const BinaryArray& binaryArray) {
   T object = boost::value_initialized<T>();
-  Common::MemoryInputStream stream(binaryArray.data(), binaryArray.size());
-  BinaryInputStreamSerializer serializer(stream);
+  BinarySpanInputSerializer serializer(Xi::ConstByteSpan{binaryArray.data(), binaryArray.size()});
   if (!serializer(object, "")) {
     throw std::runtime_error("deserialization failed");
   }
-  if (!stream.endOfStream()) {  // check that all data was consumed
-    throw std::runtime_error(
-        "failed to unpack type: not all bytes have been processed (pos=" + std::to_string(stream.getPosition()) + ")");
+  if (!serializer.isEndOfStream()) {  // check that all data was consumed
+    throw std::runtime_error("failed to unpack type: not all bytes have been processed (pos=" +
+                             std::to_string(binaryArray.size() - serializer.remaining()) + ")");
   }
 
   return object;
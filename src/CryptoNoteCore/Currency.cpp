@@ -743,11 +743,15 @@ uint64_t Currency::nextDifficulty(BlockVersion version, uint32_t blockIndex, std
   }
 }
 
-bool Currency::checkProofOfWork(const CachedBlock& block, uint64_t currentDiffic) const {
+Crypto::Hash Currency::proofOfWorkHash(const CachedBlock& block) const {
   const auto& powBlob = block.getProofOfWorkBlob();
   Crypto::Hash hash{};
   proofOfWorkAlgorithm(block.getBlock().version)(powBlob.span(), hash);
-  return check_hash(hash, currentDiffic);
+  return hash;
+}
+
+bool Currency::checkProofOfWork(const CachedBlock& block, uint64_t currentDiffic) const {
+  return check_hash(proofOfWorkHash(block), currentDiffic);
 }
 
 size_t Currency::getApproximateMaximumInputCount(size_t transactionSize, size_t outputCount, size_t mixinCount) const {
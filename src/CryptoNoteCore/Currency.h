@@ -151,6 +151,7 @@ class Currency {
   uint64_t nextDifficulty(BlockVersion version, uint32_t blockIndex, std::vector<uint64_t> timestamps,
                           std::vector<uint64_t> cumulativeDifficulties) const;
 
+  Crypto::Hash proofOfWorkHash(const CachedBlock& block) const;
   bool checkProofOfWork(const CachedBlock& block, uint64_t currentDifficulty) const;
 
   Currency(Currency&& currency);
@@ -20,8 +20,13 @@
 #include <string>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
 
 #include <Xi/Exceptional.hpp>
+#include <Xi/Endianess/Big.hh>
 #include <Serialization/SerializationOverloads.h>
 #include <Serialization/BinaryInputStreamSerializer.h>
 #include <Serialization/BinaryOutputStreamSerializer.h>
@@ -94,23 +99,75 @@ const KeyPrefix KEY_OUTPUT_AMOUNTS_COUNT_KEY = makePrefix(0x10);
 const KeyPrefix TRANSACTIONS_COUNT_KEY = makePrefix(0x11);
 const KeyPrefix KEY_OUTPUT_KEY_PREFIX = makePrefix(0x12);
 
+/*!
+ * \brief appendKey encodes a key, or a component of a composed key, at the end of a raw database key.
+ *
+ * Unsigned integers are encoded big endian, such that the bytewise order of raw keys matches the numeric order of
+ * block indices, amounts and timestamps and database iterators yield them ascending.
+ */
 template <typename _KeyT>
-std::string serializeKey(const KeyPrefix& cprefix, const _KeyT& ckey) {
+void appendKey(std::string& raw, const _KeyT& ckey) {
   using namespace Xi;
 
-  auto& prefix = const_cast<KeyPrefix&>(cprefix);
-  auto& key = const_cast<_KeyT&>(ckey);
+  if constexpr (std::is_same_v<_KeyT, NoKey>) {
+    XI_UNUSED(raw, ckey);
+  } else if constexpr (std::is_integral_v<_KeyT> && std::is_unsigned_v<_KeyT> && sizeof(_KeyT) > 1) {
+    const _KeyT encoded = Endianess::big(ckey);
+    raw.append(reinterpret_cast<const char*>(&encoded), sizeof(encoded));
+  } else {
+    auto& key = const_cast<_KeyT&>(ckey);
+
+    std::stringstream builder{};
+    Common::StdOutputStream stream{builder};
+    BinaryOutputStreamSerializer serializer{stream};
+    serializer.setUseVarInt(false);
+    exceptional_if_not<SerializationError>(serializer(key, "key"), "database key serialization failed");
+    raw.append(builder.str());
+  }
+}
 
-  std::stringstream builder{};
-  Common::StdOutputStream stream{builder};
-  BinaryOutputStreamSerializer serializer{stream};
-  serializer.setUseVarInt(false);
+template <typename _FirstT, typename _SecondT>
+void appendKey(std::string& raw, const std::pair<_FirstT, _SecondT>& key) {
+  appendKey(raw, key.first);
+  appendKey(raw, key.second);
+}
 
-  exceptional_if_not<SerializationError>(serializer.binary(prefix.Prefix.data(), prefix.Prefix.size(), "prefix"),
-                                         "database prefix serialization failed");
-  exceptional_if_not<SerializationError>(serializer(key, "key"), "database key serialization failed");
+template <typename _KeyT>
+std::string serializeKey(const KeyPrefix& prefix, const _KeyT& key) {
+  std::string raw{prefix.Prefix.begin(), prefix.Prefix.end()};
+  appendKey(raw, key);
+  return raw;
+}
+
+/*!
+ * \brief deserializeKey decodes a raw key of a table keyed by an unsigned integer.
+ */
+template <typename _KeyT>
+_KeyT deserializeKey(Xi::ConstByteSpan raw, const KeyPrefix& prefix) {
+  static_assert(std::is_integral_v<_KeyT> && std::is_unsigned_v<_KeyT>, "only integer keys are decodable");
+  using namespace Xi;
 
-  return builder.str();
+  exceptional_if_not<DeserializationError>(raw.size() == prefix.Prefix.size() + sizeof(_KeyT),
+                                           "database key has an unexpected size");
+  exceptional_if_not<DeserializationError>(std::equal(prefix.Prefix.begin(), prefix.Prefix.end(), raw.begin()),
+                                           "database key has an unexpected prefix");
+  _KeyT encoded{0};
+  std::memcpy(&encoded, raw.data() + prefix.Prefix.size(), sizeof(_KeyT));
+  return Endianess::big(encoded);
+}
+
+/*!
+ * \brief serializePrefixEnd returns the smallest raw key greater than all keys starting with the given prefix.
+ */
+static inline std::string serializePrefixEnd(const KeyPrefix& prefix) {
+  std::string raw{prefix.Prefix.begin(), prefix.Prefix.end()};
+  while (!raw.empty() && static_cast<Xi::Byte>(raw.back()) == 0xFF) {
+    raw.pop_back();
+  }
+  if (!raw.empty()) {
+    raw.back() = static_cast<char>(static_cast<Xi::Byte>(raw.back()) + 1);
+  }
+  return raw;
 }
 
 template <typename _KeyT, typename _ValueT>
@@ -138,19 +195,25 @@ void serializeKeys(std::vector<std::string>& rawKeys, const KeyPrefix& prefix,
 }
 
 template <typename _KeyT, typename _ValueT>
-void deserialize(const std::string& serialized, _ValueT& value, const _KeyT& expectedKey,
+void deserialize(Xi::ConstByteSpan serialized, _ValueT& value, const _KeyT& expectedKey,
                  const KeyPrefix& expectedPrefix) {
   using namespace Xi;
 
   XI_UNUSED(expectedKey, expectedPrefix);
 
-  Common::ByteSpanInputStream stream{Xi::asConstByteSpan(serialized)};
+  Common::ByteSpanInputStream stream{serialized};
   CryptoNote::BinaryInputStreamSerializer serializer(stream);
 
   exceptional_if_not<DeserializationError>(serializer(value, "value"), "database value deserialization failed");
   exceptional_if_not<DeserializationError>(stream.isEndOfStream(), "database deserialization has left overs");
 }
 
+template <typename _KeyT, typename _ValueT>
+void deserialize(const std::string& serialized, _ValueT& value, const _KeyT& expectedKey,
+                 const KeyPrefix& expectedPrefix) {
+  deserialize(Xi::asConstByteSpan(serialized), value, expectedKey, expectedPrefix);
+}
+
 template <typename _ValueT, typename _IteratorT>
 void deserializeValue(std::pair<_ValueT, bool>& container, _IteratorT& combinedIter, const KeyPrefix& prefix) {
   const bool wasRequested = container.second;
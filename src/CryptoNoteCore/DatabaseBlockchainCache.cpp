@@ -25,6 +25,7 @@
 #include <Common/ShuffleGenerator.h>
 
 #include "BlockchainUtils.h"
+#include "DBUtils.h"
 
 #include <CryptoNoteCore/BlockchainStorage.h>
 #include <CryptoNoteCore/CryptoNoteTools.h>
@@ -36,6 +37,28 @@ namespace CryptoNote {
 namespace {
 
 const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
+const size_t RAW_BLOCKS_CACHE_CAPACITY = 64 * 1024 * 1024;
+const size_t TRANSACTION_INFOS_CACHE_CAPACITY = 32 * 1024 * 1024;
+const size_t READ_CACHE_SHARD_COUNT = 16;
+
+size_t rawBlockCacheSize(const RawBlock& block) {
+  size_t reval = sizeof(RawBlock) + block.blockTemplate.size();
+  for (const auto& transaction : block.transactions) {
+    reval += sizeof(BinaryArray) + transaction.size();
+  }
+  return reval;
+}
+
+size_t transactionInfoCacheSize(const ExtendedTransactionInfo& info) {
+  size_t reval = sizeof(ExtendedTransactionInfo);
+  reval += info.outputs.size() * sizeof(TransactionOutput);
+  reval += info.globalIndexes.size() * sizeof(uint32_t);
+  for (const auto& amountIndexes : info.amountToKeyIndexes) {
+    // map node overhead is approximated by three pointers and the key
+    reval += 4 * sizeof(void*) + amountIndexes.second.size() * sizeof(uint32_t);
+  }
+  return reval;
+}
 const CachedBlockInfo NULL_CACHED_BLOCK_INFO{Crypto::Hash::Null, BlockVersion::Null, BlockFeature::None, 0, 0, 0, 0, 0};
 
 bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uint32_t> globalIndexes,
@@ -68,41 +91,6 @@ bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uin
   XI_RETURN_SC(true);
 }
 
-bool requestTransactionHashesForGlobalOutputIndexes(const std::vector<PackedOutIndex>& packedOuts, IDataBase& database,
-                                                    std::vector<Crypto::Hash>& transactionHashes) {
-  BlockchainReadBatch readHashesBatch;
-
-  std::set<uint32_t> blockIndexes;
-  std::for_each(packedOuts.begin(), packedOuts.end(),
-                [&blockIndexes](PackedOutIndex out) { blockIndexes.insert(out.data.blockIndex); });
-  std::for_each(blockIndexes.begin(), blockIndexes.end(), [&readHashesBatch](uint32_t blockIndex) {
-    readHashesBatch.requestTransactionHashesByBlock(blockIndex);
-  });
-
-  auto dbResult = database.read(readHashesBatch);
-  if (dbResult) {
-    return false;
-  }
-
-  auto readResult = readHashesBatch.extractResult();
-  const auto& transactionHashesMap = readResult.getTransactionHashesByBlocks();
-
-  if (transactionHashesMap.size() != blockIndexes.size()) {
-    return false;
-  }
-
-  transactionHashes.reserve(transactionHashes.size() + packedOuts.size());
-  for (const auto& output : packedOuts) {
-    if (output.data.transactionIndex >= transactionHashesMap.at(output.data.blockIndex).size()) {
-      return false;
-    }
-
-    transactionHashes.push_back(transactionHashesMap.at(output.data.blockIndex)[output.data.transactionIndex]);
-  }
-
-  return true;
-}
-
 bool requestCachedTransactionInfos(const std::vector<Crypto::Hash>& transactionHashes, IDataBase& database,
                                    std::vector<CachedTransactionInfo>& result) {
   result.reserve(result.size() + transactionHashes.size());
@@ -166,17 +154,6 @@ bool requestExtendedTransactionInfos(const std::vector<Crypto::Hash>& transactio
   return true;
 }
 
-// returns ExtendedTransactionInfos in the same order as packedOuts are
-bool requestExtendedTransactionInfos(const std::vector<PackedOutIndex>& packedOuts, IDataBase& database,
-                                     std::vector<ExtendedTransactionInfo>& result) {
-  std::vector<Crypto::Hash> transactionHashes;
-  if (!requestTransactionHashesForGlobalOutputIndexes(packedOuts, database, transactionHashes)) {
-    return false;
-  }
-
-  return requestExtendedTransactionInfos(transactionHashes, database, result);
-}
-
 uint64_t roundToMidnight(uint64_t timestamp) {
   if (timestamp > static_cast<uint64_t>(std::numeric_limits<time_t>::max())) {
     throw std::runtime_error("Timestamp is too big");
@@ -214,12 +191,13 @@ bool requestRawBlock(IDataBase& database, uint32_t blockIndex, RawBlock& block)
     return false;
   }
 
-  auto result = batch.extractResult();
-  if (result.getRawBlocks().count(blockIndex) == 0) {
+  auto rawBlocks = batch.extractResult().takeRawBlocks();
+  auto search = rawBlocks.find(blockIndex);
+  if (search == rawBlocks.end()) {
     return false;
   }
 
-  block = result.getRawBlocks().at(blockIndex);
+  block = std::move(search->second);
   return true;
 }
 
@@ -413,7 +391,8 @@ class DatabaseVersionReadBatch : public IReadBatch {
     return {DB_VERSION_KEY};
   }
 
-  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override {
+  virtual void submitRawResult(const std::vector<Xi::ConstByteSpan>& values,
+                               const std::vector<bool>& resultStates) override {
     assert(values.size() == 1);
     assert(resultStates.size() == values.size());
 
@@ -421,7 +400,8 @@ class DatabaseVersionReadBatch : public IReadBatch {
       return;
     }
 
-    version = static_cast<uint32_t>(std::atoi(values[0].c_str()));
+    const std::string value{reinterpret_cast<const char*>(values[0].data()), values[0].size()};
+    version = static_cast<uint32_t>(std::atoi(value.c_str()));
   }
 
   boost::optional<uint32_t> getDbSchemeVersion() {
@@ -451,7 +431,26 @@ class DatabaseVersionWriteBatch : public IWriteBatch {
   uint32_t schemeVersion;
 };
 
-const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+const uint32_t CURRENT_DB_SCHEME_VERSION = 3;
+
+/*!
+ * \brief readDatabaseRange reads all values of one table with keys in [begin, end), ordered by their key.
+ */
+template <typename _ValueT, typename _KeyT>
+std::vector<_ValueT> readDatabaseRange(IDataBase& database, const DB::KeyPrefix& prefix, const _KeyT& begin,
+                                       const _KeyT& end) {
+  std::vector<_ValueT> values{};
+  auto ec = database.iterate(DB::serializeKey(prefix, begin), DB::serializeKey(prefix, end),
+                             [&values, &prefix](Xi::ConstByteSpan, Xi::ConstByteSpan value) {
+                               values.emplace_back();
+                               DB::deserialize(value, values.back(), DB::noKey(), prefix);
+                               return true;
+                             });
+  if (ec) {
+    throw std::runtime_error(ec.message());
+  }
+  return values;
+}
 
 }  // namespace
 
@@ -467,7 +466,10 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
       currency(curr),
       database(dataBase),
       blockchainCacheFactory(blockchainCacheFactory),
-      logger(_logger, "DatabaseBlockchainCache") {
+      logger(_logger, "DatabaseBlockchainCache"),
+      rawBlocksCache{RAW_BLOCKS_CACHE_CAPACITY, READ_CACHE_SHARD_COUNT, rawBlockCacheSize},
+      transactionInfosCache{TRANSACTION_INFOS_CACHE_CAPACITY, READ_CACHE_SHARD_COUNT, transactionInfoCacheSize},
+      keyOutputIndex{[this](Amount amount) { return readKeyOutputColumn(amount); }} {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -491,6 +493,7 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
     logger(Logging::Debugging) << "top block index is nill, add genesis block";
     addGenesisBlock(CachedBlock{currency.genesisBlock()});
   }
+  loadTopBlockInfo();
 }
 
 bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase& database, Logging::ILogger& _logger) {
@@ -544,12 +547,17 @@ void DatabaseBlockchainCache::deleteClosestTimestampBlockIndex(BlockchainWriteBa
     midnight += ONE_DAY_SECONDS;
   }
 
-  BlockchainReadBatch midnightBatch;
-  while (readDatabase(midnightBatch.requestClosestTimestampBlockIndex(midnight))
-             .getClosestTimestampBlockIndex()
-             .count(midnight)) {
-    writeBatch.removeClosestTimestampBlockIndex(midnight);
-    midnight += ONE_DAY_SECONDS;
+  // Days without blocks have no entry, thus all entries from the first deleted day onwards are removed.
+  auto ec = database.iterate(DB::serializeKey(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, midnight),
+                             DB::serializePrefixEnd(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX),
+                             [&writeBatch](Xi::ConstByteSpan key, Xi::ConstByteSpan) {
+                               writeBatch.removeClosestTimestampBlockIndex(
+                                   DB::deserializeKey<uint64_t>(key, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX));
+                               return true;
+                             });
+  if (ec) {
+    logger(Logging::Error) << "deleteClosestTimestampBlockIndex error: " << ec.message();
+    throw std::runtime_error(ec.message());
   }
 
   logger(Logging::Trace) << "deleted closest timestamp";
@@ -622,6 +630,13 @@ std::shared_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   }
 
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
+  rawBlocksCache.eraseIf([splitBlockIndex](uint32_t index, const RawBlock&) { return index >= splitBlockIndex; });
+  transactionInfosCache.eraseIf([splitBlockIndex](const Crypto::Hash&, const ExtendedTransactionInfo& info) {
+    return info.blockIndex >= splitBlockIndex;
+  });
+  for (const auto& boundary : keyIndexSplitBoundaries) {
+    keyOutputIndex.truncate(boundary.first, boundary.second);
+  }
 
   children.push_back(cache.get());
   logger(Logging::Trace) << "Delete successfull";
@@ -631,6 +646,7 @@ std::shared_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   topBlockHash = boost::none;
   topBlockVersion = boost::none;
   transactionsCount = boost::none;
+  loadTopBlockInfo();
 
   logger(Logging::Debugging) << "split completed";
 
@@ -660,18 +676,12 @@ Crypto::Hash DatabaseBlockchainCache::pushBlockToAnotherCache(IBlockchainCache&
 std::vector<Crypto::Hash> DatabaseBlockchainCache::requestTransactionHashesFromBlockIndex(uint32_t splitBlockIndex) {
   logger(Logging::Debugging) << "Requesting transaction hashes starting from block index " << splitBlockIndex;
 
-  BlockchainReadBatch readBatch;
-  for (uint32_t blockIndex = splitBlockIndex; blockIndex <= getTopBlockIndex(); ++blockIndex) {
-    readBatch.requestTransactionHashesByBlock(blockIndex);
-  }
+  const auto blocksTransactions = readDatabaseRange<std::vector<Crypto::Hash>>(
+      database, DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, splitBlockIndex, getTopBlockIndex() + 1);
 
   std::vector<Crypto::Hash> transactionHashes;
-
-  auto dbResult = readDatabase(readBatch);
-  for (const auto& kv : dbResult.getTransactionHashesByBlocks()) {
-    for (const auto& hash : kv.second) {
-      transactionHashes.emplace_back(hash);
-    }
+  for (const auto& blockTransactions : blocksTransactions) {
+    transactionHashes.insert(transactionHashes.end(), blockTransactions.begin(), blockTransactions.end());
   }
 
   return transactionHashes;
@@ -834,6 +844,7 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
         outputInfo.unlockTime = transactionCacheInfo.unlockTime;
         outputInfo.index = poi;
         batch.insertKeyOutputInfo(amountOutput->amount, globalIndex, outputInfo);
+        keyOutputIndex.append(amountOutput->amount, globalIndex, blockIndex, outputInfo.unlockTime);
       }
     }
   }
@@ -1009,12 +1020,73 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   topBlockVersion = cachedBlock.getBlock().version;
   logger(Logging::Debugging) << "push block " << cachedBlock.getBlockHash() << " completed";
 
+  rawBlocksCache.erase(index);
+  for (const auto& transactionHash : txHashes) {
+    transactionInfosCache.erase(transactionHash);
+  }
+
   unitsCache.push_back(blockInfo);
   if (unitsCache.size() > unitsCacheSize) {
     unitsCache.pop_front();
   }
 }
 
+void DatabaseBlockchainCache::beginBatchedPush() {
+  if (const auto ec = database.beginWriteGroup()) {
+    logger(Logging::Error) << "begin batched push failed: " << ec.message();
+    throw std::runtime_error(ec.message());
+  }
+}
+
+void DatabaseBlockchainCache::commitBatchedPush() {
+  if (const auto ec = database.commitWriteGroup()) {
+    logger(Logging::Error) << "batched push write failed: " << ec.message();
+    throw std::runtime_error(ec.message());
+  }
+}
+
+BlockchainReadCacheStatistics DatabaseBlockchainCache::getReadCacheStatistics() const {
+  BlockchainReadCacheStatistics reval{};
+  reval.blockHits = rawBlocksCache.hits();
+  reval.blockMisses = rawBlocksCache.misses();
+  reval.blockCacheSize = rawBlocksCache.size();
+  reval.transactionHits = transactionInfosCache.hits();
+  reval.transactionMisses = transactionInfosCache.misses();
+  reval.transactionCacheSize = transactionInfosCache.size();
+  reval.keyOutputIndex = keyOutputIndex.usage();
+  return reval;
+}
+
+KeyOutputColumnIndex::Column DatabaseBlockchainCache::readKeyOutputColumn(Amount amount) const {
+  auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
+  auto outputsCount = readDatabase(batch).getKeyOutputGlobalIndexesCountForAmounts();
+  const GlobalOutputIndex count = outputsCount[amount];
+
+  KeyOutputColumnIndex::Column column{};
+  column.reserve(count);
+  auto ec = database.iterate(
+      DB::serializeKey(DB::KEY_OUTPUT_KEY_PREFIX, std::make_pair(amount, GlobalOutputIndex{0})),
+      DB::serializeKey(DB::KEY_OUTPUT_KEY_PREFIX, std::make_pair(amount, count)),
+      [&column](Xi::ConstByteSpan, Xi::ConstByteSpan value) {
+        KeyOutputInfo info{};
+        DB::deserialize(value, info, DB::noKey(), DB::KEY_OUTPUT_KEY_PREFIX);
+        column.push_back(info.index.data.blockIndex, info.unlockTime);
+        return true;
+      });
+  if (ec) {
+    throw std::runtime_error(ec.message());
+  }
+  if (column.size() != count) {
+    logger(Logging::Error) << "key output index for amount " << amount << " expected " << count << " outputs, found "
+                           << column.size();
+    throw std::runtime_error{"key output index inconsistent with database"};
+  }
+
+  logger(Logging::Trace) << "loaded key output index for amount " << amount << ", " << count << " outputs, "
+                         << column.memoryUsage() << " bytes";
+  return column;
+}
+
 PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex) const {
   return getExtendedPushedBlockInfo(blockIndex).pushedBlockInfo;
 }
@@ -1177,6 +1249,13 @@ uint32_t DatabaseBlockchainCache::getTopBlockIndex() const {
   return *topBlockIndex;
 }
 
+void DatabaseBlockchainCache::loadTopBlockInfo() const {
+  getTopBlockIndex();
+  getTopBlockHash();
+  getTopBlockVersion();
+  getCachedTransactionsCount();
+}
+
 BlockVersion DatabaseBlockchainCache::getBlockVersionForHeight(uint32_t height) const {
   return currency.upgradeManager().getBlockVersion(height);
 }
@@ -1319,33 +1398,11 @@ std::vector<CachedBlockInfo> DatabaseBlockchainCache::getLastDbUnits(uint32_t bl
     readFrom += 1;
   }
 
-  uint32_t toRead = blockIndex - readFrom + 1;
-  std::vector<CachedBlockInfo> units;
-  units.reserve(toRead);
-
-  const uint32_t step = 200;
-  while (toRead > 0) {
-    auto next = std::min(toRead, step);
-    toRead -= next;
-
-    BlockchainReadBatch batch;
-    for (auto id = readFrom; id < readFrom + next; ++id) {
-      batch.requestCachedBlock(id);
-    }
-
-    readFrom += next;
-
-    auto res = readDatabase(batch);
-
-    std::map<uint32_t, CachedBlockInfo> sortedResult(res.getCachedBlocks().begin(), res.getCachedBlocks().end());
-    for (const auto& kv : sortedResult) {
-      units.push_back(kv.second);
-    }
-    //    std::transform(sortedResult.begin(), sortedResult.end(), std::back_inserter(units),
-    //                   [&](const std::pair<uint32_t, CachedBlockInfo>& cb) { return pred(cb.second); });
+  if (readFrom > blockIndex) {
+    return {};
   }
 
-  return units;
+  return readDatabaseRange<CachedBlockInfo>(database, DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, readFrom, blockIndex + 1);
 }
 
 std::vector<uint64_t> DatabaseBlockchainCache::getLastUnits(
@@ -1416,22 +1473,14 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashes(uint32_t start
     return {};
   }
 
-  BlockchainReadBatch request;
-  auto index = startIndex;
-  while (index != startIndex + count) {
-    request.requestCachedBlock(index++);
-  }
-
-  auto result = readDatabase(request);
-  assert(result.getCachedBlocks().size() == count);
+  const auto blocks =
+      readDatabaseRange<CachedBlockInfo>(database, DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, startIndex, startIndex + count);
+  assert(blocks.size() == count);
 
   std::vector<Crypto::Hash> hashes;
   hashes.reserve(count);
-
-  std::map<uint32_t, CachedBlockInfo> sortedResult(result.getCachedBlocks().begin(), result.getCachedBlocks().end());
-
-  std::transform(sortedResult.begin(), sortedResult.end(), std::back_inserter(hashes),
-                 [](const std::pair<uint32_t, CachedBlockInfo>& cb) { return cb.second.blockHash; });
+  std::transform(blocks.begin(), blocks.end(), std::back_inserter(hashes),
+                 [](const CachedBlockInfo& block) { return block.blockHash; });
   return hashes;
 }
 
@@ -1543,21 +1592,16 @@ std::vector<BinaryArray> DatabaseBlockchainCache::getRawTransactions(
 void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>& transactions,
                                                  std::vector<BinaryArray>& foundTransactions,
                                                  std::vector<Crypto::Hash>& missedTransactions) const {
-  BlockchainReadBatch batch;
-  for (auto& hash : transactions) {
-    batch.requestCachedTransaction(hash);
-  }
-
-  auto res = readDatabase(batch);
-  for (auto& tx : res.getCachedTransactions()) {
-    batch.requestRawBlock(tx.second.blockIndex);
+  const auto hashesMap = readTransactionInfos(transactions);
+  std::vector<uint32_t> blockIndices{};
+  blockIndices.reserve(hashesMap.size());
+  for (const auto& tx : hashesMap) {
+    blockIndices.push_back(tx.second.blockIndex);
   }
 
-  auto blocks = readDatabase(batch);
+  const auto blocksMap = readRawBlocks(blockIndices);
 
   foundTransactions.reserve(foundTransactions.size() + transactions.size());
-  auto& hashesMap = res.getCachedTransactions();
-  auto& blocksMap = blocks.getRawBlocks();
   for (const auto& hash : transactions) {
     auto transactionIt = hashesMap.find(hash);
     if (transactionIt == hashesMap.end()) {
@@ -1589,9 +1633,8 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
 }
 
 RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const {
-  auto batch = BlockchainReadBatch().requestRawBlock(index);
-  auto res = readDatabase(batch);
-  return std::move(res.getRawBlocks().at(index));
+  auto rawBlocks = readRawBlocks({index});
+  return std::move(rawBlocks.at(index));
 }
 
 RawBlockVector DatabaseBlockchainCache::getBlocks(ConstBlockHeightSpan heights) const {
@@ -1600,19 +1643,29 @@ RawBlockVector DatabaseBlockchainCache::getBlocks(ConstBlockHeightSpan heights)
   RawBlockVector reval{};
   reval.reserve(heights.size());
 
-  BlockchainReadBatch batch{};
+  std::vector<uint32_t> indices{};
+  indices.reserve(heights.size());
   for (const auto& height : heights) {
     exceptional_if<InvalidArgumentError>(height.isNull(), "provided height is null");
-    batch.requestRawBlock(height.toIndex());
+    indices.push_back(height.toIndex());
   }
 
-  auto result = readDatabase(batch);
-  auto& rawBlocks = result.getRawBlocks();
+  auto rawBlocks = readRawBlocks(indices);
 
-  for (const auto& height : heights) {
-    auto search = rawBlocks.find(height.toIndex());
+  // peers may request a block several times, it is only moved out for its last occurrence
+  std::unordered_map<uint32_t, size_t> remainingOccurrences{};
+  for (const auto index : indices) {
+    remainingOccurrences[index] += 1;
+  }
+
+  for (const auto index : indices) {
+    auto search = rawBlocks.find(index);
     exceptional_if<NotFoundError>(search == rawBlocks.end(), "raw block not available for height");
-    reval.emplace_back(std::move(search->second));
+    if (--remainingOccurrences[index] == 0) {
+      reval.emplace_back(std::move(search->second));
+    } else {
+      reval.emplace_back(search->second);
+    }
   }
 
   return reval;
@@ -1664,19 +1717,25 @@ CachedTransactionVector DatabaseBlockchainCache::getTransactions(ConstTransactio
 
   auto cachedInfo = getTransactionInfos(ids);
 
-  BlockchainReadBatch batch{};
+  std::vector<uint32_t> indices{};
+  indices.reserve(cachedInfo.size());
   for (const auto& info : cachedInfo) {
-    batch.requestRawBlock(info.blockIndex);
+    indices.push_back(info.blockIndex);
   }
 
-  auto result = readDatabase(batch);
-  auto& blocks = result.getRawBlocks();
+  auto blocks = readRawBlocks(indices);
+  // Transactions of the same block share one decoded block.
+  std::unordered_map<uint32_t, CachedRawBlock> decodedBlocks{};
 
   for (const auto& info : cachedInfo) {
-    auto search = blocks.find(info.blockIndex);
-    exceptional_if<NotFoundError>(search == blocks.end(), "block not contained for transaction cache info");
+    auto decoded = decodedBlocks.find(info.blockIndex);
+    if (decoded == decodedBlocks.end()) {
+      auto search = blocks.find(info.blockIndex);
+      exceptional_if<NotFoundError>(search == blocks.end(), "block not contained for transaction cache info");
+      decoded = decodedBlocks.emplace(info.blockIndex, CachedRawBlock{std::move(search->second)}).first;
+    }
 
-    CachedRawBlock rawBlock{std::move(search->second)};
+    CachedRawBlock& rawBlock = decoded->second;
 
     const auto transactionIndex = info.transactionIndex;
     if (transactionIndex == 0) {
@@ -1707,13 +1766,7 @@ CachedTransactionInfoVector DatabaseBlockchainCache::getTransactionInfos(ConstTr
   CachedTransactionInfoVector reval{};
   reval.resize(ids.size());
 
-  BlockchainReadBatch batch{};
-  for (const auto& id : ids) {
-    batch.requestCachedTransaction(id);
-  }
-
-  auto result = readDatabase(batch);
-  auto& transactions = result.getCachedTransactions();
+  auto transactions = readTransactionInfos(ids);
 
   size_t i = 0;
   for (const auto& id : ids) {
@@ -1725,6 +1778,63 @@ CachedTransactionInfoVector DatabaseBlockchainCache::getTransactionInfos(ConstTr
   return reval;
 }
 
+std::unordered_map<uint32_t, RawBlock> DatabaseBlockchainCache::readRawBlocks(
+    const std::vector<uint32_t>& indices) const {
+  std::unordered_map<uint32_t, RawBlock> reval{};
+  reval.reserve(indices.size());
+
+  BlockchainReadBatch batch{};
+  bool hasMisses = false;
+  for (const auto index : indices) {
+    if (reval.find(index) != reval.end()) {
+      continue;
+    }
+    if (auto cached = rawBlocksCache.get(index)) {
+      reval.emplace(index, std::move(*cached));
+    } else {
+      batch.requestRawBlock(index);
+      hasMisses = true;
+    }
+  }
+
+  if (hasMisses) {
+    for (auto& block : readDatabase(batch).takeRawBlocks()) {
+      rawBlocksCache.put(block.first, block.second);
+      reval.emplace(block.first, std::move(block.second));
+    }
+  }
+  return reval;
+}
+
+std::unordered_map<Crypto::Hash, ExtendedTransactionInfo> DatabaseBlockchainCache::readTransactionInfos(
+    ConstTransactionHashSpan ids) const {
+  std::unordered_map<Crypto::Hash, ExtendedTransactionInfo> reval{};
+  reval.reserve(ids.size());
+
+  BlockchainReadBatch batch{};
+  bool hasMisses = false;
+  for (const auto& id : ids) {
+    if (reval.find(id) != reval.end()) {
+      continue;
+    }
+    if (auto cached = transactionInfosCache.get(id)) {
+      reval.emplace(id, std::move(*cached));
+    } else {
+      batch.requestCachedTransaction(id);
+      hasMisses = true;
+    }
+  }
+
+  if (hasMisses) {
+    auto result = readDatabase(batch);
+    for (const auto& transaction : result.getCachedTransactions()) {
+      transactionInfosCache.put(transaction.first, transaction.second);
+      reval.emplace(transaction.first, transaction.second);
+    }
+  }
+  return reval;
+}
+
 BinaryArray DatabaseBlockchainCache::getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const {
   const auto block = getBlockByIndex(blockIndex);
   const auto blockTemplate = fromBinaryArray<BlockTemplate>(block.blockTemplate);
@@ -1751,113 +1861,40 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getTransactionHashes() const
 
 uint64_t DatabaseBlockchainCache::getAvailableMixinsCount(DatabaseBlockchainCache::Amount amount, uint32_t blockIndex,
                                                           uint64_t threshold) const {
-  auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
-  auto result = readDatabase(batch);
-
-  // std::unordered_map<IBlockchainCache::Amount, uint32_t>
-  auto outputsCount = result.getKeyOutputGlobalIndexesCountForAmounts();
-  auto outputsToCount = outputsCount[amount];
-
-  XI_RETURN_SC_IF(outputsToCount == 0, 0);
-  XI_RETURN_SC_IF(blockIndex >= getTopBlockIndex(), outputsToCount);
-
-  uint32_t count =
-      static_cast<uint32_t>(availableMixinsCountSearch(amount, blockIndex, 0, outputsToCount - 1, threshold));
-
-#if !defined(NDEBUG)
-  if (count < outputsToCount && count < threshold) {
-    uint32_t nextIndex = count;
-    std::vector<PackedOutIndex> nextPackedIndices{};
-    if (!requestPackedOutputs(amount, Common::ArrayView<uint32_t>{std::addressof(nextIndex), 1}, database,
-                              nextPackedIndices)) {
-      throw std::runtime_error{"key output extraction failed"};
-    }
-    assert(nextPackedIndices.size() == 1);
-    assert(nextPackedIndices.front().data.blockIndex > blockIndex);
-  }
-#endif
-
-  return count;
-}
-
-uint64_t DatabaseBlockchainCache::availableMixinsCountSearch(DatabaseBlockchainCache::Amount amount,
-                                                             uint32_t blockIndex, uint32_t leftIndex,
-                                                             uint32_t rightIndex, uint64_t threshold) const {
-  XI_RETURN_SC_IF(leftIndex == rightIndex, leftIndex + 1);
-  const uint32_t midIndex = leftIndex + (rightIndex - leftIndex) / 2;
-  std::array<uint32_t, 3> boundaryIndices{{leftIndex, midIndex, rightIndex}};
-  std::vector<PackedOutIndex> boundaryPackedIndices{};
-  if (!requestPackedOutputs(amount, Common::ArrayView<uint32_t>{boundaryIndices.data(), boundaryIndices.size()},
-                            database, boundaryPackedIndices)) {
-    throw std::runtime_error{"key output extraction failed"};
-  }
-  assert(boundaryIndices.size() == 3);
-  XI_RETURN_SC_IF(boundaryPackedIndices.front().data.blockIndex > blockIndex, leftIndex);
-  XI_RETURN_SC_IF(boundaryPackedIndices.back().data.blockIndex <= blockIndex, rightIndex + 1);
-  const auto mid = boundaryPackedIndices.at(1);
-
-  if (mid.data.blockIndex > blockIndex) {
-    XI_RETURN_SC_IF(midIndex == 0, 0);
-    return availableMixinsCountSearch(amount, blockIndex, leftIndex, midIndex - 1, threshold);
-  } else if (midIndex + 1 >= threshold) {
-    return midIndex + 1;
-  } else {
-    return availableMixinsCountSearch(amount, blockIndex, midIndex + 1, rightIndex, threshold);
-  }
+  XI_UNUSED(threshold);
+  const bool isTopQuery = blockIndex >= getTopBlockIndex();
+  return keyOutputIndex.visit(amount, [blockIndex, isTopQuery](const KeyOutputColumnIndex::Column& column) {
+    XI_RETURN_SC_IF(isTopQuery, static_cast<uint64_t>(column.size()));
+    return column.countUntil(blockIndex);
+  });
 }
 
 std::vector<uint32_t> DatabaseBlockchainCache::getRandomOutsByAmount(uint64_t amount, size_t count,
                                                                      uint32_t blockIndex) const {
-  auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
-  auto result = readDatabase(batch);
-  auto outputsCount = result.getKeyOutputGlobalIndexesCountForAmounts();
-  auto outputsToPick = std::min(static_cast<uint32_t>(count), outputsCount[amount]);
-
-  std::vector<uint32_t> resultOuts;
-  resultOuts.reserve(outputsToPick);
+  return keyOutputIndex.visit(amount, [&](const KeyOutputColumnIndex::Column& column) {
+    const auto outputsCount = static_cast<uint32_t>(column.size());
+    auto outputsToPick = std::min(static_cast<uint32_t>(count), outputsCount);
 
-  ShuffleGenerator<uint32_t, Xi::Crypto::Random::Engine<uint32_t>> generator(outputsCount[amount]);
-
-  uint64_t cumulativeTries = 0;
-  while (outputsToPick && cumulativeTries < outputsCount[amount]) {
-    std::vector<uint32_t> globalIndexes;
-    globalIndexes.reserve(outputsToPick);
+    std::vector<uint32_t> resultOuts;
+    resultOuts.reserve(outputsToPick);
 
+    ShuffleGenerator<uint32_t, Xi::Crypto::Random::Engine<uint32_t>> generator(outputsCount);
     try {
-      for (uint32_t i = 0; i < outputsToPick; ++i, globalIndexes.push_back(generator()))
-        /* */;
-    } catch (const SequenceEnded&) {
-      logger(Logging::Trace) << "getRandomOutsByAmount: generator reached sequence end";
-      return resultOuts;
-    }
-
-    std::vector<PackedOutIndex> outputs;
-    if (extractKeyOtputIndexes(amount, Common::ArrayView<uint32_t>(globalIndexes.data(), globalIndexes.size()),
-                               outputs) != ExtractOutputKeysResult::SUCCESS) {
-      logger(Logging::Debugging) << "getRandomOutsByAmount: failed to extract key output indexes";
-      throw std::runtime_error("Invalid output index");  // TODO: make error code
-    }
-
-    std::vector<ExtendedTransactionInfo> transactions;
-    if (!requestExtendedTransactionInfos(outputs, database, transactions)) {
-      logger(Logging::Trace) << "getRandomOutsByAmount: requestExtendedTransactionInfos failed";
-      throw std::runtime_error("Error while requesting transactions");  // TODO: make error code
-    }
-
-    assert(globalIndexes.size() == transactions.size());
+      while (outputsToPick > 0) {
+        const auto globalIndex = generator();
+        if (!isTransactionSpendTimeUnlocked(column.unlockTimes[globalIndex], blockIndex)) {
+          continue;
+        }
 
-    for (size_t i = 0; i < transactions.size(); ++i) {
-      if (!isTransactionSpendTimeUnlocked(transactions[i].unlockTime, blockIndex)) {
-        continue;
+        resultOuts.push_back(globalIndex);
+        --outputsToPick;
       }
-
-      resultOuts.push_back(globalIndexes[i]);
-      --outputsToPick;
+    } catch (const SequenceEnded&) {
+      logger(Logging::Trace) << "getRandomOutsByAmount: generator reached sequence end";
     }
-    cumulativeTries += transactions.size();
-  }
 
-  return resultOuts;
+    return resultOuts;
+  });
 }
 
 ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
@@ -1963,7 +2000,7 @@ DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExt
 
   ExtendedPushedBlockInfo extendedInfo;
 
-  extendedInfo.pushedBlockInfo.rawBlock = dbResult.getRawBlocks().at(blockIndex);
+  extendedInfo.pushedBlockInfo.rawBlock = std::move(dbResult.takeRawBlocks().at(blockIndex));
   extendedInfo.pushedBlockInfo.blockSize = blockInfo.blobSize;
   extendedInfo.pushedBlockInfo.blockDifficulty =
       blockInfo.cumulativeDifficulty - previousBlockInfo.cumulativeDifficulty;
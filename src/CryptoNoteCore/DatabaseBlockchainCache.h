@@ -33,6 +33,8 @@
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
 
 #include "CryptoNoteCore/Blockchain/CommonBlockchainCache.h"
+#include "CryptoNoteCore/Blockchain/KeyOutputColumnIndex.hpp"
+#include "CryptoNoteCore/Blockchain/ShardedLruCache.hpp"
 
 namespace CryptoNote {
 
@@ -67,6 +69,9 @@ class DatabaseBlockchainCache : public CommonBlockchainCache {
   void pushBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& cachedTransactions,
                  const TransactionValidatorState& validatorState, size_t blockSize, uint64_t generatedCoins,
                  uint64_t blockDifficulty, RawBlock&& rawBlock) override;
+  void beginBatchedPush() override;
+  void commitBatchedPush() override;
+  BlockchainReadCacheStatistics getReadCacheStatistics() const override;
   virtual PushedBlockInfo getPushedBlockInfo(uint32_t index) const override;
   [[nodiscard]] bool checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const override;
   [[nodiscard]] bool checkIfSpent(const Crypto::KeyImage& keyImage) const override;
@@ -154,10 +159,6 @@ class DatabaseBlockchainCache : public CommonBlockchainCache {
  public:
   [[nodiscard]] uint64_t getAvailableMixinsCount(Amount amount, uint32_t blockIndex, uint64_t threshold) const override;
 
- private:
-  [[nodiscard]] uint64_t availableMixinsCountSearch(Amount amount, uint32_t blockIndex, uint32_t leftIndex,
-                                                    uint32_t rightIndex, uint64_t threshold) const;
-
  public:
   virtual std::vector<uint32_t> getRandomOutsByAmount(uint64_t amount, size_t count,
                                                       uint32_t blockIndex) const override;
@@ -186,11 +187,31 @@ class DatabaseBlockchainCache : public CommonBlockchainCache {
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
 
+  /// Decoded raw blocks by index, readers populate it on misses, split and pushBlock invalidate touched entries.
+  mutable ShardedLruCache<uint32_t, RawBlock> rawBlocksCache;
+  /// Decoded transaction infos by transaction hash, maintained like the raw blocks cache.
+  mutable ShardedLruCache<Crypto::Hash, ExtendedTransactionInfo> transactionInfosCache;
+  /// Block index and unlock time of every key output, loaded per amount on first use.
+  KeyOutputColumnIndex keyOutputIndex;
+
+  KeyOutputColumnIndex::Column readKeyOutputColumn(Amount amount) const;
+
+  std::unordered_map<uint32_t, RawBlock> readRawBlocks(const std::vector<uint32_t>& indices) const;
+  std::unordered_map<Crypto::Hash, ExtendedTransactionInfo> readTransactionInfos(ConstTransactionHashSpan ids) const;
+
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
 
   void deleteClosestTimestampBlockIndex(BlockchainWriteBatch& writeBatch, uint32_t splitBlockIndex);
   CachedBlockInfo getCachedBlockInfo(uint32_t index) const;
+
+  /*!
+   * \brief loadTopBlockInfo loads all lazily cached top block members.
+   *
+   * Readers may query the cache concurrently and must not populate them, thus they are loaded whenever the top block
+   * changes.
+   */
+  void loadTopBlockInfo() const;
   BlockchainReadResult readDatabase(BlockchainReadBatch& batch) const;
 
   void addSpentKeyImage(const Crypto::KeyImage& keyImage, uint32_t blockIndex);
@@ -26,6 +26,7 @@
 #include "CryptoNoteCore/CryptoNote.h"
 #include "CryptoNoteCore/CachedBlock.h"
 #include "CryptoNoteCore/Blockchain/RawBlock.h"
+#include "CryptoNoteCore/Blockchain/ReadCacheStatistics.h"
 #include "CryptoNoteCore/DatabaseCacheData.h"
 #include "CryptoNoteCore/Transactions/CachedTransaction.h"
 #include "CryptoNoteCore/Transactions/TransactionValidatiorState.h"
@@ -142,6 +143,14 @@ class IBlockchainCache : public std::enable_shared_from_this<IBlockchainCache> {
   virtual void pushBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& cachedTransactions,
                          const TransactionValidatorState& validatorState, size_t blockSize, uint64_t generatedCoins,
                          uint64_t blockDifficulty, RawBlock&& rawBlock) = 0;
+
+  /// Bundles the storage writes of all following pushes into one write until commitBatchedPush is called.
+  virtual void beginBatchedPush() = 0;
+  /// Writes all pushes since beginBatchedPush, throws if the storage failed.
+  virtual void commitBatchedPush() = 0;
+  /// Hit rates of the decoded block and transaction caches in front of the storage, zero if there are none.
+  virtual BlockchainReadCacheStatistics getReadCacheStatistics() const = 0;
+
   virtual PushedBlockInfo getPushedBlockInfo(uint32_t index) const = 0;
 
   [[nodiscard]] virtual bool checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const = 0;
@@ -8,9 +8,10 @@
 
 #include <vector>
 #include <optional>
+#include <functional>
 
 #include <Xi/Result.h>
-#include <Xi/Concurrent/RecursiveLock.h>
+#include <Xi/Concurrent/RecursiveReadersWriterLock.h>
 
 #include "CryptoNoteCore/CryptoNote.h"
 
@@ -68,7 +69,7 @@ class ICore : public IBlockchain {
   virtual ~ICore() {
   }
 
-  virtual Xi::Concurrent::RecursiveLock::lock_t lock() const = 0;
+  virtual Xi::Concurrent::RecursiveReadersWriterLock::write_lock_t lock() const = 0;
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) = 0;
   virtual bool removeMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) = 0;
@@ -120,6 +121,20 @@ class ICore : public IBlockchain {
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) = 0;
   virtual std::error_code addBlock(RawBlock&& rawBlock) = 0;
 
+  /*!
+   * \brief addBlocks adds a batch of blocks, usually received during synchronization
+   * \param cachedBlocks The blocks to add, in chain order
+   * \param rawBlocks The raw blocks corresponding to cachedBlocks
+   * \param onBlockProcessed Called with the index and add block result of every processed block, returning false
+   * stops the import
+   * \return The number of blocks processed
+   *
+   * Validation steps not depending on the chain state (transaction parsing, hashing, proof of work and transfer pre
+   * validation) run ahead in parallel for all blocks, while blocks are still committed one after another.
+   */
+  virtual size_t addBlocks(const std::vector<CachedBlock>& cachedBlocks, std::vector<RawBlock>&& rawBlocks,
+                           const std::function<bool(size_t, const std::error_code&)>& onBlockProcessed) = 0;
+
   /*!
    * \brief addBlock tries to add block with already known transaction details
    * \param block A lite block missing transaction transaction details
@@ -18,21 +18,69 @@
 #pragma once
 
 #include <string>
+#include <functional>
 #include <system_error>
 
+#include <Xi/Byte.hh>
+
 #include "IWriteBatch.h"
 #include "IReadBatch.h"
 
 namespace CryptoNote {
 
 class IDataBase {
+ public:
+  /// Visits one raw entry of a range, returning false stops the iteration.
+  using RangeVisitor = std::function<bool(Xi::ConstByteSpan key, Xi::ConstByteSpan value)>;
+
  public:
   virtual ~IDataBase() {
   }
 
+  /*!
+   * \brief write applies the batch, persisting may be deferred.
+   *
+   * Reads and iterations observe the changes immediately. Writes are persisted atomically in their order, a failure
+   * to persist is reported by the following writes.
+   */
   [[nodiscard]] virtual std::error_code write(IWriteBatch& batch) = 0;
+  /// Applies the batch and returns once it and all previous writes are synced to disk.
   [[nodiscard]] virtual std::error_code writeSync(IWriteBatch& batch) = 0;
 
+  /*!
+   * \brief read looks up all keys of the batch and submits the raw results to it.
+   *
+   * The batch deserializes the results while the database holds its pending writes locked for reading. The batch must
+   * not write to this database from within submitRawResult, such a write waits for that lock and deadlocks.
+   */
   [[nodiscard]] virtual std::error_code read(IReadBatch& batch) = 0;
+
+  /*!
+   * \brief iterate visits all entries with a raw key in [begin, end) in ascending bytewise key order.
+   * \param begin Inclusive lower bound of the range, its prefix determines the table iterated.
+   * \param end Exclusive upper bound of the range, must address the same table as begin.
+   * \param visitor Called for every entry, the spans are only valid during the call.
+   * \return An error if the underlying database failed, otherwise success even if the range was empty.
+   *
+   * The visitor runs while the database holds its pending writes locked for reading. It must not write to this
+   * database, such a write waits for that lock and deadlocks. Collect changes and write them once iterate returned.
+   */
+  [[nodiscard]] virtual std::error_code iterate(const std::string& begin, const std::string& end,
+                                                const RangeVisitor& visitor) = 0;
+
+  /*!
+   * \brief beginWriteGroup collects all following writes in memory until the group is committed.
+   *
+   * Reads and iterations observe the pending writes of the group. Opening a group while another one is pending has no
+   * effect, synchronous writes commit the group. All changes of the group are held in memory until it is committed,
+   * callers are responsible to bound its size.
+   */
+  [[nodiscard]] virtual std::error_code beginWriteGroup() = 0;
+
+  /*!
+   * \brief commitWriteGroup queues all changes collected since beginWriteGroup to be persisted as one atomic batch.
+   * \return An error if the underlying database failed, success if no group was pending.
+   */
+  [[nodiscard]] virtual std::error_code commitWriteGroup() = 0;
 };
 }  // namespace CryptoNote
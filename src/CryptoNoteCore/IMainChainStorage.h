@@ -17,12 +17,40 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <Xi/Global.hh>
+#include <Xi/Byte.hh>
+
 #include <CryptoNoteCore/CryptoNote.h>
 #include <CryptoNoteCore/Blockchain/RawBlock.h>
 
 namespace CryptoNote {
 
 class IMainChainStorage {
+ public:
+  /*!
+   * \brief The BlockBlob class references a binary serialized raw block in place.
+   *
+   * The blob pins the storage, its blocks are neither popped, overwritten nor unmapped while the blob is alive. Writers
+   * wait until all blobs are released, thus a blob must never be held by the thread modifying the storage.
+   */
+  class BlockBlob {
+   public:
+    BlockBlob(Xi::ConstByteSpan blob, std::shared_ptr<void> pin) : m_blob{blob}, m_pin{std::move(pin)} {
+    }
+
+    Xi::ConstByteSpan span() const {
+      return m_blob;
+    }
+
+   private:
+    Xi::ConstByteSpan m_blob;
+    std::shared_ptr<void> m_pin;
+  };
+
  public:
   virtual ~IMainChainStorage() {
   }
@@ -31,6 +59,12 @@ class IMainChainStorage {
   virtual void popBlock() = 0;
 
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
+
+  /// Returns the binary serialized raw block pinned in place, if the storage supports it.
+  virtual std::optional<BlockBlob> getBlockBlobByIndex(uint32_t index) const {
+    XI_UNUSED(index);
+    return std::nullopt;
+  }
   virtual uint64_t getBlobSizeByIndex(uint32_t index) const = 0;
   virtual uint32_t getBlockCount() const = 0;
 
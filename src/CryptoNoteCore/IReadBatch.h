@@ -21,6 +21,8 @@
 #include <string>
 #include <utility>
 
+#include <Xi/Byte.hh>
+
 namespace CryptoNote {
 
 class IReadBatch {
@@ -28,7 +30,14 @@ class IReadBatch {
   virtual ~IReadBatch() = default;
 
   virtual std::vector<std::string> getRawKeys() const = 0;
-  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) = 0;
+
+  /*!
+   * \brief submitRawResult passes the values read for getRawKeys() in request order.
+   *
+   * The spans are only valid during the call, they may point directly into database owned memory. Implementations
+   * must deserialize or copy everything they need before returning.
+   */
+  virtual void submitRawResult(const std::vector<Xi::ConstByteSpan>& values, const std::vector<bool>& resultStates) = 0;
 };
 
 }  // namespace CryptoNote
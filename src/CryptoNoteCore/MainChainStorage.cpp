@@ -20,6 +20,7 @@
 #include <boost/filesystem.hpp>
 
 #include "CryptoNoteTools.h"
+#include "MappedMainChainStorage.h"
 
 namespace CryptoNote {
 
@@ -36,14 +37,17 @@ MainChainStorage::~MainChainStorage() {
 }
 
 void MainChainStorage::pushBlock(const RawBlock& rawBlock, const uint64_t blobSize) {
+  XI_CONCURRENT_RLOCK(m_access);
   storage.push_back(Entity{rawBlock, blobSize});
 }
 
 void MainChainStorage::popBlock() {
+  XI_CONCURRENT_RLOCK(m_access);
   storage.pop_back();
 }
 
 RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
+  XI_CONCURRENT_RLOCK(m_access);
   if (index >= storage.size()) {
     throw std::out_of_range("Block index " + std::to_string(index) +
                             " is out of range. Blocks count: " + std::to_string(storage.size()));
@@ -53,6 +57,7 @@ RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
 }
 
 uint64_t MainChainStorage::getBlobSizeByIndex(uint32_t index) const {
+  XI_CONCURRENT_RLOCK(m_access);
   if (index >= storage.size()) {
     throw std::out_of_range("Block index " + std::to_string(index) +
                             " is out of range. Blocks count: " + std::to_string(storage.size()));
@@ -62,18 +67,52 @@ uint64_t MainChainStorage::getBlobSizeByIndex(uint32_t index) const {
 }
 
 uint32_t MainChainStorage::getBlockCount() const {
+  XI_CONCURRENT_RLOCK(m_access);
   return static_cast<uint32_t>(storage.size());
 }
 
 void MainChainStorage::clear() {
+  XI_CONCURRENT_RLOCK(m_access);
   storage.clear();
 }
 
+namespace {
+void migrateMainChainStorage(const std::string& blocksFilename, const std::string& indexesFilename,
+                             const std::string& storeDirectory) {
+  {
+    MainChainStorage legacy(blocksFilename, indexesFilename);
+    MappedMainChainStorage store(storeDirectory);
+    const uint32_t legacyCount = legacy.getBlockCount();
+
+    // an interrupted migration is resumed, unless the store diverged from the legacy storage
+    const uint32_t migrated = store.getBlockCount();
+    if (migrated > legacyCount || (migrated > 0 && store.getBlockByIndex(migrated - 1).blockTemplate !=
+                                                       legacy.getBlockByIndex(migrated - 1).blockTemplate)) {
+      store.clear();
+    }
+    for (uint32_t index = store.getBlockCount(); index < legacyCount; ++index) {
+      store.pushBlock(legacy.getBlockByIndex(index), legacy.getBlobSizeByIndex(index));
+    }
+    // the destructor swallows flush failures, the legacy files must outlive any block not on disk yet
+    store.sync();
+  }
+
+  // all blocks are durable in the store, the legacy files are obsolete now
+  boost::filesystem::remove(blocksFilename);
+  boost::filesystem::remove(indexesFilename);
+}
+}  // namespace
+
 std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency) {
   boost::filesystem::path blocksFilename = boost::filesystem::path(dataDir) / currency.blocksFileName();
   boost::filesystem::path indexesFilename = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
+  boost::filesystem::path storeDirectory = boost::filesystem::path(dataDir) / (currency.blocksFileName() + "-store");
+
+  if (boost::filesystem::exists(blocksFilename) && boost::filesystem::exists(indexesFilename)) {
+    migrateMainChainStorage(blocksFilename.string(), indexesFilename.string(), storeDirectory.string());
+  }
 
-  std::unique_ptr<IMainChainStorage> storage(new MainChainStorage(blocksFilename.string(), indexesFilename.string()));
+  std::unique_ptr<IMainChainStorage> storage(new MappedMainChainStorage(storeDirectory.string()));
   if (storage->getBlockCount() == 0) {
     RawBlock genesis;
     genesis.blockTemplate = toBinaryArray(currency.genesisBlock());
@@ -19,6 +19,7 @@
 
 #include <string>
 
+#include <Xi/Concurrent/RecursiveLock.h>
 #include <Serialization/ISerializer.h>
 
 #include "IMainChainStorage.h"
@@ -53,9 +54,17 @@ class MainChainStorage : public IMainChainStorage {
   virtual void clear() override;
 
  private:
+  /// The swapped vector loads items on read access, concurrent readers need to be serialized.
+  mutable Xi::Concurrent::RecursiveLock m_access;
   mutable SwappedVector<Entity> storage;
 };
 
+/*!
+ * \brief createSwappedMainChainStorage opens the memory mapped main chain storage of the data directory.
+ *
+ * Blocks of a legacy swapped vector storage found in the data directory are migrated first, the legacy files are
+ * removed afterwards.
+ */
 std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency);
 
 }  // namespace CryptoNote
@@ -0,0 +1,286 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include "CryptoNoteCore/MappedMainChainStorage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include <Xi/FileSystem.h>
+#include <Xi/Crypto/Hash/Crc.hpp>
+#include <Serialization/BinarySpanInputSerializer.hpp>
+
+#include "CryptoNoteCore/CryptoNoteTools.h"
+
+namespace CryptoNote {
+
+namespace {
+const uint64_t INDEX_MAGIC = 0x5844495354534958ULL;  // "XISTSIDX"
+const uint32_t INDEX_VERSION = 1;
+const uint32_t INITIAL_INDEX_CAPACITY = 1 << 16;
+const char* const INDEX_FILENAME = "index.bin";
+
+uint32_t checksum(Xi::ConstByteSpan blob) {
+  const auto crc = Xi::Crypto::Hash::crc32(blob);
+  uint32_t reval = 0;
+  static_assert(sizeof(reval) * 8 == Xi::Crypto::Hash::Crc::Hash32::bits(), "crc32 must fit the index entry");
+  std::memcpy(&reval, crc.data(), sizeof(reval));
+  return reval;
+}
+}  // namespace
+
+MappedMainChainStorage::MappedMainChainStorage(const std::string& directory) : m_directory{directory} {
+  static_assert(sizeof(IndexHeader) == 24, "index header layout is persisted");
+  static_assert(sizeof(IndexEntry) == 32, "index entry layout is persisted");
+
+  Xi::FileSystem::ensureDirectoryExists(m_directory).throwOnError();
+  const auto indexPath = (boost::filesystem::path{m_directory} / INDEX_FILENAME).string();
+  if (Xi::FileSystem::exists(indexPath).takeOrThrow()) {
+    m_index.open(indexPath);
+    if (m_index.size() < sizeof(IndexHeader) || header().magic != INDEX_MAGIC || header().version != INDEX_VERSION ||
+        header().count > indexCapacity() || header().durableCount > header().count) {
+      throw std::runtime_error{"Failed to load main chain storage, corrupted index: " + indexPath};
+    }
+  } else {
+    m_index.create(indexPath, sizeof(IndexHeader) + INITIAL_INDEX_CAPACITY * sizeof(IndexEntry), false);
+    header() = IndexHeader{INDEX_MAGIC, INDEX_VERSION, 0, 0, 0};
+    m_index.flush(m_index.data(), sizeof(IndexHeader));
+  }
+
+  // segments of blocks after the durable mark may be missing, their blocks are cut by the tail recovery
+  if (header().durableCount > 0 && !openSegments(entry(header().durableCount - 1).segment)) {
+    throw std::runtime_error{"Failed to load main chain storage, missing segment: " +
+                             segmentPath(static_cast<uint32_t>(m_segments.size()))};
+  }
+  recoverTail();
+}
+
+MappedMainChainStorage::~MappedMainChainStorage() {
+  try {
+    XI_CONCURRENT_LOCK_WRITE(m_access);
+    syncLocked();
+  } catch (...) {
+    // blocks pushed after the last sync are validated on next open
+  }
+}
+
+void MappedMainChainStorage::pushBlock(const RawBlock& rawBlock, const uint64_t blobSize) {
+  XI_CONCURRENT_LOCK_WRITE(m_access);
+  const auto blob = toBinaryArray(rawBlock);
+  const uint32_t count = header().count;
+
+  uint32_t segmentIndex = 0;
+  uint64_t offset = 0;
+  if (count > 0) {
+    const auto& last = entry(count - 1);
+    segmentIndex = last.segment;
+    offset = last.offset + last.size;
+    if (offset + blob.size() > segment(segmentIndex, 0).size()) {
+      segmentIndex += 1;
+      offset = 0;
+    }
+  }
+
+  auto& file = segment(segmentIndex, offset + blob.size());
+  std::memcpy(file.data() + offset, blob.data(), blob.size());
+
+  ensureIndexCapacity(count + 1);
+  entry(count) = IndexEntry{segmentIndex,
+                            static_cast<uint32_t>(blob.size()),
+                            offset,
+                            blobSize,
+                            checksum(Xi::ConstByteSpan{blob.data(), blob.size()}),
+                            0};
+  header().count = count + 1;
+
+  if (header().count - header().durableCount >= SYNC_INTERVAL) {
+    syncLocked();
+  }
+}
+
+void MappedMainChainStorage::popBlock() {
+  XI_CONCURRENT_LOCK_WRITE(m_access);
+  if (header().count == 0) {
+    throw std::out_of_range{"Main chain storage is empty, nothing to pop."};
+  }
+  header().count -= 1;
+  if (header().durableCount > header().count) {
+    // the next block pushed at this height overwrites flushed data, it must not be trusted on disk before its resync
+    header().durableCount = header().count;
+    flushHeader();
+  }
+}
+
+RawBlock MappedMainChainStorage::getBlockByIndex(uint32_t index) const {
+  XI_CONCURRENT_LOCK_READ(m_access);
+  throwIfOutOfRange(index);
+
+  RawBlock reval{};
+  BinarySpanInputSerializer serializer{blobOf(entry(index))};
+  if (!serialize(reval, serializer) || !serializer.isEndOfStream()) {
+    throw std::runtime_error{"Main chain storage block " + std::to_string(index) + " is corrupted."};
+  }
+  return reval;
+}
+
+std::optional<IMainChainStorage::BlockBlob> MappedMainChainStorage::getBlockBlobByIndex(uint32_t index) const {
+  // pops, pushes overwriting a popped block and clear wait for the lock, the blob stays mapped and unchanged meanwhile
+  auto pin = std::make_shared<boost::shared_lock<boost::shared_mutex>>(m_access.mutex);
+  throwIfOutOfRange(index);
+  return BlockBlob{blobOf(entry(index)), std::move(pin)};
+}
+
+uint64_t MappedMainChainStorage::getBlobSizeByIndex(uint32_t index) const {
+  XI_CONCURRENT_LOCK_READ(m_access);
+  throwIfOutOfRange(index);
+  return entry(index).blobSize;
+}
+
+uint32_t MappedMainChainStorage::getBlockCount() const {
+  XI_CONCURRENT_LOCK_READ(m_access);
+  return header().count;
+}
+
+void MappedMainChainStorage::sync() {
+  XI_CONCURRENT_LOCK_WRITE(m_access);
+  syncLocked();
+}
+
+void MappedMainChainStorage::clear() {
+  XI_CONCURRENT_LOCK_WRITE(m_access);
+  header().count = 0;
+  header().durableCount = 0;
+  flushHeader();
+
+  for (uint32_t i = 0; i < m_segments.size(); ++i) {
+    m_segments[i]->close();
+  }
+  m_segments.clear();
+  for (uint32_t i = 0; Xi::FileSystem::exists(segmentPath(i)).takeOrThrow(); ++i) {
+    Xi::FileSystem::removeFileIfExists(segmentPath(i)).throwOnError();
+  }
+}
+
+MappedMainChainStorage::IndexHeader& MappedMainChainStorage::header() const {
+  return *reinterpret_cast<IndexHeader*>(m_index.data());
+}
+
+MappedMainChainStorage::IndexEntry& MappedMainChainStorage::entry(uint32_t index) const {
+  return reinterpret_cast<IndexEntry*>(m_index.data() + sizeof(IndexHeader))[index];
+}
+
+uint32_t MappedMainChainStorage::indexCapacity() const {
+  return static_cast<uint32_t>((m_index.size() - sizeof(IndexHeader)) / sizeof(IndexEntry));
+}
+
+void MappedMainChainStorage::ensureIndexCapacity(uint32_t count) {
+  const uint32_t capacity = indexCapacity();
+  if (count > capacity) {
+    m_index.resize(sizeof(IndexHeader) + 2 * static_cast<uint64_t>(capacity) * sizeof(IndexEntry));
+  }
+}
+
+System::MemoryMappedFile& MappedMainChainStorage::segment(uint32_t index, uint64_t minimumSize) {
+  while (m_segments.size() <= index) {
+    const auto path = segmentPath(static_cast<uint32_t>(m_segments.size()));
+    m_segments.emplace_back(std::make_unique<System::MemoryMappedFile>());
+    if (Xi::FileSystem::exists(path).takeOrThrow()) {
+      m_segments.back()->open(path);
+    } else {
+      m_segments.back()->create(path, std::max(SEGMENT_CAPACITY, minimumSize), false);
+    }
+  }
+
+  auto& reval = *m_segments[index];
+  if (reval.size() < minimumSize) {
+    // only reached for a segment appended to from its very beginning, it holds no block a span could point into
+    reval.resize(minimumSize);
+  }
+  return reval;
+}
+
+bool MappedMainChainStorage::openSegments(uint32_t lastSegment) {
+  while (m_segments.size() <= lastSegment) {
+    const auto path = segmentPath(static_cast<uint32_t>(m_segments.size()));
+    if (!Xi::FileSystem::exists(path).takeOrThrow()) {
+      return false;
+    }
+    auto file = std::make_unique<System::MemoryMappedFile>();
+    file->open(path);
+    m_segments.emplace_back(std::move(file));
+  }
+  return true;
+}
+
+std::string MappedMainChainStorage::segmentPath(uint32_t index) const {
+  return (boost::filesystem::path{m_directory} / ("segment-" + std::to_string(index) + ".bin")).string();
+}
+
+Xi::ConstByteSpan MappedMainChainStorage::blobOf(const IndexEntry& entry) const {
+  return Xi::ConstByteSpan{m_segments[entry.segment]->data() + entry.offset, entry.size};
+}
+
+bool MappedMainChainStorage::isValid(const IndexEntry& entry) const {
+  XI_RETURN_EC_IF(entry.segment >= m_segments.size(), false);
+  XI_RETURN_EC_IF(entry.offset + entry.size > m_segments[entry.segment]->size(), false);
+  XI_RETURN_EC_IF_NOT(checksum(blobOf(entry)) == entry.checksum, false);
+  XI_RETURN_SC(true);
+}
+
+void MappedMainChainStorage::recoverTail() {
+  uint32_t count = header().durableCount;
+  while (count < header().count && openSegments(entry(count).segment) && isValid(entry(count))) {
+    count += 1;
+  }
+  header().count = count;
+  syncLocked();
+}
+
+void MappedMainChainStorage::syncLocked() {
+  if (header().durableCount < header().count) {
+    for (uint32_t i = entry(header().durableCount).segment; i < m_segments.size(); ++i) {
+      m_segments[i]->flush(m_segments[i]->data(), m_segments[i]->size());
+    }
+    // the entries must reach the disk before the durable mark covering them
+    m_index.flush(m_index.data(), m_index.size());
+  }
+  header().durableCount = header().count;
+  flushHeader();
+}
+
+void MappedMainChainStorage::flushHeader() {
+  m_index.flush(m_index.data(), sizeof(IndexHeader));
+}
+
+void MappedMainChainStorage::throwIfOutOfRange(uint32_t index) const {
+  if (index >= header().count) {
+    throw std::out_of_range("Block index " + std::to_string(index) +
+                            " is out of range. Blocks count: " + std::to_string(header().count));
+  }
+}
+
+}  // namespace CryptoNote
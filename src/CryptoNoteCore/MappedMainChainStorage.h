@@ -0,0 +1,117 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Xi/Global.hh>
+#include <Xi/Byte.hh>
+#include <Xi/Concurrent/ReadersWriterLock.h>
+#include <System/MemoryMappedFile.h>
+
+#include "CryptoNoteCore/IMainChainStorage.h"
+
+namespace CryptoNote {
+
+/*!
+ * \brief The MappedMainChainStorage class stores the main chain in memory mapped, append only segment files.
+ *
+ * Blocks are stored binary serialized back to back in segments of a fixed capacity. Segments are never remapped while
+ * they hold blocks, thus blobs are served as spans straight into the map, pinned by a read lock of the storage. An
+ * index file holds one fixed width entry, including a checksum of the blob, per block.
+ *
+ * Every SYNC_INTERVAL blocks all segments and the index are flushed and the block count is marked durable. Blocks
+ * pushed after the last durable mark are validated against their checksum on open, the storage is cut at the first
+ * torn block.
+ */
+class MappedMainChainStorage : public IMainChainStorage {
+ public:
+  static constexpr uint64_t SEGMENT_CAPACITY = 256ULL << 20;
+  static constexpr uint32_t SYNC_INTERVAL = 256;
+
+ public:
+  explicit MappedMainChainStorage(const std::string& directory);
+  XI_DELETE_COPY(MappedMainChainStorage);
+  XI_DELETE_MOVE(MappedMainChainStorage);
+  ~MappedMainChainStorage() override;
+
+  void pushBlock(const RawBlock& rawBlock, const uint64_t blobSize) override;
+  void popBlock() override;
+
+  RawBlock getBlockByIndex(uint32_t index) const override;
+  std::optional<BlockBlob> getBlockBlobByIndex(uint32_t index) const override;
+  uint64_t getBlobSizeByIndex(uint32_t index) const override;
+  uint32_t getBlockCount() const override;
+
+  void clear() override;
+
+  /// Flushes all blocks pushed since the last durable mark and marks them durable, throws if flushing fails.
+  void sync();
+
+ private:
+  struct IndexHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t durableCount;  ///< Blocks known to be flushed, never validated again on open.
+    uint32_t reserved;
+  };
+
+  struct IndexEntry {
+    uint32_t segment;
+    uint32_t size;
+    uint64_t offset;
+    uint64_t blobSize;
+    uint32_t checksum;
+    uint32_t reserved;
+  };
+
+  IndexHeader& header() const;
+  IndexEntry& entry(uint32_t index) const;
+  uint32_t indexCapacity() const;
+  void ensureIndexCapacity(uint32_t count);
+
+  System::MemoryMappedFile& segment(uint32_t index, uint64_t minimumSize);
+  bool openSegments(uint32_t lastSegment);
+  std::string segmentPath(uint32_t index) const;
+  Xi::ConstByteSpan blobOf(const IndexEntry& entry) const;
+  bool isValid(const IndexEntry& entry) const;
+
+  void recoverTail();
+  void syncLocked();
+  void flushHeader();
+  void throwIfOutOfRange(uint32_t index) const;
+
+ private:
+  std::string m_directory;
+  Xi::Concurrent::ReadersWriterLock m_access;
+  mutable System::MemoryMappedFile m_index;
+  std::vector<std::unique_ptr<System::MemoryMappedFile>> m_segments;
+};
+
+}  // namespace CryptoNote
@@ -17,14 +17,22 @@
 
 #include "RocksDBWrapper.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+
 #include <Xi/FileSystem.h>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice_transform.h"
 #include "rocksdb/utilities/backupable_db.h"
 
 #include "DataBaseErrors.h"
+#include "DBUtils.h"
 
 using namespace CryptoNote;
 using namespace Logging;
@@ -33,6 +41,9 @@ RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "Rocks
 }
 
 RocksDBWrapper::~RocksDBWrapper() {
+  if (state.load() == INITIALIZED) {
+    close();
+  }
 }
 
 void RocksDBWrapper::init(const DataBaseConfig& config) {
@@ -46,15 +57,17 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
   logger(Info) << "Opening DB in " << dataDir;
 
   rocksdb::DB* dbPtr;
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
 
-  rocksdb::Options dbOptions = getDBOptions(config);
-  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+  rocksdb::DBOptions dbOptions = getDBOptions(config);
+  const auto descriptors = getColumnFamilyDescriptors(config);
+  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
   if (status.ok()) {
     logger(Info) << "DB opened in " << dataDir;
   } else if (!status.ok() && status.IsInvalidArgument()) {
     logger(Info) << "DB not found in " << dataDir << ". Creating new DB...";
     dbOptions.create_if_missing = true;
-    status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+    status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
     if (!status.ok()) {
       logger(Error) << "DB Error. DB can't be created in " << dataDir << ". Error: " << status.ToString();
       throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
@@ -68,6 +81,10 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
   }
 
   db.reset(dbPtr);
+  columnFamilies = std::move(handles);
+  isWriterStopping = false;
+  pendingError = std::error_code{};
+  writer = std::thread{[this]() { runWriteBehind(); }};
   state.store(INITIALIZED);
 }
 
@@ -77,8 +94,40 @@ void RocksDBWrapper::shutdown() {
   }
 
   logger(Info) << "Closing DB.";
-  db->Flush(rocksdb::FlushOptions());
+  {
+    std::unique_lock<std::shared_mutex> lock{pendingAccess};
+    if (const auto ec = commitWriteGroupLocked(lock, false)) {
+      logger(Error) << "Pending writes lost: " << ec.message();
+    } else if (const auto drainError = drainLocked(lock)) {
+      logger(Error) << "Pending writes lost: " << drainError.message();
+    }
+  }
+  db->Flush(rocksdb::FlushOptions(), columnFamilies);
   db->SyncWAL();
+  close();
+}
+
+void RocksDBWrapper::close() {
+  {
+    std::unique_lock<std::shared_mutex> lock{pendingAccess};
+    if (const auto ec = commitWriteGroupLocked(lock, false)) {
+      logger(Error) << "Pending write group lost: " << ec.message();
+    }
+    // the writer persists everything queued before it stops
+    isWriterStopping = true;
+    pendingChanged.notify_all();
+  }
+  if (writer.joinable()) {
+    writer.join();
+  }
+  if (pendingError) {
+    logger(Error) << "Pending writes lost: " << pendingError.message();
+  }
+  pendingIndex.reset();
+  for (auto handle : columnFamilies) {
+    db->DestroyColumnFamilyHandle(handle);
+  }
+  columnFamilies.clear();
   db.reset();
   state.store(NOT_INITIALIZED);
 }
@@ -92,8 +141,8 @@ void RocksDBWrapper::destoy(const DataBaseConfig& config) {
 
   logger(Warning) << "Destroying DB in " << dataDir;
 
-  rocksdb::Options dbOptions = getDBOptions(config);
-  rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions);
+  rocksdb::Options dbOptions{getDBOptions(config), rocksdb::ColumnFamilyOptions{}};
+  rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions, getColumnFamilyDescriptors(config));
 
   if (status.ok()) {
     logger(Warning) << "DB destroyed in " << dataDir;
@@ -120,27 +169,158 @@ std::error_code RocksDBWrapper::writeSync(IWriteBatch& batch) {
 }
 
 std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
-  rocksdb::WriteOptions writeOptions;
-  writeOptions.sync = sync;
+  auto inserts = batch.extractRawDataToInsert();
+  auto removals = batch.extractRawKeysToRemove();
+  PendingWrite pending{};
+  pending.sync = sync;
+  pending.changes.reserve(inserts.size() + removals.size());
+  for (auto& kvPair : inserts) {
+    pending.changes.emplace_back(std::move(kvPair.first), std::move(kvPair.second));
+  }
+  for (auto& key : removals) {
+    pending.changes.emplace_back(std::move(key), std::nullopt);
+  }
 
-  rocksdb::WriteBatch rocksdbBatch;
-  std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
-  for (const std::pair<std::string, std::string>& kvPair : rawData) {
-    rocksdbBatch.Put(rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+  std::unique_lock<std::shared_mutex> lock{pendingAccess};
+  if (pendingError) {
+    return pendingError;
   }
 
-  std::vector<std::string> rawKeys(batch.extractRawKeysToRemove());
-  for (const std::string& key : rawKeys) {
-    rocksdbBatch.Delete(rocksdb::Slice(key));
+  if (!pendingIndex) {
+    // overwrite_key is required for iterators over the index to yield the latest value of a key only
+    pendingIndex = std::make_unique<rocksdb::WriteBatchWithIndex>(rocksdb::BytewiseComparator(), 0, true);
   }
+  stage(*pendingIndex, pending);
 
-  rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
+  if (writeGroup) {
+    // changes keep their order, a key removed by one write of the group may be inserted again by a later one
+    std::move(pending.changes.begin(), pending.changes.end(), std::back_inserter(writeGroup->changes));
+    return sync ? commitWriteGroupLocked(lock, true) : std::error_code{};
+  }
 
-  if (!status.ok()) {
-    logger(Error) << "Can't write to DB. " << status.ToString();
-    return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
-  } else {
-    return std::error_code();
+  return enqueueLocked(lock, std::move(pending));
+}
+
+std::error_code RocksDBWrapper::beginWriteGroup() {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  std::unique_lock<std::shared_mutex> lock{pendingAccess};
+  if (!writeGroup) {
+    writeGroup = std::make_unique<PendingWrite>();
+  }
+  return pendingError;
+}
+
+std::error_code RocksDBWrapper::commitWriteGroup() {
+  std::unique_lock<std::shared_mutex> lock{pendingAccess};
+  return commitWriteGroupLocked(lock, false);
+}
+
+std::error_code RocksDBWrapper::commitWriteGroupLocked(std::unique_lock<std::shared_mutex>& lock, bool sync) {
+  if (!writeGroup) {
+    return pendingError;
+  }
+
+  PendingWrite group{std::move(*writeGroup)};
+  writeGroup.reset();
+  group.sync = sync;
+  return enqueueLocked(lock, std::move(group));
+}
+
+std::error_code RocksDBWrapper::enqueueLocked(std::unique_lock<std::shared_mutex>& lock, PendingWrite write) {
+  if (pendingQueue.size() + inFlightWrites >= WRITE_BEHIND_WINDOW) {
+    // waiting for a complete drain instead of a free slot lets the writer release the pending index regularly
+    const auto start = std::chrono::steady_clock::now();
+    if (const auto ec = drainLocked(lock)) {
+      return ec;
+    }
+    logger(Debugging) << "Write behind window full, writer waited "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                               start)
+                             .count()
+                      << "ms for the database.";
+  }
+  if (pendingError) {
+    return pendingError;
+  }
+
+  const bool sync = write.sync;
+  pendingQueue.emplace_back(std::move(write));
+  pendingChanged.notify_all();
+  return sync ? drainLocked(lock) : std::error_code{};
+}
+
+std::error_code RocksDBWrapper::drainLocked(std::unique_lock<std::shared_mutex>& lock) {
+  pendingChanged.wait(lock, [this]() { return isDrainedLocked() || pendingError; });
+  return pendingError;
+}
+
+bool RocksDBWrapper::isDrainedLocked() const {
+  return pendingQueue.empty() && inFlightWrites == 0;
+}
+
+void RocksDBWrapper::resetPendingIndexLocked() {
+  if (!writeGroup) {
+    pendingIndex.reset();
+    return;
+  }
+
+  // everything but the open group is persisted, back to back groups would grow the index without bounds otherwise
+  pendingIndex = std::make_unique<rocksdb::WriteBatchWithIndex>(rocksdb::BytewiseComparator(), 0, true);
+  stage(*pendingIndex, *writeGroup);
+}
+
+void RocksDBWrapper::stage(rocksdb::WriteBatchBase& batch, const PendingWrite& write) const {
+  for (const auto& change : write.changes) {
+    const auto family = getColumnFamilyHandle(change.first);
+    if (change.second) {
+      batch.Put(family, rocksdb::Slice(change.first), rocksdb::Slice(*change.second));
+    } else {
+      batch.Delete(family, rocksdb::Slice(change.first));
+    }
+  }
+}
+
+rocksdb::Status RocksDBWrapper::persist(const rocksdb::WriteOptions& options, rocksdb::WriteBatch& batch) {
+  return db->Write(options, &batch);
+}
+
+void RocksDBWrapper::runWriteBehind() {
+  std::unique_lock<std::shared_mutex> lock{pendingAccess};
+  while (true) {
+    pendingChanged.wait(lock, [this]() { return isWriterStopping || !pendingQueue.empty(); });
+    if (pendingQueue.empty()) {
+      return;
+    }
+
+    // group commit, everything queued while the previous write was running is persisted at once
+    std::vector<PendingWrite> group{std::make_move_iterator(pendingQueue.begin()),
+                                    std::make_move_iterator(pendingQueue.end())};
+    pendingQueue.clear();
+    inFlightWrites = group.size();
+    lock.unlock();
+
+    rocksdb::WriteOptions writeOptions;
+    rocksdb::WriteBatch rocksdbBatch;
+    for (const auto& write : group) {
+      writeOptions.sync = writeOptions.sync || write.sync;
+      stage(rocksdbBatch, write);
+    }
+    const rocksdb::Status status = persist(writeOptions, rocksdbBatch);
+
+    lock.lock();
+    inFlightWrites = 0;
+    if (!status.ok()) {
+      logger(Error) << "Can't write to DB. " << status.ToString();
+      // later writes depend on the failed one, they stay readable from the pending index but are never persisted
+      pendingError = make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+      pendingQueue.clear();
+    } else if (isDrainedLocked()) {
+      resetPendingIndexLocked();
+    }
+    pendingChanged.notify_all();
   }
 }
 
@@ -151,23 +331,31 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
 
   rocksdb::ReadOptions readOptions;
 
-  std::vector<std::string> rawKeys(batch.getRawKeys());
-  std::vector<rocksdb::Slice> keySlices;
-  keySlices.reserve(rawKeys.size());
-  for (const std::string& key : rawKeys) {
-    keySlices.emplace_back(rocksdb::Slice(key));
-  }
-
-  std::vector<std::string> values;
-  values.reserve(rawKeys.size());
-  std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
+  const std::vector<std::string> rawKeys(batch.getRawKeys());
 
-  std::error_code error;
+  // Values stay pinned in the block cache (or memtable) until the batch has deserialized them, no intermediate string
+  // copy of the blobs is made.
+  std::vector<rocksdb::PinnableSlice> pinnedValues(rawKeys.size());
+  std::vector<Xi::ConstByteSpan> values;
   std::vector<bool> resultStates;
-  for (const rocksdb::Status& status : statuses) {
+  values.reserve(rawKeys.size());
+  resultStates.reserve(rawKeys.size());
+  std::shared_lock<std::shared_mutex> lock{pendingAccess};
+  for (size_t i = 0; i < rawKeys.size(); ++i) {
+    const auto& key = rawKeys[i];
+    auto& value = pinnedValues[i];
+    const auto family = getColumnFamilyHandle(key);
+    const auto status = pendingIndex ? pendingIndex->GetFromBatchAndDB(db.get(), readOptions, family,
+                                                                       rocksdb::Slice{key}, &value)
+                                     : db->Get(readOptions, family, rocksdb::Slice{key}, &value);
     if (!status.ok() && !status.IsNotFound()) {
       return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
     }
+    if (status.ok()) {
+      values.emplace_back(reinterpret_cast<const Xi::Byte*>(value.data()), value.size());
+    } else {
+      values.emplace_back();
+    }
     resultStates.push_back(status.ok());
   }
 
@@ -175,12 +363,104 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
   return std::error_code();
 }
 
-rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
+std::error_code RocksDBWrapper::iterate(const std::string& begin, const std::string& end,
+                                        const RangeVisitor& visitor) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  const rocksdb::Slice upperBound{end};
+  rocksdb::ReadOptions readOptions;
+  readOptions.iterate_upper_bound = &upperBound;
+  // Ranges may span several output amounts, the prefix extractor must not restrict the seek.
+  readOptions.total_order_seek = true;
+
+  std::shared_lock<std::shared_mutex> lock{pendingAccess};
+  const auto family = getColumnFamilyHandle(begin);
+  std::unique_ptr<rocksdb::Iterator> iterator{db->NewIterator(readOptions, family)};
+  if (pendingIndex) {
+    iterator.reset(pendingIndex->NewIteratorWithBase(family, iterator.release()));
+  }
+  for (iterator->Seek(rocksdb::Slice(begin)); iterator->Valid(); iterator->Next()) {
+    const auto key = iterator->key();
+    // the upper bound only applies to the database, pending entries are bounded here
+    if (pendingIndex && key.compare(upperBound) >= 0) {
+      break;
+    }
+    const auto value = iterator->value();
+    if (!visitor(Xi::asConstByteSpan(key.data(), key.size()), Xi::asConstByteSpan(value.data(), value.size()))) {
+      break;
+    }
+  }
+
+  if (!iterator->status().ok()) {
+    logger(Error) << "Can't iterate DB. " << iterator->status().ToString();
+    return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+  } else {
+    return std::error_code();
+  }
+}
+
+RocksDBWrapper::ColumnFamily RocksDBWrapper::getColumnFamily(const std::string& key) {
+  static const std::array<ColumnFamily, 256> families = []() {
+    std::array<ColumnFamily, 256> reval{};
+    reval.fill(DEFAULT);
+    const auto assign = [&reval](const DB::KeyPrefix& prefix, ColumnFamily family) {
+      reval[prefix.Prefix[0]] = family;
+    };
+
+    assign(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, BLOCKS);
+    assign(DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, BLOCKS);
+    assign(DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, BLOCKS);
+    assign(DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, BLOCKS);
+    assign(DB::LAST_BLOCK_INDEX_KEY, BLOCKS);
+
+    assign(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, RAW_BLOCKS);
+
+    assign(DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, TRANSACTIONS);
+    assign(DB::BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX, TRANSACTIONS);
+    assign(DB::TRANSACTIONS_COUNT_KEY, TRANSACTIONS);
+
+    assign(DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, KEY_IMAGES);
+    assign(DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX, KEY_IMAGES);
+
+    assign(DB::KEY_OUTPUT_AMOUNT_PREFIX, KEY_OUTPUTS);
+    assign(DB::KEY_OUTPUT_AMOUNT_COUNT_PREFIX, KEY_OUTPUTS);
+    assign(DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, KEY_OUTPUTS);
+    assign(DB::KEY_OUTPUT_AMOUNTS_COUNT_KEY, KEY_OUTPUTS);
+    assign(DB::KEY_OUTPUT_KEY_PREFIX, KEY_OUTPUTS);
+
+    assign(DB::PAYMENT_ID_TO_TX_HASH_PREFIX, PAYMENT_IDS);
+
+    assign(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, TIMESTAMPS);
+    assign(DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX, TIMESTAMPS);
+    return reval;
+  }();
+
+  // Table keys always start with the prefix byte followed by 0xFF, anything else is unprefixed meta data.
+  if (key.size() < 2 || static_cast<uint8_t>(key[1]) != 0xFF) {
+    return DEFAULT;
+  }
+  return families[static_cast<uint8_t>(key[0])];
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBWrapper::getColumnFamilyHandle(const std::string& key) const {
+  return columnFamilies[getColumnFamily(key)];
+}
+
+rocksdb::DBOptions RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
   rocksdb::DBOptions dbOptions;
   dbOptions.IncreaseParallelism(config.getBackgroundThreadsCount());
   dbOptions.info_log_level = rocksdb::InfoLogLevel::WARN_LEVEL;
   dbOptions.max_open_files = config.getMaxOpenFiles();
+  dbOptions.create_missing_column_families = true;
+  // writes are persisted behind the chain state, a crash may cut the log tail but must never leave a partial batch
+  dbOptions.wal_recovery_mode = rocksdb::WALRecoveryMode::kPointInTimeRecovery;
+  return dbOptions;
+}
 
+rocksdb::ColumnFamilyOptions RocksDBWrapper::getColumnFamilyOptions(const DataBaseConfig& config, ColumnFamily family,
+                                                                    std::shared_ptr<rocksdb::Cache> blockCache) {
   rocksdb::ColumnFamilyOptions fOptions;
   fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
   // merge two memtables when flushing to L0
@@ -221,11 +501,61 @@ rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
   }
 
   rocksdb::BlockBasedTableOptions tableOptions;
-  tableOptions.block_cache = rocksdb::NewLRUCache(config.getReadCacheSize());
+  tableOptions.block_cache = blockCache;
+  switch (family) {
+    case BLOCKS:
+    case TRANSACTIONS:
+    case PAYMENT_IDS:
+      tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+      break;
+
+    case RAW_BLOCKS:
+      // raw blocks are large values only read by index, larger blocks keep the index small and compress better
+      tableOptions.block_size = 64 * 1024;
+      break;
+
+    case KEY_IMAGES:
+      // most key image lookups are double spending checks of unspent keys, the filter answers them without a disk read
+      tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+      break;
+
+    case KEY_OUTPUTS:
+      // outputs are keyed by table prefix and amount first, lookups and scans mostly stay within one amount
+      fOptions.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(2 + sizeof(uint64_t)));
+      fOptions.memtable_prefix_bloom_size_ratio = 0.1;
+      tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+      break;
+
+    default:
+      break;
+  }
   std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
   fOptions.table_factory = tfp;
 
-  return rocksdb::Options(dbOptions, fOptions);
+  return fOptions;
+}
+
+std::vector<rocksdb::ColumnFamilyDescriptor> RocksDBWrapper::getColumnFamilyDescriptors(
+    const DataBaseConfig& config) {
+  static const std::array<const char*, COLUMN_FAMILIES_COUNT> names{{
+      rocksdb::kDefaultColumnFamilyName.c_str(),
+      "blocks",
+      "raw_blocks",
+      "transactions",
+      "key_images",
+      "key_outputs",
+      "payment_ids",
+      "timestamps",
+  }};
+
+  // All tables share one read cache, such that its budget goes to the tables read the most.
+  std::shared_ptr<rocksdb::Cache> blockCache = rocksdb::NewLRUCache(config.getReadCacheSize());
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  descriptors.reserve(COLUMN_FAMILIES_COUNT);
+  for (size_t i = 0; i < COLUMN_FAMILIES_COUNT; ++i) {
+    descriptors.emplace_back(names[i], getColumnFamilyOptions(config, static_cast<ColumnFamily>(i), blockCache));
+  }
+  return descriptors;
 }
 
 std::string RocksDBWrapper::getDataDir(const DataBaseConfig& config) {
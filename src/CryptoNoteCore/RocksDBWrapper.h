@@ -18,10 +18,19 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "rocksdb/db.h"
+#include "rocksdb/write_batch_base.h"
+#include "rocksdb/utilities/write_batch_with_index.h"
 
 #include "IDataBase.h"
 #include "DataBaseConfig.h"
@@ -48,17 +57,88 @@ class RocksDBWrapper : public IDataBase {
   [[nodiscard]] std::error_code write(IWriteBatch& batch) override;
   [[nodiscard]] std::error_code writeSync(IWriteBatch& batch) override;
   [[nodiscard]] std::error_code read(IReadBatch& batch) override;
+  [[nodiscard]] std::error_code iterate(const std::string& begin, const std::string& end,
+                                        const RangeVisitor& visitor) override;
+  [[nodiscard]] std::error_code beginWriteGroup() override;
+  [[nodiscard]] std::error_code commitWriteGroup() override;
+
+ protected:
+  /*!
+   * \brief persist writes one group committed batch to the database, called by the write behind thread only.
+   *
+   * The database is closed by the base destructor, overrides must shut it down before they are destroyed.
+   */
+  virtual rocksdb::Status persist(const rocksdb::WriteOptions& options, rocksdb::WriteBatch& batch);
 
  private:
+  /*!
+   * \brief The ColumnFamily enum enumerates the tables the database is split into, each tuned for its access pattern.
+   *
+   * Keys are routed to their family by the table prefix they start with (see DBUtils.h), keys without a known prefix
+   * are stored in the default family.
+   */
+  enum ColumnFamily : size_t {
+    DEFAULT,
+    BLOCKS,
+    RAW_BLOCKS,
+    TRANSACTIONS,
+    KEY_IMAGES,
+    KEY_OUTPUTS,
+    PAYMENT_IDS,
+    TIMESTAMPS,
+    COLUMN_FAMILIES_COUNT
+  };
+
+  /// Raw changes of one or more writes in their order, persisted atomically by the write behind stage.
+  struct PendingWrite {
+    std::vector<std::pair<std::string, std::optional<std::string>>> changes;  ///< A missing value removes the key.
+    bool sync = false;
+  };
+
+  /// Maximum number of writes queued for persistence, a full window blocks writers until all of them are persisted.
+  static constexpr size_t WRITE_BEHIND_WINDOW = 32;
+
   std::error_code write(IWriteBatch& batch, bool sync);
+  std::error_code commitWriteGroupLocked(std::unique_lock<std::shared_mutex>& lock, bool sync);
+  std::error_code enqueueLocked(std::unique_lock<std::shared_mutex>& lock, PendingWrite write);
+  std::error_code drainLocked(std::unique_lock<std::shared_mutex>& lock);
+  bool isDrainedLocked() const;
+  void resetPendingIndexLocked();
+  void stage(rocksdb::WriteBatchBase& batch, const PendingWrite& write) const;
+  void runWriteBehind();
+  void close();
+
+  static ColumnFamily getColumnFamily(const std::string& key);
+  rocksdb::ColumnFamilyHandle* getColumnFamilyHandle(const std::string& key) const;
 
-  rocksdb::Options getDBOptions(const DataBaseConfig& config);
+  rocksdb::DBOptions getDBOptions(const DataBaseConfig& config);
+  rocksdb::ColumnFamilyOptions getColumnFamilyOptions(const DataBaseConfig& config, ColumnFamily family,
+                                                      std::shared_ptr<rocksdb::Cache> blockCache);
+  std::vector<rocksdb::ColumnFamilyDescriptor> getColumnFamilyDescriptors(const DataBaseConfig& config);
   std::string getDataDir(const DataBaseConfig& config);
 
   enum State { NOT_INITIALIZED, INITIALIZED };
 
   Logging::LoggerRef logger;
   std::unique_ptr<rocksdb::DB> db;
+  std::vector<rocksdb::ColumnFamilyHandle*> columnFamilies;  ///< indexed by ColumnFamily, owned by db
   std::atomic<State> state;
+
+  /*!
+   * Writes are handed to a background writer and persisted in order, consecutive writes queued meanwhile are committed
+   * as one atomic batch. All changes not yet known to be persisted are indexed in pendingIndex, such that reads and
+   * iterations observe them. Whenever the queue is drained the index is rebuilt from the open write group only, thus
+   * it never holds more than the open group and WRITE_BEHIND_WINDOW queued writes. The size of a group is bounded by
+   * its caller only. All pending state is guarded by pendingAccess.
+   */
+  std::unique_ptr<rocksdb::WriteBatchWithIndex> pendingIndex;
+  std::unique_ptr<PendingWrite> writeGroup;  ///< Open write group, queued as a single write on commit.
+  std::deque<PendingWrite> pendingQueue;
+  size_t inFlightWrites = 0;  ///< Writes taken by the writer thread, not yet persisted.
+  std::error_code pendingError;  ///< First failure of the writer thread, reported by all following writes.
+  bool isWriterStopping = false;
+  std::shared_mutex pendingAccess;
+  std::condition_variable_any pendingChanged;
+  std::thread writer;
 };
 }  // namespace CryptoNote
@@ -42,6 +42,9 @@ class ITransactionPool {
   using transaction_hashes_container_t = std::vector<Crypto::Hash>;
   using TransactionQueryResult = std::shared_ptr<PendingTransactionInfo>;
 
+  /// Visits a pending transaction, returning false stops the iteration.
+  using EligibleTransactionVisitor = std::function<bool(const CachedTransaction&)>;
+
  public:
   virtual ~ITransactionPool() = default;
 
@@ -129,6 +132,14 @@ class ITransactionPool {
    */
   virtual std::vector<CachedTransaction> eligiblePoolTransactions(EligibleIndex index) const = 0;
 
+  /*!
+   * \brief forEachEligibleTransaction visits pool transactions ready to be mined, most profitable first, without
+   * copying them.
+   * \param index The eligble index of the blockchain the visited transactions must be eligible
+   * \param visitor Called for every eligible transaction while the pool is locked, may return false to stop early
+   */
+  virtual void forEachEligibleTransaction(EligibleIndex index, const EligibleTransactionVisitor& visitor) const = 0;
+
   /*!
    * \brief acquireExclusiveAccess locks the transaction pool for exclusive access
    * \return a RAII object holding the log, once destroyed your exclusive access is gone
@@ -26,6 +26,8 @@
 #include <vector>
 #include <cinttypes>
 #include <atomic>
+#include <memory>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -47,6 +49,7 @@
 #include "CryptoNoteCore/Transactions/ITransactionPoolObserver.h"
 #include "CryptoNoteCore/Transactions/ITransactionValidator.h"
 #include "CryptoNoteCore/Transactions/TransactionPriortiyComparator.h"
+#include "CryptoNoteCore/Transactions/TransactionPoolStateHash.h"
 #include "CryptoNoteCore/Transactions/PendingTransactionInfo.h"
 #include "CryptoNoteCore/Transactions/TransactionValidatiorState.h"
 
@@ -92,6 +95,7 @@ class TransactionPool : public ITransactionPool, private IBlockchainObserver {
 
   TransactionQueryResult queryTransaction(const Crypto::Hash& hash) const override;
   std::vector<CachedTransaction> eligiblePoolTransactions(EligibleIndex index) const override;
+  void forEachEligibleTransaction(EligibleIndex index, const EligibleTransactionVisitor& visitor) const override;
   Xi::Concurrent::RecursiveLock::lock_t acquireExclusiveAccess() const override;
   // -------------------------------------- ITransactionPool End -------------------------------------------------------
 
@@ -184,17 +188,6 @@ class TransactionPool : public ITransactionPool, private IBlockchainObserver {
   Xi::Result<void> insertTransaction(CachedTransaction transaction, PosixTimestamp receiveTime,
                                      ITransactionPoolObserver::AdditionReason reason);
 
-  /*!
-   * \brief computeStateHash calculates a hash of all contained transactions
-   * \return A unique hash encoding the state of the pool
-   */
-  Crypto::Hash computeStateHash() const;
-
-  /*!
-   * \brief invalidateStateHash marks the state hash as invalid to enforce recomputation next time queired
-   */
-  void invalidateStateHash();
-
   /*!
    * \brief evaluateBlockVersionUpgradeConstraints reevaluates all transactions that may got invalid due to higher
    * constraints after a version upgrade
@@ -205,7 +198,7 @@ class TransactionPool : public ITransactionPool, private IBlockchainObserver {
   IBlockchain& m_blockchain;                                     ///< The blockchain this pool operates on
   Tools::ObserverManager<ITransactionPoolObserver> m_observers;  ///< observers to notify about pool changes
   Xi::Concurrent::RecursiveLock m_access;                        ///< Mutex fron concurrent read single write access
-  mutable boost::optional<Crypto::Hash> m_stateHash;     ///< Lazy initialized and cached tree hash of all transactions
+  TransactionPoolStateHash m_stateHash;                  ///< Accumulated hash of all transactions contained
   boost::optional<BlockVersion> m_eligibleBlockVersion;  ///< Stores the block version all transactions are elgible for.
   std::atomic<std::size_t> m_cumulativeSize{0};          /// Sum of all transaction blob sizes.
   std::atomic<std::size_t> m_cumulativeFees{0};          /// Sum of all transaction blob sizes.
@@ -221,6 +214,8 @@ class TransactionPool : public ITransactionPool, private IBlockchainObserver {
       m_paymentIds;  ///< transactions using a payment id (PaymentId -> TransactionHash[])
   _hash_map<Amount, Crypto::HashSet>
       m_partiallyMixed;  ///< references not fully mixed transactions (Amount -> TransactionHash)
+  std::set<std::shared_ptr<PendingTransactionInfo>, TransactionPriorityOrder>
+      m_priorityIndex;  ///< all transactions contained, most profitable first
 
   // Deprecated BEGIN
  public:
@@ -100,6 +100,11 @@ std::vector<CachedTransaction> TransactionPoolCleanWrapper::eligiblePoolTransact
   return transactionPool->eligiblePoolTransactions(index);
 }
 
+void TransactionPoolCleanWrapper::forEachEligibleTransaction(EligibleIndex index,
+                                                             const EligibleTransactionVisitor& visitor) const {
+  transactionPool->forEachEligibleTransaction(index, visitor);
+}
+
 Xi::Concurrent::RecursiveLock::lock_t TransactionPoolCleanWrapper::acquireExclusiveAccess() const {
   return transactionPool->acquireExclusiveAccess();
 }
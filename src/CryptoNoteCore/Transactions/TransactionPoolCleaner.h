@@ -53,6 +53,7 @@ class TransactionPoolCleanWrapper : public ITransactionPool {
   [[nodiscard]] bool save(const std::string& dataDir) override;
   TransactionQueryResult queryTransaction(const Crypto::Hash& hash) const override;
   std::vector<CachedTransaction> eligiblePoolTransactions(EligibleIndex index) const override;
+  void forEachEligibleTransaction(EligibleIndex index, const EligibleTransactionVisitor& visitor) const override;
   Xi::Concurrent::RecursiveLock::lock_t acquireExclusiveAccess() const override;
 
   CachedTransaction getTransaction(const Crypto::Hash& hash) const override;
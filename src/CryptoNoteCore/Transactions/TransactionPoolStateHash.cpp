@@ -0,0 +1,57 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include "CryptoNoteCore/Transactions/TransactionPoolStateHash.h"
+
+#include <algorithm>
+
+#include <Xi/Byte.hh>
+
+CryptoNote::TransactionPoolStateHash::TransactionPoolStateHash() {
+  clear();
+}
+
+void CryptoNote::TransactionPoolStateHash::toggle(const Crypto::Hash &transactionHash) {
+  const auto digest = Crypto::Hash::compute(transactionHash.span()).takeOrThrow();
+  for (size_t i = 0; i < Crypto::Hash::bytes(); ++i) {
+    m_accumulator[i] ^= digest[i];
+  }
+}
+
+Crypto::Hash CryptoNote::TransactionPoolStateHash::compute(uint64_t count) const {
+  if (count == 0) {
+    return Crypto::Hash::Null;
+  }
+  // The pool size is mixed in so the final hash does not expose the accumulator itself.
+  Xi::ByteArray<Crypto::Hash::bytes() + sizeof(uint64_t)> state{};
+  std::copy(m_accumulator.begin(), m_accumulator.end(), state.begin());
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    state[Crypto::Hash::bytes() + i] = static_cast<Xi::Byte>((count >> (8 * i)) & 0xFF);
+  }
+  return Crypto::Hash::compute(Xi::asConstByteSpan(state.data(), state.size())).takeOrThrow();
+}
+
+void CryptoNote::TransactionPoolStateHash::clear() {
+  m_accumulator.nullify();
+}
@@ -0,0 +1,66 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <cinttypes>
+
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/*!
+ * \brief The TransactionPoolStateHash class accumulates a hash over a set of transactions.
+ *
+ * The accumulator is the XOR of the fast hashes of all transaction hashes contained, thus adding and removing are
+ * the same operation, the result does not depend on the insertion order and computing the state hash never requires
+ * a pass over all transactions.
+ */
+class TransactionPoolStateHash {
+ public:
+  TransactionPoolStateHash();
+
+  /*!
+   * \brief toggle adds or removes a transaction from the accumulator
+   * \param transactionHash The hash of the transaction inserted or removed
+   */
+  void toggle(const Crypto::Hash& transactionHash);
+
+  /*!
+   * \brief compute finalizes the accumulator for a set of transactions
+   * \param count The number of transactions toggled in
+   * \return Null if the set is empty, otherwise the hash of the accumulator and the number of transactions
+   */
+  Crypto::Hash compute(uint64_t count) const;
+
+  /*!
+   * \brief clear resets the accumulator to the empty set
+   */
+  void clear();
+
+ private:
+  Crypto::Hash m_accumulator;
+};
+
+}  // namespace CryptoNote
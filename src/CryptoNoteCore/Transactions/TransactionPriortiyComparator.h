@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <memory>
+
 namespace CryptoNote {
 class PendingTransactionInfo;
 
@@ -36,4 +38,13 @@ struct TransactionPriorityComparator {
    */
   bool operator()(const PendingTransactionInfo& lhs, const PendingTransactionInfo& rhs) const;
 };
+
+/*!
+ * \brief The TransactionPriorityOrder struct orders pending transactions by TransactionPriorityComparator and breaks
+ * ties by their hash, such that distinct transactions never compare equal.
+ */
+struct TransactionPriorityOrder {
+  bool operator()(const std::shared_ptr<PendingTransactionInfo>& lhs,
+                  const std::shared_ptr<PendingTransactionInfo>& rhs) const;
+};
 }  // namespace CryptoNote
@@ -219,9 +219,8 @@ std::error_code CryptoNote::preValidateTransfer(const CryptoNote::CachedTransact
 
 std::error_code CryptoNote::postValidateTransfer(const CryptoNote::CachedTransaction &transaction,
                                                  const CryptoNote::TransferValidationContext &context,
-                                                 TransferValidationCache &cache, const TransferValidationInfo &info) {
-  XI_UNUSED(context);
-
+                                                 TransferValidationCache &cache, const TransferValidationInfo &info,
+                                                 const Crypto::RingSignatureVerifier *verifier) {
   const auto &tx = transaction.getTransaction();
   assert(tx.signatures.has_value());
   assert(std::holds_alternative<TransactionSignatureCollection>(*tx.signatures));
@@ -262,15 +261,38 @@ std::error_code CryptoNote::postValidateTransfer(const CryptoNote::CachedTransac
       publicKeysReferenced.emplace_back(std::addressof(referencedPublicKeySearch->second.publicKey));
     }
 
-    XI_RETURN_EC_IF_NOT(
-        Crypto::check_ring_signature(transaction.getTransactionPrefixHash(), keyInput.keyImage,
-                                     publicKeysReferenced.data(), publicKeysReferenced.size(), inputSignatures.data()),
-        Error::INPUT_INVALID_SIGNATURES);
+    if (context.skipSignatures) {
+      continue;
+    } else if (verifier != nullptr) {
+      XI_RETURN_EC_IF_NOT(verifier->checkRingSignature(transaction.getTransactionPrefixHash(), keyInput.keyImage,
+                                                       publicKeysReferenced.data(), publicKeysReferenced.size(),
+                                                       inputSignatures.data()),
+                          Error::INPUT_INVALID_SIGNATURES);
+    } else {
+      XI_RETURN_EC_IF_NOT(
+          Crypto::check_ring_signature(transaction.getTransactionPrefixHash(), keyInput.keyImage,
+                                       publicKeysReferenced.data(), publicKeysReferenced.size(), inputSignatures.data()),
+          Error::INPUT_INVALID_SIGNATURES);
+    }
   }
 
   return Error::VALIDATION_SUCCESS;
 }
 
+void CryptoNote::registerRingSignatureKeys(const CryptoNote::TransferValidationInfo &info,
+                                           Crypto::RingSignatureVerifier &verifier) {
+  size_t count = 0;
+  for (const auto &amountOutputs : info.outputs) {
+    count += amountOutputs.second.size();
+  }
+  verifier.reserve(count);
+  for (const auto &amountOutputs : info.outputs) {
+    for (const auto &output : amountOutputs.second) {
+      verifier.addKey(output.second.publicKey);
+    }
+  }
+}
+
 std::error_code CryptoNote::makeTransferValidationInfo(const IBlockchainCache &segment,
                                                        const TransferValidationContext &context,
                                                        const std::unordered_map<Amount, GlobalOutputIndexSet> &refs,
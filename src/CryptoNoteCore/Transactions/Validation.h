@@ -25,6 +25,8 @@
 
 #include <unordered_map>
 
+#include <crypto/crypto.h>
+
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/IBlockchainCache.h"
 #include "CryptoNoteCore/Transactions/Transaction.h"
@@ -46,6 +48,8 @@ struct TransferValidationContext {
   uint32_t previousBlockIndex = 0;
   uint64_t timestamp = 0;
   bool inCheckpointRange = false;
+  /// Trusted checkpoint import, ring signatures are not verified. Mixins and references are still checked.
+  bool skipSignatures = false;
 
   uint8_t minimumMixin = 0;
   uint8_t maximumMixin = 0;
@@ -84,9 +88,15 @@ struct TransferValidationInfo {
                                                   const TransferValidationContext& context,
                                                   TransferValidationCache& cache, TransferValidationState& out);
 
+/// Validates the referenced outputs and ring signatures, if a verifier is provided signatures are checked using its
+/// shared key tables. Signatures are skipped entirely if the context requests a trusted import.
 [[nodiscard]] std::error_code postValidateTransfer(const CachedTransaction& transaction,
                                                    const TransferValidationContext& context,
-                                                   TransferValidationCache& cache, const TransferValidationInfo& info);
+                                                   TransferValidationCache& cache, const TransferValidationInfo& info,
+                                                   const Crypto::RingSignatureVerifier* verifier = nullptr);
+
+/// Registers every output key referenced by the validation info, tables of the keys still need to be prepared.
+void registerRingSignatureKeys(const TransferValidationInfo& info, Crypto::RingSignatureVerifier& verifier);
 
 [[nodiscard]] std::error_code makeTransferValidationInfo(const IBlockchainCache& segment,
                                                          const TransferValidationContext& context,
@@ -447,10 +447,7 @@ int CryptoNoteProtocolHandler::handle_request_get_objects(int command, NOTIFY_RE
   }
 
   rsp.current_blockchain_height = BlockHeight::fromIndex(m_core.getTopBlockIndex());
-  std::vector<RawBlock> rawBlocks;
-  m_core.getBlocks(arg.blocks, rawBlocks, rsp.missed_ids, Xi::Config::Network::blocksP2pSynchronizationMaxBlobSize());
-
-  rsp.blocks = std::move(rawBlocks);
+  m_core.getBlocks(arg.blocks, rsp.blocks, rsp.missed_ids, Xi::Config::Network::blocksP2pSynchronizationMaxBlobSize());
 
   m_logger(Logging::Trace) << context << "-->>NOTIFY_RESPONSE_GET_OBJECTS: blocks.size()=" << rsp.blocks.size()
                            << ", txs.size()=" << rsp.transactions.size()
@@ -565,12 +562,13 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& context, std::vector<RawBlock>&& rawBlocks,
                                               const std::vector<CachedBlock>& cachedBlocks) {
   assert(rawBlocks.size() == cachedBlocks.size());
-  for (size_t index = 0; index < rawBlocks.size(); ++index) {
-    if (m_stop) {
-      break;
-    }
+  if (m_stop) {
+    return 0;
+  }
 
-    auto addResult = m_core.addBlock(cachedBlocks[index], std::move(rawBlocks[index]));
+  int result = 0;
+  m_core.addBlocks(cachedBlocks, std::move(rawBlocks), [&](size_t index, const std::error_code& addResult) {
+    XI_UNUSED(index);
     if (addResult == error::AddBlockErrorCondition::BLOCK_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::TRANSACTION_VALIDATION_FAILED ||
         addResult == error::AddBlockErrorCondition::DESERIALIZATION_FAILED) {
@@ -578,25 +576,29 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
                                    << "Block verification failed, dropping connection: " << addResult.message();
       reportFailureIfSynced(context, P2pPenalty::BlockValidationFailure);
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
-      return 1;
+      result = 1;
+      return false;
     } else if (addResult == error::AddBlockErrorCondition::BLOCK_REJECTED) {
       m_logger(Logging::Info) << context << "Block received at sync phase was marked as orphaned, dropping connection: "
                               << addResult.message();
       reportFailureIfSynced(context, P2pPenalty::BlockValidationFailure);
-      return 1;
+      result = 1;
+      return false;
     } else if (addResult == error::AddBlockErrorCode::ALREADY_EXISTS) {
       m_logger(Logging::Debugging) << context
                                    << "Block already exists, switching to idle state: " << addResult.message();
       context.m_state = CryptoNoteConnectionContext::state_idle;
       context.m_needed_objects.clear();
       context.m_requested_objects.clear();
-      return 1;
+      result = 1;
+      return false;
     }
 
     m_dispatcher.yield();
-  }
+    return !m_stop;
+  });
 
-  return 0;
+  return result;
 }
 
 int CryptoNoteProtocolHandler::doPushLiteBlock(CryptoNoteConnectionContext& context, uint32_t hops, BlockHeight height,
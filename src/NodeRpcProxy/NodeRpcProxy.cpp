@@ -54,6 +54,10 @@ namespace {
 
 XI_DECLARE_EXCEPTIONAL_CATEGORY(NodeRpcProxy)
 XI_DECLARE_EXCEPTIONAL_INSTANCE(Unauthorized, "invocation failed due to authorization failure", NodeRpcProxy)
+XI_DECLARE_EXCEPTIONAL_INSTANCE(NodeUnavailable, "node failed to serve the request for now", NodeRpcProxy)
+
+/// Additional attempts of a binary request the node failed with a server error, ie. while its core is busy.
+const size_t BinaryRequestRetries = 2;
 
 std::error_code interpretResponseStatus(const std::string& status) {
   if (CORE_RPC_STATUS_BUSY == status) {
@@ -718,7 +722,7 @@ std::error_code NodeRpcProxy::doGetRandomOutsByAmounts(
   }
 
   m_logger(Trace) << "Send getrandom_outs request";
-  XI_TRY_RPC_COMMAND(jsonCommand("/getrandom_outs", req, rsp));
+  XI_TRY_RPC_COMMAND(binaryCommand("/getrandom_outs", req, rsp));
   outs = std::move(rsp.outs);
   return std::error_code{};
 }
@@ -756,7 +760,7 @@ std::error_code NodeRpcProxy::doGetTransactionOutsGlobalIndices(const Crypto::Ha
   req.transaction_hash = transactionHash;
 
   m_logger(Trace) << "Send get_o_indexes request, transaction " << req.transaction_hash;
-  XI_TRY_RPC_COMMAND(jsonCommand("/get_o_indexes", req, rsp));
+  XI_TRY_RPC_COMMAND(binaryCommand("/get_o_indexes", req, rsp));
   m_logger(Trace) << "get_o_indexes complete";
   outsGlobalIndices.clear();
   for (auto idx : rsp.output_indices) {
@@ -775,7 +779,7 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   req.timestamp = timestamp;
 
   m_logger(Trace) << "Send queryblockslite request, timestamp " << req.timestamp;
-  XI_TRY_RPC_COMMAND(jsonCommand("/queryblockslite", req, rsp));
+  XI_TRY_RPC_COMMAND(binaryCommand("/queryblockslite", req, rsp));
 
   m_logger(Trace) << "queryblockslite complete, startHeight " << rsp.start_height.native() << ", block count "
                   << rsp.blocks.size();
@@ -819,7 +823,7 @@ std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<Crypto::H
   req.known_transaction_hashes = knownPoolTxIds;
 
   m_logger(Trace) << "Send get_pool_changes_lite request, tailBlockId " << req.tail_block_hash;
-  XI_TRY_RPC_COMMAND(jsonCommand("/get_pool_changes_lite", req, rsp));
+  XI_TRY_RPC_COMMAND(binaryCommand("/get_pool_changes_lite", req, rsp));
 
   m_logger(Trace) << "get_pool_changes_lite complete, isTailBlockActual " << rsp.is_current_tail_block;
   isBcActual = rsp.is_current_tail_block;
@@ -950,21 +954,51 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
       std::move(procedure), callback));
 }
 
+namespace {
+/*!
+ * \brief invokeBinaryCommand posts a binary encoded request
+ * \return false if the node does not serve the route with binary bodies
+ *
+ * Nodes not aware of binary bodies either do not know the route, reject the media type or handle the request as json,
+ * answering with a successful but non binary body. Any other failure, like a busy core or a node restricted to block
+ * explorer requests, is answered the same way for json requests and thus not a reason to fall back.
+ */
 template <typename Request, typename Response>
-std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res) {
-  std::error_code ec;
+bool invokeBinaryCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+  using namespace ::Xi::Http;
 
-  try {
-    invokeBinaryCommand(*m_httpClient, url, req, res);
-    ec = interpretResponseStatus(res.status);
-  } catch (const std::exception&) {
-    ec = make_error_code(error::NETWORK_ERROR);
+  std::string body{};
+  if (!storeToBinaryString(req, body)) {
+    throw std::runtime_error("Failed to serialize binary request");
   }
 
-  return ec;
+  const auto response = client.postSync(url, ContentType::Binary, std::move(body));
+  const auto status = response.status();
+  if (status == StatusCode::Unauthorized) {
+    Xi::exceptional<UnauthorizedError>();
+  } else if (status == StatusCode::NotFound || status == StatusCode::UnsupportedMediaType) {
+    return false;
+  } else if (static_cast<int>(status) >= 500) {
+    Xi::exceptional<NodeUnavailableError>("HTTP status: " + Xi::to_string(status));
+  } else if (status != StatusCode::Ok) {
+    throw std::runtime_error("HTTP status: " + Xi::to_string(status));
+  }
+
+  boost::optional<ContentType> contentType{};
+  try {
+    contentType = response.headers().contentType();
+  } catch (...) {
+    return false;
+  }
+  if (!contentType.has_value() || *contentType != ContentType::Binary) {
+    return false;
+  }
+  if (!loadFromBinaryString(res, response.body())) {
+    throw std::runtime_error("Failed to parse binary response");
+  }
+  return true;
 }
 
-namespace {
 template <typename Request, typename Response>
 void invokeJsonCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
   using namespace ::Xi::Http;
@@ -1020,6 +1054,49 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
   return ec;
 }
 
+template <typename Request, typename Response>
+std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res) {
+  if (!m_binaryRpc.load()) {
+    return jsonCommand(url, req, res);
+  }
+
+  std::error_code ec;
+
+  for (size_t attempt = 0;; ++attempt) {
+    try {
+      m_logger(Trace) << "Send " << url << " binary request";
+      if (!invokeBinaryCommand(*m_httpClient, url, req, res)) {
+        m_logger(Info) << "Node does not serve " << url << " binary requests, falling back to JSON.";
+        m_binaryRpc.store(false);
+        return jsonCommand(url, req, res);
+      }
+      ec = interpretResponseStatus(res.status);
+    } catch (const UnauthorizedError& e) {
+      m_logger(Error) << "Rpc authorization failed: " << e.what();
+      ec = make_error_code(error::NOT_AUTHORIZED);
+    } catch (const NodeUnavailableError& e) {
+      if (attempt < BinaryRequestRetries) {
+        m_logger(Debugging) << url << " binary request failed, retrying: " << e.what();
+        continue;
+      }
+      m_logger(Error) << url << " binary request failed: " << e.what();
+      ec = make_error_code(error::NODE_BUSY);
+    } catch (const std::exception& e) {
+      m_logger(Error) << url << " binary request failed: " << e.what();
+      ec = make_error_code(error::NETWORK_ERROR);
+    }
+    break;
+  }
+
+  if (ec) {
+    m_logger(Trace) << url << " binary request failed: " << ec << ", " << ec.message();
+  } else {
+    m_logger(Trace) << url << " binary request compete";
+  }
+
+  return ec;
+}
+
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Request& req, Response& res) {
   using namespace ::Xi::Http;
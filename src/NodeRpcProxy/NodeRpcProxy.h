@@ -197,6 +197,8 @@ class NodeRpcProxy : public CryptoNote::INode {
   // Internal state
   bool m_stop = false;
   std::atomic_bool m_pollUpdates{true};
+  /// Cleared once the node turned out not to serve binary requests, requests fall back to JSON then.
+  std::atomic_bool m_binaryRpc{true};
   std::atomic<size_t> m_peerCount;
   std::atomic<BlockHeight> m_networkHeight;
   std::atomic<BlockVersion::value_type> m_networkVersion;
@@ -59,15 +59,7 @@ void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool n
   head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
   head.m_flags = LEVIN_PACKET_REQUEST;
 
-  // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  writeStrict(&head, sizeof(head), out);
 }
 
 bool LevinProtocol::readCommand(Command& cmd) {
@@ -112,20 +104,24 @@ void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t
   head.m_flags = LEVIN_PACKET_RESPONSE;
   head.m_return_code = returnCode;
 
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  writeStrict(&head, sizeof(head), out);
 }
 
-void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
-  size_t offset = 0;
-  while (offset < size) {
-    offset += m_conn.write(ptr + offset, size - offset);
+void LevinProtocol::writeStrict(const void* head, size_t headSize, const BinaryArray& body) {
+  // header and body go out in one gather write, a short write continues inside whichever buffer it ended
+  System::TcpConnection::Buffer buffers[] = {{static_cast<const uint8_t*>(head), headSize}, {body.data(), body.size()}};
+  size_t first = 0;
+  const size_t count = body.empty() ? 1 : 2;
+  while (first < count) {
+    size_t written = m_conn.write(buffers + first, count - first);
+    while (first < count && written >= buffers[first].size) {
+      written -= buffers[first].size;
+      ++first;
+    }
+    if (first < count) {
+      buffers[first].data += written;
+      buffers[first].size -= written;
+    }
   }
 }
 
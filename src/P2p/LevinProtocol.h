@@ -105,7 +105,8 @@ class LevinProtocol {
 
  private:
   bool readStrict(uint8_t* ptr, size_t size);
-  void writeStrict(const uint8_t* ptr, size_t size);
+  /// Writes the header followed by the body without joining them into one buffer first.
+  void writeStrict(const void* head, size_t headSize, const BinaryArray& body);
   System::TcpConnection& m_conn;
 };
 
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <fstream>
 #include <cinttypes>
+#include <map>
 #include <thread>
 #include <future>
 
@@ -144,7 +145,7 @@ bool P2pConnectionContext::pushMessage(P2pMessage&& msg) {
 }
 
 std::vector<P2pMessage> P2pConnectionContext::popBuffer() {
-  writeOperationStartTime = TimePoint();
+  writeOperationStartTime.store(TimePoint(), std::memory_order_relaxed);
 
   while (writeQueue.empty() && !stopped) {
     queueEvent.wait();
@@ -153,23 +154,39 @@ std::vector<P2pMessage> P2pConnectionContext::popBuffer() {
   std::vector<P2pMessage> msgs(std::move(writeQueue));
   writeQueue.clear();
   writeQueueSize = 0;
-  writeOperationStartTime = Clock::now();
+  writeOperationStartTime.store(Clock::now(), std::memory_order_relaxed);
   queueEvent.clear();
   return msgs;
 }
 
 uint64_t P2pConnectionContext::writeDuration(TimePoint now) const {  // in milliseconds
-  return writeOperationStartTime == TimePoint()
-             ? 0
-             : std::chrono::duration_cast<std::chrono::milliseconds>(now - writeOperationStartTime).count();
+  const auto startTime = writeOperationStartTime.load(std::memory_order_relaxed);
+  return startTime == TimePoint() ? 0
+                                  : std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
 }
 
 void P2pConnectionContext::interrupt() {
   logger(Debugging) << *this << "Interrupt connection";
-  assert(context != nullptr);
   stopped = true;
   queueEvent.set();
-  context->interrupt();
+  // the handler may not have been started on its loop yet, it checks the stopped flag first
+  if (context != nullptr) {
+    context->interrupt();
+  }
+}
+
+bool P2pConnectionContext::isStopped() const {
+  return stopped;
+}
+
+void P2pConnectionContext::rebind(System::Dispatcher& newDispatcher) {
+  assert(context == nullptr);
+  connection.rebind(newDispatcher);
+  queueEvent = System::Event(newDispatcher);
+  if (!writeQueue.empty() || stopped) {
+    queueEvent.set();
+  }
+  dispatcher = &newDispatcher;
 }
 
 template <typename Command, typename Handler>
@@ -365,7 +382,9 @@ bool NodeServer::init_config() {
 //-----------------------------------------------------------------------------------
 void NodeServer::for_each_connection(std::function<void(CryptoNoteConnectionContext&, PeerIdType)> f) {
   for (auto& ctx : m_connections) {
-    f(ctx.second, ctx.second.peerId);
+    if (!ctx.second.isReleased) {
+      f(ctx.second, ctx.second.peerId);
+    }
   }
 }
 
@@ -473,6 +492,21 @@ bool NodeServer::init(const NetNodeConfig& config) {
     return false;
   }
 
+  auto ioThreads = config.getIoThreads();
+#if defined(_WIN32)
+  if (ioThreads > 0) {
+    logger(Warning) << "Sockets cannot move between event loops on this platform, serving all peers on the main loop";
+    ioThreads = 0;
+  }
+#endif
+  try {
+    m_ioLoops = std::make_unique<System::DispatcherGroup>(m_dispatcher, ioThreads);
+  } catch (const std::exception& e) {
+    logger(Error) << "Failed to start p2p event loops: " << e.what();
+    return false;
+  }
+  logger(Info) << "Serving peers on " << (ioThreads + 1) << " event loop(s)";
+
   for (auto& p : m_command_line_peers)
     m_peerlist.append_with_peer_white(p);
 
@@ -528,6 +562,11 @@ bool NodeServer::run() {
   safeInterrupt(m_workingContextGroup);
   m_workingContextGroup.wait();
 
+  // no new connections are accepted or made anymore, stop the ones served
+  m_ioLoops->stop();
+  // connections accepted while stopping never had their handler started
+  m_connections.clear();
+
   logger(Info) << "NodeServer loop stopped";
   m_currentState.store(Stopped, std::memory_order_release);
   return true;
@@ -655,15 +694,19 @@ bool NodeServer::handshake(CryptoNote::LevinProtocol& proto, P2pConnectionContex
 bool NodeServer::timedSync() {
   COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
   m_payload_handler.get_payload_sync_data(arg.payload_data);
-  auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+  auto cmdBuf = std::make_shared<const BinaryArray>(LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg));
 
+  std::vector<P2pConnectionContext*> targets;
   forEachConnection([&](P2pConnectionContext& conn) {
     if (conn.peerId && (conn.m_state == CryptoNoteConnectionContext::state_normal ||
                         conn.m_state == CryptoNoteConnectionContext::state_idle)) {
-      conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
+      targets.push_back(&conn);
     }
   });
 
+  postToConnections(targets, [cmdBuf](P2pConnectionContext& conn) {
+    conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
+  });
   return true;
 }
 
@@ -706,12 +749,45 @@ void NodeServer::forEachConnection(std::function<void(P2pConnectionContext&)> ac
 
   for (const auto& connId : connectionIds) {
     auto it = m_connections.find(connId);
-    if (it != m_connections.end()) {
+    if (it != m_connections.end() && !it->second.isReleased) {
       action(it->second);
     }
   }
 }
 
+void NodeServer::postToConnections(const std::vector<P2pConnectionContext*>& connections,
+                                   std::function<void(P2pConnectionContext&)> action) {
+  std::map<System::Dispatcher*, std::vector<P2pConnectionContext*>> batches;
+  for (auto connection : connections) {
+    if (connection->isReleased) {
+      continue;
+    } else if (connection->dispatcher == &m_dispatcher) {
+      action(*connection);
+    } else {
+      batches[connection->dispatcher].push_back(connection);
+    }
+  }
+  if (batches.empty()) {
+    return;
+  }
+
+  // Released connections are erased only after their loop acknowledged the release. Batches posted before are
+  // executed by that loop first, thus the connections referenced are still alive.
+  auto sharedAction = std::make_shared<std::function<void(P2pConnectionContext&)>>(std::move(action));
+  for (auto& batch : batches) {
+    batch.first->remoteSpawn([sharedAction, iConnections = std::move(batch.second)] {
+      for (auto connection : iConnections) {
+        (*sharedAction)(*connection);
+      }
+    });
+  }
+}
+
+template <typename _ProcedureT>
+auto NodeServer::onControlLoop(System::Dispatcher& current, _ProcedureT&& procedure) -> decltype(procedure()) {
+  return System::DispatcherGroup::invoke(current, m_dispatcher, std::forward<_ProcedureT>(procedure));
+}
+
 //-----------------------------------------------------------------------------------
 bool NodeServer::is_peer_used(const PeerlistEntry& peer) {
   if (m_config.m_peer_id == peer.id)
@@ -820,11 +896,7 @@ bool NodeServer::try_to_connect_and_handshake_with_new_peer(const NetworkAddress
     }
 
     auto iter = m_connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
-    const boost::uuids::uuid& connectionId = iter->first;
-    P2pConnectionContext& connectionContext = iter->second;
-
-    m_workingContextGroup.spawn(
-        std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connectionContext)));
+    serveConnection(iter->first, iter->second);
 
     return true;
   } catch (System::InterruptedException&) {
@@ -1119,24 +1191,33 @@ void NodeServer::relay_notify_to_all(int command, const BinaryArray& data_buff,
                                      const net_connection_id* excludeConnection) {
   net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
 
+  std::vector<P2pConnectionContext*> targets;
   forEachConnection([&](P2pConnectionContext& conn) {
     if (conn.peerId && conn.m_connection_id != excludeId &&
         (conn.m_state == CryptoNoteConnectionContext::state_normal ||
          conn.m_state == CryptoNoteConnectionContext::state_synchronizing)) {
-      conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+      targets.push_back(&conn);
     }
   });
+
+  // the payload is copied once, every write queue only holds a reference to it
+  auto payload = std::make_shared<const BinaryArray>(data_buff);
+  postToConnections(targets, [command, payload](P2pConnectionContext& conn) {
+    conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, payload));
+  });
 }
 
 //-----------------------------------------------------------------------------------
-bool NodeServer::invoke_notify_to_peer(int command, const BinaryArray& buffer,
+bool NodeServer::invoke_notify_to_peer(int command, BinaryArray buffer,
                                        const CryptoNoteConnectionContext& context) {
   auto it = m_connections.find(context.m_connection_id);
-  if (it == m_connections.end()) {
+  if (it == m_connections.end() || it->second.isReleased) {
     return false;
   }
 
-  it->second.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, buffer));
+  postToConnections({&it->second}, [command, iBuffer = std::move(buffer)](P2pConnectionContext& conn) mutable {
+    conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, std::move(iBuffer)));
+  });
 
   return true;
 }
@@ -1418,11 +1499,7 @@ void NodeServer::acceptLoop() {
 
       if (!isBlocked(ctx.m_remote_ip)) {
         auto iter = m_connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
-        const boost::uuids::uuid& connectionId = iter->first;
-        P2pConnectionContext& connection = iter->second;
-
-        m_workingContextGroup.spawn(
-            std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connection)));
+        serveConnection(iter->first, iter->second);
       } else {
         logger(Debugging) << ctx << " tried to connect but is banned.";
       }
@@ -1461,14 +1538,17 @@ void NodeServer::timeoutLoop() {
       m_timeoutTimer.sleep(std::chrono::seconds(10));
       auto now = P2pConnectionContext::Clock::now();
 
+      std::vector<P2pConnectionContext*> timedOut;
       for (auto& kv : m_connections) {
         auto& ctx = kv.second;
-        if (ctx.writeDuration(now) >
-            static_cast<uint64_t>(std::chrono::milliseconds{Xi::Config::P2P::invokeTimeout()}.count())) {
+        if (!ctx.isReleased &&
+            ctx.writeDuration(now) >
+                static_cast<uint64_t>(std::chrono::milliseconds{Xi::Config::P2P::invokeTimeout()}.count())) {
           logger(Debugging) << ctx << "write operation timed out, stopping connection";
-          safeInterrupt(ctx);
+          timedOut.push_back(&ctx);
         }
       }
+      postToConnections(timedOut, [this](P2pConnectionContext& ctx) { safeInterrupt(ctx); });
     }
   } catch (System::InterruptedException&) {
     logger(Debugging) << "timeoutLoop() is interrupted";
@@ -1661,29 +1741,56 @@ void NodeServer::timedSyncLoop() {
   logger(Debugging) << "timedSyncLoop finished";
 }
 
+void NodeServer::serveConnection(const boost::uuids::uuid& connectionId, P2pConnectionContext& connection) {
+  try {
+    connection.rebind(m_ioLoops->next());
+  } catch (...) {
+    const auto id = connectionId;
+    m_connections.erase(id);
+    throw;
+  }
+
+  m_ioLoops->spawn(*connection.dispatcher,
+                   std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connection)));
+}
+
 void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
+  // Runs on the loop serving the connection. Socket io stays on that loop, everything touching the connection map,
+  // the peerlist or the protocol handler, and therefore the core, is handed off to the control loop.
+  System::Dispatcher& dispatcher = *ctx.dispatcher;
+
   // This inner context is necessary in order to stop connection handler at any moment
-  System::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
-    System::Context<> writeContext(m_dispatcher, std::bind(&NodeServer::writeHandler, this, std::ref(ctx)));
+  System::Context<> context(dispatcher, [this, &dispatcher, &connectionId, &ctx] {
+    System::Context<> writeContext(dispatcher, std::bind(&NodeServer::writeHandler, this, std::ref(ctx)));
 
     try {
-      on_connection_new(ctx);
+      auto state = onControlLoop(dispatcher, [this, &ctx] {
+        on_connection_new(ctx);
+
+        if (is_ip_address_blocked(ctx.m_remote_ip)) {
+          ctx.m_state = CryptoNoteConnectionContext::state_shutdown;
+          logger(Debugging) << ctx << " tried to connect but is still blocked.";
+        }
+        return ctx.m_state;
+      });
 
       LevinProtocol proto(ctx.connection);
       LevinProtocol::Command cmd;
 
-      if (is_ip_address_blocked(ctx.m_remote_ip)) {
-        ctx.m_state = CryptoNoteConnectionContext::state_shutdown;
-        logger(Debugging) << ctx << " tried to connect but is still blocked.";
-      }
-
-      while (ctx.m_state != CryptoNoteConnectionContext::state_shutdown) {
-        if (ctx.m_state == CryptoNoteConnectionContext::state_sync_required) {
-          ctx.m_state = CryptoNoteConnectionContext::state_synchronizing;
-          m_payload_handler.start_sync(ctx);
-        } else if (ctx.m_state == CryptoNoteConnectionContext::state_pool_sync_required) {
-          ctx.m_state = CryptoNoteConnectionContext::state_normal;
-          m_payload_handler.requestMissingPoolTransactions(ctx);
+      while (state != CryptoNoteConnectionContext::state_shutdown && !ctx.isStopped()) {
+        if (state == CryptoNoteConnectionContext::state_sync_required ||
+            state == CryptoNoteConnectionContext::state_pool_sync_required) {
+          state = onControlLoop(dispatcher, [this, &ctx] {
+            if (ctx.m_state == CryptoNoteConnectionContext::state_sync_required) {
+              ctx.m_state = CryptoNoteConnectionContext::state_synchronizing;
+              m_payload_handler.start_sync(ctx);
+            } else if (ctx.m_state == CryptoNoteConnectionContext::state_pool_sync_required) {
+              ctx.m_state = CryptoNoteConnectionContext::state_normal;
+              m_payload_handler.requestMissingPoolTransactions(ctx);
+            }
+            return ctx.m_state;
+          });
+          continue;
         }
 
         if (!proto.readCommand(cmd)) {
@@ -1692,7 +1799,16 @@ void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pCo
 
         BinaryArray response;
         bool handled = false;
-        auto retcode = handleCommand(cmd, response, ctx, handled);
+        int32_t retcode = 0;
+        state = onControlLoop(dispatcher, [&] {
+          retcode = handleCommand(cmd, response, ctx, handled);
+
+          if (is_ip_address_blocked(ctx.m_remote_ip)) {
+            ctx.m_state = CryptoNoteConnectionContext::state_shutdown;
+            logger(Debugging) << ctx << " was blocked while handling the connection, dropping connection.";
+          }
+          return ctx.m_state;
+        });
 
         // send response
         if (cmd.needReply()) {
@@ -1703,11 +1819,6 @@ void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pCo
 
           ctx.pushMessage(P2pMessage(P2pMessage::REPLY, cmd.command, std::move(response), retcode));
         }
-
-        if (is_ip_address_blocked(ctx.m_remote_ip)) {
-          ctx.m_state = CryptoNoteConnectionContext::state_shutdown;
-          logger(Debugging) << ctx << " was blocked while handling the connection, dropping connection.";
-        }
       }
     } catch (System::InterruptedException&) {
       logger(Debugging) << ctx << "connectionHandler() inner context is interrupted";
@@ -1719,8 +1830,19 @@ void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pCo
     safeInterrupt(writeContext);
     writeContext.wait();
 
-    on_connection_close(ctx);
-    m_connections.erase(connectionId);
+    try {
+      onControlLoop(dispatcher, [this, &ctx] {
+        on_connection_close(ctx);
+        ctx.isReleased = true;
+      });
+      // Work posted to this loop before the release has been executed by now, the connection can be erased safely.
+      onControlLoop(dispatcher, [this, &connectionId] {
+        const auto id = connectionId;
+        m_connections.erase(id);
+      });
+    } catch (std::exception& e) {
+      logger(Warning) << ctx << "Failed to release connection: " << e.what();
+    }
   });
 
   ctx.context = &context;
@@ -1752,13 +1874,13 @@ void NodeServer::writeHandler(P2pConnectionContext& ctx) {
         logger(Debugging) << ctx << "msg " << msg.type << ':' << msg.command;
         switch (msg.type) {
           case P2pMessage::COMMAND:
-            proto.sendMessage(msg.command, msg.buffer, true);
+            proto.sendMessage(msg.command, *msg.buffer, true);
             break;
           case P2pMessage::NOTIFY:
-            proto.sendMessage(msg.command, msg.buffer, false);
+            proto.sendMessage(msg.command, *msg.buffer, false);
             break;
           case P2pMessage::REPLY:
-            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
+            proto.sendReply(msg.command, *msg.buffer, msg.returnCode);
             break;
           default:
             assert(false);
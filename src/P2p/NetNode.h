@@ -12,12 +12,14 @@
 #include <list>
 #include <atomic>
 #include <future>
+#include <memory>
 
 #include <boost/functional/hash.hpp>
 
 #include <System/Context.h>
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
+#include <System/DispatcherGroup.h>
 #include <System/Event.h>
 #include <System/Timer.h>
 #include <System/TcpConnection.h>
@@ -50,21 +52,27 @@ class ISerializer;
 struct P2pMessage {
   enum Type { COMMAND, REPLY, NOTIFY };
 
-  P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0)
-      : type(type), command(command), buffer(buffer), returnCode(returnCode) {
+  P2pMessage(Type type, uint32_t command, BinaryArray buffer, int32_t returnCode = 0)
+      : type(type), command(command), buffer(std::make_shared<const BinaryArray>(std::move(buffer))),
+        returnCode(returnCode) {
   }
 
-  P2pMessage(P2pMessage&& msg)
+  /// Shares an already serialized payload, relaying the same message to many peers never copies its body.
+  P2pMessage(Type type, uint32_t command, std::shared_ptr<const BinaryArray> buffer, int32_t returnCode = 0)
+      : type(type), command(command), buffer(std::move(buffer)), returnCode(returnCode) {
+  }
+
+  P2pMessage(P2pMessage&& msg) noexcept
       : type(msg.type), command(msg.command), buffer(std::move(msg.buffer)), returnCode(msg.returnCode) {
   }
 
   size_t size() {
-    return buffer.size();
+    return buffer->size();
   }
 
   Type type;
   uint32_t command;
-  const BinaryArray buffer;
+  std::shared_ptr<const BinaryArray> buffer;
   int32_t returnCode;
 };
 
@@ -74,14 +82,19 @@ struct P2pConnectionContext : public CryptoNoteConnectionContext {
   using TimePoint = Clock::time_point;
 
   System::Context<void>* context;
+  System::Dispatcher* dispatcher;  ///< Event loop serving the socket, the write queue and the handler contexts.
   PeerIdType peerId;
   System::TcpConnection connection;
+  bool isReleased;  ///< Closed on the control loop, no further work may be posted to the serving loop.
 
   P2pConnectionContext(System::Dispatcher& dispatcher, Logging::ILogger& log, System::TcpConnection&& conn)
       : context(nullptr),
+        dispatcher(&dispatcher),
         peerId(0),
         connection(std::move(conn)),
+        isReleased(false),
         logger(log, "node_server"),
+        writeOperationStartTime(TimePoint()),
         queueEvent(dispatcher),
         stopped(false) {
   }
@@ -89,9 +102,12 @@ struct P2pConnectionContext : public CryptoNoteConnectionContext {
   P2pConnectionContext(P2pConnectionContext&& ctx)
       : CryptoNoteConnectionContext(std::move(ctx)),
         context(ctx.context),
+        dispatcher(ctx.dispatcher),
         peerId(ctx.peerId),
         connection(std::move(ctx.connection)),
+        isReleased(ctx.isReleased),
         logger(ctx.logger.getLogger(), "node_server"),
+        writeOperationStartTime(TimePoint()),
         queueEvent(std::move(ctx.queueEvent)),
         stopped(std::move(ctx.stopped)) {
   }
@@ -99,12 +115,17 @@ struct P2pConnectionContext : public CryptoNoteConnectionContext {
   bool pushMessage(P2pMessage&& msg);
   std::vector<P2pMessage> popBuffer();
   void interrupt();
+  bool isStopped() const;
 
+  /// Moves the idle connection to another event loop, must happen before its handlers are spawned.
+  void rebind(System::Dispatcher& newDispatcher);
+
+  /// Thread safe, the control loop checks for stalled writes of connections served by other loops.
   uint64_t writeDuration(TimePoint now) const;
 
  private:
   Logging::LoggerRef logger;
-  TimePoint writeOperationStartTime;
+  std::atomic<TimePoint> writeOperationStartTime;
   System::Event queueEvent;
   std::vector<P2pMessage> writeQueue;
   size_t writeQueueSize = 0;
@@ -192,13 +213,26 @@ class NodeServer : public IP2pEndpoint {
   bool handleTimedSyncResponse(const BinaryArray& in, P2pConnectionContext& context);
   void forEachConnection(std::function<void(P2pConnectionContext&)> action);
 
+  /*!
+   * \brief postToConnections Runs an action on the loop serving each connection.
+   *
+   * Connections served by the control loop are handled immediately, others are batched into a single remote spawn
+   * per loop. The action is shared between loops and must not capture state of the control loop by reference.
+   */
+  void postToConnections(const std::vector<P2pConnectionContext*>& connections,
+                         std::function<void(P2pConnectionContext&)> action);
+
+  /// Runs a procedure on the control loop, which owns the connection map, the peerlist and the protocol handler.
+  template <typename _ProcedureT>
+  auto onControlLoop(System::Dispatcher& current, _ProcedureT&& procedure) -> decltype(procedure());
+
   void on_connection_new(P2pConnectionContext& context);
   void on_connection_close(P2pConnectionContext& context);
 
   //----------------- i_p2p_endpoint -------------------------------------------------------------
   virtual void relay_notify_to_all(int command, const BinaryArray& data_buff,
                                    const net_connection_id* excludeConnection) override;
-  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff,
+  virtual bool invoke_notify_to_peer(int command, BinaryArray req_buff,
                                      const CryptoNoteConnectionContext& context) override;
   virtual void for_each_connection(
       std::function<void(CryptoNote::CryptoNoteConnectionContext&, PeerIdType)> f) override;
@@ -245,6 +279,7 @@ class NodeServer : public IP2pEndpoint {
   ConnectionContainer m_connections;
 
   void acceptLoop();
+  void serveConnection(const boost::uuids::uuid& connectionId, P2pConnectionContext& connection);
   void connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& connection);
   void writeHandler(P2pConnectionContext& ctx);
   void onIdle();
@@ -279,6 +314,7 @@ class NodeServer : public IP2pEndpoint {
 
   System::Dispatcher& m_dispatcher;
   System::ContextGroup m_workingContextGroup;
+  std::unique_ptr<System::DispatcherGroup> m_ioLoops;  ///< Shards connections, the control loop is its primary.
   System::Event m_stopEvent;
   System::Timer m_idleTimer;
   System::Timer m_timeoutTimer;
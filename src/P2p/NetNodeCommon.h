@@ -20,7 +20,7 @@ struct IP2pEndpoint {
 
   virtual void relay_notify_to_all(int command, const BinaryArray& data_buff,
                                    const net_connection_id* excludeConnection) = 0;
-  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff,
+  virtual bool invoke_notify_to_peer(int command, BinaryArray req_buff,
                                      const CryptoNote::CryptoNoteConnectionContext& context) = 0;
   virtual uint64_t get_connections_count() = 0;
   virtual void for_each_connection(std::function<void(CryptoNote::CryptoNoteConnectionContext&, PeerIdType)> f) = 0;
@@ -57,7 +57,7 @@ struct p2p_endpoint_stub : public IP2pEndpoint {
                                    const net_connection_id* excludeConnection) override {
     XI_UNUSED(command, data_buff, excludeConnection);
   }
-  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff,
+  virtual bool invoke_notify_to_peer(int command, BinaryArray req_buff,
                                      const CryptoNote::CryptoNoteConnectionContext& context) override {
     XI_UNUSED(command, req_buff, context);
     return true;
@@ -62,6 +62,7 @@ NetNodeConfig::NetNodeConfig() {
   configFolder = Tools::getDefaultDataDirectory();
   m_blockDuration = std::chrono::hours{1};
   m_autoBlock = false;
+  m_ioThreads = 0;
   m_appid = "";
 }
 
@@ -166,6 +167,10 @@ bool NetNodeConfig::getAutoBlock() const {
   return m_autoBlock;
 }
 
+size_t NetNodeConfig::getIoThreads() const {
+  return m_ioThreads;
+}
+
 const std::string& NetNodeConfig::appIdentifier() const {
   return m_appid;
 }
@@ -226,4 +231,8 @@ void NetNodeConfig::setAutoBlock(bool enabled) {
   m_autoBlock = enabled;
 }
 
+void NetNodeConfig::setIoThreads(size_t threads) {
+  m_ioThreads = threads;
+}
+
 }  // namespace CryptoNote
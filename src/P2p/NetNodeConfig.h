@@ -39,6 +39,7 @@ class NetNodeConfig {
   std::string getConfigFolder() const;
   std::chrono::seconds getBlockDuration() const;
   bool getAutoBlock() const;
+  size_t getIoThreads() const;
   const std::string& appIdentifier() const;
   const Xi::Config::Network::Configuration& network() const;
 
@@ -56,6 +57,7 @@ class NetNodeConfig {
   void setConfigFolder(const std::string& folder);
   void setBlockDuration(std::chrono::seconds duration);
   void setAutoBlock(bool enabled);
+  void setIoThreads(size_t threads);
 
  private:
   std::string bindIp;
@@ -71,6 +73,7 @@ class NetNodeConfig {
   std::string p2pStateFilename;
   std::chrono::seconds m_blockDuration;
   bool m_autoBlock;
+  size_t m_ioThreads;
   std::string m_appid;
   Xi::Config::Network::Configuration m_netConfig;
 };
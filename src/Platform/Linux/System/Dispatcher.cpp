@@ -23,7 +23,6 @@
 #include <sys/timerfd.h>
 #include <fcntl.h>
 #include <string.h>
-#include <ucontext.h>
 #include <unistd.h>
 #include "ErrorMessage.h"
 
@@ -33,7 +32,7 @@ namespace {
 
 struct ContextMakingData {
   Dispatcher* dispatcher;
-  void* ucontext;
+  void* context;
 };
 
 class MutextGuard {
@@ -55,7 +54,15 @@ class MutextGuard {
 
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
-const size_t STACK_SIZE = 64 * 1024;
+bool initializeMainContext(void** context, std::string& message) {
+  try {
+    *context = makeMainContext();
+    return true;
+  } catch (const std::exception& e) {
+    message = e.what();
+    return false;
+  }
+}
 
 };  // namespace
 
@@ -65,9 +72,8 @@ Dispatcher::Dispatcher() {
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
+    if (!initializeMainContext(&mainContext.context, message)) {
+      assert(!message.empty());
     } else {
       remoteSpawnEvent = eventfd(0, O_NONBLOCK);
       if (remoteSpawnEvent == -1) {
@@ -106,6 +112,8 @@ Dispatcher::Dispatcher() {
         }
         assert(result == 0);
       }
+
+      destroyMainContext(mainContext.context);
     }
 
     auto result = close(epoll);
@@ -127,13 +135,8 @@ Dispatcher::~Dispatcher() {
   assert(contextGroup.firstWaiter == nullptr);
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
-  while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t*>(firstReusableContext->stackPtr);
-    firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
+  releaseReusableContexts();
+  destroyMainContext(mainContext.context);
 
   while (!timers.empty()) {
     int result = ::close(timers.top());
@@ -154,13 +157,7 @@ Dispatcher::~Dispatcher() {
 }
 
 void Dispatcher::clear() {
-  while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t*>(firstReusableContext->stackPtr);
-    firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
+  releaseReusableContexts();
 
   while (!timers.empty()) {
     int result = ::close(timers.top());
@@ -226,11 +223,9 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    NativeContext* oldContext = currentContext;
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t*>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-    }
+    switchContext(&oldContext->context, context->context);
   }
 }
 
@@ -381,26 +376,21 @@ int Dispatcher::getEpoll() const {
 
 NativeContext& Dispatcher::getReusableContext() {
   if (firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) {  // makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
-    }
-
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
-
-    ContextMakingData makingContextData{this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void (*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
-
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
+    auto& stackPool = ContextStackPool::instance();
+    ContextStack stack = stackPool.acquire();
+    void* newlyCreatedContext = nullptr;
+    try {
+      ContextMakingData makingContextData{this, nullptr};
+      newlyCreatedContext = makeContext(stack, contextProcedureStatic, &makingContextData);
+      makingContextData.context = newlyCreatedContext;
+      switchContext(&currentContext->context, newlyCreatedContext);
+    } catch (...) {
+      stackPool.release(stack);
+      throw;
     }
 
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
-    firstReusableContext->stackPtr = stackPointer;
+    firstReusableContext->stack = stack;
   };
 
   NativeContext* context = firstReusableContext;
@@ -437,18 +427,15 @@ void Dispatcher::pushTimer(int timer) {
   timers.push(timer);
 }
 
-void Dispatcher::contextProcedure(void* ucontext) {
+void Dispatcher::contextProcedure(void* machineContext) {
   assert(firstReusableContext == nullptr);
   NativeContext context;
-  context.ucontext = ucontext;
+  context.context = machineContext;
   context.interrupted = false;
   context.next = nullptr;
   context.inExecutionQueue = false;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-  }
+  switchContext(&context.context, currentContext->context);
 
   for (;;) {
     ++runningContextCount;
@@ -499,7 +486,17 @@ void Dispatcher::contextProcedure(void* ucontext) {
 
 void Dispatcher::contextProcedureStatic(void* context) {
   ContextMakingData* makingContextData = reinterpret_cast<ContextMakingData*>(context);
-  makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+  makingContextData->dispatcher->contextProcedure(makingContextData->context);
+}
+
+void Dispatcher::releaseReusableContexts() {
+  auto& stackPool = ContextStackPool::instance();
+  while (firstReusableContext != nullptr) {
+    // the context lives on its own stack, it must not be touched once the stack is released
+    ContextStack stack = firstReusableContext->stack;
+    firstReusableContext = firstReusableContext->next;
+    stackPool.release(stack);
+  }
 }
 
 }  // namespace System
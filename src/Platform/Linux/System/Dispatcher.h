@@ -25,13 +25,15 @@
 #include <bits/reg.h>
 #endif
 
+#include "FiberContext.h"
+
 namespace System {
 
 struct NativeContextGroup;
 
 struct NativeContext {
-  void* ucontext;
-  void* stackPtr;
+  void* context;  ///< Suspended machine state, see switchContext.
+  ContextStack stack;
   bool interrupted;
   bool inExecutionQueue;
   NativeContext* next;
@@ -112,7 +114,8 @@ class Dispatcher {
   NativeContext* firstReusableContext;
   size_t runningContextCount;
 
-  void contextProcedure(void* ucontext);
+  void contextProcedure(void* context);
+  void releaseReusableContexts();
   static void contextProcedureStatic(void* context);
 };
 
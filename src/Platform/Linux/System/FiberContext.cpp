@@ -0,0 +1,338 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include "FiberContext.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#include <ucontext.h>
+#endif
+
+#include <Xi/Global.hh>
+
+#include "ErrorMessage.h"
+
+namespace System {
+
+namespace {
+size_t pageSize() {
+  static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+size_t roundToPages(size_t size) {
+  return (size + pageSize() - 1) / pageSize() * pageSize();
+}
+}  // namespace
+
+ContextStackPool& ContextStackPool::instance() {
+  static ContextStackPool pool{};
+  return pool;
+}
+
+ContextStackPool::ContextStackPool() : m_stackSize{DEFAULT_STACK_SIZE}, m_capacity{DEFAULT_CAPACITY} {
+}
+
+ContextStackPool::~ContextStackPool() {
+  for (auto& stack : m_stacks) {
+    unmap(stack);
+  }
+}
+
+void ContextStackPool::configure(size_t stackSize, size_t capacity) {
+  std::lock_guard<std::mutex> lock{m_guard};
+  const auto rounded = roundToPages(stackSize);
+  if (rounded != m_stackSize) {
+    // stacks of the former size are released as they are, only pooled ones can be dropped here
+    for (auto& stack : m_stacks) {
+      unmap(stack);
+    }
+    m_stacks.clear();
+    m_stackSize = rounded;
+  }
+  m_capacity = capacity;
+  while (m_stacks.size() > m_capacity) {
+    unmap(m_stacks.back());
+    m_stacks.pop_back();
+  }
+}
+
+size_t ContextStackPool::stackSize() const {
+  std::lock_guard<std::mutex> lock{m_guard};
+  return m_stackSize;
+}
+
+size_t ContextStackPool::capacity() const {
+  std::lock_guard<std::mutex> lock{m_guard};
+  return m_capacity;
+}
+
+size_t ContextStackPool::pooled() const {
+  std::lock_guard<std::mutex> lock{m_guard};
+  return m_stacks.size();
+}
+
+ContextStack ContextStackPool::acquire() {
+  size_t stackSize = 0;
+  {
+    std::lock_guard<std::mutex> lock{m_guard};
+    if (!m_stacks.empty()) {
+      ContextStack reval = m_stacks.back();
+      m_stacks.pop_back();
+      return reval;
+    }
+    stackSize = m_stackSize;
+  }
+
+  ContextStack reval{};
+  reval.mappingSize = stackSize + pageSize();
+  reval.mapping =
+      ::mmap(nullptr, reval.mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (reval.mapping == MAP_FAILED) {
+    throw std::runtime_error("ContextStackPool::acquire, mmap failed, " + lastErrorMessage());
+  }
+  if (::mprotect(reval.mapping, pageSize(), PROT_NONE) == -1) {
+    const auto message = lastErrorMessage();
+    unmap(reval);
+    throw std::runtime_error("ContextStackPool::acquire, mprotect failed, " + message);
+  }
+  return reval;
+}
+
+void ContextStackPool::release(ContextStack stack) {
+  std::lock_guard<std::mutex> lock{m_guard};
+  if (m_stacks.size() < m_capacity && stack.mappingSize == m_stackSize + pageSize()) {
+    m_stacks.push_back(stack);
+  } else {
+    unmap(stack);
+  }
+}
+
+void ContextStackPool::unmap(ContextStack& stack) {
+  if (stack.mapping != nullptr) {
+    auto result = ::munmap(stack.mapping, stack.mappingSize);
+    XI_UNUSED(result);
+    assert(result == 0);
+    stack.mapping = nullptr;
+    stack.mappingSize = 0;
+  }
+}
+
+#if defined(__x86_64__)
+
+// Stack layout of a suspended context, from its saved stack pointer upwards: mxcsr and x87 control word, r15, r14,
+// r13, r12, rbx, rbp and the return address.
+asm(R"(
+.text
+.globl xi_system_switch_context
+.type xi_system_switch_context,@function
+.align 16
+xi_system_switch_context:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $16, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $16, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+.size xi_system_switch_context,.-xi_system_switch_context
+
+.globl xi_system_context_trampoline
+.type xi_system_context_trampoline,@function
+.align 16
+xi_system_context_trampoline:
+  movq %r13, %rdi
+  callq *%r12
+  ud2
+.size xi_system_context_trampoline,.-xi_system_context_trampoline
+.section .note.GNU-stack,"",@progbits
+.text
+)");
+
+extern "C" void xi_system_switch_context(void** from, void* to);
+extern "C" void xi_system_context_trampoline();
+
+void* makeContext(const ContextStack& stack, ContextEntry entry, void* argument) {
+  // the trampoline is entered by ret and calls the entry, which requires a 16 byte aligned stack before the call
+  auto top = reinterpret_cast<uintptr_t>(stack.top()) & ~uintptr_t{15};
+  auto frame = reinterpret_cast<uint64_t*>(top - 24);
+  frame[0] = reinterpret_cast<uint64_t>(&xi_system_context_trampoline);
+  frame[-1] = 0;                                      // rbp
+  frame[-2] = 0;                                      // rbx
+  frame[-3] = reinterpret_cast<uint64_t>(entry);      // r12
+  frame[-4] = reinterpret_cast<uint64_t>(argument);   // r13
+  frame[-5] = 0;                                      // r14
+  frame[-6] = 0;                                      // r15
+  auto control = reinterpret_cast<uint32_t*>(frame - 8);
+  control[0] = 0x1F80;  // default mxcsr
+  control[1] = 0x037F;  // default x87 control word
+  return frame - 8;
+}
+
+void* makeMainContext() {
+  return nullptr;
+}
+
+void destroyMainContext(void*) {
+}
+
+void switchContext(void** from, void* to) {
+  xi_system_switch_context(from, to);
+}
+
+#elif defined(__aarch64__)
+
+// Stack layout of a suspended context, from its saved stack pointer upwards: x19 to x28, x29, x30 and d8 to d15.
+asm(R"(
+.text
+.globl xi_system_switch_context
+.type xi_system_switch_context,%function
+.align 4
+xi_system_switch_context:
+  sub sp, sp, #160
+  stp x19, x20, [sp, #0]
+  stp x21, x22, [sp, #16]
+  stp x23, x24, [sp, #32]
+  stp x25, x26, [sp, #48]
+  stp x27, x28, [sp, #64]
+  stp x29, x30, [sp, #80]
+  stp d8, d9, [sp, #96]
+  stp d10, d11, [sp, #112]
+  stp d12, d13, [sp, #128]
+  stp d14, d15, [sp, #144]
+  mov x9, sp
+  str x9, [x0]
+  mov sp, x1
+  ldp x19, x20, [sp, #0]
+  ldp x21, x22, [sp, #16]
+  ldp x23, x24, [sp, #32]
+  ldp x25, x26, [sp, #48]
+  ldp x27, x28, [sp, #64]
+  ldp x29, x30, [sp, #80]
+  ldp d8, d9, [sp, #96]
+  ldp d10, d11, [sp, #112]
+  ldp d12, d13, [sp, #128]
+  ldp d14, d15, [sp, #144]
+  add sp, sp, #160
+  ret
+.size xi_system_switch_context,.-xi_system_switch_context
+
+.globl xi_system_context_trampoline
+.type xi_system_context_trampoline,%function
+.align 4
+xi_system_context_trampoline:
+  mov x0, x20
+  blr x19
+  brk #0
+.size xi_system_context_trampoline,.-xi_system_context_trampoline
+.section .note.GNU-stack,"",%progbits
+.text
+)");
+
+extern "C" void xi_system_switch_context(void** from, void* to);
+extern "C" void xi_system_context_trampoline();
+
+void* makeContext(const ContextStack& stack, ContextEntry entry, void* argument) {
+  auto top = reinterpret_cast<uintptr_t>(stack.top()) & ~uintptr_t{15};
+  auto frame = reinterpret_cast<uint64_t*>(top - 160);
+  for (size_t i = 0; i < 20; ++i) {
+    frame[i] = 0;
+  }
+  frame[0] = reinterpret_cast<uint64_t>(entry);                          // x19
+  frame[1] = reinterpret_cast<uint64_t>(argument);                       // x20
+  frame[11] = reinterpret_cast<uint64_t>(&xi_system_context_trampoline);  // x30
+  return frame;
+}
+
+void* makeMainContext() {
+  return nullptr;
+}
+
+void destroyMainContext(void*) {
+}
+
+void switchContext(void** from, void* to) {
+  xi_system_switch_context(from, to);
+}
+
+#else
+
+void* makeContext(const ContextStack& stack, ContextEntry entry, void* argument) {
+  // the ucontext is placed at the top of the stack it describes
+  auto top = reinterpret_cast<uintptr_t>(stack.top()) - sizeof(ucontext_t);
+  top &= ~uintptr_t{alignof(ucontext_t) - 1};
+  auto context = new (reinterpret_cast<void*>(top)) ucontext_t;
+  if (getcontext(context) == -1) {  // makecontext precondition
+    throw std::runtime_error("makeContext, getcontext failed, " + lastErrorMessage());
+  }
+  context->uc_stack.ss_sp = static_cast<char*>(stack.mapping) + pageSize();
+  context->uc_stack.ss_size = top - reinterpret_cast<uintptr_t>(context->uc_stack.ss_sp);
+  context->uc_link = nullptr;
+  makecontext(context, (void (*)())entry, 1, argument);
+  return context;
+}
+
+void* makeMainContext() {
+  auto context = new ucontext_t;
+  if (getcontext(context) == -1) {
+    delete context;
+    throw std::runtime_error("makeMainContext, getcontext failed, " + lastErrorMessage());
+  }
+  return context;
+}
+
+void destroyMainContext(void* context) {
+  delete static_cast<ucontext_t*>(context);
+}
+
+void switchContext(void** from, void* to) {
+  if (swapcontext(static_cast<ucontext_t*>(*from), static_cast<ucontext_t*>(to)) == -1) {
+    throw std::runtime_error("switchContext, swapcontext failed, " + lastErrorMessage());
+  }
+}
+
+#endif
+
+}  // namespace System
@@ -0,0 +1,103 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace System {
+
+/*!
+ * \brief The ContextStack struct is a fiber stack mapped with an inaccessible guard page below its usable region.
+ */
+struct ContextStack {
+  void* mapping = nullptr;  ///< Start of the mapping, the guard page.
+  size_t mappingSize = 0;
+
+  /// Highest address of the usable region, stacks grow downwards.
+  void* top() const {
+    return static_cast<char*>(mapping) + mappingSize;
+  }
+};
+
+/*!
+ * \brief The ContextStackPool class hands out fiber stacks and keeps released ones for reuse.
+ *
+ * Stacks are mapped on demand. Up to capacity released stacks stay mapped for the next context created by any
+ * dispatcher of the process, further ones are unmapped.
+ */
+class ContextStackPool {
+ public:
+  static const size_t DEFAULT_STACK_SIZE = 64 * 1024;
+  static const size_t DEFAULT_CAPACITY = 256;
+
+  static ContextStackPool& instance();
+
+ public:
+  ContextStackPool();
+  ContextStackPool(const ContextStackPool&) = delete;
+  ContextStackPool& operator=(const ContextStackPool&) = delete;
+  ~ContextStackPool();
+
+  /// Usable size of stacks acquired afterwards, rounded up to whole pages, and the number of stacks kept for reuse.
+  void configure(size_t stackSize, size_t capacity);
+  size_t stackSize() const;
+  size_t capacity() const;
+  size_t pooled() const;
+
+  ContextStack acquire();
+  void release(ContextStack stack);
+
+ private:
+  static void unmap(ContextStack& stack);
+
+  mutable std::mutex m_guard;
+  size_t m_stackSize;
+  size_t m_capacity;
+  std::vector<ContextStack> m_stacks;
+};
+
+/// Entry point of a context created by makeContext, it must never return.
+using ContextEntry = void (*)(void* argument);
+
+/*!
+ * \brief makeContext prepares a context running entry(argument) on the given stack once switched to.
+ * \return The handle to pass to switchContext, it lives on the stack and needs no cleanup.
+ */
+void* makeContext(const ContextStack& stack, ContextEntry entry, void* argument);
+
+/// Handle of the thread executing a dispatcher, to be released with destroyMainContext.
+void* makeMainContext();
+void destroyMainContext(void* context);
+
+/*!
+ * \brief switchContext suspends the running context into *from and resumes the context to.
+ *
+ * On x86_64 and aarch64 only callee saved registers are exchanged in user space, other architectures fall back to
+ * swapcontext.
+ */
+void switchContext(void** from, void* to);
+
+}  // namespace System
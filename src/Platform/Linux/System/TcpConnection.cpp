@@ -20,6 +20,8 @@
 #include <arpa/inet.h>
 #include <cassert>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <System/ErrorMessage.h>
@@ -172,7 +174,6 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
-  std::string message;
   if (size == 0) {
     if (shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -181,7 +182,33 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void*)data, size, MSG_NOSIGNAL);
+  const Buffer buffer{data, size};
+  return write(&buffer, 1);
+}
+
+std::size_t TcpConnection::write(const Buffer* buffers, std::size_t count) {
+  assert(dispatcher != nullptr);
+  assert(contextPair.writeContext == nullptr);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  iovec ioBuffers[MAX_WRITE_BUFFERS];
+  msghdr ioMessage{};
+  ioMessage.msg_iov = ioBuffers;
+  size_t size = 0;
+  for (; ioMessage.msg_iovlen < count && ioMessage.msg_iovlen < MAX_WRITE_BUFFERS; ++ioMessage.msg_iovlen) {
+    const auto& buffer = buffers[ioMessage.msg_iovlen];
+    ioBuffers[ioMessage.msg_iovlen].iov_base = const_cast<uint8_t*>(buffer.data);
+    ioBuffers[ioMessage.msg_iovlen].iov_len = buffer.size;
+    size += buffer.size;
+  }
+  if (size == 0) {
+    return 0;
+  }
+
+  std::string message;
+  ssize_t transferred = ::sendmsg(connection, &ioMessage, MSG_NOSIGNAL);
   if (transferred == -1) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wlogical-op"
@@ -248,7 +275,7 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
         }
 
-        ssize_t transferred = ::send(connection, (void*)data, size, 0);
+        ssize_t transferred = ::sendmsg(connection, &ioMessage, MSG_NOSIGNAL);
         if (transferred == -1) {
           message = "send failed, " + lastErrorMessage();
         } else {
@@ -276,6 +303,28 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
   return std::make_pair(Ipv4Address(htonl(addr.sin_addr.s_addr)), htons(addr.sin_port));
 }
 
+void TcpConnection::rebind(Dispatcher& newDispatcher) {
+  assert(dispatcher != nullptr);
+  assert(contextPair.readContext == nullptr);
+  assert(contextPair.writeContext == nullptr);
+  if (dispatcher == &newDispatcher) {
+    return;
+  }
+
+  if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_DEL, connection, nullptr) == -1) {
+    throw std::runtime_error("TcpConnection::rebind, epoll_ctl failed, " + lastErrorMessage());
+  }
+
+  epoll_event connectionEvent;
+  connectionEvent.events = EPOLLONESHOT;
+  connectionEvent.data.ptr = nullptr;
+  if (epoll_ctl(newDispatcher.getEpoll(), EPOLL_CTL_ADD, connection, &connectionEvent) == -1) {
+    throw std::runtime_error("TcpConnection::rebind, epoll_ctl failed, " + lastErrorMessage());
+  }
+
+  dispatcher = &newDispatcher;
+}
+
 TcpConnection::TcpConnection(Dispatcher& dispatcher, int socket) : dispatcher(&dispatcher), connection(socket) {
   contextPair.readContext = nullptr;
   contextPair.writeContext = nullptr;
@@ -30,6 +30,15 @@ class Ipv4Address;
 
 class TcpConnection {
  public:
+  /// Part of a scatter/gather write, the memory must stay valid until the write returned.
+  struct Buffer {
+    const uint8_t* data;
+    std::size_t size;
+  };
+
+  /// Buffers beyond this count are left to the next write of the caller.
+  static constexpr std::size_t MAX_WRITE_BUFFERS = 16;
+
   TcpConnection();
   TcpConnection(const TcpConnection&) = delete;
   TcpConnection(TcpConnection&& other);
@@ -38,8 +47,13 @@ class TcpConnection {
   TcpConnection& operator=(TcpConnection&& other);
   std::size_t read(uint8_t* data, std::size_t size);
   std::size_t write(const uint8_t* data, std::size_t size);
+  // Writes the buffers in order with a single system call, returns the bytes transferred which may end in any buffer.
+  std::size_t write(const Buffer* buffers, std::size_t count);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
+  // Moves an idle connection to another dispatcher, which may run on a different thread.
+  void rebind(Dispatcher& dispatcher);
+
  private:
   friend class TcpConnector;
   friend class TcpListener;
@@ -22,6 +22,7 @@
 #include <sys/event.h>
 #include <sys/errno.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "Dispatcher.h"
@@ -152,7 +153,6 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
-  std::string message;
   if (size == 0) {
     if (shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -161,7 +161,34 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void*)data, size, 0);
+  const Buffer buffer{data, size};
+  return write(&buffer, 1);
+}
+
+size_t TcpConnection::write(const Buffer* buffers, size_t count) {
+  assert(dispatcher != nullptr);
+  assert(writeContext == nullptr);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  iovec ioBuffers[MAX_WRITE_BUFFERS];
+  msghdr ioMessage{};
+  ioMessage.msg_iov = ioBuffers;
+  size_t size = 0;
+  for (; static_cast<size_t>(ioMessage.msg_iovlen) < count && static_cast<size_t>(ioMessage.msg_iovlen) < MAX_WRITE_BUFFERS;
+       ++ioMessage.msg_iovlen) {
+    const auto& buffer = buffers[ioMessage.msg_iovlen];
+    ioBuffers[ioMessage.msg_iovlen].iov_base = const_cast<uint8_t*>(buffer.data);
+    ioBuffers[ioMessage.msg_iovlen].iov_len = buffer.size;
+    size += buffer.size;
+  }
+  if (size == 0) {
+    return 0;
+  }
+
+  std::string message;
+  ssize_t transferred = ::sendmsg(connection, &ioMessage, 0);
   if (transferred == -1) {
     if (errno != EAGAIN && errno != EWOULDBLOCK) {
       message = "send failed, " + lastErrorMessage();
@@ -203,7 +230,7 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw InterruptedException();
         }
 
-        ssize_t transferred = ::send(connection, (void*)data, size, 0);
+        ssize_t transferred = ::sendmsg(connection, &ioMessage, 0);
         if (transferred == -1) {
           message = "send failed, " + lastErrorMessage();
         } else {
@@ -231,6 +258,24 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
   return std::make_pair(Ipv4Address(htonl(addr.sin_addr.s_addr)), htons(addr.sin_port));
 }
 
+void TcpConnection::rebind(Dispatcher& newDispatcher) {
+  assert(dispatcher != nullptr);
+  assert(readContext == nullptr);
+  assert(writeContext == nullptr);
+  if (dispatcher == &newDispatcher) {
+    return;
+  }
+
+  // reads are registered one shot, a completed write leaves its filter in the old kqueue
+  struct kevent event;
+  EV_SET(&event, connection, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+  if (kevent(dispatcher->getKqueue(), &event, 1, NULL, 0, NULL) == -1 && errno != ENOENT) {
+    throw std::runtime_error("TcpConnection::rebind, kevent failed, " + lastErrorMessage());
+  }
+
+  dispatcher = &newDispatcher;
+}
+
 TcpConnection::TcpConnection(Dispatcher& dispatcher, int socket)
     : dispatcher(&dispatcher), connection(socket), readContext(nullptr), writeContext(nullptr) {
   int val = 1;
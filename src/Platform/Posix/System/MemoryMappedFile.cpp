@@ -180,6 +180,53 @@ void MemoryMappedFile::rename(const std::string& newPath) {
   }
 }
 
+void MemoryMappedFile::resize(uint64_t newSize, std::error_code& ec) {
+  assert(isOpened());
+
+  if (newSize == m_size) {
+    ec = std::error_code();
+    return;
+  }
+
+  Tools::ScopeExit failExitHandler([this, &ec] {
+    ec = std::error_code(errno, std::system_category());
+    std::error_code ignore;
+    close(ignore);
+  });
+
+  int result = ::munmap(m_data, static_cast<size_t>(m_size));
+  if (result == -1) {
+    failExitHandler.cancel();
+    ec = std::error_code(errno, std::system_category());
+    return;
+  }
+  m_data = nullptr;
+
+  result = ::ftruncate(m_file, static_cast<off_t>(newSize));
+  if (result == -1) {
+    return;
+  }
+
+  void* data = ::mmap(nullptr, static_cast<size_t>(newSize), PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+  if (data == MAP_FAILED) {
+    return;
+  }
+
+  m_data = reinterpret_cast<uint8_t*>(data);
+  m_size = newSize;
+  ec = std::error_code();
+
+  failExitHandler.cancel();
+}
+
+void MemoryMappedFile::resize(uint64_t newSize) {
+  std::error_code ec;
+  resize(newSize, ec);
+  if (ec) {
+    throw std::system_error(ec, "MemoryMappedFile::resize");
+  }
+}
+
 void MemoryMappedFile::close(std::error_code& ec) {
   int result;
   if (m_data != nullptr) {
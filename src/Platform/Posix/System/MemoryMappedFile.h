@@ -45,6 +45,10 @@ class MemoryMappedFile {
   void rename(const std::string& newPath, std::error_code& ec);
   void rename(const std::string& newPath);
 
+  // Changes the file size in place and remaps it, previously returned data pointers are invalidated.
+  void resize(uint64_t newSize, std::error_code& ec);
+  void resize(uint64_t newSize);
+
   void flush(uint8_t* data, uint64_t size, std::error_code& ec);
   void flush(uint8_t* data, uint64_t size);
 
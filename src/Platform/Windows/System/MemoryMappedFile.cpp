@@ -194,6 +194,70 @@ void MemoryMappedFile::rename(const std::string& newPath) {
   }
 }
 
+void MemoryMappedFile::resize(uint64_t newSize, std::error_code& ec) {
+  assert(isOpened());
+
+  if (newSize == m_size) {
+    ec = std::error_code();
+    return;
+  }
+
+  Tools::ScopeExit failExitHandler([this, &ec] {
+    ec = std::error_code(::GetLastError(), std::system_category());
+    std::error_code ignore;
+    close(ignore);
+  });
+
+  BOOL result = ::UnmapViewOfFile(m_data);
+  if (!result) {
+    failExitHandler.cancel();
+    ec = std::error_code(::GetLastError(), std::system_category());
+    return;
+  }
+  m_data = nullptr;
+
+  result = ::CloseHandle(m_mappingHandle);
+  if (!result) {
+    return;
+  }
+  m_mappingHandle = INVALID_HANDLE_VALUE;
+
+  LONG distanceToMoveHigh = static_cast<LONG>((newSize >> 32) & UINT64_C(0xffffffff));
+  DWORD filePointer = ::SetFilePointer(m_fileHandle, static_cast<LONG>(newSize & UINT64_C(0xffffffff)),
+                                       &distanceToMoveHigh, FILE_BEGIN);
+  if (filePointer == INVALID_SET_FILE_POINTER) {
+    return;
+  }
+
+  result = ::SetEndOfFile(m_fileHandle);
+  if (!result) {
+    return;
+  }
+
+  m_mappingHandle = ::CreateFileMapping(m_fileHandle, NULL, PAGE_READWRITE, 0, 0, NULL);
+  if (m_mappingHandle == NULL) {
+    return;
+  }
+
+  m_data = reinterpret_cast<uint8_t*>(::MapViewOfFile(m_mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+  if (m_data == NULL) {
+    return;
+  }
+
+  m_size = newSize;
+  ec = std::error_code();
+
+  failExitHandler.cancel();
+}
+
+void MemoryMappedFile::resize(uint64_t newSize) {
+  std::error_code ec;
+  resize(newSize, ec);
+  if (ec) {
+    throw std::system_error(ec, "MemoryMappedFile::resize");
+  }
+}
+
 void MemoryMappedFile::close(std::error_code& ec) {
   BOOL result;
   if (m_data != nullptr) {
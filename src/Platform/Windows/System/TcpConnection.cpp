@@ -167,10 +167,33 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  WSABUF buf{static_cast<ULONG>(size), reinterpret_cast<char*>(const_cast<uint8_t*>(data))};
+  const Buffer buffer{data, size};
+  return write(&buffer, 1);
+}
+
+size_t TcpConnection::write(const Buffer* buffers, size_t count) {
+  assert(dispatcher != nullptr);
+  assert(writeContext == nullptr);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  WSABUF bufs[MAX_WRITE_BUFFERS];
+  DWORD bufferCount = 0;
+  size_t size = 0;
+  for (; bufferCount < count && bufferCount < MAX_WRITE_BUFFERS; ++bufferCount) {
+    const auto& buffer = buffers[bufferCount];
+    bufs[bufferCount].len = static_cast<ULONG>(buffer.size);
+    bufs[bufferCount].buf = reinterpret_cast<char*>(const_cast<uint8_t*>(buffer.data));
+    size += buffer.size;
+  }
+  if (size == 0) {
+    return 0;
+  }
+
   TcpConnectionContext context;
   context.hEvent = NULL;
-  if (WSASend(connection, &buf, 1, NULL, 0, &context, NULL) != 0) {
+  if (WSASend(connection, bufs, bufferCount, NULL, 0, &context, NULL) != 0) {
     int lastError = WSAGetLastError();
     if (lastError != WSA_IO_PENDING) {
       throw std::runtime_error("TcpConnection::write, WSASend failed, " + errorMessage(lastError));
@@ -236,6 +259,16 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
   return std::make_pair(Ipv4Address(htonl(address.sin_addr.S_un.S_addr)), htons(address.sin_port));
 }
 
+void TcpConnection::rebind(Dispatcher& newDispatcher) {
+  assert(dispatcher != nullptr);
+  assert(readContext == nullptr);
+  assert(writeContext == nullptr);
+  if (dispatcher != &newDispatcher) {
+    // a socket stays associated with the completion port it was registered to
+    throw std::runtime_error("TcpConnection::rebind, sockets cannot change their completion port");
+  }
+}
+
 TcpConnection::TcpConnection(Dispatcher& dispatcher, size_t connection)
     : dispatcher(&dispatcher), connection(connection), readContext(nullptr), writeContext(nullptr) {
 }
@@ -0,0 +1,127 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include "BlockTemplateNotifier.h"
+
+#include <algorithm>
+
+#include <System/Context.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
+#include "CryptoNoteCore/ICore.h"
+#include "CryptoNoteCore/Transactions/ITransactionPool.h"
+
+CryptoNote::BlockTemplateNotifier::BlockTemplateNotifier(System::Dispatcher &dispatcher, ICore &core)
+    : m_dispatcher{dispatcher}, m_core{&core}, m_state{std::make_shared<State>()} {
+  m_core->addObserver(static_cast<IBlockchainObserver *>(this));
+  m_core->transactionPool().addObserver(static_cast<ITransactionPoolObserver *>(this));
+}
+
+CryptoNote::BlockTemplateNotifier::BlockTemplateNotifier(System::Dispatcher &dispatcher)
+    : m_dispatcher{dispatcher}, m_core{nullptr}, m_state{std::make_shared<State>()} {
+}
+
+CryptoNote::BlockTemplateNotifier::~BlockTemplateNotifier() {
+  if (m_core != nullptr) {
+    m_core->transactionPool().removeObserver(static_cast<ITransactionPoolObserver *>(this));
+    m_core->removeObserver(static_cast<IBlockchainObserver *>(this));
+  }
+}
+
+bool CryptoNote::BlockTemplateNotifier::wait(std::chrono::milliseconds timeout) {
+  if (m_state->stopped) {
+    throw System::InterruptedException{};
+  }
+
+  System::Event changed{m_dispatcher};
+  bool timedOut = false;
+  auto &waiters = m_state->waiters;
+  waiters.push_back(Waiter{&changed, m_dispatcher.getCurrentContext()});
+  const auto isThisWaiter = [&changed](const Waiter &waiter) { return waiter.changed == &changed; };
+
+  try {
+    System::Context<> timeoutContext{m_dispatcher, [&] {
+                                       try {
+                                         System::Timer{m_dispatcher}.sleep(timeout);
+                                         timedOut = true;
+                                         changed.set();
+                                       } catch (System::InterruptedException &) {
+                                       }
+                                     }};
+    changed.wait();
+  } catch (...) {
+    waiters.erase(std::find_if(waiters.begin(), waiters.end(), isThisWaiter));
+    throw;
+  }
+
+  waiters.erase(std::find_if(waiters.begin(), waiters.end(), isThisWaiter));
+  return !timedOut;
+}
+
+void CryptoNote::BlockTemplateNotifier::stop() {
+  auto &state = *m_state;
+  state.stopped = true;
+  for (const auto &waiter : state.waiters) {
+    m_dispatcher.interrupt(waiter.context);
+  }
+  // interrupted waiters unregister themselves once they resume
+  while (!state.waiters.empty()) {
+    m_dispatcher.yield();
+  }
+}
+
+void CryptoNote::BlockTemplateNotifier::blockAdded(uint32_t index, const Crypto::Hash &hash) {
+  XI_UNUSED(index, hash);
+  notify();
+}
+
+void CryptoNote::BlockTemplateNotifier::mainChainSwitched(const IBlockchainCache &previous,
+                                                          const IBlockchainCache &current, uint32_t splitIndex) {
+  XI_UNUSED(previous, current, splitIndex);
+  notify();
+}
+
+void CryptoNote::BlockTemplateNotifier::transactionDeletedFromPool(const Crypto::Hash &hash, DeletionReason reason) {
+  XI_UNUSED(hash, reason);
+  notify();
+}
+
+void CryptoNote::BlockTemplateNotifier::transactionAddedToPool(const Crypto::Hash &hash, AdditionReason reason) {
+  XI_UNUSED(hash, reason);
+  notify();
+}
+
+void CryptoNote::BlockTemplateNotifier::notify() {
+  // a burst of pool changes results in a single wake up, waiters recompute the state anyway
+  if (m_state->pending.exchange(true)) {
+    return;
+  }
+  m_dispatcher.remoteSpawn([state = m_state] {
+    state->pending.store(false);
+    for (const auto &waiter : state->waiters) {
+      waiter.changed->set();
+    }
+  });
+}
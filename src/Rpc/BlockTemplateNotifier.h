@@ -0,0 +1,107 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <Xi/Global.hh>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+#include "CryptoNoteCore/Blockchain/IBlockchainObserver.h"
+#include "CryptoNoteCore/Transactions/ITransactionPoolObserver.h"
+
+namespace CryptoNote {
+class ICore;
+
+/*!
+ * \brief The BlockTemplateNotifier class wakes up contexts waiting for the block template state to change.
+ *
+ * Every new main chain block, chain switch or transaction pool change is a candidate for a new block template.
+ * Notifications may arrive on any thread, they are coalesced and forwarded to the dispatcher waiting contexts run on.
+ * Waiting contexts are tracked, such that stop can interrupt them before the owner goes away.
+ */
+class BlockTemplateNotifier : private IBlockchainObserver, private ITransactionPoolObserver {
+ public:
+  BlockTemplateNotifier(System::Dispatcher& dispatcher, ICore& core);
+
+  /*!
+   * \brief BlockTemplateNotifier constructs a notifier observing nothing, changes are only signaled by notify.
+   */
+  explicit BlockTemplateNotifier(System::Dispatcher& dispatcher);
+  XI_DELETE_COPY(BlockTemplateNotifier);
+  XI_DELETE_MOVE(BlockTemplateNotifier);
+  ~BlockTemplateNotifier() override;
+
+  /*!
+   * \brief wait Suspends the current context until the next change notification or the timeout expires.
+   * \param timeout Maximum time to wait for a notification.
+   * \return True if a change was notified, false if the timeout expired.
+   * \exception System::InterruptedException The waiting context got interrupted or the notifier is stopped.
+   *
+   * Must be called from a context of the dispatcher passed on construction.
+   */
+  bool wait(std::chrono::milliseconds timeout);
+
+  /*!
+   * \brief notify Signals a possible change of the block template state to all waiting contexts, thread safe.
+   */
+  void notify();
+
+  /*!
+   * \brief stop Interrupts all waiting contexts and returns once they left, further waits are rejected.
+   *
+   * Must be called from the thread of the dispatcher passed on construction.
+   */
+  void stop();
+
+ private:
+  void blockAdded(uint32_t index, const Crypto::Hash& hash) override;
+  void mainChainSwitched(const IBlockchainCache& previous, const IBlockchainCache& current,
+                         uint32_t splitIndex) override;
+  void transactionDeletedFromPool(const Crypto::Hash& hash, DeletionReason reason) override;
+  void transactionAddedToPool(const Crypto::Hash& hash, AdditionReason reason) override;
+
+ private:
+  struct Waiter {
+    System::Event* changed;
+    System::NativeContext* context;
+  };
+
+  /// Shared with pending notifications, they may still run once the notifier is gone.
+  struct State {
+    std::atomic_bool pending{false};
+    bool stopped{false};
+    std::vector<Waiter> waiters;
+  };
+
+  System::Dispatcher& m_dispatcher;
+  ICore* m_core;
+  std::shared_ptr<State> m_state;
+};
+}  // namespace CryptoNote
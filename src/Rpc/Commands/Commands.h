@@ -25,5 +25,6 @@
 
 #include "Rpc/Commands/EmptyRequest.h"
 #include "Rpc/Commands/GetBlockTemplateState.h"
+#include "Rpc/Commands/WaitBlockTemplateState.h"
 #include "Rpc/Commands/GetBlockTemplate.h"
 #include "Rpc/Commands/SubmitBlock.h"
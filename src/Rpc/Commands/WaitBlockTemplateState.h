@@ -0,0 +1,77 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cinttypes>
+#include <string>
+
+#include <Serialization/ISerializer.h>
+
+namespace CryptoNote {
+namespace RpcCommands {
+
+/*!
+ * \brief Long polling variant of GetBlockTemplateState, the call returns once the template state differs from the
+ * state known by the caller or the timeout expired.
+ */
+struct WaitBlockTemplateState {
+  static inline std::string identifier() {
+    static const std::string __Identifier{"wait_block_template_state"};
+    return __Identifier;
+  }
+
+  struct request {
+    /*!
+     * \brief template_state The state last seen by the caller, an empty state returns immediately.
+     */
+    std::string template_state;
+
+    /*!
+     * \brief timeout Maximum milliseconds to wait for a change, the node may wait shorter.
+     */
+    uint32_t timeout;
+
+    KV_BEGIN_SERIALIZATION
+    KV_MEMBER(template_state)
+    KV_MEMBER(timeout)
+    KV_END_SERIALIZATION
+  };
+
+  struct response {
+    std::string status;
+
+    /*!
+     * \brief template_state The current state, equal to the requested state iff the timeout expired.
+     */
+    std::string template_state;
+
+    KV_BEGIN_SERIALIZATION
+    KV_MEMBER(status)
+    KV_MEMBER(template_state)
+    KV_END_SERIALIZATION
+  };
+};
+
+}  // namespace RpcCommands
+}  // namespace CryptoNote
@@ -198,7 +198,31 @@ class JsonRpcResponse {
 
   std::string getBody() {
     psResp.set("jsonrpc", JsonValue{std::string("2.0")});
-    return psResp.toString();
+    if (streamedResult.empty() || psResp.contains("error")) {
+      return psResp.toString();
+    }
+
+    // Splice the pre-rendered result into the envelope, psResp is an object holding at least "jsonrpc".
+    std::string body = psResp.toString();
+    body.pop_back();
+    body.reserve(body.size() + streamedResult.size() + 11);
+    body.append(",\"result\":");
+    body.append(streamedResult);
+    body.push_back('}');
+    return body;
+  }
+
+  /*!
+   * \brief setStreamedResult renders v directly into json text, skipping the intermediate JsonValue tree.
+   *
+   * Only applicable to results serialized as json objects. Intended for large responses.
+   */
+  template <typename T>
+  bool setStreamedResult(const T& v) {
+    streamedResult.clear();
+    XI_RETURN_EC_IF_NOT(storeToJsonBuffer(v, streamedResult), false);
+    psResp.erase("result");
+    return true;
   }
 
   template <typename T>
@@ -229,6 +253,7 @@ class JsonRpcResponse {
 
  private:
   Common::JsonValue psResp;
+  std::string streamedResult;
 };
 
 void invokeJsonRpcCommand(HttpClient& httpClient, JsonRpcRequest& req, JsonRpcResponse& res);
@@ -265,6 +290,25 @@ bool invokeMethod(const JsonRpcRequest& jsReq, JsonRpcResponse& jsRes, Handler h
   return result;
 }
 
+template <typename Request, typename Response, typename Handler>
+bool invokeStreamedMethod(const JsonRpcRequest& jsReq, JsonRpcResponse& jsRes, Handler handler) {
+  Request req;
+  Response res;
+
+  if (!jsReq.loadParams(req)) {
+    throw JsonRpcError(JsonRpc::errInvalidParams);
+  }
+
+  bool result = handler(req, res);
+
+  if (result) {
+    if (!jsRes.setStreamedResult(res)) {
+      throw JsonRpcError(JsonRpc::errInternalError);
+    }
+  }
+  return result;
+}
+
 typedef std::function<bool(void*, const JsonRpcRequest& req, JsonRpcResponse& res)> JsonMemberMethod;
 
 template <typename Class, typename Params, typename Result>
@@ -275,6 +319,14 @@ JsonMemberMethod makeMemberMethod(bool (Class::*handler)(const Params&, Result&)
   };
 }
 
+template <typename Class, typename Params, typename Result>
+JsonMemberMethod makeStreamedMemberMethod(bool (Class::*handler)(const Params&, Result&)) {
+  return [handler](void* obj, const JsonRpcRequest& req, JsonRpcResponse& res) {
+    return JsonRpc::invokeStreamedMethod<Params, Result>(
+        req, res, std::bind(handler, static_cast<Class*>(obj), std::placeholders::_1, std::placeholders::_2));
+  };
+}
+
 }  // namespace JsonRpc
 
 }  // namespace CryptoNote
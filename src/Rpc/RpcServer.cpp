@@ -7,6 +7,7 @@
 
 #include "RpcServer.h"
 
+#include <chrono>
 #include <future>
 #include <unordered_map>
 #include <cmath>
@@ -19,6 +20,7 @@
 #include <Xi/Global.hh>
 #include <Xi/Concurrent/SystemDispatcher.h>
 #include <Xi/Blockchain/Explorer/CoreExplorer.hpp>
+#include <System/InterruptedException.h>
 
 // CryptoNote
 #include "Common/StringTools.h"
@@ -72,7 +74,13 @@ static inline bool serialize(COMMAND_RPC_GET_BLOCKS_FAST::response& response, IS
 
 namespace {
 
-template <typename Command>
+/*!
+ * \brief jsonMethod wraps a typed handler into a http handler using json bodies.
+ *
+ * If Streamed is set the response is written by the JsonOutputBufferSerializer into a buffer preallocated by the size
+ * of the previous response of the same command on this thread, instead of being built as a JsonValue tree first.
+ */
+template <typename Command, bool Streamed = false>
 RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Command::request const&,
                                                                  typename Command::response&)) {
   return [handler](RpcServer* obj, const Xi::Http::Request& request, Xi::Http::Response& response) {
@@ -97,13 +105,78 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
 
     auto result = (obj->*handler)(req, res);
     response.headers().setContentType(Xi::Http::ContentType::Json);
-    if constexpr (!std::is_same_v<CryptoNote::Null, typename Command::response>) {
+    if constexpr (std::is_same_v<CryptoNote::Null, typename Command::response>) {
+      /* */
+    } else if constexpr (Streamed) {
+      thread_local size_t bodySizeHint = 0;
+      std::string body{};
+      body.reserve(bodySizeHint);
+      if (!storeToJsonBuffer(res.data(), body)) {
+        response = obj->makeInternalServerError("json serialization failed");
+        return false;
+      }
+      bodySizeHint = body.size();
+      response.setBody(std::move(body));
+    } else {
       response.setBody(storeToJson(res.data()));
     }
     return result;
   };
 }
 
+bool isBinaryRequest(const Xi::Http::Request& request) {
+  try {
+    const auto contentType = request.headers().contentType();
+    return contentType.has_value() && *contentType == Xi::Http::ContentType::Binary;
+  } catch (...) {
+    return false;
+  }
+}
+
+/*!
+ * \brief binaryMethod serves Command using the binary serializers if the request body is binary encoded.
+ *
+ * Requests of any other content type are handled by the json handler, thus clients not aware of the binary encoding
+ * are served as before. A binary request is always answered with a binary body, which clients use to detect support.
+ */
+template <typename Command>
+RpcServer::HandlerFunction binaryMethod(bool (RpcServer::*handler)(typename Command::request const&,
+                                                                   typename Command::response&)) {
+  return [handler, json = jsonMethod<Command>(handler)](RpcServer* obj, const Xi::Http::Request& request,
+                                                         Xi::Http::Response& response) {
+    if (!isBinaryRequest(request)) {
+      return json(obj, request, response);
+    }
+
+    boost::value_initialized<typename Command::request> req;
+    boost::value_initialized<typename Command::response> res;
+
+    if (request.method() != Xi::Http::Method::Post) {
+      response = obj->makeBadRequest("Only POST requests are allowed for binary bodies.");
+      return false;
+    }
+
+    if (!loadFromBinaryString(static_cast<typename Command::request&>(req), request.body())) {
+      response = obj->makeBadRequest("Invalid binary request body.");
+      return false;
+    }
+
+    if (!obj->getCorsDomain().empty()) {
+      response.headers().set(Xi::Http::HeaderContainer::AccessControlAllowOrigin, obj->getCorsDomain());
+    }
+
+    auto result = (obj->*handler)(req, res);
+    std::string body{};
+    if (!storeToBinaryString(static_cast<typename Command::response&>(res), body)) {
+      response = obj->makeInternalServerError("binary serialization failed");
+      return false;
+    }
+    response.headers().setContentType(Xi::Http::ContentType::Binary);
+    response.setBody(std::move(body));
+    return result;
+  };
+}
+
 }  // namespace
 
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
@@ -113,14 +186,14 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
     {"/getheight", {jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true, true}},
     {"/gettransactions", {jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false, true}},
     {"/getpeers", {jsonMethod<COMMAND_RPC_GET_PEERS>(&RpcServer::on_get_peers), true, true}},
-    {"/getblocks", {jsonMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false, true}},
+    {"/getblocks", {jsonMethod<COMMAND_RPC_GET_BLOCKS_FAST, true>(&RpcServer::on_get_blocks), false, true}},
     {"/queryblocks", {jsonMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false, true}},
-    {"/queryblockslite", {jsonMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true}},
+    {"/queryblockslite", {binaryMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true}},
     {"/queryblocksdetailed",
-     {jsonMethod<COMMAND_RPC_QUERY_BLOCKS_DETAILED>(&RpcServer::on_query_blocks_detailed), false, true}},
+     {jsonMethod<COMMAND_RPC_QUERY_BLOCKS_DETAILED, true>(&RpcServer::on_query_blocks_detailed), false, true}},
     {"/get_pool_changes", {jsonMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false, true}},
     {"/get_pool_changes_lite",
-     {jsonMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false, true}},
+     {binaryMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false, true}},
     {"/get_block_details_by_height",
      {jsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(&RpcServer::onGetBlockDetailsByHeight), false, true}},
     {"/get_blocks_details_by_heights",
@@ -142,9 +215,9 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
     {"/feeinfo", {jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true, false}},
     {"/getNodeFeeInfo", {jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true, false}},
     {"/get_o_indexes",
-     {jsonMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, false}},
+     {binaryMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, false}},
     {"/getrandom_outs",
-     {jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false, false}},
+     {binaryMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false, false}},
 
     // json rpc
     {"/json_rpc",
@@ -160,7 +233,8 @@ RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core
       m_protocol(protocol),
       m_isBlockexplorer{false},
       m_isBlockexplorerOnly{false},
-      m_submissionAccess{} {
+      m_submissionAccess{},
+      m_blockTemplateNotifier{dispatcher, c} {
   setDispatcher(std::make_shared<Xi::Concurrent::SystemDispatcher>(dispatcher));
 
   m_explorer = std::make_shared<Xi::Blockchain::Explorer::CoreExplorer>(c);
@@ -170,6 +244,11 @@ RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core
       std::static_pointer_cast<Xi::Rpc::ServiceProviderCollection>(m_explorerService));
 }
 
+void RpcServer::stop() {
+  Xi::Http::Server::stop();
+  m_blockTemplateNotifier.stop();
+}
+
 Xi::Http::Response RpcServer::doHandleRequest(const Xi::Http::Request& request) {
   {
     XI_CONCURRENT_LOCK_READ(m_access_token_guard);
@@ -228,7 +307,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
 
     static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
         // Enabled on block explorer
-        {"f_blocks_list_json", {makeMemberMethod(&RpcServer::f_on_blocks_list_json), false, true}},
+        {"f_blocks_list_json", {makeStreamedMemberMethod(&RpcServer::f_on_blocks_list_json), false, true}},
         {"f_block_json", {makeMemberMethod(&RpcServer::f_on_block_json), false, true}},
         {"f_blocks_list_raw", {makeMemberMethod(&RpcServer::f_on_blocks_list_raw), false, true}},
         {"f_transaction_json", {makeMemberMethod(&RpcServer::f_on_transaction_json), false, true}},
@@ -246,6 +325,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
 
         {RpcCommands::GetBlockTemplate::identifier(), {makeMemberMethod(&RpcServer::on_get_block_template), false, false}},
         {RpcCommands::GetBlockTemplateState::identifier(), {makeMemberMethod(&RpcServer::on_get_block_template_state), false, false}},
+        {RpcCommands::WaitBlockTemplateState::identifier(), {makeMemberMethod(&RpcServer::on_wait_block_template_state), false, false}},
         {RpcCommands::SubmitBlock::identifier(), {makeMemberMethod(&RpcServer::on_submit_block), false, false}},
         // clang-format on
 
@@ -1297,6 +1377,36 @@ bool RpcServer::on_get_block_template_state(const RpcCommands::GetBlockTemplateS
   return true;
 }
 
+bool RpcServer::on_wait_block_template_state(const RpcCommands::WaitBlockTemplateState::request& req,
+                                             RpcCommands::WaitBlockTemplateState::response& res) {
+  if (!isMinerEndpoint()) {
+    throw JsonRpc::JsonRpcError{CORE_RPC_ERROR_CODE_MINER_EDNPOINT_DISABLED, "Mining is disabled on this node."};
+  }
+
+  // bounded so a forgotten miner cannot pin a context forever
+  const auto timeout = std::min(std::chrono::milliseconds{req.timeout}, std::chrono::milliseconds{60000});
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  auto templateState = Common::podToHex(block_template_state_hash());
+  while (templateState == req.template_state) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+    // spurious wake ups are fine, a notification only says the state may have changed
+    try {
+      m_blockTemplateNotifier.wait(std::chrono::ceil<std::chrono::milliseconds>(deadline - now));
+    } catch (System::InterruptedException&) {
+      // the server is stopping, answer with the last state seen instead of holding the context
+      break;
+    }
+    templateState = Common::podToHex(block_template_state_hash());
+  }
+
+  res.template_state = std::move(templateState);
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::on_get_block_template(const RpcCommands::GetBlockTemplate::request& req,
                                       RpcCommands::GetBlockTemplate::response& res) {
   if (!isMinerEndpoint()) {
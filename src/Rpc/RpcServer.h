@@ -31,6 +31,7 @@
 #include "Common/Math.h"
 #include "CoreRpcServerCommandsDefinitions.h"
 #include "JsonRpc.h"
+#include "BlockTemplateNotifier.h"
 
 #include "Rpc/Commands/Commands.h"
 
@@ -55,6 +56,13 @@ class RpcServer : public Xi::Http::Server, public Xi::Http::RequestHandler {
             ICryptoNoteProtocolHandler& protocol);
   virtual ~RpcServer() override = default;
 
+  /*!
+   * \brief stop stops listening and interrupts pending block template long polls
+   *
+   * Must be called from the thread of the dispatcher passed on construction.
+   */
+  void stop();
+
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
   bool enableCors(const std::string& domain);
 
@@ -150,6 +158,8 @@ class RpcServer : public Xi::Http::Server, public Xi::Http::RequestHandler {
   Crypto::Hash block_template_state_hash() const;
   bool on_get_block_template_state(const RpcCommands::GetBlockTemplateState::request& req,
                                    RpcCommands::GetBlockTemplateState::response& res);
+  bool on_wait_block_template_state(const RpcCommands::WaitBlockTemplateState::request& req,
+                                    RpcCommands::WaitBlockTemplateState::response& res);
   bool on_get_block_template(const RpcCommands::GetBlockTemplate::request& req,
                              RpcCommands::GetBlockTemplate::response& res);
 
@@ -203,6 +213,7 @@ class RpcServer : public Xi::Http::Server, public Xi::Http::RequestHandler {
   bool m_isBlockexplorer;
   bool m_isBlockexplorerOnly;
   Xi::Concurrent::RecursiveLock m_submissionAccess;
+  BlockTemplateNotifier m_blockTemplateNotifier;
 
   std::shared_ptr<Xi::Blockchain::Explorer::IExplorer> m_explorer;
   std::shared_ptr<Xi::Blockchain::Services::BlockExplorer::BlockExplorer> m_explorerService;
@@ -0,0 +1,259 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+#include <Xi/Global.hh>
+#include <Xi/Span.hpp>
+#include <Xi/Encoding/VarInt.hh>
+
+#include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+/*!
+ * \brief Binary input serializer decoding directly from a contiguous buffer.
+ *
+ * Produces the same values as BinaryInputStreamSerializer over a Common::MemoryInputStream but reads without the
+ * virtual stream indirection. Varints are decoded in place with a single byte fast path and every read is bounds
+ * checked against the remaining buffer, failing the serialization instead of throwing.
+ */
+class BinarySpanInputSerializer final : public ISerializer {
+ public:
+  explicit BinarySpanInputSerializer(Xi::ConstByteSpan data)
+      : m_current(data.data()), m_end(data.data() + data.size()) {
+  }
+  ~BinarySpanInputSerializer() override = default;
+
+  /// Number of bytes not consumed yet.
+  size_t remaining() const {
+    return static_cast<size_t>(m_end - m_current);
+  }
+  bool isEndOfStream() const {
+    return m_current == m_end;
+  }
+
+  bool useVarInt() const {
+    return m_varintUse;
+  }
+  void setUseVarInt(bool use) {
+    m_varintUse = use;
+  }
+
+  SerializerType type() const override {
+    return ISerializer::INPUT;
+  }
+  FormatType format() const override {
+    return ISerializer::Machinery;
+  }
+
+  [[nodiscard]] bool beginObject(Common::StringView) override {
+    return true;
+  }
+  [[nodiscard]] bool endObject() override {
+    return true;
+  }
+
+  [[nodiscard]] bool beginArray(size_t& size, Common::StringView) override {
+    uint64_t count = 0;
+    XI_RETURN_EC_IF_NOT(readInteger(count, useVarInt()), false);
+    size = static_cast<size_t>(count);
+    return true;
+  }
+  [[nodiscard]] bool beginStaticArray(const size_t, Common::StringView) override {
+    return true;
+  }
+  [[nodiscard]] bool endArray() override {
+    return true;
+  }
+
+  [[nodiscard]] bool operator()(uint8_t& value, Common::StringView) override {
+    return readInteger(value, false);
+  }
+  [[nodiscard]] bool operator()(int16_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(uint16_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(int32_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(uint32_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(int64_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(uint64_t& value, Common::StringView) override {
+    return readInteger(value, useVarInt());
+  }
+  [[nodiscard]] bool operator()(double&, Common::StringView) override {
+    throw std::runtime_error("double serialization is not supported in BinarySpanInputSerializer");
+  }
+  [[nodiscard]] bool operator()(bool& value, Common::StringView) override {
+    uint8_t byte = 0;
+    XI_RETURN_EC_IF_NOT(readInteger(byte, false), false);
+    if (byte == 0b01010101) {
+      value = true;
+      return true;
+    } else if (byte == 0b00101010) {
+      value = false;
+      return true;
+    } else {
+      return false;
+    }
+  }
+  [[nodiscard]] bool operator()(std::string& value, Common::StringView) override {
+    uint64_t size = 0;
+    XI_RETURN_EC_IF_NOT(readInteger(size, useVarInt()), false);
+    XI_RETURN_EC_IF(size > remaining(), false);
+    value.assign(reinterpret_cast<const char*>(m_current), static_cast<size_t>(size));
+    m_current += size;
+    return true;
+  }
+
+  [[nodiscard]] bool binary(void* value, size_t size, Common::StringView) override {
+    XI_RETURN_EC_IF(size > remaining(), false);
+    if (size > 0) {
+      std::memcpy(value, m_current, size);
+      m_current += size;
+    }
+    return true;
+  }
+  [[nodiscard]] bool binary(std::string& value, Common::StringView name) override {
+    return (*this)(value, name);
+  }
+  [[nodiscard]] bool binary(Xi::ByteVector& value, Common::StringView) override {
+    uint64_t size = 0;
+    XI_RETURN_EC_IF_NOT(readInteger(size, useVarInt()), false);
+    XI_RETURN_EC_IF(size > remaining(), false);
+    value.assign(m_current, m_current + size);
+    m_current += size;
+    return true;
+  }
+
+  [[nodiscard]] bool maybe(bool& value, Common::StringView name) override {
+    return (*this)(value, name);
+  }
+
+  [[nodiscard]] bool typeTag(TypeTag& tag, Common::StringView) override {
+    TypeTag::binary_type binaryTag = TypeTag::NoBinaryTag;
+    XI_RETURN_EC_IF_NOT(readInteger(binaryTag, useVarInt()), false);
+    XI_RETURN_EC_IF(binaryTag == TypeTag::NoBinaryTag, false);
+    tag = TypeTag{binaryTag, TypeTag::NoTextTag};
+    return true;
+  }
+
+  [[nodiscard]] bool flag(std::vector<TypeTag>& flag, Common::StringView) override {
+    uint16_t nativeFlag = 0;
+    XI_RETURN_EC_IF_NOT(readInteger(nativeFlag, true), false);
+    XI_RETURN_EC_IF(nativeFlag > (1 << 14), false);
+    flag.clear();
+    for (size_t i = 0; (1 << i) <= nativeFlag; ++i) {
+      if ((nativeFlag & (1 << i))) {
+        flag.emplace_back(i + 1, TypeTag::NoTextTag);
+      }
+    }
+    return true;
+  }
+
+  template <typename T>
+  [[nodiscard]] bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+ private:
+  template <typename _IntegerT>
+  [[nodiscard]] bool readInteger(_IntegerT& value, bool useVarint) {
+    static_assert(std::is_integral_v<_IntegerT>, "only integers are supported");
+    if (useVarint) {
+      return readVarint(value);
+    } else {
+      XI_RETURN_EC_IF(remaining() < sizeof(_IntegerT), false);
+      std::memcpy(&value, m_current, sizeof(_IntegerT));
+      m_current += sizeof(_IntegerT);
+      boost::endian::little_to_native_inplace(value);
+      return true;
+    }
+  }
+
+  template <typename _IntegerT>
+  [[nodiscard]] bool readVarint(_IntegerT& value) {
+    XI_RETURN_EC_IF(m_current == m_end, false);
+    // Unsigned values below 0x80 encode as the value itself, which covers most sizes, tags and indices.
+    if constexpr (std::is_unsigned_v<_IntegerT>) {
+      if ((*m_current & 0x80) == 0) {
+        value = static_cast<_IntegerT>(*m_current++);
+        return true;
+      }
+    }
+    const size_t consumed = decodeVarint(m_current, remaining(), value);
+    XI_RETURN_EC_IF(consumed > remaining(), false);
+    m_current += consumed;
+    return true;
+  }
+
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, uint8_t& value) {
+    return xi_encoding_varint_decode_uint8(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, int8_t& value) {
+    return xi_encoding_varint_decode_int8(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, uint16_t& value) {
+    return xi_encoding_varint_decode_uint16(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, int16_t& value) {
+    return xi_encoding_varint_decode_int16(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, uint32_t& value) {
+    return xi_encoding_varint_decode_uint32(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, int32_t& value) {
+    return xi_encoding_varint_decode_int32(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, uint64_t& value) {
+    return xi_encoding_varint_decode_uint64(source, count, &value);
+  }
+  static size_t decodeVarint(const Xi::Byte* source, size_t count, int64_t& value) {
+    return xi_encoding_varint_decode_int64(source, count, &value);
+  }
+
+ private:
+  const Xi::Byte* m_current;
+  const Xi::Byte* m_end;
+  bool m_varintUse{true};
+};
+
+}  // namespace CryptoNote
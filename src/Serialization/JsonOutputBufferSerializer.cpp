@@ -0,0 +1,268 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include "Serialization/JsonOutputBufferSerializer.hpp"
+
+#include <charconv>
+#include <cstdio>
+
+#include <Xi/Global.hh>
+
+#include "Common/StringTools.h"
+
+namespace CryptoNote {
+
+JsonOutputBufferSerializer::JsonOutputBufferSerializer(std::string& buffer) : m_buffer{buffer} {
+  m_levels.reserve(16);
+  m_levels.push_back(Level{Scope::Object, true});
+  m_buffer.push_back('{');
+}
+
+JsonOutputBufferSerializer::~JsonOutputBufferSerializer() { /* */
+}
+
+bool JsonOutputBufferSerializer::finish() {
+  XI_RETURN_EC_IF_NOT(m_levels.size() == 1, false);
+  return endScope(Scope::Object, '}');
+}
+
+ISerializer::SerializerType JsonOutputBufferSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+ISerializer::FormatType JsonOutputBufferSerializer::format() const {
+  return ISerializer::HumanReadable;
+}
+
+bool JsonOutputBufferSerializer::beginObject(Common::StringView name) {
+  return beginScope(Scope::Object, '{', name);
+}
+
+bool JsonOutputBufferSerializer::endObject() {
+  XI_RETURN_EC_IF_NOT(m_levels.size() > 1, false);
+  return endScope(Scope::Object, '}');
+}
+
+bool JsonOutputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  XI_UNUSED(size);
+  return beginScope(Scope::Array, '[', name);
+}
+
+bool JsonOutputBufferSerializer::beginStaticArray(const size_t size, Common::StringView name) {
+  XI_UNUSED(size);
+  return beginScope(Scope::Array, '[', name);
+}
+
+bool JsonOutputBufferSerializer::endArray() {
+  return endScope(Scope::Array, ']');
+}
+
+bool JsonOutputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  // Mirrors JsonOutputStreamSerializer, which stores unsigned 64 bit values as signed json integers.
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  writeInteger(static_cast<int64_t>(value));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(double& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  char text[512];
+  const int length = std::snprintf(text, sizeof(text), "%.11f", value);
+  XI_RETURN_EC_IF(length < 0 || static_cast<size_t>(length) >= sizeof(text), false);
+  size_t end = static_cast<size_t>(length);
+  while (end > 1 && text[end - 2] != '.' && text[end - 1] == '0') {
+    --end;
+  }
+  m_buffer.append(text, end);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  m_buffer.append(value ? "true" : "false");
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  m_buffer.push_back('"');
+  writeEscaped(value);
+  m_buffer.push_back('"');
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  m_buffer.push_back('"');
+  Common::toHex(value, size, m_buffer);
+  m_buffer.push_back('"');
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(value.data(), value.size(), name);
+}
+
+bool JsonOutputBufferSerializer::binary(Xi::ByteVector& value, Common::StringView name) {
+  return binary(value.data(), value.size(), name);
+}
+
+bool JsonOutputBufferSerializer::maybe(bool& value, Common::StringView name) {
+  if (!value) {
+    XI_RETURN_EC_IF_NOT(beginValue(name), false);
+    m_buffer.append("null");
+  }
+  return true;
+}
+
+bool JsonOutputBufferSerializer::typeTag(TypeTag& tag, Common::StringView name) {
+  XI_RETURN_EC_IF(tag.text() == TypeTag::NoTextTag, false);
+  TypeTag::text_type tTag = tag.text();
+  XI_RETURN_EC_IF_NOT(this->operator()(tTag, name), false);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::flag(std::vector<TypeTag>& flag, Common::StringView name) {
+  if (flag.empty()) {
+    bool hasFlag = false;
+    return maybe(hasFlag, name);
+  } else {
+    size_t count = flag.size();
+    XI_RETURN_EC_IF_NOT(beginArray(count, name), false);
+    for (size_t i = 0; i < count; ++i) {
+      XI_RETURN_EC_IF_NOT(typeTag(flag[i], ""), false);
+    }
+    XI_RETURN_EC_IF_NOT(endArray(), false);
+    return true;
+  }
+}
+
+bool JsonOutputBufferSerializer::beginValue(Common::StringView name) {
+  XI_RETURN_EC_IF(m_levels.empty(), false);
+  auto& level = m_levels.back();
+  if (!level.empty) {
+    m_buffer.push_back(',');
+  }
+  level.empty = false;
+  if (level.scope == Scope::Object) {
+    m_buffer.push_back('"');
+    m_buffer.append(name.getData(), name.getSize());
+    m_buffer.append("\":");
+  }
+  return true;
+}
+
+bool JsonOutputBufferSerializer::beginScope(Scope scope, char open, Common::StringView name) {
+  XI_RETURN_EC_IF_NOT(beginValue(name), false);
+  m_levels.push_back(Level{scope, true});
+  m_buffer.push_back(open);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::endScope(Scope scope, char close) {
+  XI_RETURN_EC_IF(m_levels.empty(), false);
+  XI_RETURN_EC_IF_NOT(m_levels.back().scope == scope, false);
+  m_levels.pop_back();
+  m_buffer.push_back(close);
+  return true;
+}
+
+void JsonOutputBufferSerializer::writeInteger(int64_t value) {
+  char text[24];
+  const auto result = std::to_chars(text, text + sizeof(text), value);
+  m_buffer.append(text, result.ptr);
+}
+
+void JsonOutputBufferSerializer::writeEscaped(const std::string& value) {
+  size_t begin = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    const char* escaped = nullptr;
+    switch (value[i]) {
+      case '\b':
+        escaped = "\\b";
+        break;
+      case '\f':
+        escaped = "\\f";
+        break;
+      case '\n':
+        escaped = "\\n";
+        break;
+      case '\r':
+        escaped = "\\r";
+        break;
+      case '\t':
+        escaped = "\\t";
+        break;
+      case '"':
+        escaped = "\\\"";
+        break;
+      case '\\':
+        escaped = "\\\\";
+        break;
+      default:
+        continue;
+    }
+    m_buffer.append(value, begin, i - begin);
+    m_buffer.append(escaped);
+    begin = i + 1;
+  }
+  m_buffer.append(value, begin, std::string::npos);
+}
+
+}  // namespace CryptoNote
@@ -0,0 +1,110 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Serialization/ISerializer.h"
+
+namespace CryptoNote {
+
+/*!
+ * \brief The JsonOutputBufferSerializer class writes json text directly into a caller provided buffer.
+ *
+ * Other than the JsonOutputStreamSerializer no intermediate Common::JsonValue tree is built, values are appended to
+ * the buffer as they are visited. Values are encoded the same way the JsonOutputStreamSerializer does, object members
+ * however are emitted in serialization order instead of being sorted by name.
+ *
+ * The serializer opens a root object on construction, call finish once all members have been serialized.
+ */
+class JsonOutputBufferSerializer final : public ISerializer {
+ public:
+  /*!
+   * \brief JsonOutputBufferSerializer appends a json object to buffer
+   * \param buffer The buffer to append to, its content and capacity are kept, thus it can be reused.
+   */
+  explicit JsonOutputBufferSerializer(std::string& buffer);
+  ~JsonOutputBufferSerializer() override;
+
+  /*!
+   * \brief finish closes the root object
+   * \return false if any nested object or array is still open, otherwise true
+   */
+  [[nodiscard]] bool finish();
+
+  // ISerializer =====================================================================================================
+  SerializerType type() const override;
+  FormatType format() const override;
+
+  [[nodiscard]] virtual bool beginObject(Common::StringView name) override;
+  [[nodiscard]] virtual bool endObject() override;
+
+  [[nodiscard]] virtual bool beginArray(size_t& size, Common::StringView name) override;
+  [[nodiscard]] virtual bool beginStaticArray(const size_t size, Common::StringView name) override;
+  [[nodiscard]] virtual bool endArray() override;
+
+  [[nodiscard]] virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(int16_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(int32_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(int64_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(double& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(bool& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool operator()(std::string& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  [[nodiscard]] virtual bool binary(std::string& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool binary(Xi::ByteVector& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool maybe(bool& value, Common::StringView name) override;
+  [[nodiscard]] virtual bool typeTag(TypeTag& tag, Common::StringView name) override;
+  [[nodiscard]] virtual bool flag(std::vector<TypeTag>& flag, Common::StringView name) override;
+
+  template <typename T>
+  [[nodiscard]] bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+  // ISerializer =====================================================================================================
+
+ private:
+  enum struct Scope { Object, Array };
+  struct Level {
+    Scope scope;
+    bool empty;
+  };
+
+  /// Writes the separator and, inside objects, the member name preceding the next value.
+  [[nodiscard]] bool beginValue(Common::StringView name);
+  [[nodiscard]] bool beginScope(Scope scope, char open, Common::StringView name);
+  [[nodiscard]] bool endScope(Scope scope, char close);
+  void writeInteger(int64_t value);
+  void writeEscaped(const std::string& value);
+
+ private:
+  std::string& m_buffer;
+  std::vector<Level> m_levels;
+};
+
+}  // namespace CryptoNote
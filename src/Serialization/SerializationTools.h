@@ -25,8 +25,10 @@
 #include <Common/StringOutputStream.h>
 #include "JsonInputStreamSerializer.h"
 #include "JsonOutputStreamSerializer.h"
+#include "JsonOutputBufferSerializer.hpp"
 #include "BinaryInputStreamSerializer.h"
 #include "BinaryOutputStreamSerializer.h"
+#include "BinarySpanInputSerializer.hpp"
 
 namespace Common {
 
@@ -125,6 +127,52 @@ template <typename T>
   }
 }
 
+/*!
+ * \brief storeToJsonBuffer appends the json representation of v to out without building a JsonValue tree.
+ *
+ * Object members are written in serialization order. On failure out may contain a partial document.
+ */
+template <typename T>
+[[nodiscard]] bool storeToJsonBuffer(const T& v, std::string& out) {
+  try {
+    JsonOutputBufferSerializer s{out};
+    if (!serialize(const_cast<T&>(v), s)) {
+      return false;
+    }
+    return s.finish();
+  } catch (...) {
+    return false;
+  }
+}
+
+/*!
+ * \brief storeToBinaryString appends the binary representation of v to out.
+ */
+template <typename T>
+[[nodiscard]] bool storeToBinaryString(const T& v, std::string& out) {
+  try {
+    Common::StringOutputStream stream{out};
+    BinaryOutputStreamSerializer s{stream};
+    return serialize(const_cast<T&>(v), s);
+  } catch (...) {
+    return false;
+  }
+}
+
+/*!
+ * \brief loadFromBinaryString deserializes v from buf, failing if buf is not consumed entirely.
+ */
+template <typename T>
+[[nodiscard]] bool loadFromBinaryString(T& v, const std::string& buf) {
+  try {
+    BinarySpanInputSerializer s{Xi::ConstByteSpan{reinterpret_cast<const Xi::Byte*>(buf.data()), buf.size()}};
+    XI_RETURN_EC_IF_NOT(serialize(v, s), false);
+    return s.isEndOfStream();
+  } catch (...) {
+    return false;
+  }
+}
+
 template <typename T>
 [[nodiscard]] bool loadFromJson(T& v, const std::string& buf) {
   try {
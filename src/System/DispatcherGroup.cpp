@@ -0,0 +1,182 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include "System/DispatcherGroup.h"
+
+#include <cassert>
+#include <stdexcept>
+
+#include <System/ContextGroup.h>
+
+namespace System {
+
+struct DispatcherGroup::Worker {
+  std::thread thread;
+  Dispatcher* dispatcher = nullptr;
+  ContextGroup* group = nullptr;
+  Event* stopEvent = nullptr;
+  bool isStopping = false;
+  std::function<void()> onStopped;
+};
+
+DispatcherGroup::DispatcherGroup(Dispatcher& primary, size_t workers)
+    : m_primary{primary}, m_primaryGroup{std::make_unique<ContextGroup>(primary)}, m_next{0}, m_stopped{false} {
+  m_workers.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    auto worker = std::make_unique<Worker>();
+    std::promise<void> ready{};
+    auto isReady = ready.get_future();
+    worker->thread = std::thread{[this, &ready, iWorker = worker.get()] { runWorker(*iWorker, ready); }};
+    m_workers.emplace_back(std::move(worker));
+    try {
+      isReady.get();
+    } catch (...) {
+      m_workers.back()->thread.join();
+      m_workers.pop_back();
+      stop();
+      throw;
+    }
+  }
+}
+
+DispatcherGroup::~DispatcherGroup() {
+  try {
+    stop();
+  } catch (...) {
+  }
+}
+
+Dispatcher& DispatcherGroup::primary() {
+  return m_primary;
+}
+
+size_t DispatcherGroup::workers() const {
+  return m_workers.size();
+}
+
+Dispatcher& DispatcherGroup::next() {
+  if (m_workers.empty()) {
+    return m_primary;
+  }
+  auto& worker = *m_workers[m_next];
+  m_next = (m_next + 1) % m_workers.size();
+  return *worker.dispatcher;
+}
+
+void DispatcherGroup::spawn(Dispatcher& dispatcher, std::function<void()>&& procedure) {
+  if (&dispatcher == &m_primary) {
+    m_primary.remoteSpawn([this, iProcedure = std::move(procedure)]() mutable {
+      if (!m_stopped) {
+        m_primaryGroup->spawn(std::move(iProcedure));
+      }
+    });
+    return;
+  }
+
+  for (auto& worker : m_workers) {
+    if (worker->dispatcher == &dispatcher) {
+      dispatcher.remoteSpawn([iWorker = worker.get(), iProcedure = std::move(procedure)]() mutable {
+        // the worker is only accessed from its own thread here
+        if (!iWorker->isStopping) {
+          iWorker->group->spawn(std::move(iProcedure));
+        }
+      });
+      return;
+    }
+  }
+
+  throw std::invalid_argument{"DispatcherGroup::spawn, dispatcher is not part of this group"};
+}
+
+void DispatcherGroup::stop() {
+  if (m_stopped) {
+    return;
+  }
+  m_stopped = true;
+
+  m_primaryGroup->interrupt();
+
+  Event stopped{m_primary};
+  size_t remaining = m_workers.size();
+  for (auto& worker : m_workers) {
+    worker->onStopped = [this, &stopped, &remaining] {
+      m_primary.remoteSpawn([&stopped, &remaining] {
+        if (--remaining == 0) {
+          stopped.set();
+        }
+      });
+    };
+    worker->dispatcher->remoteSpawn([iWorker = worker.get()] { iWorker->stopEvent->set(); });
+  }
+
+  // workers may invoke procedures on the primary dispatcher until they are done, keep serving them
+  bool interrupted = false;
+  while (remaining > 0) {
+    try {
+      stopped.wait();
+    } catch (InterruptedException&) {
+      interrupted = true;
+    }
+  }
+  for (auto& worker : m_workers) {
+    worker->thread.join();
+  }
+  m_workers.clear();
+
+  m_primaryGroup->wait();
+  if (interrupted) {
+    m_primary.interrupt();
+  }
+}
+
+void DispatcherGroup::runWorker(Worker& worker, std::promise<void>& ready) {
+  std::unique_ptr<Dispatcher> dispatcher{};
+  try {
+    dispatcher = std::make_unique<Dispatcher>();
+  } catch (...) {
+    ready.set_exception(std::current_exception());
+    return;
+  }
+
+  {
+    ContextGroup group{*dispatcher};
+    Event stopEvent{*dispatcher};
+    worker.dispatcher = dispatcher.get();
+    worker.group = &group;
+    worker.stopEvent = &stopEvent;
+    ready.set_value();
+
+    while (!stopEvent.get()) {
+      stopEvent.wait();
+    }
+    worker.isStopping = true;
+    group.interrupt();
+    group.wait();
+  }
+
+  assert(worker.onStopped);
+  worker.onStopped();
+}
+
+}  // namespace System
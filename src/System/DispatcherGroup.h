@@ -0,0 +1,157 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
+
+namespace System {
+
+class ContextGroup;
+
+/*!
+ * \brief A set of event loops, each running on its own thread, next to a primary dispatcher.
+ *
+ * The primary dispatcher is owned by the caller and keeps running on its thread. The group starts a number of worker
+ * loops and places tasks on them in round robin order. Without workers every task is placed on the primary
+ * dispatcher, which keeps the behaviour of a single threaded node.
+ *
+ * Tasks spawned through the group are interrupted on stop. Apart from spawn and invoke all methods must be called from
+ * the thread of the primary dispatcher.
+ */
+class DispatcherGroup {
+ public:
+  DispatcherGroup(Dispatcher& primary, size_t workers);
+  DispatcherGroup(const DispatcherGroup&) = delete;
+  DispatcherGroup& operator=(const DispatcherGroup&) = delete;
+  ~DispatcherGroup();
+
+  Dispatcher& primary();
+
+  /// Number of worker loops, excluding the primary dispatcher.
+  size_t workers() const;
+
+  /// Dispatcher for the next task, round robin over the workers or the primary dispatcher if there are none.
+  Dispatcher& next();
+
+  /*!
+   * \brief spawn Spawns a task on one of the loops of this group, may be called from any thread of the group.
+   * \param dispatcher The loop to run the task on, must be the primary dispatcher or one of the workers.
+   * \param procedure The task to execute, interrupted once the group stops.
+   */
+  void spawn(Dispatcher& dispatcher, std::function<void()>&& procedure);
+
+  /*!
+   * \brief stop Interrupts all tasks spawned and waits for them, then joins the worker threads.
+   *
+   * The primary dispatcher keeps serving its contexts while waiting, thus workers may still invoke procedures on it
+   * while they shut down.
+   */
+  void stop();
+
+  /*!
+   * \brief invoke Runs a procedure on another loop and suspends the calling context until it returned.
+   * \param current The dispatcher running the calling context.
+   * \param target The dispatcher to run the procedure on.
+   * \param procedure The procedure to run, exceptions thrown are rethrown in the calling context.
+   * \return The result of the procedure.
+   *
+   * The calling context is not interruptible while the procedure runs, as the procedure may reference its stack. A
+   * pending interruption is delivered once the procedure returned.
+   */
+  template <typename _ProcedureT>
+  static auto invoke(Dispatcher& current, Dispatcher& target, _ProcedureT&& procedure)
+      -> decltype(procedure());
+
+ private:
+  struct Worker;
+
+  void runWorker(Worker& worker, std::promise<void>& ready);
+
+ private:
+  Dispatcher& m_primary;
+  std::unique_ptr<ContextGroup> m_primaryGroup;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  size_t m_next;
+  bool m_stopped;
+};
+
+template <typename _ProcedureT>
+auto DispatcherGroup::invoke(Dispatcher& current, Dispatcher& target, _ProcedureT&& procedure)
+    -> decltype(procedure()) {
+  using result_type = decltype(procedure());
+  if (&current == &target) {
+    return procedure();
+  }
+
+  Event done{current};
+  std::exception_ptr error{};
+  [[maybe_unused]] std::conditional_t<std::is_void<result_type>::value, bool, std::unique_ptr<result_type>> result{};
+  target.remoteSpawn([&] {
+    try {
+      if constexpr (std::is_void<result_type>::value) {
+        procedure();
+      } else {
+        result = std::make_unique<result_type>(procedure());
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    auto localDone = &done;
+    current.remoteSpawn([localDone] { localDone->set(); });
+  });
+
+  bool interrupted = false;
+  while (!done.get()) {
+    try {
+      done.wait();
+    } catch (InterruptedException&) {
+      interrupted = true;
+    }
+  }
+  if (interrupted) {
+    current.interrupt();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if constexpr (!std::is_void<result_type>::value) {
+    return std::move(*result);
+  }
+}
+
+}  // namespace System
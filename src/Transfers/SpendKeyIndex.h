@@ -0,0 +1,88 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/*!
+ * \brief The SpendKeyIndex class maps the spend keys of all subscriptions sharing a view key to their subscription.
+ *
+ * Scanning underives every output once and matches the result against all subscriptions with a single lookup,
+ * independent of the number of addresses. Spend keys are compressed curve points and thus uniformly distributed, the
+ * leading bytes of a key are used as its hash instead of mixing all of them.
+ */
+template <typename _ValueT>
+class SpendKeyIndex {
+ public:
+  using value_type = _ValueT;
+
+ public:
+  void insert(const Crypto::PublicKey& spendKey, value_type value) {
+    m_index[spendKey] = value;
+  }
+
+  void erase(const Crypto::PublicKey& spendKey) {
+    m_index.erase(spendKey);
+  }
+
+  void reserve(size_t count) {
+    m_index.reserve(count);
+  }
+
+  /// Returns the value registered for the spend key or nullptr if the key is unknown.
+  const value_type* find(const Crypto::PublicKey& spendKey) const {
+    const auto search = m_index.find(spendKey);
+    return search == m_index.end() ? nullptr : std::addressof(search->second);
+  }
+
+  size_t size() const {
+    return m_index.size();
+  }
+
+  bool empty() const {
+    return m_index.empty();
+  }
+
+ private:
+  struct PrefixHash {
+    size_t operator()(const Crypto::PublicKey& key) const {
+      uint64_t prefix = 0;
+      std::memcpy(&prefix, key.data(), sizeof(prefix));
+      return static_cast<size_t>(prefix);
+    }
+  };
+
+  std::unordered_map<Crypto::PublicKey, value_type, PrefixHash> m_index;
+};
+
+}  // namespace CryptoNote
@@ -7,11 +7,13 @@
 
 #include "TransfersConsumer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <numeric>
-#include <future>
+
+#include <async++.h>
 
 #include "CommonTypes.h"
-#include "Common/BlockingQueue.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/Transactions/TransactionApi.h"
@@ -19,7 +21,6 @@
 #include "Wallet/IWallet.h"
 #include "CryptoNoteCore/INode.h"
 #include "Wallet/WalletErrors.h"
-#include <future>
 
 using namespace Crypto;
 using namespace Logging;
@@ -45,27 +46,23 @@ class MarkTransactionConfirmedException : public std::exception {
   Crypto::Hash m_txHash;
 };
 
+using SubscriptionOutputs = std::unordered_map<TransfersSubscription*, std::vector<uint32_t>>;
+
 void checkOutputKey(const KeyDerivation& derivation, const PublicKey& key, size_t keyIndex, size_t outputIndex,
-                    const std::unordered_set<PublicKey>& spendKeys,
-                    std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
+                    const SpendKeyIndex<TransfersSubscription*>& spendKeys, SubscriptionOutputs& outputs) {
   PublicKey spendKey;
   underive_public_key(derivation, keyIndex, key, spendKey);
 
-  if (spendKeys.find(spendKey) != spendKeys.end()) {
-    outputs[spendKey].push_back(static_cast<uint32_t>(outputIndex));
+  if (const auto subscription = spendKeys.find(spendKey)) {
+    outputs[*subscription].push_back(static_cast<uint32_t>(outputIndex));
   }
 }
 
-void findMyOutputs(const ITransactionReader& tx, const SecretKey& viewSecretKey,
-                   const std::unordered_set<PublicKey>& spendKeys,
-                   std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
-  auto txPublicKey = tx.getTransactionPublicKey();
-  KeyDerivation derivation;
-
-  if (!generate_key_derivation(txPublicKey, viewSecretKey, derivation)) {
-    return;
-  }
+/// Number of transactions a scanning worker processes at once, their key derivations are computed as one batch.
+const size_t ScanChunkSize = 32;
 
+void findMyOutputs(const ITransactionReader& tx, const KeyDerivation& derivation,
+                   const SpendKeyIndex<TransfersSubscription*>& spendKeys, SubscriptionOutputs& outputs) {
   size_t keyIndex = 0;
   size_t outputCount = tx.getOutputCount();
 
@@ -98,8 +95,12 @@ std::vector<Crypto::Hash> getBlockHashes(const CryptoNote::CompleteBlock* blocks
 namespace CryptoNote {
 
 TransfersConsumer::TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger,
-                                     const SecretKey& viewSecret)
-    : m_viewSecret(viewSecret), m_node(node), m_currency(currency), m_logger(logger, "TransfersConsumer") {
+                                     const SecretKey& viewSecret, async::threadpool_scheduler& scanners)
+    : m_viewSecret(viewSecret),
+      m_node(node),
+      m_currency(currency),
+      m_logger(logger, "TransfersConsumer"),
+      m_scanners(scanners) {
   updateSyncStart();
 }
 
@@ -112,7 +113,7 @@ ITransfersSubscription& TransfersConsumer::addSubscription(const AccountSubscrip
 
   if (res.get() == nullptr) {
     res.reset(new TransfersSubscription(m_currency, m_logger.getLogger(), subscription));
-    m_spendKeys.insert(subscription.keys.address.spendPublicKey);
+    m_spendKeys.insert(subscription.keys.address.spendPublicKey, res.get());
 
     if (m_subscriptions.size() == 1) {
       m_syncStart = res->getSyncStart();
@@ -213,92 +214,90 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, BlockHeight
 
   struct PreprocessedTx : Tx, PreprocessInfo {};
 
+  // Transactions are collected in chain order, every one is preprocessed into its own slot. Thus the scanning pool
+  // neither locks nor requires the results to be sorted afterwards.
   std::vector<PreprocessedTx> preprocessedTransactions;
-  std::mutex preprocessedTransactionsMutex;
-
-  size_t workers = std::thread::hardware_concurrency();
-  if (workers == 0) {
-    workers = 2;
-  }
+  uint32_t emptyBlockCount = 0;
 
-  BlockingQueue<Tx> inputQueue(workers * 2);
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto timestamp = blocks[i].timestamp;
+    const auto& block = blocks[i].block;
 
-  std::atomic<bool> stopProcessing(false);
-  std::atomic<size_t> emptyBlockCount(0);
+    if (!block.is_initialized()) {
+      ++emptyBlockCount;
+      continue;
+    }
 
-  auto pushingThread = std::async(std::launch::async, [&] {
-    for (uint32_t i = 0; i < count && !stopProcessing; ++i) {
-      const auto timestamp = blocks[i].timestamp;
-      const auto& block = blocks[i].block;
+    // filter by syncStartTimestamp
+    if (m_syncStart.timestamp && timestamp < m_syncStart.timestamp) {
+      ++emptyBlockCount;
+      continue;
+    }
 
-      if (!block.is_initialized()) {
-        ++emptyBlockCount;
-        continue;
-      }
+    TransactionBlockInfo blockInfo;
+    blockInfo.height = startHeight.next(i);
+    blockInfo.timestamp = timestamp;
+    blockInfo.transactionIndex = 0;  // position in block
 
-      // filter by syncStartTimestamp
-      if (m_syncStart.timestamp && timestamp < m_syncStart.timestamp) {
-        ++emptyBlockCount;
+    for (const auto& tx : blocks[i].transactions) {
+      auto pubKey = tx->getTransactionPublicKey();
+      if (pubKey == PublicKey::Null) {
+        ++blockInfo.transactionIndex;
         continue;
       }
 
-      TransactionBlockInfo blockInfo;
-      blockInfo.height = startHeight.next(i);
-      blockInfo.timestamp = timestamp;
-      blockInfo.transactionIndex = 0;  // position in block
-
-      for (const auto& tx : blocks[i].transactions) {
-        auto pubKey = tx->getTransactionPublicKey();
-        if (pubKey == PublicKey::Null) {
-          ++blockInfo.transactionIndex;
-          continue;
-        }
-
-        bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
-        Tx item = {blockInfo, tx.get(), isLastTransactionInBlock};
-        inputQueue.push(item);
-        ++blockInfo.transactionIndex;
-      }
+      PreprocessedTx item{};
+      item.blockInfo = blockInfo;
+      item.tx = tx.get();
+      item.isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
+      preprocessedTransactions.push_back(std::move(item));
+      ++blockInfo.transactionIndex;
     }
+  }
 
-    inputQueue.close();
-  });
-
-  auto processingFunction = [&] {
-    Tx item;
-    std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
-      PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
+  const size_t chunkCount = (preprocessedTransactions.size() + ScanChunkSize - 1) / ScanChunkSize;
+  std::vector<std::error_code> chunkErrors(chunkCount);
+  std::atomic<bool> stopProcessing(false);
 
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
-      if (ec) {
-        stopProcessing = true;
-        break;
+  std::error_code processingError;
+  try {
+    async::parallel_for(m_scanners, async::irange(size_t{0}, chunkCount), [&](size_t chunk) {
+      if (stopProcessing) {
+        return;
       }
 
-      std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
-    }
-    return ec;
-  };
-
-  std::vector<std::future<std::error_code>> processingThreads;
-  for (size_t i = 0; i < workers; ++i) {
-    processingThreads.push_back(std::async(std::launch::async, processingFunction));
+      const size_t begin = chunk * ScanChunkSize;
+      const size_t end = std::min(begin + ScanChunkSize, preprocessedTransactions.size());
+      std::vector<PublicKey> transactionKeys{};
+      transactionKeys.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+        transactionKeys.push_back(preprocessedTransactions[i].tx->getTransactionPublicKey());
+      }
+      std::vector<KeyDerivation> derivations(transactionKeys.size());
+      std::unique_ptr<bool[]> isDerivationValid{new bool[transactionKeys.size()]};
+      generate_key_derivations(transactionKeys.data(), transactionKeys.size(), m_viewSecret, derivations.data(),
+                               isDerivationValid.get());
+
+      for (size_t i = begin; i < end && !stopProcessing; ++i) {
+        auto& item = preprocessedTransactions[i];
+        const auto derivation = isDerivationValid[i - begin] ? std::addressof(derivations[i - begin]) : nullptr;
+        const auto ec = preprocessOutputs(item.blockInfo, *item.tx, derivation, item);
+        if (ec) {
+          chunkErrors[chunk] = ec;
+          stopProcessing = true;
+          return;
+        }
+      }
+    });
+  } catch (const std::system_error& e) {
+    processingError = e.code();
+  } catch (const std::exception&) {
+    processingError = std::make_error_code(std::errc::operation_canceled);
   }
 
-  std::error_code processingError;
-  for (auto& f : processingThreads) {
-    try {
-      std::error_code ec = f.get();
-      if (!processingError && ec) {
-        processingError = ec;
-      }
-    } catch (const std::system_error& e) {
-      processingError = e.code();
-    } catch (const std::exception&) {
-      processingError = std::make_error_code(std::errc::operation_canceled);
+  for (const auto& ec : chunkErrors) {
+    if (!processingError && ec) {
+      processingError = ec;
     }
   }
 
@@ -311,14 +310,7 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, BlockHeight
   std::vector<Crypto::Hash> blockHashes = getBlockHashes(blocks, count);
   m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-  // sort by block height and transaction index in block
-  std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(),
-            [](const PreprocessedTx& a, const PreprocessedTx& b) {
-              return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) <
-                     std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-            });
-
-  uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
+  uint32_t processedBlockCount = emptyBlockCount;
   try {
     for (const auto& tx : preprocessedTransactions) {
       processTransaction(tx.blockInfo, *tx.tx, tx);
@@ -483,9 +475,21 @@ std::error_code createTransfers(const AccountKeys& account, const TransactionBlo
 
 std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo,
                                                      const ITransactionReader& tx, PreprocessInfo& info) {
-  std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
+  KeyDerivation derivation;
+  const bool isDerivationValid = generate_key_derivation(tx.getTransactionPublicKey(), m_viewSecret, derivation);
+  return preprocessOutputs(blockInfo, tx, isDerivationValid ? std::addressof(derivation) : nullptr, info);
+}
+
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo,
+                                                     const ITransactionReader& tx, const KeyDerivation* derivation,
+                                                     PreprocessInfo& info) {
+  if (derivation == nullptr) {
+    return std::error_code();
+  }
+
+  SubscriptionOutputs outputs;
   try {
-    findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
+    findMyOutputs(tx, *derivation, m_spendKeys, outputs);
   } catch (const std::exception& e) {
     m_logger(Warning, BRIGHT_RED) << "Failed to process transaction: " << e.what() << ", transaction hash "
                                   << Common::podToHex(tx.getTransactionHash());
@@ -506,14 +510,11 @@ std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo&
   }
 
   for (const auto& kv : outputs) {
-    auto it = m_subscriptions.find(kv.first);
-    if (it != m_subscriptions.end()) {
-      auto& transfers = info.outputs[kv.first];
-      errorCode =
-          createTransfers(it->second->getKeys(), blockInfo, tx, kv.second, info.globalIdxs, transfers, m_logger);
-      if (errorCode) {
-        return errorCode;
-      }
+    const auto& keys = kv.first->getKeys();
+    auto& transfers = info.outputs[keys.address.spendPublicKey];
+    errorCode = createTransfers(keys, blockInfo, tx, kv.second, info.globalIdxs, transfers, m_logger);
+    if (errorCode) {
+      return errorCode;
     }
   }
 
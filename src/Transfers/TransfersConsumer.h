@@ -10,6 +10,7 @@
 #include "IBlockchainSynchronizer.h"
 #include "ITransfersSynchronizer.h"
 #include "TransfersSubscription.h"
+#include "SpendKeyIndex.h"
 
 #include "crypto/crypto.h"
 #include "Logging/LoggerRef.h"
@@ -19,6 +20,10 @@
 #include <unordered_set>
 #include <vector>
 
+namespace async {
+class threadpool_scheduler;
+}
+
 namespace CryptoNote {
 
 class INode;
@@ -26,7 +31,7 @@ class INode;
 class TransfersConsumer : public IObservableImpl<IBlockchainConsumerObserver, IBlockchainConsumer> {
  public:
   TransfersConsumer(const CryptoNote::Currency& currency, INode& node, Logging::ILogger& logger,
-                    const Crypto::SecretKey& viewSecret);
+                    const Crypto::SecretKey& viewSecret, async::threadpool_scheduler& scanners);
 
   ITransfersSubscription& addSubscription(const AccountSubscription& subscription);
   // returns true if no subscribers left
@@ -63,6 +68,9 @@ class TransfersConsumer : public IObservableImpl<IBlockchainConsumerObserver, IB
 
   std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
                                     PreprocessInfo& info);
+  /// Same as above using a precomputed derivation of the transaction key, nullptr if the key is invalid.
+  std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+                                    const Crypto::KeyDerivation* derivation, PreprocessInfo& info);
   std::error_code processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx);
   void processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
                           const PreprocessInfo& info);
@@ -78,12 +86,13 @@ class TransfersConsumer : public IObservableImpl<IBlockchainConsumerObserver, IB
   const Crypto::SecretKey m_viewSecret;
   // map { spend public key -> subscription }
   std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersSubscription>> m_subscriptions;
-  std::unordered_set<Crypto::PublicKey> m_spendKeys;
+  SpendKeyIndex<TransfersSubscription*> m_spendKeys;
   std::unordered_set<Crypto::Hash> m_poolTxs;
 
   INode& m_node;
   const CryptoNote::Currency& m_currency;
   Logging::LoggerRef m_logger;
+  async::threadpool_scheduler& m_scanners;
 };
 
 }  // namespace CryptoNote
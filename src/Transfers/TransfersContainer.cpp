@@ -148,7 +148,8 @@ TransfersContainer::TransfersContainer(const Currency& currency, Logging::ILogge
     : m_currentHeight(BlockHeight::Genesis),
       m_currency(currency),
       m_logger(logger, "TransfersContainer"),
-      m_transactionSpendableAge(transactionSpendableAge) {
+      m_transactionSpendableAge(transactionSpendableAge),
+      m_balanceHeight(BlockHeight::Genesis) {
 }
 
 bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx,
@@ -599,6 +600,7 @@ std::vector<Hash> TransfersContainer::detach(BlockHeight height) {
 
   // TODO: notification on detach
   m_currentHeight = height;
+  rebuildBalances();
 
   return deletedTransactions;
 }
@@ -650,6 +652,134 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
   }
+
+  updateBalanceEntries(keyImage);
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::updateBalanceEntries(const KeyImage& keyImage) {
+  auto& keyImageIndex = m_balanceEntries.get<BalanceKeyImageIndex>();
+  auto entriesRange = keyImageIndex.equal_range(keyImage);
+  for (auto it = entriesRange.first; it != entriesRange.second; ++it) {
+    balanceOf(it->state) -= it->amount;
+  }
+  keyImageIndex.erase(entriesRange.first, entriesRange.second);
+
+  SpentOutputDescriptor descriptor(&keyImage);
+  auto unconfirmedRange = m_unconfirmedTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
+  for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+    addBalanceEntry(*it);
+  }
+  auto availableRange = m_availableTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    addBalanceEntry(*it);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addBalanceEntry(const TransactionOutputInformationEx& output) const {
+  if (!output.visible || output.type != TransactionTypes::OutputTargetType::Key) {
+    return;
+  }
+
+  BalanceEntry entry{};
+  entry.keyImage = output.keyImage;
+  entry.amount = output.amount;
+  entry.blockHeight = output.blockHeight;
+  entry.unlockTime = output.unlockTime;
+  evaluateBalanceEntry(entry);
+  balanceOf(entry.state) += entry.amount;
+  m_balanceEntries.insert(entry);
+}
+
+/**
+ * \brief Computes the state at the balance height and timestamp, along with the next point it may change at.
+ */
+void TransfersContainer::evaluateBalanceEntry(BalanceEntry& entry) const {
+  entry.nextHeight = BlockHeight::Null;
+  entry.nextTimestamp = std::numeric_limits<uint64_t>::max();
+
+  if (entry.blockHeight == BlockHeight::Null) {
+    entry.state = IncludeStateLocked;
+  } else if (!m_currency.isUnlockSatisfied(entry.unlockTime, m_balanceHeight.toIndex(), m_balanceTimestamp)) {
+    entry.state = IncludeStateLocked;
+    if (m_currency.isLockedBasedOnBlockIndex(entry.unlockTime)) {
+      entry.nextHeight = BlockHeight::fromIndex(static_cast<BlockHeight::value_type>(entry.unlockTime));
+    } else {
+      entry.nextTimestamp = entry.unlockTime;
+    }
+  } else if (m_balanceHeight < entry.blockHeight.next(m_transactionSpendableAge)) {
+    entry.state = IncludeStateSoftLocked;
+    entry.nextHeight = entry.blockHeight.next(m_transactionSpendableAge);
+  } else {
+    entry.state = IncludeStateUnlocked;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::advanceBalances() const {
+  if (m_currentHeight < m_balanceHeight) {
+    rebuildBalances();
+    return;
+  }
+
+  m_balanceHeight = m_currentHeight;
+  m_balanceTimestamp = std::max(m_balanceTimestamp, static_cast<uint64_t>(time(NULL)));
+
+  const auto reevaluate = [this](auto& index, auto it) {
+    const auto amount = it->amount;
+    balanceOf(it->state) -= amount;
+    index.modify(it, [this](BalanceEntry& entry) { evaluateBalanceEntry(entry); });
+    balanceOf(it->state) += amount;
+  };
+
+  auto& heightIndex = m_balanceEntries.get<BalanceHeightIndex>();
+  while (!heightIndex.empty() && heightIndex.begin()->nextHeight != BlockHeight::Null &&
+         heightIndex.begin()->nextHeight <= m_balanceHeight) {
+    reevaluate(heightIndex, heightIndex.begin());
+  }
+
+  auto& timestampIndex = m_balanceEntries.get<BalanceTimestampIndex>();
+  while (!timestampIndex.empty() && timestampIndex.begin()->nextTimestamp <= m_balanceTimestamp) {
+    reevaluate(timestampIndex, timestampIndex.begin());
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalances() const {
+  m_balanceEntries.clear();
+  m_unlockedBalance = 0;
+  m_softLockedBalance = 0;
+  m_lockedBalance = 0;
+  m_balanceHeight = m_currentHeight;
+  m_balanceTimestamp = static_cast<uint64_t>(time(NULL));
+
+  for (const auto& output : m_unconfirmedTransfers) {
+    addBalanceEntry(output);
+  }
+  for (const auto& output : m_availableTransfers) {
+    addBalanceEntry(output);
+  }
+}
+
+uint64_t& TransfersContainer::balanceOf(uint32_t state) const {
+  switch (state) {
+    case IncludeStateUnlocked:
+      return m_unlockedBalance;
+    case IncludeStateSoftLocked:
+      return m_softLockedBalance;
+    default:
+      assert(state == IncludeStateLocked);
+      return m_lockedBalance;
+  }
 }
 
 bool TransfersContainer::advanceHeight(BlockHeight height) {
@@ -675,22 +805,23 @@ size_t TransfersContainer::transactionsCount() const {
 
 uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
-  uint64_t amount = 0;
+  advanceBalances();
 
-  for (const auto& t : m_availableTransfers) {
-    if (t.visible && isIncluded(t, flags)) {
-      amount += t.amount;
-    }
+  // only key outputs are tracked, they are the only outputs that may be included
+  if ((flags & IncludeTypeKey) == 0) {
+    return 0;
   }
 
+  uint64_t amount = 0;
+  if ((flags & IncludeStateUnlocked) != 0) {
+    amount += m_unlockedBalance;
+  }
+  if ((flags & IncludeStateSoftLocked) != 0) {
+    amount += m_softLockedBalance;
+  }
   if ((flags & IncludeStateLocked) != 0) {
-    for (const auto& t : m_unconfirmedTransfers) {
-      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-        amount += t.amount;
-      }
-    }
+    amount += m_lockedBalance;
   }
-
   return amount;
 }
 
@@ -902,6 +1033,7 @@ bool TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  rebuildBalances();
 
   // Repair the container if it was broken while handling addTransaction() in previous version of the code
   // Hope it isn't necessary anymore
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 #include <unordered_map>
 #include <mutex>
 #include <vector>
@@ -238,6 +239,32 @@ class TransfersContainer : public ITransfersContainer {
                                                 &SpentTransactionOutput::getSpendingTransactionHash> > > >
       SpentTransfersMultiIndex;
 
+  /// Balance contribution of a visible key output, reevaluated once the height or time its state depends on passed.
+  struct BalanceEntry {
+    Crypto::KeyImage keyImage;
+    uint64_t amount = 0;
+    BlockHeight blockHeight = BlockHeight::Null;  ///< Null for unconfirmed outputs
+    uint64_t unlockTime = 0;
+    uint32_t state = IncludeStateLocked;
+    BlockHeight nextHeight = BlockHeight::Null;                       ///< Null if the state is final for heights
+    uint64_t nextTimestamp = std::numeric_limits<uint64_t>::max();  ///< max if the state is final for timestamps
+  };
+
+  struct BalanceKeyImageIndex {};
+  struct BalanceHeightIndex {};
+  struct BalanceTimestampIndex {};
+
+  typedef boost::multi_index_container<
+      BalanceEntry,
+      boost::multi_index::indexed_by<
+          boost::multi_index::hashed_non_unique<boost::multi_index::tag<BalanceKeyImageIndex>,
+                                                BOOST_MULTI_INDEX_MEMBER(BalanceEntry, Crypto::KeyImage, keyImage)>,
+          boost::multi_index::ordered_non_unique<boost::multi_index::tag<BalanceHeightIndex>,
+                                                 BOOST_MULTI_INDEX_MEMBER(BalanceEntry, BlockHeight, nextHeight)>,
+          boost::multi_index::ordered_non_unique<boost::multi_index::tag<BalanceTimestampIndex>,
+                                                 BOOST_MULTI_INDEX_MEMBER(BalanceEntry, uint64_t, nextTimestamp)> > >
+      BalanceMultiIndex;
+
  private:
   void addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx);
   bool addTransactionOutputs(const TransactionBlockInfo& block, const ITransactionReader& tx,
@@ -249,6 +276,13 @@ class TransfersContainer : public ITransfersContainer {
   static bool isIncluded(TransactionTypes::OutputTargetType type, uint32_t state, uint32_t flags);
   void updateTransfersVisibility(const Crypto::KeyImage& keyImage);
 
+  void updateBalanceEntries(const Crypto::KeyImage& keyImage);
+  void addBalanceEntry(const TransactionOutputInformationEx& output) const;
+  void evaluateBalanceEntry(BalanceEntry& entry) const;
+  void advanceBalances() const;
+  void rebuildBalances() const;
+  uint64_t& balanceOf(uint32_t state) const;
+
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex,
                    const TransactionOutputInformationEx& output);
   void repair();
@@ -264,6 +298,15 @@ class TransfersContainer : public ITransfersContainer {
   const CryptoNote::Currency& m_currency;
   mutable std::mutex m_mutex;
   Logging::LoggerRef m_logger;
+
+  // Running balances of the visible key outputs per state, lazily advanced to the current height and time. Outputs
+  // with a pending state change are ordered by the height or timestamp it happens at.
+  mutable BalanceMultiIndex m_balanceEntries;
+  mutable uint64_t m_unlockedBalance = 0;
+  mutable uint64_t m_softLockedBalance = 0;
+  mutable uint64_t m_lockedBalance = 0;
+  mutable BlockHeight m_balanceHeight;
+  mutable uint64_t m_balanceTimestamp = 0;
 };
 
 }  // namespace CryptoNote
@@ -8,7 +8,11 @@
 #include "TransfersSynchronizer.h"
 #include "TransfersConsumer.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <Xi/Exceptions.hpp>
+#include <async++.h>
 
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
@@ -26,6 +30,7 @@ const uint32_t TRANSFERS_STORAGE_ARCHIVE_VERSION = 0;
 TransfersSyncronizer::TransfersSyncronizer(const CryptoNote::Currency& currency, Logging::ILogger& logger,
                                            IBlockchainSynchronizer& sync, INode& node)
     : m_currency(currency), m_logger(logger, "TransfersSyncronizer"), m_sync(sync), m_node(node) {
+  m_scanners = std::make_unique<async::threadpool_scheduler>(std::max(std::thread::hardware_concurrency(), 2U));
 }
 
 TransfersSyncronizer::~TransfersSyncronizer() {
@@ -46,7 +51,7 @@ ITransfersSubscription& TransfersSyncronizer::addSubscription(const AccountSubsc
 
   if (it == m_consumers.end()) {
     std::unique_ptr<TransfersConsumer> consumer(
-        new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey));
+        new TransfersConsumer(m_currency, m_node, m_logger.getLogger(), acc.keys.viewSecretKey, *m_scanners));
 
     m_sync.addConsumer(consumer.get());
     consumer->addObserver(this);
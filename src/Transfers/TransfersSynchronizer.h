@@ -18,6 +18,10 @@
 
 #include "Logging/LoggerRef.h"
 
+namespace async {
+class threadpool_scheduler;
+}
+
 namespace CryptoNote {
 class Currency;
 }
@@ -56,6 +60,9 @@ class TransfersSyncronizer : public ITransfersSynchronizer, public IBlockchainCo
  private:
   Logging::LoggerRef m_logger;
 
+  // long living workers scanning new blocks for all consumers, must outlive the consumers
+  std::unique_ptr<async::threadpool_scheduler> m_scanners;
+
   // map { view public key -> consumer }
   typedef std::unordered_map<Crypto::PublicKey, std::unique_ptr<TransfersConsumer>> ConsumersContainer;
   ConsumersContainer m_consumers;
@@ -0,0 +1,332 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include "Wallet/WalletCacheJournal.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+
+#include <Xi/Exceptions.hpp>
+
+namespace CryptoNote {
+
+namespace {
+// DO NOT CHANGE IT, chunk boundaries must stay stable across versions for the deduplication to work.
+const std::array<uint64_t, 256>& gearTable() {
+  static const std::array<uint64_t, 256> table = [] {
+    std::array<uint64_t, 256> reval{};
+    uint64_t state = 0x5851f42d4c957f2dULL;
+    for (auto& value : reval) {
+      state += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = state;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      value = z ^ (z >> 31);
+    }
+    return reval;
+  }();
+  return table;
+}
+
+const size_t RecordHeaderSize = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(Crypto::chacha8_iv);
+
+void writeUint32(std::vector<uint8_t>& out, uint32_t value) {
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void writeUint64(std::vector<uint8_t>& out, uint64_t value) {
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+uint32_t readUint32(const uint8_t* in) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value |= static_cast<uint32_t>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t readUint64(const uint8_t* in) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+Crypto::Hash computeHash(const uint8_t* data, size_t size) {
+  Crypto::Hash reval;
+  Crypto::Hash::compute(Xi::ConstByteSpan{data, size}, reval).throwOnError();
+  return reval;
+}
+
+void incrementIv(Crypto::chacha8_iv& iv) {
+  uint64_t value = readUint64(iv.data) + 1;
+  for (size_t i = 0; i < sizeof(iv.data); ++i) {
+    iv.data[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+}  // namespace
+
+std::vector<size_t> WalletCacheJournal::chunk(const uint8_t* data, size_t size) {
+  const auto& gear = gearTable();
+
+  std::vector<size_t> reval;
+  reval.reserve(size / (ChunkBoundaryMask + 1) + 1);
+
+  size_t start = 0;
+  uint64_t fingerprint = 0;
+  for (size_t i = 0; i < size; ++i) {
+    fingerprint = (fingerprint << 1) + gear[data[i]];
+    const size_t length = i + 1 - start;
+    if ((length >= MinChunkSize && (fingerprint & ChunkBoundaryMask) == 0) || length >= MaxChunkSize) {
+      reval.push_back(i + 1);
+      start = i + 1;
+      fingerprint = 0;
+    }
+  }
+  if (start < size) {
+    reval.push_back(size);
+  }
+  return reval;
+}
+
+bool WalletCacheJournal::load(const uint8_t* journal, size_t size, const Crypto::chacha8_key& key,
+                              std::vector<uint8_t>& containerData) {
+  detach();
+
+  struct Manifest {
+    uint64_t dataSize;
+    uint64_t recordSize;
+    std::vector<Crypto::Hash> chunks;
+  };
+
+  std::unordered_map<Crypto::Hash, std::vector<uint8_t>> chunks;
+  std::unordered_map<Crypto::Hash, uint64_t> chunkRecordSizes;
+  std::vector<Manifest> manifests;
+
+  size_t offset = 0;
+  std::vector<uint8_t> payload;
+  while (offset < size) {
+    if (size - offset < RecordHeaderSize) {
+      break;
+    }
+    const auto type = static_cast<RecordType>(journal[offset]);
+    const uint32_t paddedSize = readUint32(journal + offset + 1);
+    Crypto::chacha8_iv iv;
+    std::memcpy(iv.data, journal + offset + 1 + sizeof(paddedSize), sizeof(iv.data));
+    const size_t recordSize = RecordHeaderSize + paddedSize;
+    if (size - offset < recordSize || paddedSize < sizeof(uint32_t)) {
+      break;
+    }
+
+    payload.resize(paddedSize);
+    Crypto::chacha8(journal + offset + RecordHeaderSize, paddedSize, key, iv, reinterpret_cast<char*>(payload.data()));
+    const uint32_t payloadSize = readUint32(payload.data());
+    if (payloadSize > paddedSize - sizeof(uint32_t)) {
+      break;
+    }
+    const uint8_t* const content = payload.data() + sizeof(uint32_t);
+
+    if (type == RecordType::Chunk) {
+      if (payloadSize < sizeof(Crypto::Hash)) {
+        break;
+      }
+      Crypto::Hash id;
+      std::memcpy(id.data(), content, id.size());
+      if (computeHash(content + id.size(), payloadSize - id.size()) != id) {
+        break;
+      }
+      chunks[id].assign(content + id.size(), content + payloadSize);
+      chunkRecordSizes[id] = recordSize;
+    } else if (type == RecordType::Manifest) {
+      const size_t headerSize = 2 * sizeof(uint64_t);
+      if (payloadSize < headerSize + sizeof(Crypto::Hash)) {
+        break;
+      }
+      const size_t bodySize = payloadSize - sizeof(Crypto::Hash);
+      Crypto::Hash checksum;
+      std::memcpy(checksum.data(), content + bodySize, checksum.size());
+      if (computeHash(content, bodySize) != checksum) {
+        break;
+      }
+      const uint64_t chunkCount = readUint64(content + sizeof(uint64_t));
+      if (chunkCount != (bodySize - headerSize) / sizeof(Crypto::Hash) ||
+          (bodySize - headerSize) % sizeof(Crypto::Hash) != 0) {
+        break;
+      }
+
+      Manifest manifest;
+      manifest.dataSize = readUint64(content);
+      manifest.recordSize = recordSize;
+      manifest.chunks.resize(chunkCount);
+      for (size_t i = 0; i < chunkCount; ++i) {
+        std::memcpy(manifest.chunks[i].data(), content + headerSize + i * sizeof(Crypto::Hash),
+                    sizeof(Crypto::Hash));
+      }
+      manifests.emplace_back(std::move(manifest));
+    } else {
+      break;
+    }
+
+    offset += recordSize;
+  }
+
+  for (auto manifest = manifests.rbegin(); manifest != manifests.rend(); ++manifest) {
+    uint64_t dataSize = 0;
+    bool isComplete = true;
+    for (const auto& id : manifest->chunks) {
+      auto search = chunks.find(id);
+      if (search == chunks.end()) {
+        isComplete = false;
+        break;
+      }
+      dataSize += search->second.size();
+    }
+    if (!isComplete || dataSize != manifest->dataSize) {
+      continue;
+    }
+
+    containerData.clear();
+    containerData.reserve(dataSize);
+    std::unordered_set<Crypto::Hash> liveChunks;
+    m_liveSize = manifest->recordSize;
+    for (const auto& id : manifest->chunks) {
+      const auto& chunkData = chunks[id];
+      containerData.insert(containerData.end(), chunkData.begin(), chunkData.end());
+      if (liveChunks.insert(id).second) {
+        m_liveSize += chunkRecordSizes[id];
+      }
+    }
+
+    m_chunks = std::move(chunkRecordSizes);
+    // Appending after a torn record would hide the new records from the next load, hence a rewrite is enforced.
+    m_attached = offset == size;
+    return true;
+  }
+
+  return false;
+}
+
+std::vector<uint8_t> WalletCacheJournal::append(const uint8_t* containerData, size_t size,
+                                                const Crypto::chacha8_key& key, Crypto::chacha8_iv& nextIv) {
+  Xi::exceptional_if_not<Xi::RuntimeError>(isAttached(), "wallet cache journal is not attached");
+  std::vector<uint8_t> reval;
+  encodeChunks(containerData, size, key, nextIv, reval);
+  return reval;
+}
+
+std::vector<uint8_t> WalletCacheJournal::rewrite(const uint8_t* containerData, size_t size,
+                                                 const Crypto::chacha8_key& key, Crypto::chacha8_iv& nextIv) {
+  detach();
+  std::vector<uint8_t> reval;
+  reval.reserve(size + size / MinChunkSize * (RecordHeaderSize + 2 * sizeof(Crypto::Hash)) + RecordHeaderSize);
+  encodeChunks(containerData, size, key, nextIv, reval);
+  m_attached = true;
+  return reval;
+}
+
+bool WalletCacheJournal::isAttached() const {
+  return m_attached;
+}
+
+bool WalletCacheJournal::needsCompaction(uint64_t journalSize) const {
+  return !isAttached() || journalSize > CompactionRatio * m_liveSize;
+}
+
+void WalletCacheJournal::detach() {
+  m_chunks.clear();
+  m_liveSize = 0;
+  m_attached = false;
+}
+
+void WalletCacheJournal::encodeRecord(WalletCacheJournal::RecordType type, const std::vector<uint8_t>& payload,
+                                      const Crypto::chacha8_key& key, Crypto::chacha8_iv& nextIv,
+                                      std::vector<uint8_t>& out) {
+  const size_t paddedSize = (sizeof(uint32_t) + payload.size() + RecordPadding - 1) / RecordPadding * RecordPadding;
+  Xi::exceptional_if<Xi::RuntimeError>(paddedSize > std::numeric_limits<uint32_t>::max(),
+                                       "wallet cache journal record too large");
+
+  out.push_back(static_cast<uint8_t>(type));
+  writeUint32(out, static_cast<uint32_t>(paddedSize));
+  const Crypto::chacha8_iv iv = nextIv;
+  incrementIv(nextIv);
+  out.insert(out.end(), std::begin(iv.data), std::end(iv.data));
+
+  // The plain payload size is encrypted along with the payload, only the padded size is visible.
+  std::vector<uint8_t> padded;
+  padded.reserve(paddedSize);
+  writeUint32(padded, static_cast<uint32_t>(payload.size()));
+  padded.insert(padded.end(), payload.begin(), payload.end());
+  padded.resize(paddedSize, 0);
+
+  const size_t offset = out.size();
+  out.resize(offset + paddedSize);
+  Crypto::chacha8(padded.data(), padded.size(), key, iv, reinterpret_cast<char*>(out.data() + offset));
+}
+
+void WalletCacheJournal::encodeChunks(const uint8_t* containerData, size_t size, const Crypto::chacha8_key& key,
+                                      Crypto::chacha8_iv& nextIv, std::vector<uint8_t>& out) {
+  std::vector<uint8_t> manifest;
+  writeUint64(manifest, size);
+  const auto boundaries = chunk(containerData, size);
+  writeUint64(manifest, boundaries.size());
+  manifest.reserve(manifest.size() + (boundaries.size() + 1) * sizeof(Crypto::Hash));
+
+  std::unordered_set<Crypto::Hash> liveChunks;
+  uint64_t liveSize = 0;
+  std::vector<uint8_t> payload;
+  size_t start = 0;
+  for (const auto end : boundaries) {
+    const auto id = computeHash(containerData + start, end - start);
+    manifest.insert(manifest.end(), id.begin(), id.end());
+
+    auto search = m_chunks.find(id);
+    if (search == m_chunks.end()) {
+      payload.assign(id.begin(), id.end());
+      payload.insert(payload.end(), containerData + start, containerData + end);
+      const size_t recordOffset = out.size();
+      encodeRecord(RecordType::Chunk, payload, key, nextIv, out);
+      search = m_chunks.emplace(id, out.size() - recordOffset).first;
+    }
+    if (liveChunks.insert(id).second) {
+      liveSize += search->second;
+    }
+    start = end;
+  }
+
+  const auto checksum = computeHash(manifest.data(), manifest.size());
+  manifest.insert(manifest.end(), checksum.begin(), checksum.end());
+  const size_t manifestOffset = out.size();
+  encodeRecord(RecordType::Manifest, manifest, key, nextIv, out);
+  m_liveSize = liveSize + (out.size() - manifestOffset);
+}
+
+}  // namespace CryptoNote
@@ -0,0 +1,105 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <crypto/chacha8.h>
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/*!
+ * \brief Append-only encoding of the serialized wallet cache within the container storage suffix.
+ *
+ * The serialized cache is cut into content defined chunks, such that an insertion only changes the chunks around it.
+ * Every save appends the chunks not stored yet followed by a manifest listing the chunks of the cache. Each record is
+ * encrypted on its own and carries a hash to detect torn appends, loading uses the latest manifest all chunks are
+ * available for. Once the journal outgrows the live records by CompactionRatio it is rewritten from scratch.
+ *
+ * Record payloads are padded to multiples of RecordPadding, the file only reveals the number of records and their
+ * sizes rounded up to it instead of the exact layout of the serialized cache.
+ */
+class WalletCacheJournal {
+ public:
+  static inline constexpr size_t MinChunkSize = 2 * 1024;
+  static inline constexpr size_t MaxChunkSize = 64 * 1024;
+  static inline constexpr uint64_t ChunkBoundaryMask = (1ULL << 13) - 1;  ///< ~8KiB average chunk size
+  static inline constexpr uint64_t CompactionRatio = 2;
+  static inline constexpr size_t RecordPadding = 1024;
+
+ public:
+  /// Splits data at content defined boundaries, returns the chunk end offsets.
+  static std::vector<size_t> chunk(const uint8_t* data, size_t size);
+
+ public:
+  /*!
+   * \brief Decodes the journal and attaches to it on success.
+   * \return false if no complete cache was found.
+   */
+  [[nodiscard]] bool load(const uint8_t* journal, size_t size, const Crypto::chacha8_key& key,
+                          std::vector<uint8_t>& containerData);
+
+  /*!
+   * \brief Encodes the records to append for the new cache data.
+   * \pre isAttached()
+   */
+  std::vector<uint8_t> append(const uint8_t* containerData, size_t size, const Crypto::chacha8_key& key,
+                              Crypto::chacha8_iv& nextIv);
+
+  /// Encodes a compacted journal storing only the given cache data and attaches to it.
+  std::vector<uint8_t> rewrite(const uint8_t* containerData, size_t size, const Crypto::chacha8_key& key,
+                               Crypto::chacha8_iv& nextIv);
+
+  /// True if the journal state matches the storage suffix, otherwise appending is not possible.
+  bool isAttached() const;
+  /// True if the journal of the given size should be rewritten instead of appended to.
+  bool needsCompaction(uint64_t journalSize) const;
+  /// Forgets the journal state, the next save must rewrite it.
+  void detach();
+
+ private:
+  enum struct RecordType : uint8_t {
+    Chunk = 1,
+    Manifest = 2,
+  };
+
+  void encodeRecord(RecordType type, const std::vector<uint8_t>& payload, const Crypto::chacha8_key& key,
+                    Crypto::chacha8_iv& nextIv, std::vector<uint8_t>& out);
+  void encodeChunks(const uint8_t* containerData, size_t size, const Crypto::chacha8_key& key,
+                    Crypto::chacha8_iv& nextIv, std::vector<uint8_t>& out);
+
+ private:
+  /// Encoded record size of every chunk stored in the journal.
+  std::unordered_map<Crypto::Hash, uint64_t> m_chunks;
+  /// Encoded size of the records required to restore the latest manifest.
+  uint64_t m_liveSize = 0;
+  bool m_attached = false;
+};
+
+}  // namespace CryptoNote
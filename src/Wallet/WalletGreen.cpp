@@ -209,6 +209,7 @@ void WalletGreen::doShutdown() {
   m_blockchainSynchronizer.removeObserver(this);
 
   m_containerStorage.close();
+  m_cacheJournal.detach();
   m_walletsContainer.clear();
 
   clearCaches(true, true);
@@ -229,7 +230,7 @@ void WalletGreen::clearCacheAndShutdown() {
 
   clearCaches(true, true);
 
-  saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, "");
+  saveWalletCache(m_containerStorage, m_key, m_cacheJournal, WalletSaveLevel::SAVE_ALL, "");
 
   m_walletsContainer.clear();
 
@@ -375,6 +376,7 @@ void WalletGreen::initWithKeys(const std::string& path, const std::string& passw
 
   newStorage.flush();
   m_containerStorage.swap(newStorage);
+  m_cacheJournal.detach();
   incNextIv();
 
   m_viewPublicKey = viewPublicKey;
@@ -399,15 +401,28 @@ void WalletGreen::save(WalletSaveLevel saveLevel, const std::string& extra) {
 
   stopBlockchainSynchronizer();
 
+  std::string containerData;
+  bool isSerialized = false;
   try {
-    saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+    isSerialized = serializeWalletCache(saveLevel, extra, containerData);
   } catch (const std::exception& e) {
     m_logger(Error) << "Failed to save container: " << e.what();
     startBlockchainSynchronizer();
     throw;
   }
 
+  // Only the serialization reads the synchronized state, the journal write works on the serialized copy.
   startBlockchainSynchronizer();
+
+  if (isSerialized) {
+    try {
+      storeWalletCache(m_containerStorage, m_key, m_cacheJournal, containerData, extra);
+    } catch (const std::exception& e) {
+      m_logger(Error) << "Failed to save container: " << e.what();
+      throw;
+    }
+  }
+
   m_logger(Info) << "Container saved";
 }
 
@@ -442,7 +457,8 @@ void WalletGreen::exportWallet(const std::string& path, bool encrypt, WalletSave
 
     copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newStorageKey);
     copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newStorageKey);
-    saveWalletCache(newStorage, newStorageKey, saveLevel, extra);
+    WalletCacheJournal newStorageJournal;
+    saveWalletCache(newStorage, newStorageKey, newStorageJournal, saveLevel, extra);
 
     failExitHandler.cancel();
 
@@ -509,7 +525,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
         }
 
         if (!addedSpendKeys.empty() || !deletedSpendKeys.empty()) {
-          saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, extra);
+          saveWalletCache(m_containerStorage, m_key, m_cacheJournal, WalletSaveLevel::SAVE_ALL, extra);
         }
       } catch (const std::exception& e) {
         m_logger(Error) << "Failed to load cache: " << e.what() << ", reset wallet data";
@@ -573,6 +589,7 @@ void WalletGreen::load(const std::string& path, const std::string& password) {
 
 void WalletGreen::loadContainerStorage(const std::string& path) {
   try {
+    m_cacheJournal.detach();
     m_containerStorage.open(path, FileMappedVectorOpenMode::OPEN, sizeof(ContainerStoragePrefix));
 
     ContainerStoragePrefix* prefix = reinterpret_cast<ContainerStoragePrefix*>(m_containerStorage.prefix());
@@ -601,7 +618,7 @@ void WalletGreen::loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKe
   assert(m_containerStorage.isOpened());
 
   BinaryArray contanerData;
-  loadAndDecryptContainerData(m_containerStorage, m_key, contanerData);
+  loadAndDecryptContainerData(m_containerStorage, m_key, m_cacheJournal, contanerData);
 
   WalletSerializerV2 s(*this, m_actualBalance, m_pendingBalance, m_walletsContainer, m_synchronizer,
                        m_unlockHeigtTransactionsJob, m_unlockTimestampTransactionsJob, m_transactions, m_transfers,
@@ -617,8 +634,16 @@ void WalletGreen::loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKe
   }
 }
 
-void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel,
-                                  const std::string& extra) {
+void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key,
+                                  WalletCacheJournal& journal, WalletSaveLevel saveLevel, const std::string& extra) {
+  std::string containerData;
+  if (serializeWalletCache(saveLevel, extra, containerData)) {
+    storeWalletCache(storage, key, journal, containerData, extra);
+  }
+}
+
+bool WalletGreen::serializeWalletCache(WalletSaveLevel saveLevel, const std::string& extra,
+                                       std::string& containerData) {
   m_logger(Debugging) << "Saving cache...";
 
   WalletTransactions transactions;
@@ -640,7 +665,7 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
                           [](const WalletTransaction& tx) { return tx.state == WalletTransactionState::DELETED; });
   }
 
-  std::string containerData;
+  containerData.clear();
   Common::StringOutputStream containerStream(containerData);
 
   WalletSerializerV2 s(*this, m_actualBalance, m_pendingBalance, m_walletsContainer, m_synchronizer,
@@ -649,12 +674,20 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
 
   if (!s.save(containerStream, saveLevel)) {
     m_logger(Fatal) << "Container saving failed";
-  } else {
-    encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
-    storage.flush();
-    m_extra = extra;
-    m_logger(Debugging) << "Container saving finished";
+    return false;
   }
+  return true;
+}
+
+void WalletGreen::storeWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key,
+                                   WalletCacheJournal& journal, const std::string& containerData,
+                                   const std::string& extra) {
+  const auto previousSize = storage.suffixSize();
+  encryptAndSaveContainerData(storage, key, journal, containerData.data(), containerData.size());
+  storage.flush();
+  m_extra = extra;
+  m_logger(Debugging) << "Container saving finished, cache size " << containerData.size() << " bytes, journal "
+                      << previousSize << " -> " << storage.suffixSize() << " bytes";
 }
 
 void WalletGreen::copyContainerStorageKeys(ContainerStorage& src, const chacha8_key& srcKey, ContainerStorage& dst,
@@ -708,32 +741,40 @@ void WalletGreen::copyContainerStoragePrefix(ContainerStorage& src, const chacha
 }
 
 void WalletGreen::encryptAndSaveContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key,
-                                              const void* containerData, size_t containerDataSize) {
+                                              WalletCacheJournal& journal, const void* containerData,
+                                              size_t containerDataSize) {
+  const auto* data = reinterpret_cast<const uint8_t*>(containerData);
   ContainerStoragePrefix* prefix = reinterpret_cast<ContainerStoragePrefix*>(storage.prefix());
 
-  Crypto::chacha8_iv suffixIv = prefix->nextIv;
-  incIv(prefix->nextIv);
-
-  BinaryArray encryptedContainer;
-  encryptedContainer.resize(containerDataSize);
-  chacha8(containerData, containerDataSize, key, suffixIv, reinterpret_cast<char*>(encryptedContainer.data()));
-
-  std::string suffix;
-  Common::StringOutputStream suffixStream(suffix);
-  BinaryOutputStreamSerializer suffixSerializer(suffixStream);
-  if (!suffixSerializer(suffixIv, "suffixIv")) {
-    throw std::runtime_error{"serialization failed"};
-  }
-  if (!suffixSerializer(encryptedContainer, "encryptedContainer")) {
-    throw std::runtime_error{"block serialization failed"};
+  try {
+    if (prefix->version >= WalletSerializerV2::JOURNAL_VERSION && !journal.needsCompaction(storage.suffixSize())) {
+      std::vector<uint8_t> records = journal.append(data, containerDataSize, key, prefix->nextIv);
+      // persist the advanced iv before any record encrypted with it, appending remaps the prefix
+      storage.flush();
+      storage.appendSuffix(records.data(), records.size());
+    } else {
+      std::vector<uint8_t> suffix = journal.rewrite(data, containerDataSize, key, prefix->nextIv);
+      prefix->version = WalletSerializerV2::JOURNAL_VERSION;
+      storage.resizeSuffix(suffix.size());
+      std::copy(suffix.begin(), suffix.end(), storage.suffix());
+    }
+  } catch (...) {
+    journal.detach();
+    throw;
   }
-
-  storage.resizeSuffix(suffix.size());
-  std::copy(suffix.begin(), suffix.end(), storage.suffix());
 }
 
 void WalletGreen::loadAndDecryptContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key,
-                                              BinaryArray& containerData) {
+                                              WalletCacheJournal& journal, BinaryArray& containerData) {
+  const ContainerStoragePrefix* prefix = reinterpret_cast<const ContainerStoragePrefix*>(storage.prefix());
+  if (prefix->version >= WalletSerializerV2::JOURNAL_VERSION) {
+    if (!journal.load(storage.suffix(), storage.suffixSize(), key, containerData)) {
+      throw std::runtime_error{"wallet cache journal is corrupted"};
+    }
+    return;
+  }
+
+  journal.detach();
   Common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
   BinaryInputStreamSerializer suffixSerializer(suffixStream);
   Crypto::chacha8_iv suffixIv;
@@ -869,6 +910,7 @@ void WalletGreen::convertAndLoadWalletFile(const std::string& path, std::ifstrea
   });
 
   m_containerStorage.open(tmpPath.string(), Common::FileMappedVectorOpenMode::CREATE, sizeof(ContainerStoragePrefix));
+  m_cacheJournal.detach();
   ContainerStoragePrefix* prefix = reinterpret_cast<ContainerStoragePrefix*>(m_containerStorage.prefix());
   prefix->version = WalletSerializerV2::SERIALIZATION_VERSION;
   Xi::exceptional_if_not<Xi::RuntimeError>(Xi::Crypto::Random::generate(Xi::ByteSpan{prefix->nextIv.data}) ==
@@ -883,7 +925,7 @@ void WalletGreen::convertAndLoadWalletFile(const std::string& path, std::ifstrea
     incNextIv();
   }
 
-  saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, "");
+  saveWalletCache(m_containerStorage, m_key, m_cacheJournal, WalletSaveLevel::SAVE_ALL, "");
 
   boost::filesystem::rename(path, bakPath);
   std::error_code ec;
@@ -916,16 +958,22 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
   Crypto::chacha8_key newKey;
   Xi::Crypto::Chacha8::generate_key(newPassword, newKey.data, CHACHA8_KEY_SIZE);
 
+  // the journal is rewritten for the new key, it must not refer to the previous file if the update fails
+  m_cacheJournal.detach();
+  Tools::ScopeExit journalGuard([this] { m_cacheJournal.detach(); });
+
   m_containerStorage.atomicUpdate([this, newKey](ContainerStorage& newStorage) {
     copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
     copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
 
     if (m_containerStorage.suffixSize() > 0) {
       BinaryArray containerData;
-      loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
-      encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
+      WalletCacheJournal currentJournal;
+      loadAndDecryptContainerData(m_containerStorage, m_key, currentJournal, containerData);
+      encryptAndSaveContainerData(newStorage, newKey, m_cacheJournal, containerData.data(), containerData.size());
     }
   });
+  journalGuard.cancel();
 
   m_key = newKey;
   m_password = newPassword;
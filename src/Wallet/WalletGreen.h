@@ -25,6 +25,7 @@
 #include <string>
 
 #include "IFusionManager.h"
+#include "WalletCacheJournal.h"
 #include "WalletIndices.h"
 
 #include "Logging/LoggerRef.h"
@@ -347,16 +348,21 @@ class WalletGreen : public IWallet,
                                          ContainerStorage& dst, const Crypto::chacha8_key& dstKey);
   void deleteOrphanTransactions(const std::unordered_set<Crypto::PublicKey>& deletedKeys);
   static void encryptAndSaveContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key,
-                                          const void* containerData, size_t containerDataSize);
+                                          WalletCacheJournal& journal, const void* containerData,
+                                          size_t containerDataSize);
   static void loadAndDecryptContainerData(ContainerStorage& storage, const Crypto::chacha8_key& key,
-                                          BinaryArray& containerData);
+                                          WalletCacheJournal& journal, BinaryArray& containerData);
   void initTransactionPool();
   void loadSpendKeys();
   void loadContainerStorage(const std::string& path);
   void loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKeys,
                        std::unordered_set<Crypto::PublicKey>& deletedKeys, std::string& extra);
-  void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel,
-                       const std::string& extra);
+  void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletCacheJournal& journal,
+                       WalletSaveLevel saveLevel, const std::string& extra);
+  [[nodiscard]] bool serializeWalletCache(WalletSaveLevel saveLevel, const std::string& extra,
+                                          std::string& containerData);
+  void storeWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletCacheJournal& journal,
+                        const std::string& containerData, const std::string& extra);
   void subscribeWallets();
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(const std::vector<std::string>& addresses, uint64_t threshold,
@@ -393,6 +399,7 @@ class WalletGreen : public IWallet,
 
   WalletsContainer m_walletsContainer;
   ContainerStorage m_containerStorage;
+  WalletCacheJournal m_cacheJournal;  ///< state of the m_containerStorage suffix
   UnlockHeightTransactionJobs m_unlockHeigtTransactionsJob;
   UnlockTimestampTransactionJobs m_unlockTimestampTransactionsJob;
   WalletTransactions m_transactions;
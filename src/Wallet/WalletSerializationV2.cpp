@@ -153,7 +153,7 @@ WalletSerializerV2::WalletSerializerV2(ITransfersObserver& transfersObserver, ui
 }
 
 bool WalletSerializerV2::load(Common::IInputStream& source, uint8_t version) {
-  if (version != WalletSerializerV2::SERIALIZATION_VERSION)
+  if (version < WalletSerializerV2::MIN_VERSION || version > WalletSerializerV2::SERIALIZATION_VERSION)
     throw std::runtime_error{"Unsupported wallet version."};
 
   CryptoNote::BinaryInputStreamSerializer s(source);
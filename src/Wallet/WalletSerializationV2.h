@@ -45,7 +45,9 @@ class WalletSerializerV2 {
   std::unordered_set<Crypto::PublicKey>& deletedKeys();
 
   static const uint8_t MIN_VERSION = 6;
-  static const uint8_t SERIALIZATION_VERSION = 6;
+  /// Containers of this version store the cache as WalletCacheJournal, the serialized cache itself is unchanged.
+  static const uint8_t JOURNAL_VERSION = 7;
+  static const uint8_t SERIALIZATION_VERSION = 7;
 
  private:
   [[nodiscard]] bool loadKeyListAndBalances(CryptoNote::ISerializer& serializer, bool saveCache);
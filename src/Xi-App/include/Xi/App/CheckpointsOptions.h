@@ -42,10 +42,12 @@ namespace App {
 struct CheckpointsOptions : public IOptions {
   std::string CheckpointsFile = "";
   bool UseCheckpoints = true;
+  bool TrustedImport = false;
 
   KV_BEGIN_SERIALIZATION
   KV_MEMBER_RENAME(CheckpointsFile, file)
   KV_MEMBER_RENAME(UseCheckpoints, enable)
+  KV_MEMBER_RENAME(TrustedImport, trusted_import)
   KV_END_SERIALIZATION
 
   void loadEnvironment(Environment& env) override;
@@ -50,6 +50,8 @@ struct NodeOptions : public IOptions {
   XI_PROPERTY(uint16_t, externalPort, 0)
   XI_PROPERTY(uint16_t, banDuration, 60)
   XI_PROPERTY(bool, autoBan, false)
+  XI_PROPERTY(uint16_t, ioThreads, 2)
+  XI_PROPERTY(uint32_t, contextStacks, 256)
   XI_PROPERTY(std::vector<std::string>, addPeers, {})
   XI_PROPERTY(std::vector<std::string>, exclusivePeers, {})
   XI_PROPERTY(std::vector<std::string>, priorityPeers, {})
@@ -63,6 +65,8 @@ struct NodeOptions : public IOptions {
   KV_MEMBER_RENAME(externalPort(), external_port)
   KV_MEMBER_RENAME(banDuration(), ban_duration)
   KV_MEMBER_RENAME(autoBan(), auto_ban)
+  KV_MEMBER_RENAME(ioThreads(), io_threads)
+  KV_MEMBER_RENAME(contextStacks(), context_stacks)
   KV_MEMBER_RENAME(addPeers(), peers_add)
   KV_MEMBER_RENAME(exclusivePeers(), peers_exclusive)
   KV_MEMBER_RENAME(priorityPeers(), peers_priority)
@@ -57,6 +57,10 @@
 #include <Windows.h>
 #endif
 
+#if defined(__linux__)
+#include <System/FiberContext.h>
+#endif
+
 #include "Xi/App/Environment.h"
 
 namespace {
@@ -606,6 +610,10 @@ void Xi::App::Application::initializeNode() {
   m_protocol =
       std::make_unique<CryptoNote::CryptoNoteProtocolHandler>(*currency(), dispatcher(), *core(), nullptr, logger());
   auto config = m_nodeOptions->getConfig(m_dbOptions->DataDirectory, *currency());
+#if defined(__linux__)
+  auto &stackPool = System::ContextStackPool::instance();
+  stackPool.configure(stackPool.stackSize(), m_nodeOptions->contextStacks());
+#endif
   m_node = std::make_unique<CryptoNote::NodeServer>(dispatcher(), currency()->network(), *m_protocol, logger());
   m_protocol->set_p2p_endpoint(m_node.get());
   exceptional_if_not<RuntimeError>(m_node->init(config), "unable to initialize local node");
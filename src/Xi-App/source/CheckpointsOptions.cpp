@@ -40,6 +40,7 @@ void Xi::App::CheckpointsOptions::loadEnvironment(Xi::App::Environment &env) {
   env
     (UseCheckpoints, "CHECKPOINTS")
     (CheckpointsFile, "CHECKPOINTS_IMPORT")
+    (TrustedImport, "CHECKPOINTS_TRUSTED_IMPORT")
   ;
   // clang-format on
 }
@@ -53,6 +54,10 @@ void Xi::App::CheckpointsOptions::emplaceOptions(cxxopts::Options &options) {
 
       ("checkpoints-import", "imports additional checkpoints from a csv file",
         cxxopts::value<std::string>(CheckpointsFile)->default_value(CheckpointsFile))
+
+      ("checkpoints-trusted-import", "skips ring signature verification of blocks within the checkpoint zone",
+        cxxopts::value<bool>(TrustedImport)->default_value(TrustedImport ? "true" : "false")
+                                           ->implicit_value("true"))
   ;
   // clang-format on
 }
@@ -72,6 +77,7 @@ std::unique_ptr<CryptoNote::Checkpoints> Xi::App::CheckpointsOptions::getCheckpo
     const CryptoNote::Currency &currency, Logging::ILogger &logger) const {
   auto reval = std::make_unique<CryptoNote::Checkpoints>(logger);
   reval->setEnabled(UseCheckpoints);
+  reval->setTrustedImport(UseCheckpoints && TrustedImport);
   for (const auto &checkpoint : currency.integratedCheckpoints()) {
     reval->addCheckpoint(checkpoint.index, checkpoint.blockId);
   }
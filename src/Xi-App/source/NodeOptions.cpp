@@ -49,6 +49,8 @@ void NodeOptions::loadEnvironment(Environment &env) {
     (externalPort(), "P2P_EXTERNAL_PORT")
     (banDuration(), "P2P_BAN_DURATION")
     (autoBan(), "P2P_BAN_AUTO")
+    (ioThreads(), "P2P_IO_THREADS")
+    (contextStacks(), "P2P_CONTEXT_STACKS")
     (addPeers(), "P2P_PEERS_ADD")
     (exclusivePeers(), "P2P_PEERS_EXCLUSIVE")
     (priorityPeers(), "P2P_PPERS_PRIORITY")
@@ -74,6 +76,10 @@ void NodeOptions::emplaceOptions(cxxopts::Options &options) {
       cxxopts::value<uint16_t>(banDuration())->default_value(std::to_string(banDuration())), "<minutes>")
     ("p2p-ban-auto", "enabled protection mechnisms that automatically ban malicious peers",
       cxxopts::value<bool>(autoBan())->default_value("false")->implicit_value("true"), "<enabled>")
+    ("p2p-io-threads", "additional event loops serving peer connections, 0 serves all peers on the main loop",
+      cxxopts::value<uint16_t>(ioThreads())->default_value(std::to_string(ioThreads())), "<count>")
+    ("p2p-context-stacks", "released context stacks kept mapped for reuse by new connections and requests (linux only)",
+      cxxopts::value<uint32_t>(contextStacks())->default_value(std::to_string(contextStacks())), "<count>")
     ("p2p-peers-add", "Adds additional peers to the peerlist on startup",
       cxxopts::value<std::vector<std::string>>(addPeers()), "<ip4:port>*")
     ("p2p-peers-exclusive", "Adds exclusive peers, your node will only connect to those.",
@@ -117,6 +123,7 @@ CryptoNote::NetNodeConfig NodeOptions::getConfig(const std::string &dataDir,
   CryptoNote::NetNodeConfig config{};
   config.setAutoBlock(autoBan());
   config.setBlockDuration(std::chrono::minutes{banDuration()});
+  config.setIoThreads(ioThreads());
   if (!config.init(currency.network(), currency.networkUniqueName(), bind(), port(), externalPort(), localIp(),
                    hidePort(), dataDir, addPeers(), exclusivePeers(), priorityPeers(), seedPeers())) {
     exceptional<InvalidConfigurationError>();
@@ -0,0 +1,121 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include <Xi/ExternalIncludePush.h>
+#include <boost/thread/shared_mutex.hpp>
+#include <Xi/ExternalIncludePop.h>
+
+namespace Xi {
+namespace Concurrent {
+
+/*!
+ * \brief A readers writer lock that may be reentered by the thread holding it.
+ *
+ * Three modes are supported:
+ *  - shared, any number of readers may hold the lock concurrently.
+ *  - upgrade, a single thread prepares a write while readers continue to run.
+ *  - exclusive, a single thread holds the lock, no readers are allowed.
+ *
+ * The thread owning the upgrade or exclusive mode may reenter any mode, an upgrade owner acquiring the exclusive mode
+ * upgrades the lock until the exclusive scope is left. Readers may reenter the shared mode, but must never request a
+ * write, which would wait for the reader itself and throws instead.
+ */
+class RecursiveReadersWriterLock {
+ public:
+  RecursiveReadersWriterLock();
+  ~RecursiveReadersWriterLock() = default;
+
+  RecursiveReadersWriterLock(const RecursiveReadersWriterLock&) = delete;
+  RecursiveReadersWriterLock& operator=(const RecursiveReadersWriterLock&) = delete;
+
+  void lock_shared() const;
+  void unlock_shared() const;
+
+  void lock_upgrade() const;
+  void unlock_upgrade() const;
+
+  void lock() const;
+  void unlock() const;
+
+ private:
+  bool isOwner() const;
+  size_t& sharedDepth() const;
+
+ private:
+  mutable boost::shared_mutex m_mutex;
+  mutable std::atomic<std::thread::id> m_owner;
+  mutable size_t m_upgradeDepth;
+  mutable size_t m_exclusiveDepth;
+  mutable size_t m_ownerSharedDepth;
+
+ public:
+  template <void (RecursiveReadersWriterLock::*_Lock)() const, void (RecursiveReadersWriterLock::*_Unlock)() const>
+  class Guard {
+   public:
+    explicit Guard(const RecursiveReadersWriterLock& lock) : m_lock{&lock} {
+      (m_lock->*_Lock)();
+    }
+    Guard(Guard&& other) : m_lock{other.m_lock} {
+      other.m_lock = nullptr;
+    }
+    ~Guard() {
+      if (m_lock != nullptr) {
+        (m_lock->*_Unlock)();
+      }
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    Guard& operator=(Guard&&) = delete;
+
+   private:
+    const RecursiveReadersWriterLock* m_lock;
+  };
+
+  using read_lock_t = Guard<&RecursiveReadersWriterLock::lock_shared, &RecursiveReadersWriterLock::unlock_shared>;
+  using prepare_write_lock_t =
+      Guard<&RecursiveReadersWriterLock::lock_upgrade, &RecursiveReadersWriterLock::unlock_upgrade>;
+  using write_lock_t = Guard<&RecursiveReadersWriterLock::lock, &RecursiveReadersWriterLock::unlock>;
+};
+
+#define XI_CONCURRENT_RECURSIVE_LOCK_READ(X)                                                 \
+  ::Xi::Concurrent::RecursiveReadersWriterLock::read_lock_t __##X##__RECURSIVE_READ_LOCK{X}; \
+  (void)__##X##__RECURSIVE_READ_LOCK
+
+#define XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(X)                                                 \
+  ::Xi::Concurrent::RecursiveReadersWriterLock::prepare_write_lock_t __##X##__RECURSIVE_PREPARE_LOCK{X}; \
+  (void)__##X##__RECURSIVE_PREPARE_LOCK
+
+#define XI_CONCURRENT_RECURSIVE_LOCK_WRITE(X)                                                  \
+  ::Xi::Concurrent::RecursiveReadersWriterLock::write_lock_t __##X##__RECURSIVE_WRITE_LOCK{X}; \
+  (void)__##X##__RECURSIVE_WRITE_LOCK
+
+}  // namespace Concurrent
+}  // namespace Xi
@@ -0,0 +1,135 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include "Xi/Concurrent/RecursiveReadersWriterLock.h"
+
+#include <cassert>
+#include <unordered_map>
+
+#include "Xi/Exceptions.hpp"
+
+namespace {
+using SharedDepthMap = std::unordered_map<const Xi::Concurrent::RecursiveReadersWriterLock*, size_t>;
+
+SharedDepthMap& threadSharedDepths() {
+  thread_local SharedDepthMap depths{};
+  return depths;
+}
+
+void throwIfReading(const Xi::Concurrent::RecursiveReadersWriterLock* lock) {
+  const auto& depths = threadSharedDepths();
+  if (depths.find(lock) != depths.end()) {
+    Xi::exceptional<Xi::RuntimeError>("write access requested by a thread holding shared access");
+  }
+}
+}  // namespace
+
+Xi::Concurrent::RecursiveReadersWriterLock::RecursiveReadersWriterLock()
+    : m_mutex{}, m_owner{std::thread::id{}}, m_upgradeDepth{0}, m_exclusiveDepth{0}, m_ownerSharedDepth{0} {
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::lock_shared() const {
+  if (isOwner()) {
+    m_ownerSharedDepth += 1;
+    return;
+  }
+
+  auto& depth = sharedDepth();
+  if (depth == 0) {
+    m_mutex.lock_shared();
+  }
+  depth += 1;
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::unlock_shared() const {
+  if (isOwner()) {
+    assert(m_ownerSharedDepth > 0);
+    m_ownerSharedDepth -= 1;
+    return;
+  }
+
+  auto& depth = sharedDepth();
+  assert(depth > 0);
+  if (--depth == 0) {
+    threadSharedDepths().erase(this);
+    m_mutex.unlock_shared();
+  }
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::lock_upgrade() const {
+  if (isOwner()) {
+    m_upgradeDepth += 1;
+    return;
+  }
+
+  throwIfReading(this);
+  m_mutex.lock_upgrade();
+  m_owner = std::this_thread::get_id();
+  m_upgradeDepth = 1;
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::unlock_upgrade() const {
+  assert(isOwner());
+  assert(m_upgradeDepth > 0);
+  if (--m_upgradeDepth == 0 && m_exclusiveDepth == 0) {
+    m_owner = std::thread::id{};
+    m_mutex.unlock_upgrade();
+  }
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::lock() const {
+  if (isOwner()) {
+    if (m_exclusiveDepth == 0) {
+      m_mutex.unlock_upgrade_and_lock();
+    }
+    m_exclusiveDepth += 1;
+    return;
+  }
+
+  throwIfReading(this);
+  m_mutex.lock();
+  m_owner = std::this_thread::get_id();
+  m_exclusiveDepth = 1;
+}
+
+void Xi::Concurrent::RecursiveReadersWriterLock::unlock() const {
+  assert(isOwner());
+  assert(m_exclusiveDepth > 0);
+  if (--m_exclusiveDepth == 0) {
+    if (m_upgradeDepth > 0) {
+      m_mutex.unlock_and_lock_upgrade();
+    } else {
+      m_owner = std::thread::id{};
+      m_mutex.unlock();
+    }
+  }
+}
+
+bool Xi::Concurrent::RecursiveReadersWriterLock::isOwner() const {
+  return m_owner.load() == std::this_thread::get_id();
+}
+
+size_t& Xi::Concurrent::RecursiveReadersWriterLock::sharedDepth() const {
+  return threadSharedDepths()[this];
+}
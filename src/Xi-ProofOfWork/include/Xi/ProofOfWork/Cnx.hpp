@@ -23,26 +23,74 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include <Xi/Global.hh>
+#include <Xi/Byte.hh>
 
 #include "Xi/ProofOfWork/IAlgorithm.hpp"
 
 namespace Xi {
 namespace ProofOfWork {
 
+namespace Cnx {
+
+/*!
+ * \brief cnx reference engine, keeps every node as a heap allocated polymorphic hash state inside of a tree.
+ * \param blob The data to hash.
+ * \param hash Output of the computed hash.
+ * \param insertions Number of nodes inserted into the hash tree.
+ */
+void cnx(ConstByteSpan blob, ::Crypto::Hash& hash, const size_t insertions);
+
+/*!
+ * \brief cnxFlat allocation free engine, bit identical to cnx.
+ *
+ * Node states are plain structs living in a thread local arena and are ordered by an index array, the algorithm of a
+ * node is dispatched by its tag instead of virtual calls. The arena only grows, thus once a thread computed a hash
+ * for a given number of insertions no further allocations are made.
+ *
+ * \param blob The data to hash.
+ * \param hash Output of the computed hash.
+ * \param insertions Number of nodes inserted into the hash tree.
+ */
+void cnxFlat(ConstByteSpan blob, ::Crypto::Hash& hash, const size_t insertions);
+
+/*!
+ * \brief cnxFlatBatch computes cnxFlat for every nonce substituted into the blob template.
+ *
+ * The root node absorbs the bytes in front of the nonce only once, every nonce continues from a copy of that state.
+ *
+ * \param blob The template to hash, the nonce bytes are ignored.
+ * \param nonceOffset Offset of the nonce within the blob.
+ * \param nonces Concatenated nonces, one for each hash.
+ * \param hashes Output of the computed hashes.
+ * \param insertions Number of nodes inserted into the hash tree.
+ */
+void cnxFlatBatch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes,
+                  const size_t insertions);
+
+}  // namespace Cnx
+
 struct CNX_v1_Light : IAlgorithm {
   ~CNX_v1_Light() override = default;
   void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const override;
+  void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+             Xi::Span<::Crypto::Hash> hashes) const override;
 };
 
 struct CNX_v1 : IAlgorithm {
   ~CNX_v1() override = default;
   void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const override;
+  void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+             Xi::Span<::Crypto::Hash> hashes) const override;
 };
 
 struct CNX_v1_Heavy : IAlgorithm {
   ~CNX_v1_Heavy() override = default;
   void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const override;
+  void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+             Xi::Span<::Crypto::Hash> hashes) const override;
 };
 
 }  // namespace ProofOfWork
@@ -23,8 +23,11 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include <Xi/Global.hh>
 #include <Xi/Byte.hh>
+#include <Xi/Span.hpp>
 
 #include <Xi/Crypto/FastHash.hpp>
 
@@ -36,6 +39,21 @@ class IAlgorithm {
   virtual ~IAlgorithm() = default;
 
   virtual void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const = 0;
+
+  /*!
+   * \brief batch computes one hash for each nonce, substituting the nonce into a common blob template.
+   *
+   * The default implementation copies the template once and dispatches the single hash call for every nonce,
+   * algorithms override it to hash the batch without virtual dispatch and to share state across nonces.
+   *
+   * \param blob The blob template, bytes at the nonce position are ignored.
+   * \param nonceOffset Position of the nonce within the blob.
+   * \param nonces Concatenated nonces, each nonce spans nonces.size() / hashes.size() bytes.
+   * \param hashes Output, the hash of the i-th nonce is written to hashes[i].
+   * \throws InvalidSizeError iff the nonces are not evenly distributed or do not fit into the blob.
+   */
+  virtual void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+                     Xi::Span<::Crypto::Hash> hashes) const;
 };
 
 }  // namespace ProofOfWork
@@ -33,6 +33,8 @@ namespace ProofOfWork {
 struct Keccak : IAlgorithm {
   ~Keccak() override = default;
   void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const override;
+  void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+             Xi::Span<::Crypto::Hash> hashes) const override;
 };
 
 }  // namespace ProofOfWork
@@ -33,6 +33,8 @@ namespace ProofOfWork {
 struct SHA2_256 : IAlgorithm {
   ~SHA2_256() override;
   void operator()(Xi::ConstByteSpan blob, ::Crypto::Hash& hash) const override;
+  void batch(Xi::ConstByteSpan blob, size_t nonceOffset, Xi::ConstByteSpan nonces,
+             Xi::Span<::Crypto::Hash> hashes) const override;
 };
 
 }  // namespace ProofOfWork
@@ -0,0 +1,76 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include <Xi/Global.hh>
+#include <Xi/Byte.hh>
+#include <Xi/Span.hpp>
+#include <Xi/Exceptions.hpp>
+#include <Xi/Crypto/FastHash.hpp>
+
+namespace Xi {
+namespace ProofOfWork {
+
+/// Validates a batch request and returns the size of a single nonce.
+inline size_t batchNonceSize(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces,
+                             Span<::Crypto::Hash> hashes) {
+  if (hashes.empty()) {
+    return 0;
+  }
+  const size_t nonceSize = nonces.size() / hashes.size();
+  if (nonceSize == 0 || nonceSize * hashes.size() != nonces.size()) {
+    exceptional<InvalidSizeError>("nonces do not match the number of hashes requested");
+  }
+  if (nonceOffset > blob.size() || blob.size() - nonceOffset < nonceSize) {
+    exceptional<InvalidSizeError>("nonce does not fit into the blob template");
+  }
+  return nonceSize;
+}
+
+/*!
+ * Copies the template once into a thread local buffer and invokes hashFn(blob, hash) for every nonce, only the nonce
+ * bytes are rewritten in between.
+ */
+template <typename _HashFn>
+inline void forEachNonce(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes,
+                         _HashFn&& hashFn) {
+  const size_t nonceSize = batchNonceSize(blob, nonceOffset, nonces, hashes);
+  if (nonceSize == 0) {
+    return;
+  }
+
+  thread_local std::vector<Byte> buffer{};
+  buffer.assign(blob.begin(), blob.end());
+  const ConstByteSpan current{buffer.data(), buffer.size()};
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    std::memcpy(buffer.data() + nonceOffset, nonces.data() + i * nonceSize, nonceSize);
+    hashFn(current, hashes[i]);
+  }
+}
+
+}  // namespace ProofOfWork
+}  // namespace Xi
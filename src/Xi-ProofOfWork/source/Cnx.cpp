@@ -37,6 +37,7 @@
 #include "Xi/ProofOfWork/Cnx.hpp"
 
 #include <memory>
+#include <set>
 #include <vector>
 
 #include <openssl/sha.h>
@@ -342,15 +343,27 @@ void cnx(ConstByteSpan blob, ::Crypto::Hash& hash, const size_t insertions) {
 }  // namespace Cnx
 
 void CNX_v1_Light::operator()(ConstByteSpan blob, ::Crypto::Hash& hash) const {
-  Cnx::cnx(blob, hash, 64);
+  Cnx::cnxFlat(blob, hash, 64);
+}
+
+void CNX_v1_Light::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes) const {
+  Cnx::cnxFlatBatch(blob, nonceOffset, nonces, hashes, 64);
 }
 
 void CNX_v1::operator()(ConstByteSpan blob, ::Crypto::Hash& hash) const {
-  Cnx::cnx(blob, hash, 256);
+  Cnx::cnxFlat(blob, hash, 256);
+}
+
+void CNX_v1::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes) const {
+  Cnx::cnxFlatBatch(blob, nonceOffset, nonces, hashes, 256);
 }
 
 void CNX_v1_Heavy::operator()(ConstByteSpan blob, ::Crypto::Hash& hash) const {
-  Cnx::cnx(blob, hash, 1024);
+  Cnx::cnxFlat(blob, hash, 1024);
+}
+
+void CNX_v1_Heavy::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes) const {
+  Cnx::cnxFlatBatch(blob, nonceOffset, nonces, hashes, 1024);
 }
 
 }  // namespace ProofOfWork
@@ -0,0 +1,348 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include "Xi/ProofOfWork/Cnx.hpp"
+
+#include <cstring>
+#include <cinttypes>
+#include <vector>
+
+#include <openssl/sha.h>
+
+#include <Xi/Crypto/Hash/Keccak.hh>
+
+#include "groestl/groestl.h"
+#include "blake/blake256.h"
+
+#include "Batch.hpp"
+
+namespace Xi {
+namespace ProofOfWork {
+namespace Cnx {
+
+namespace {
+
+enum struct NodeKind : uint8_t {
+  Keccak = 0,
+  Groestl = 1,
+  Blake = 2,
+  Sha = 3,
+};
+
+/// Plain hashing state of a single node, the union member in use is determined by kind.
+struct NodeState {
+  ::Crypto::Hash hash;
+  NodeKind kind;
+  union {
+    xi_crypto_hash_keccak_state keccak;
+    groestl_hash_state groestl;
+    blake_state blake;
+    SHA256_CTX sha;
+  } state;
+};
+
+void finalize(NodeState& node) {
+  switch (node.kind) {
+    case NodeKind::Keccak: {
+      xi_crypto_hash_keccak_state state = node.state.keccak;
+      xi_crypto_hash_keccak_finish(std::addressof(state), node.hash.data());
+    } break;
+    case NodeKind::Groestl: {
+      groestl_hash_state state = node.state.groestl;
+      groestl_final(std::addressof(state), node.hash.data());
+    } break;
+    case NodeKind::Blake: {
+      blake_state state = node.state.blake;
+      blake256_final(std::addressof(state), node.hash.data());
+    } break;
+    case NodeKind::Sha: {
+      SHA256_CTX state = node.state.sha;
+      SHA256_Final(node.hash.data(), std::addressof(state));
+    } break;
+  }
+}
+
+void absorb(NodeState& node, const Byte* data, size_t size) {
+  switch (node.kind) {
+    case NodeKind::Keccak:
+      xi_crypto_hash_keccak_update(std::addressof(node.state.keccak), data, size);
+      break;
+    case NodeKind::Groestl:
+      groestl_update(std::addressof(node.state.groestl), data, size);
+      break;
+    case NodeKind::Blake:
+      blake224_update(std::addressof(node.state.blake), data, size);
+      break;
+    case NodeKind::Sha:
+      SHA256_Update(std::addressof(node.state.sha), data, size);
+      break;
+  }
+}
+
+void update(NodeState& node, const Byte* data, size_t size) {
+  absorb(node, data, size);
+  finalize(node);
+}
+
+void initialize(NodeState& node, const Byte selector) {
+  node.kind = static_cast<NodeKind>(selector & 0b11);
+  switch (node.kind) {
+    case NodeKind::Keccak:
+      xi_crypto_hash_keccak_init(std::addressof(node.state.keccak));
+      break;
+    case NodeKind::Groestl:
+      groestl_init(std::addressof(node.state.groestl));
+      break;
+    case NodeKind::Blake:
+      blake224_init(std::addressof(node.state.blake));
+      break;
+    case NodeKind::Sha:
+      SHA256_Init(std::addressof(node.state.sha));
+      break;
+  }
+}
+
+/// Nodes are stored in an arena and never move, the order array keeps them sorted by their hash.
+class FlatTree {
+ public:
+  using index_type = uint32_t;
+
+  struct Insertion {
+    size_t position;
+    bool inserted;
+  };
+
+ private:
+  std::vector<NodeState> m_nodes;
+  std::vector<index_type> m_order;
+  size_t m_allocated = 0;
+  size_t m_size = 0;
+
+ public:
+  void reset(const size_t capacity) {
+    if (m_nodes.size() < capacity) {
+      m_nodes.resize(capacity);
+      m_order.resize(capacity);
+    }
+    m_allocated = 0;
+    m_size = 0;
+  }
+
+  NodeState& node(const index_type index) {
+    return m_nodes[index];
+  }
+  index_type at(const size_t position) const {
+    return m_order[position];
+  }
+  size_t size() const {
+    return m_size;
+  }
+
+  index_type makeNode(const Byte selector) {
+    const auto index = static_cast<index_type>(m_allocated++);
+    initialize(m_nodes[index], selector);
+    return index;
+  }
+
+  /// Creates a new node selected and seeded by the hash of another node.
+  index_type makeNode(const index_type parent) {
+    const auto& parentHash = m_nodes[parent].hash;
+    const auto index = makeNode(parentHash[::Crypto::Hash::bytes() - 1]);
+    update(m_nodes[index], parentHash.data(), ::Crypto::Hash::bytes());
+    return index;
+  }
+
+  /// Creates a node continuing from an already seeded hashing state.
+  index_type makeNode(const NodeState& seed) {
+    const auto index = static_cast<index_type>(m_allocated++);
+    m_nodes[index] = seed;
+    return index;
+  }
+
+  index_type makeNode(ConstByteSpan blob) {
+    if (blob.empty()) {
+      const auto index = makeNode(Byte{0});
+      finalize(m_nodes[index]);
+      return index;
+    } else {
+      const auto index = makeNode(blob.data()[0]);
+      update(m_nodes[index], blob.data(), blob.size_bytes());
+      return index;
+    }
+  }
+
+  Insertion insert(const index_type index) {
+    const Byte* hash = m_nodes[index].hash.data();
+    size_t low = 0;
+    size_t high = m_size;
+    while (low < high) {
+      const size_t mid = low + (high - low) / 2;
+      const int cmp = std::memcmp(m_nodes[m_order[mid]].hash.data(), hash, ::Crypto::Hash::bytes());
+      if (cmp < 0) {
+        low = mid + 1;
+      } else if (cmp > 0) {
+        high = mid;
+      } else {
+        return Insertion{mid, false};
+      }
+    }
+    std::memmove(m_order.data() + low + 1, m_order.data() + low, (m_size - low) * sizeof(index_type));
+    m_order[low] = index;
+    m_size += 1;
+    return Insertion{low, true};
+  }
+
+  /// Inserts the node, rehashing it with its own hash until it does not collide with any other node.
+  size_t insertUnique(const index_type index) {
+    auto insertion = insert(index);
+    while (!insertion.inserted) {
+      auto& iNode = m_nodes[index];
+      update(iNode, iNode.hash.data(), ::Crypto::Hash::bytes());
+      insertion = insert(index);
+    }
+    return insertion.position;
+  }
+
+  void erase(const size_t begin, const size_t end) {
+    std::memmove(m_order.data() + begin, m_order.data() + end, (m_size - end) * sizeof(index_type));
+    m_size -= end - begin;
+  }
+};
+
+FlatTree& threadTree() {
+  thread_local FlatTree tree{};
+  return tree;
+}
+
+/// Grows the tree from its already hashed root node and writes the final hash.
+void grow(FlatTree& tree, FlatTree::index_type root, ::Crypto::Hash& hash, const size_t insertions) {
+  using index_type = FlatTree::index_type;
+
+  index_type previousInsertion = root;
+  tree.insert(previousInsertion);
+
+  index_type previousNodes[4];
+  for (size_t i = 0; i < insertions;) {
+    const auto iNode = tree.makeNode(previousInsertion);
+    size_t position = tree.insertUnique(iNode);
+    if (++i >= insertions) {
+      break;
+    }
+    previousInsertion = iNode;
+
+    const Byte selector = tree.node(iNode).hash[::Crypto::Hash::bytes() - 1];
+    const size_t range = (selector & 0b11) + 1;
+    size_t previousCount = 0;
+    size_t begin = position, end = position;
+
+    if (selector & 0b1) {
+      if (position > 0) {
+        // Mirrors the reference engine, which erases one node more than it reinserts if the range does not hit the
+        // front of the tree.
+        size_t j = position - 1;
+        for (size_t k = 0; k < range; ++k) {
+          previousNodes[previousCount++] = tree.at(j);
+          if (j == 0) {
+            break;
+          }
+          j -= 1;
+        }
+        begin = j;
+      }
+    } else {
+      size_t l = begin = position + 1;
+      for (size_t k = 0; l < tree.size() && k < range; ++k) {
+        previousNodes[previousCount++] = tree.at(l);
+        l += 1;
+      }
+      end = l;
+    }
+
+    tree.erase(begin, end);
+    for (size_t j = previousCount; j > 0; --j) {
+      const auto jIndex = previousNodes[j - 1];
+      update(tree.node(jIndex), tree.node(previousInsertion).hash.data(), ::Crypto::Hash::bytes());
+      tree.insert(jIndex);
+      const auto jNode = tree.makeNode(jIndex);
+      tree.insertUnique(jNode);
+      previousInsertion = jNode;
+      if (++i >= insertions) {
+        break;
+      }
+    }
+  }
+
+  xi_crypto_hash_keccak_state finalState{};
+  xi_crypto_hash_keccak_init(std::addressof(finalState));
+  for (size_t i = 0; i < tree.size(); ++i) {
+    xi_crypto_hash_keccak_update(std::addressof(finalState), tree.node(tree.at(i)).hash.data(),
+                                 ::Crypto::Hash::bytes());
+  }
+  xi_crypto_hash_keccak_finish(std::addressof(finalState), hash.data());
+}
+
+}  // namespace
+
+void cnxFlat(ConstByteSpan blob, ::Crypto::Hash& hash, const size_t insertions) {
+  auto& tree = threadTree();
+  tree.reset(insertions + 1);
+  grow(tree, tree.makeNode(blob), hash, insertions);
+}
+
+void cnxFlatBatch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes,
+                  const size_t insertions) {
+  const size_t nonceSize = batchNonceSize(blob, nonceOffset, nonces, hashes);
+  if (nonceSize == 0) {
+    return;
+  }
+  // The first byte selects the algorithm of the root node, a leading nonce leaves nothing to share. The bundled blake
+  // and groestl updates count bits and only continue correctly on whole blocks, thus only keccak and sha roots resume
+  // from a shared prefix.
+  const auto rootKind = static_cast<NodeKind>(blob.data()[0] & 0b11);
+  if (nonceOffset == 0 || (rootKind != NodeKind::Keccak && rootKind != NodeKind::Sha)) {
+    forEachNonce(blob, nonceOffset, nonces, hashes,
+                 [insertions](ConstByteSpan current, ::Crypto::Hash& hash) { cnxFlat(current, hash, insertions); });
+    return;
+  }
+
+  NodeState prefix{};
+  initialize(prefix, blob.data()[0]);
+  absorb(prefix, blob.data(), nonceOffset);
+
+  const Byte* suffix = blob.data() + nonceOffset + nonceSize;
+  const size_t suffixSize = blob.size() - nonceOffset - nonceSize;
+  auto& tree = threadTree();
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    tree.reset(insertions + 1);
+    const auto root = tree.makeNode(prefix);
+    auto& rootNode = tree.node(root);
+    absorb(rootNode, nonces.data() + i * nonceSize, nonceSize);
+    absorb(rootNode, suffix, suffixSize);
+    finalize(rootNode);
+    grow(tree, root, hashes[i], insertions);
+  }
+}
+
+}  // namespace Cnx
+}  // namespace ProofOfWork
+}  // namespace Xi
@@ -0,0 +1,38 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include "Xi/ProofOfWork/IAlgorithm.hpp"
+
+#include "Batch.hpp"
+
+namespace Xi {
+namespace ProofOfWork {
+
+void IAlgorithm::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces,
+                       Span<::Crypto::Hash> hashes) const {
+  forEachNonce(blob, nonceOffset, nonces, hashes,
+               [this](ConstByteSpan current, ::Crypto::Hash& hash) { (*this)(current, hash); });
+}
+
+}  // namespace ProofOfWork
+}  // namespace Xi
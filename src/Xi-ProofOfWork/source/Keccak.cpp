@@ -25,6 +25,8 @@
 
 #include <Xi/Crypto/Hash/Keccak.hh>
 
+#include "Batch.hpp"
+
 namespace Xi {
 namespace ProofOfWork {
 
@@ -32,5 +34,26 @@ void Keccak::operator()(ConstByteSpan blob, ::Crypto::Hash &hash) const {
   (void)xi_crypto_hash_keccak_256(blob.data(), blob.size_bytes(), hash.data());
 }
 
+void Keccak::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes) const {
+  const size_t nonceSize = batchNonceSize(blob, nonceOffset, nonces, hashes);
+  if (nonceSize == 0) {
+    return;
+  }
+
+  // Everything in front of the nonce is absorbed only once, each nonce continues from a copy of that state.
+  xi_crypto_hash_keccak_state prefix{};
+  xi_crypto_hash_keccak_init(std::addressof(prefix));
+  xi_crypto_hash_keccak_update(std::addressof(prefix), blob.data(), nonceOffset);
+
+  const Byte* suffix = blob.data() + nonceOffset + nonceSize;
+  const size_t suffixSize = blob.size() - nonceOffset - nonceSize;
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    xi_crypto_hash_keccak_state state = prefix;
+    xi_crypto_hash_keccak_update(std::addressof(state), nonces.data() + i * nonceSize, nonceSize);
+    xi_crypto_hash_keccak_update(std::addressof(state), suffix, suffixSize);
+    xi_crypto_hash_keccak_finish(std::addressof(state), hashes[i].data());
+  }
+}
+
 }  // namespace ProofOfWork
 }  // namespace Xi
@@ -23,8 +23,12 @@
 
 #include "Xi/ProofOfWork/Sha2-256.hpp"
 
+#include <openssl/sha.h>
+
 #include <Xi/Crypto/Hash/Sha2.hh>
 
+#include "Batch.hpp"
+
 namespace Xi {
 namespace ProofOfWork {
 
@@ -36,5 +40,26 @@ void SHA2_256::operator()(ConstByteSpan blob, ::Crypto::Hash &hash) const {
   (void)xi_crypto_hash_sha2_256(blob.data(), blob.size_bytes(), hash.data());
 }
 
+void SHA2_256::batch(ConstByteSpan blob, size_t nonceOffset, ConstByteSpan nonces, Span<::Crypto::Hash> hashes) const {
+  const size_t nonceSize = batchNonceSize(blob, nonceOffset, nonces, hashes);
+  if (nonceSize == 0) {
+    return;
+  }
+
+  // Everything in front of the nonce is absorbed only once, each nonce continues from a copy of that state.
+  SHA256_CTX prefix{};
+  SHA256_Init(std::addressof(prefix));
+  SHA256_Update(std::addressof(prefix), blob.data(), nonceOffset);
+
+  const Byte* suffix = blob.data() + nonceOffset + nonceSize;
+  const size_t suffixSize = blob.size() - nonceOffset - nonceSize;
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    SHA256_CTX state = prefix;
+    SHA256_Update(std::addressof(state), nonces.data() + i * nonceSize, nonceSize);
+    SHA256_Update(std::addressof(state), suffix, suffixSize);
+    SHA256_Final(hashes[i].data(), std::addressof(state));
+  }
+}
+
 }  // namespace ProofOfWork
 }  // namespace Xi
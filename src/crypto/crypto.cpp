@@ -143,6 +143,26 @@ bool crypto_ops::generate_key_derivation(const PublicKey &key1, const SecretKey
   return true;
 }
 
+void crypto_ops::generate_key_derivations(const PublicKey *keys, size_t count, const SecretKey &secret,
+                                          KeyDerivation *derivations, bool *valid) {
+  signed char digits[64];
+  assert(sc_check(reinterpret_cast<const unsigned char *>(&secret)) == 0);
+  sc_radix16(digits, reinterpret_cast<const unsigned char *>(&secret));
+  for (size_t i = 0; i < count; ++i) {
+    ge_p3 point;
+    ge_p2 point2;
+    ge_p1p1 point3;
+    valid[i] = ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char *>(&keys[i])) == 0;
+    if (!valid[i]) {
+      continue;
+    }
+    ge_scalarmult_radix16(&point2, digits, &point);
+    ge_mul8(&point3, &point2);
+    ge_p1p1_to_p2(&point2, &point3);
+    ge_tobytes(reinterpret_cast<unsigned char *>(&derivations[i]), &point2);
+  }
+}
+
 static void derivation_to_scalar(const KeyDerivation &derivation, size_t output_index, EllipticCurveScalar &res) {
   struct {
     KeyDerivation derivation;
@@ -514,4 +534,92 @@ bool crypto_ops::check_ring_signature(const Hash &prefix_hash, const KeyImage &i
          reinterpret_cast<unsigned char *>(&sum));
   return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
 }
+
+struct RingSignatureVerifier::KeyTables {
+  bool valid;
+  ge_dsmp key;
+  ge_dsmp hashedKey;
+};
+
+RingSignatureVerifier::RingSignatureVerifier() {
+}
+
+RingSignatureVerifier::~RingSignatureVerifier() {
+}
+
+void RingSignatureVerifier::reserve(size_t count) {
+  m_keys.reserve(count);
+  m_tables.reserve(count);
+  m_index.reserve(count);
+}
+
+void RingSignatureVerifier::addKey(const PublicKey &key) {
+  if (m_index.emplace(key, m_keys.size()).second) {
+    m_keys.push_back(key);
+    m_tables.emplace_back(std::make_unique<KeyTables>());
+    m_tables.back()->valid = false;
+  }
+}
+
+size_t RingSignatureVerifier::keyCount() const {
+  return m_keys.size();
+}
+
+void RingSignatureVerifier::prepare(size_t index) {
+  assert(index < m_keys.size());
+  auto &tables = *m_tables[index];
+  ge_p3 point;
+  if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char *>(&m_keys[index])) != 0) {
+    tables.valid = false;
+    return;
+  }
+  ge_dsm_precomp(tables.key, &point);
+  hash_to_ec(m_keys[index], point);
+  ge_dsm_precomp(tables.hashedKey, &point);
+  tables.valid = true;
+}
+
+bool RingSignatureVerifier::checkRingSignature(const Hash &prefix_hash, const KeyImage &image,
+                                               const PublicKey *const *pubs, size_t pubs_count,
+                                               const Signature *sig) const {
+  const KeyTables **tables = reinterpret_cast<const KeyTables **>(alloca(pubs_count * sizeof(const KeyTables *)));
+  for (size_t i = 0; i < pubs_count; i++) {
+    const auto search = m_index.find(*pubs[i]);
+    if (search == m_index.end() || !m_tables[search->second]->valid) {
+      return check_ring_signature(prefix_hash, image, pubs, pubs_count, sig);
+    }
+    tables[i] = m_tables[search->second].get();
+  }
+
+  ge_p3 image_unp;
+  ge_dsmp image_pre;
+  EllipticCurveScalar sum, h;
+  rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs_count)));
+  if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&image)) != 0) {
+    return false;
+  }
+  ge_dsm_precomp(image_pre, &image_unp);
+  sc_0(reinterpret_cast<unsigned char *>(&sum));
+  buf->h = prefix_hash;
+  for (size_t i = 0; i < pubs_count; i++) {
+    ge_p2 tmp2;
+    if (sc_check(reinterpret_cast<const unsigned char *>(&sig[i])) != 0 ||
+        sc_check(reinterpret_cast<const unsigned char *>(&sig[i]) + 32) != 0) {
+      return false;
+    }
+    ge_double_scalarmult_base_precomp_vartime(&tmp2, reinterpret_cast<const unsigned char *>(&sig[i]), tables[i]->key,
+                                              reinterpret_cast<const unsigned char *>(&sig[i]) + 32);
+    ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &tmp2);
+    ge_double_scalarmult_precomp2_vartime(&tmp2, reinterpret_cast<const unsigned char *>(&sig[i]) + 32,
+                                          tables[i]->hashedKey, reinterpret_cast<const unsigned char *>(&sig[i]),
+                                          image_pre);
+    ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &tmp2);
+    sc_add(reinterpret_cast<unsigned char *>(&sum), reinterpret_cast<unsigned char *>(&sum),
+           reinterpret_cast<const unsigned char *>(&sig[i]));
+  }
+  hash_to_scalar(buf, rs_comm_size(pubs_count), h);
+  sc_sub(reinterpret_cast<unsigned char *>(&h), reinterpret_cast<unsigned char *>(&h),
+         reinterpret_cast<unsigned char *>(&sum));
+  return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
+}
 }  // namespace Crypto
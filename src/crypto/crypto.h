@@ -9,8 +9,10 @@
 
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <Xi/Exceptional.hpp>
@@ -63,6 +65,8 @@ class crypto_ops {
   friend bool secret_key_to_public_key(const SecretKey &, PublicKey &);
   static bool generate_key_derivation(const PublicKey &, const SecretKey &, KeyDerivation &);
   friend bool generate_key_derivation(const PublicKey &, const SecretKey &, KeyDerivation &);
+  static void generate_key_derivations(const PublicKey *, size_t, const SecretKey &, KeyDerivation *, bool *);
+  friend void generate_key_derivations(const PublicKey *, size_t, const SecretKey &, KeyDerivation *, bool *);
   static bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
   friend bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
   friend bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t *, size_t, PublicKey &);
@@ -147,6 +151,14 @@ inline bool generate_key_derivation(const PublicKey &key1, const SecretKey &key2
   return crypto_ops::generate_key_derivation(key1, key2, derivation);
 }
 
+/* Batched generate_key_derivation for many transaction keys and one view key, the secret is decomposed only once.
+ * valid[i] is false if keys[i] is not a valid point, derivations[i] is left untouched in that case.
+ */
+inline void generate_key_derivations(const PublicKey *keys, size_t count, const SecretKey &secret,
+                                     KeyDerivation *derivations, bool *valid) {
+  crypto_ops::generate_key_derivations(keys, count, secret, derivations, valid);
+}
+
 inline bool derive_public_key(const KeyDerivation &derivation, size_t output_index, const PublicKey &base,
                               const uint8_t *prefix, size_t prefixLength, PublicKey &derived_key) {
   return crypto_ops::derive_public_key(derivation, output_index, base, prefix, prefixLength, derived_key);
@@ -236,4 +248,34 @@ inline bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
   return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig);
 }
 
+/* Verifies many ring signatures sharing public keys, ie. all rings of a block.
+ * * Every key is registered once using addKey, afterwards prepare computes the decompressed point tables of the key and
+ * its hash_to_ec image. prepare may be called concurrently for distinct indices.
+ * * Once all keys are prepared checkRingSignature is thread safe and yields exactly the same result as
+ * check_ring_signature, rings containing keys that were not registered fall back to check_ring_signature.
+ */
+class RingSignatureVerifier {
+ public:
+  RingSignatureVerifier();
+  ~RingSignatureVerifier();
+
+  RingSignatureVerifier(const RingSignatureVerifier &) = delete;
+  RingSignatureVerifier &operator=(const RingSignatureVerifier &) = delete;
+
+  void reserve(size_t count);
+  void addKey(const PublicKey &key);
+  size_t keyCount() const;
+  void prepare(size_t index);
+
+  bool checkRingSignature(const Hash &prefix_hash, const KeyImage &image, const PublicKey *const *pubs,
+                          size_t pubs_count, const Signature *sig) const;
+
+ private:
+  struct KeyTables;
+
+  std::vector<PublicKey> m_keys;
+  std::vector<std::unique_ptr<KeyTables>> m_tables;
+  std::unordered_map<PublicKey, size_t> m_index;
+};
+
 }  // namespace Crypto
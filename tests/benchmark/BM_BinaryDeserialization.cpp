@@ -0,0 +1,142 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <Common/MemoryInputStream.h>
+#include <Serialization/BinaryInputStreamSerializer.h>
+#include <Serialization/BinarySpanInputSerializer.hpp>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+
+namespace {
+/// Serialized transfers of a block, each spending two inputs with a ring size of eleven into four outputs.
+struct BlockTransactions {
+  static constexpr size_t TransactionCount = 64;
+  static constexpr size_t InputsPerTransaction = 2;
+  static constexpr size_t RingSize = 11;
+  static constexpr size_t OutputsPerTransaction = 4;
+
+  std::vector<CryptoNote::BinaryArray> blobs;
+  size_t totalSize = 0;
+
+  static const BlockTransactions& instance() {
+    static const BlockTransactions data{};
+    return data;
+  }
+
+ private:
+  template <typename _BlobT>
+  static void randomize(_BlobT& blob, std::mt19937_64& random) {
+    for (size_t i = 0; i < blob.size(); ++i) {
+      blob.data()[i] = static_cast<uint8_t>(random());
+    }
+  }
+
+  BlockTransactions() {
+    using namespace Xi::Blockchain::Transaction;
+
+    std::mt19937_64 random{0x5eed};
+    for (size_t i = 0; i < TransactionCount; ++i) {
+      CryptoNote::Transaction transaction{};
+      transaction.version = 1;
+      transaction.type = Type::Transfer;
+      transaction.extra.features = ExtraFeature::PublicKey;
+      transaction.extra.publicKey.emplace();
+      randomize(*transaction.extra.publicKey, random);
+
+      SignatureVector signatures{};
+      for (size_t j = 0; j < InputsPerTransaction; ++j) {
+        AmountInput input{};
+        input.amount = CanonicalAmount{(j + 1) * 1000000};
+        randomize(input.keyImage, random);
+        for (size_t k = 0; k < RingSize; ++k) {
+          input.outputIndices.push_back(static_cast<GlobalDeltaIndex>(random() % (k == 0 ? 2000000 : 20000) + 1));
+        }
+        transaction.inputs.emplace_back(std::move(input));
+
+        RingSignature ringSignature(RingSize);
+        for (auto& signature : ringSignature) {
+          randomize(signature, random);
+        }
+        signatures.emplace_back(std::move(ringSignature));
+      }
+      transaction.signatures = SignatureCollection{std::move(signatures)};
+
+      for (size_t j = 0; j < OutputsPerTransaction; ++j) {
+        KeyOutputTarget target{};
+        randomize(target.key, random);
+        transaction.outputs.emplace_back(AmountOutput{CanonicalAmount{(j + 1) * 100000}, OutputTarget{target}});
+      }
+
+      blobs.emplace_back(CryptoNote::toBinaryArray(transaction));
+      totalSize += blobs.back().size();
+    }
+  }
+};
+
+/// The parse path fromBinaryArray used before, every read goes through the virtual Common::IInputStream.
+CryptoNote::Transaction parseFromStream(const CryptoNote::BinaryArray& blob) {
+  CryptoNote::Transaction transaction{};
+  Common::MemoryInputStream stream(blob.data(), blob.size());
+  CryptoNote::BinaryInputStreamSerializer serializer(stream);
+  if (!serializer(transaction, "") || !stream.endOfStream()) {
+    throw std::runtime_error{"deserialization failed"};
+  }
+  return transaction;
+}
+}  // namespace
+
+static void BM_ParseTransactions_Stream(benchmark::State& state) {
+  const auto& data = BlockTransactions::instance();
+  for (auto _ : state) {
+    (void)_;
+    for (const auto& blob : data.blobs) {
+      auto transaction = parseFromStream(blob);
+      benchmark::DoNotOptimize(transaction.inputs.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * data.blobs.size()));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.totalSize));
+}
+
+static void BM_ParseTransactions_Span(benchmark::State& state) {
+  const auto& data = BlockTransactions::instance();
+  for (auto _ : state) {
+    (void)_;
+    for (const auto& blob : data.blobs) {
+      auto transaction = CryptoNote::fromBinaryArray<CryptoNote::Transaction>(blob);
+      benchmark::DoNotOptimize(transaction.inputs.data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * data.blobs.size()));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.totalSize));
+}
+
+BENCHMARK(BM_ParseTransactions_Stream)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseTransactions_Span)->Unit(benchmark::kMicrosecond);
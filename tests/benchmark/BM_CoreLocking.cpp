@@ -0,0 +1,196 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <Xi/FileSystem.h>
+#include <System/Dispatcher.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Account.h>
+#include <CryptoNoteCore/CachedBlock.h>
+#include <CryptoNoteCore/Checkpoints.h>
+#include <CryptoNoteCore/Core.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/DatabaseBlockchainCache.h>
+#include <CryptoNoteCore/DatabaseBlockchainCacheFactory.h>
+#include <CryptoNoteCore/MainChainStorage.h>
+#include <CryptoNoteCore/RocksDBWrapper.h>
+
+namespace {
+/*!
+ * A core on the unit tests network with a short chain mined on top of the genesis block. Blocks are mined by the
+ * benchmark itself, the network difficulty is low enough to keep that cheap.
+ */
+class CoreEnvironment {
+ public:
+  static constexpr uint32_t InitialBlocks = 64;
+
+  static CoreEnvironment& instance() {
+    static CoreEnvironment environment{};
+    return environment;
+  }
+
+  CryptoNote::Core& core() {
+    return *m_core;
+  }
+
+  const CryptoNote::AccountPublicAddress& minerAddress() const {
+    return m_miner.getAccountKeys().address;
+  }
+
+  bool mineAndSubmitBlock() {
+    using namespace CryptoNote;
+    BlockTemplate block;
+    uint64_t difficulty = 0;
+    uint32_t index = 0;
+    if (!m_core->getBlockTemplate(block, minerAddress(), difficulty, index)) {
+      return false;
+    }
+    while (!m_currency->checkProofOfWork(CachedBlock{block}, difficulty)) {
+      block.nonce.advance(1);
+    }
+    return m_core->submitBlock(toBinaryArray(block)) == error::AddBlockErrorCode::ADDED_TO_MAIN;
+  }
+
+ private:
+  CoreEnvironment() {
+    using namespace CryptoNote;
+    Xi::FileSystem::removeDircetoryIfExists(m_dir).throwOnError();
+    Xi::FileSystem::ensureDirectoryExists(m_dir).throwOnError();
+    m_currency = std::make_unique<Currency>(CurrencyBuilder{m_logger}.network("UnitTests.Network").currency());
+    m_checkpoints = std::make_unique<Checkpoints>(m_logger);
+    DataBaseConfig config{};
+    config.setDataDir(m_dir);
+    m_database = std::make_unique<RocksDBWrapper>(m_logger);
+    m_database->init(config);
+    if (!DatabaseBlockchainCache::checkDBSchemeVersion(*m_database, m_logger)) {
+      throw std::runtime_error{"unable to initialize the benchmark database"};
+    }
+    m_core = std::make_unique<Core>(*m_currency, m_logger, *m_checkpoints, m_dispatcher, false,
+                                    std::make_unique<DatabaseBlockchainCacheFactory>(*m_database, m_logger),
+                                    createSwappedMainChainStorage(m_dir, *m_currency));
+    if (!m_core->load()) {
+      throw std::runtime_error{"unable to load the benchmark core"};
+    }
+    m_miner.generate();
+    for (uint32_t i = 0; i < InitialBlocks; ++i) {
+      if (!mineAndSubmitBlock()) {
+        throw std::runtime_error{"unable to mine the benchmark chain"};
+      }
+    }
+  }
+
+  ~CoreEnvironment() {
+    m_core.reset();
+    m_database->shutdown();
+  }
+
+ private:
+  std::string m_dir{"./core_locking_benchmark"};
+  Logging::ConsoleLogger m_logger{Logging::Error};
+  System::Dispatcher m_dispatcher{};
+  std::unique_ptr<CryptoNote::Currency> m_currency;
+  std::unique_ptr<CryptoNote::Checkpoints> m_checkpoints;
+  std::unique_ptr<CryptoNote::RocksDBWrapper> m_database;
+  std::unique_ptr<CryptoNote::Core> m_core;
+  CryptoNote::AccountBase m_miner{};
+};
+
+/*!
+ * Runs the readers of the core, optionally while an importer keeps mining and submitting blocks. Readers take a
+ * shared core lock, block templates additionally lock the transaction pool.
+ */
+class CoreLockingBenchmark : public benchmark::Fixture {
+ public:
+  std::atomic_bool isImporting{false};
+  std::thread importer;
+
+  void SetUp(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    auto& environment = CoreEnvironment::instance();
+    if (state.range(0) != 0) {
+      isImporting = true;
+      importer = std::thread{[this, &environment]() {
+        while (isImporting) {
+          environment.mineAndSubmitBlock();
+        }
+      }};
+    }
+  }
+
+  void TearDown(const benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    isImporting = false;
+    if (importer.joinable()) {
+      importer.join();
+    }
+  }
+};
+}  // namespace
+
+BENCHMARK_DEFINE_F(CoreLockingBenchmark, BM_CoreBlockTemplate)(benchmark::State& state) {
+  auto& environment = CoreEnvironment::instance();
+  for (auto _ : state) {
+    (void)_;
+    CryptoNote::BlockTemplate block;
+    uint64_t difficulty = 0;
+    uint32_t index = 0;
+    benchmark::DoNotOptimize(environment.core().getBlockTemplate(block, environment.minerAddress(), difficulty, index));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(CoreLockingBenchmark, BM_CoreGetBlocks)(benchmark::State& state) {
+  auto& core = CoreEnvironment::instance().core();
+  uint32_t seed = static_cast<uint32_t>(state.thread_index()) * 7919;
+  for (auto _ : state) {
+    (void)_;
+    benchmark::DoNotOptimize(core.getBlocks(seed++ % CoreEnvironment::InitialBlocks, 1));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Argument 0 measures reads only, 1 with a concurrent block import.
+BENCHMARK_REGISTER_F(CoreLockingBenchmark, BM_CoreBlockTemplate)
+    ->ArgName("import")
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_REGISTER_F(CoreLockingBenchmark, BM_CoreGetBlocks)
+    ->ArgName("import")
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
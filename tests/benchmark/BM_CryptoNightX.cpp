@@ -39,3 +39,36 @@ BENCHMARK_DEFINE_F(HashBasedBenchmark, BM_CryptoNightX)(benchmark::State& state)
 }
 
 BENCHMARK_REGISTER_F(HashBasedBenchmark, BM_CryptoNightX)->Unit(benchmark::kMillisecond)->Iterations(2)->Threads(1);
+
+BENCHMARK_DEFINE_F(HashBasedBenchmark, BM_CryptoNightX_TreeEngine)(benchmark::State& state) {
+  unsigned char const* data = HashBasedBenchmark::data();
+  const auto insertions = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    (void)_;
+    for (std::size_t i = 0; i < BlockCount; ++i)
+      Xi::ProofOfWork::Cnx::cnx(Xi::ConstByteSpan{data + i * BlockSize, BlockSize}, HashPlaceholder, insertions);
+  }
+}
+
+BENCHMARK_DEFINE_F(HashBasedBenchmark, BM_CryptoNightX_FlatEngine)(benchmark::State& state) {
+  unsigned char const* data = HashBasedBenchmark::data();
+  const auto insertions = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    (void)_;
+    for (std::size_t i = 0; i < BlockCount; ++i)
+      Xi::ProofOfWork::Cnx::cnxFlat(Xi::ConstByteSpan{data + i * BlockSize, BlockSize}, HashPlaceholder, insertions);
+  }
+}
+
+BENCHMARK_REGISTER_F(HashBasedBenchmark, BM_CryptoNightX_TreeEngine)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Threads(1);
+BENCHMARK_REGISTER_F(HashBasedBenchmark, BM_CryptoNightX_FlatEngine)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Threads(1);
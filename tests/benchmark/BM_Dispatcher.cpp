@@ -0,0 +1,89 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+#include <System/Context.h>
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+
+namespace {
+/// Yields a fixed number of times, each yield is one round trip through the dispatcher queue.
+void yieldRepeatedly(System::Dispatcher& dispatcher, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dispatcher.yield();
+  }
+}
+}  // namespace
+
+/// Spawns short lived contexts, measures context creation on top of the reusable context list.
+static void BM_DispatcherSpawn(benchmark::State& state) {
+  const auto batch = static_cast<size_t>(state.range(0));
+  System::Dispatcher dispatcher;
+  for (auto _ : state) {
+    (void)_;
+    System::ContextGroup group{dispatcher};
+    for (size_t i = 0; i < batch; ++i) {
+      group.spawn([] {});
+    }
+    group.wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+
+/// Two contexts handing control to each other, one item equals one context switch.
+static void BM_DispatcherPingPong(benchmark::State& state) {
+  constexpr size_t Rounds = 1000;
+  System::Dispatcher dispatcher;
+  for (auto _ : state) {
+    (void)_;
+    System::ContextGroup group{dispatcher};
+    group.spawn([&dispatcher] { yieldRepeatedly(dispatcher, Rounds); });
+    group.spawn([&dispatcher] { yieldRepeatedly(dispatcher, Rounds); });
+    group.wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Rounds * 2));
+}
+
+/// Many contexts yielding in turn, touches one stack after another as a loaded node does.
+static void BM_DispatcherSwitchFanOut(benchmark::State& state) {
+  constexpr size_t Rounds = 16;
+  const auto contexts = static_cast<size_t>(state.range(0));
+  System::Dispatcher dispatcher;
+  for (auto _ : state) {
+    (void)_;
+    System::ContextGroup group{dispatcher};
+    for (size_t i = 0; i < contexts; ++i) {
+      group.spawn([&dispatcher] { yieldRepeatedly(dispatcher, Rounds); });
+    }
+    group.wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * contexts * Rounds));
+}
+
+BENCHMARK(BM_DispatcherSpawn)->ArgName("contexts")->Arg(1)->Arg(64)->Arg(1024);
+BENCHMARK(BM_DispatcherPingPong);
+BENCHMARK(BM_DispatcherSwitchFanOut)->ArgName("contexts")->Arg(16)->Arg(256)->Arg(2048);
@@ -0,0 +1,160 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <Rpc/CoreRpcServerCommandsDefinitions.h>
+#include <Serialization/SerializationTools.h>
+
+namespace {
+/// A /queryblocksdetailed response, every block carries transfers spending two inputs with a ring size of eleven.
+class DetailedBlocksResponse {
+ public:
+  static constexpr size_t TransactionsPerBlock = 16;
+  static constexpr size_t InputsPerTransaction = 2;
+  static constexpr size_t RingSize = 11;
+  static constexpr size_t OutputsPerTransaction = 4;
+
+  static const CryptoNote::COMMAND_RPC_QUERY_BLOCKS_DETAILED::response& instance(size_t blockCount) {
+    static std::map<size_t, DetailedBlocksResponse> responses{};
+    auto search = responses.find(blockCount);
+    if (search == responses.end()) {
+      search = responses.emplace(blockCount, DetailedBlocksResponse{blockCount}).first;
+    }
+    return search->second.m_response;
+  }
+
+ private:
+  template <typename _BlobT>
+  static void randomize(_BlobT& blob, std::mt19937_64& random) {
+    for (size_t i = 0; i < blob.size(); ++i) {
+      blob.data()[i] = static_cast<uint8_t>(random());
+    }
+  }
+
+  explicit DetailedBlocksResponse(size_t blockCount) {
+    using namespace Xi::Blockchain::Transaction;
+
+    std::mt19937_64 random{0x15011};
+    m_response.status = CORE_RPC_STATUS_OK;
+    m_response.start_height = CryptoNote::BlockHeight::fromIndex(0);
+    m_response.current_height = CryptoNote::BlockHeight::fromIndex(static_cast<uint32_t>(blockCount));
+    m_response.full_offset = 0;
+    m_response.blocks.resize(blockCount);
+
+    for (size_t i = 0; i < blockCount; ++i) {
+      auto& block = m_response.blocks[i];
+      block.timestamp = 1554000000 + i * 60;
+      block.height = CryptoNote::BlockHeight::fromIndex(static_cast<uint32_t>(i));
+      randomize(block.hash, random);
+      randomize(block.prevBlockHash, random);
+      block.difficulty = random();
+      block.reward = random() % 100000000;
+
+      block.transactions.resize(TransactionsPerBlock);
+      for (auto& transaction : block.transactions) {
+        randomize(transaction.hash, random);
+        randomize(transaction.blockHash, random);
+        randomize(transaction.extra.publicKey, random);
+        transaction.blockHeight = block.height;
+        transaction.inBlockchain = true;
+        transaction.mixin = RingSize - 1;
+
+        SignatureVector signatures{};
+        for (size_t j = 0; j < InputsPerTransaction; ++j) {
+          CryptoNote::KeyInputDetails input{};
+          input.input.amount = CanonicalAmount{(j + 1) * 1000000};
+          randomize(input.input.keyImage, random);
+          for (size_t k = 0; k < RingSize; ++k) {
+            input.input.outputIndices.push_back(static_cast<GlobalDeltaIndex>(random() % 20000 + 1));
+          }
+          input.mixin = RingSize - 1;
+          randomize(input.output.transactionHash, random);
+          transaction.inputs.emplace_back(std::move(input));
+
+          RingSignature ringSignature(RingSize);
+          for (auto& signature : ringSignature) {
+            randomize(signature, random);
+          }
+          signatures.emplace_back(std::move(ringSignature));
+        }
+        transaction.signatures = SignatureCollection{std::move(signatures)};
+
+        for (size_t j = 0; j < OutputsPerTransaction; ++j) {
+          KeyOutputTarget target{};
+          randomize(target.key, random);
+          transaction.outputs.emplace_back(CryptoNote::TransactionOutputDetails{
+              AmountOutput{CanonicalAmount{(j + 1) * 100000}, OutputTarget{target}}, random() % 2000000});
+        }
+      }
+    }
+  }
+
+  CryptoNote::COMMAND_RPC_QUERY_BLOCKS_DETAILED::response m_response{};
+};
+}  // namespace
+
+/// The previous response path, a JsonValue tree built by the JsonOutputStreamSerializer and then stringified.
+static void BM_JsonResponse_Tree(benchmark::State& state) {
+  const auto& response = DetailedBlocksResponse::instance(static_cast<size_t>(state.range(0)));
+  size_t bodySize = 0;
+  for (auto _ : state) {
+    (void)_;
+    std::string body{};
+    if (!CryptoNote::storeToJson(response, body)) {
+      throw std::runtime_error{"json serialization failed"};
+    }
+    bodySize = body.size();
+    benchmark::DoNotOptimize(body.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bodySize));
+  state.counters["body_size"] = static_cast<double>(bodySize);
+}
+
+/// The streamed path as used by jsonMethod, the buffer is reserved by the size of the previous response.
+static void BM_JsonResponse_Streamed(benchmark::State& state) {
+  const auto& response = DetailedBlocksResponse::instance(static_cast<size_t>(state.range(0)));
+  size_t bodySizeHint = 0;
+  for (auto _ : state) {
+    (void)_;
+    std::string body{};
+    body.reserve(bodySizeHint);
+    if (!CryptoNote::storeToJsonBuffer(response, body)) {
+      throw std::runtime_error{"json serialization failed"};
+    }
+    bodySizeHint = body.size();
+    benchmark::DoNotOptimize(body.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bodySizeHint));
+  state.counters["body_size"] = static_cast<double>(bodySizeHint);
+}
+
+BENCHMARK(BM_JsonResponse_Tree)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JsonResponse_Streamed)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
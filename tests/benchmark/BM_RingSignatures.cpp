@@ -0,0 +1,107 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <crypto/crypto.h>
+
+namespace {
+struct Ring {
+  Crypto::Hash prefix;
+  Crypto::KeyImage image;
+  std::vector<const Crypto::PublicKey*> keys;
+  std::vector<Crypto::Signature> signatures;
+};
+
+/// Generates rings as found in a block, each ring draws its members from a shared pool of outputs.
+class RingSignatureBenchmark : public benchmark::Fixture {
+ public:
+  static constexpr size_t RingSize = 8;
+  static constexpr size_t RingCount = 128;
+  static constexpr size_t PoolSize = 256;
+
+  std::vector<Crypto::PublicKey> publicKeys;
+  std::vector<Crypto::SecretKey> secretKeys;
+  std::vector<Ring> rings;
+
+  void SetUp(const benchmark::State&) override {
+    if (!rings.empty()) {
+      return;
+    }
+    publicKeys.resize(PoolSize);
+    secretKeys.resize(PoolSize);
+    for (size_t i = 0; i < PoolSize; ++i) {
+      Crypto::generate_keys(publicKeys[i], secretKeys[i]);
+    }
+
+    rings.resize(RingCount);
+    for (size_t i = 0; i < RingCount; ++i) {
+      auto& ring = rings[i];
+      ring.prefix = Crypto::Hash::compute(Xi::asConstByteSpan(&i, sizeof(i))).takeOrThrow();
+      for (size_t j = 0; j < RingSize; ++j) {
+        ring.keys.push_back(std::addressof(publicKeys[(i * 7 + j * 13) % PoolSize]));
+      }
+      const size_t realIndex = i % RingSize;
+      const size_t realKey = (i * 7 + realIndex * 13) % PoolSize;
+      Crypto::generate_key_image(publicKeys[realKey], secretKeys[realKey], ring.image);
+      ring.signatures.resize(RingSize);
+      Crypto::generate_ring_signature(ring.prefix, ring.image, ring.keys, secretKeys[realKey], realIndex,
+                                      ring.signatures.data());
+    }
+  }
+};
+}  // namespace
+
+BENCHMARK_DEFINE_F(RingSignatureBenchmark, BM_RingSignature_PerInput)(benchmark::State& state) {
+  for (auto _ : state) {
+    (void)_;
+    for (const auto& ring : rings) {
+      benchmark::DoNotOptimize(
+          Crypto::check_ring_signature(ring.prefix, ring.image, ring.keys, ring.signatures.data()));
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(RingSignatureBenchmark, BM_RingSignature_Block)(benchmark::State& state) {
+  for (auto _ : state) {
+    (void)_;
+    Crypto::RingSignatureVerifier verifier{};
+    for (const auto& ring : rings) {
+      for (const auto key : ring.keys) {
+        verifier.addKey(*key);
+      }
+    }
+    for (size_t i = 0; i < verifier.keyCount(); ++i) {
+      verifier.prepare(i);
+    }
+    for (const auto& ring : rings) {
+      benchmark::DoNotOptimize(verifier.checkRingSignature(ring.prefix, ring.image, ring.keys.data(),
+                                                           ring.keys.size(), ring.signatures.data()));
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(RingSignatureBenchmark, BM_RingSignature_PerInput)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(RingSignatureBenchmark, BM_RingSignature_Block)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,122 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <Common/VectorOutputStream.h>
+#include <Logging/ConsoleLogger.h>
+#include <Serialization/BinaryOutputStreamSerializer.h>
+#include <CryptoNoteCore/BlockchainReadBatch.h>
+#include <CryptoNoteCore/BlockchainWriteBatch.h>
+#include <CryptoNoteCore/CryptoNoteSerialization.h>
+#include <CryptoNoteCore/RocksDBWrapper.h>
+
+namespace {
+/*!
+ * Serves block requests of a syncing peer, raw blocks are read from the database and encoded into the wire format
+ * of a get objects response.
+ */
+class ServeBlocksBenchmark : public benchmark::Fixture {
+ public:
+  static constexpr uint32_t StoredBlocks = 2000;
+  static constexpr size_t TransactionsPerBlock = 16;
+  static constexpr size_t TransactionBlobSize = 2048;
+
+  std::string dir{"./serve_blocks_benchmark"};
+  Logging::ConsoleLogger logger{Logging::Error};
+  std::unique_ptr<CryptoNote::RocksDBWrapper> database;
+
+  void SetUp(const benchmark::State&) override {
+    using namespace CryptoNote;
+
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+    Xi::FileSystem::ensureDirectoryExists(dir).throwOnError();
+    DataBaseConfig config{};
+    config.setDataDir(dir);
+    database = std::make_unique<RocksDBWrapper>(logger);
+    database->init(config);
+
+    BlockchainWriteBatch batch{};
+    for (uint32_t index = 0; index < StoredBlocks; ++index) {
+      RawBlock block{};
+      block.blockTemplate.resize(512, static_cast<uint8_t>(index));
+      block.transactions.resize(TransactionsPerBlock, BinaryArray(TransactionBlobSize, static_cast<uint8_t>(index)));
+      batch.insertRawBlock(index, block);
+    }
+    if (database->write(batch)) {
+      throw std::runtime_error{"failed to populate benchmark database"};
+    }
+  }
+
+  void TearDown(const benchmark::State&) override {
+    database->shutdown();
+    database.reset();
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+  }
+};
+}  // namespace
+
+BENCHMARK_DEFINE_F(ServeBlocksBenchmark, BM_ServeBlocks)(benchmark::State& state) {
+  using namespace CryptoNote;
+
+  const auto blocksPerRequest = static_cast<uint32_t>(state.range(0));
+  uint32_t offset = 0;
+  size_t bytesServed = 0;
+  for (auto _ : state) {
+    (void)_;
+    BlockchainReadBatch request{};
+    for (uint32_t i = 0; i < blocksPerRequest; ++i) {
+      request.requestRawBlock((offset + i) % StoredBlocks);
+    }
+    offset = (offset + blocksPerRequest) % StoredBlocks;
+    if (database->read(request)) {
+      state.SkipWithError("database read failed");
+      break;
+    }
+
+    auto rawBlocks = request.extractResult().takeRawBlocks();
+    BinaryArray response{};
+    Common::VectorOutputStream stream{response};
+    BinaryOutputStreamSerializer serializer{stream};
+    for (auto& rawBlock : rawBlocks) {
+      if (!serialize(rawBlock.second, serializer)) {
+        state.SkipWithError("block encoding failed");
+        break;
+      }
+    }
+    bytesServed += response.size();
+    benchmark::DoNotOptimize(response.data());
+  }
+  state.SetItemsProcessed(state.iterations() * blocksPerRequest);
+  state.SetBytesProcessed(static_cast<int64_t>(bytesServed));
+}
+
+BENCHMARK_REGISTER_F(ServeBlocksBenchmark, BM_ServeBlocks)->ArgName("blocks")->Arg(1)->Arg(20)->Arg(100);
@@ -0,0 +1,115 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include <crypto/crypto.h>
+#include <Transfers/SpendKeyIndex.h>
+
+namespace {
+/// Transactions of a block, a quarter of their outputs pay to one of the subscribed addresses.
+struct ScanData {
+  static constexpr size_t MaxAddressCount = 100000;
+  static constexpr size_t TransactionCount = 64;
+  static constexpr size_t OutputsPerTransaction = 4;
+
+  Crypto::PublicKey viewPublicKey;
+  Crypto::SecretKey viewSecretKey;
+  std::vector<Crypto::PublicKey> spendKeys;
+  std::vector<Crypto::PublicKey> transactionKeys;
+  std::vector<std::vector<Crypto::PublicKey>> outputKeys;
+
+  static const ScanData& instance() {
+    static const ScanData data{};
+    return data;
+  }
+
+ private:
+  ScanData() {
+    Crypto::generate_keys(viewPublicKey, viewSecretKey);
+    spendKeys.resize(MaxAddressCount);
+    for (auto& spendKey : spendKeys) {
+      Crypto::SecretKey spendSecretKey{};
+      Crypto::generate_keys(spendKey, spendSecretKey);
+    }
+
+    transactionKeys.resize(TransactionCount);
+    outputKeys.resize(TransactionCount);
+    for (size_t i = 0; i < TransactionCount; ++i) {
+      Crypto::SecretKey transactionSecretKey{};
+      Crypto::generate_keys(transactionKeys[i], transactionSecretKey);
+      Crypto::KeyDerivation derivation{};
+      Crypto::generate_key_derivation(viewPublicKey, transactionSecretKey, derivation);
+      for (size_t j = 0; j < OutputsPerTransaction; ++j) {
+        Crypto::PublicKey receiver{};
+        if (j == 0) {
+          // the first subscribed address is part of every index size
+          receiver = spendKeys.front();
+        } else {
+          Crypto::SecretKey receiverSecretKey{};
+          Crypto::generate_keys(receiver, receiverSecretKey);
+        }
+        Crypto::PublicKey outputKey{};
+        Crypto::derive_public_key(derivation, j, receiver, outputKey);
+        outputKeys[i].push_back(outputKey);
+      }
+    }
+  }
+};
+}  // namespace
+
+static void BM_SpendKeyScan(benchmark::State& state) {
+  const auto& data = ScanData::instance();
+  const auto addressCount = static_cast<size_t>(state.range(0));
+
+  CryptoNote::SpendKeyIndex<size_t> index{};
+  index.reserve(addressCount);
+  for (size_t i = 0; i < addressCount; ++i) {
+    index.insert(data.spendKeys[i], i);
+  }
+
+  std::vector<Crypto::KeyDerivation> derivations(data.transactionKeys.size());
+  std::unique_ptr<bool[]> isValid{new bool[data.transactionKeys.size()]};
+  for (auto _ : state) {
+    (void)_;
+    size_t matches = 0;
+    Crypto::generate_key_derivations(data.transactionKeys.data(), data.transactionKeys.size(), data.viewSecretKey,
+                                     derivations.data(), isValid.get());
+    for (size_t i = 0; i < data.outputKeys.size(); ++i) {
+      for (size_t j = 0; j < data.outputKeys[i].size(); ++j) {
+        Crypto::PublicKey spendKey{};
+        Crypto::underive_public_key(derivations[i], j, data.outputKeys[i][j], spendKey);
+        matches += index.find(spendKey) != nullptr ? 1 : 0;
+      }
+    }
+    benchmark::DoNotOptimize(matches);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(ScanData::TransactionCount * ScanData::OutputsPerTransaction));
+}
+
+BENCHMARK(BM_SpendKeyScan)->RangeMultiplier(10)->Range(1, ScanData::MaxAddressCount)->Unit(benchmark::kMicrosecond);
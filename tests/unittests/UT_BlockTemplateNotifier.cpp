@@ -0,0 +1,83 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+#include <Rpc/BlockTemplateNotifier.h>
+
+TEST(CryptoNote_BlockTemplateNotifier, WakesUpOnNotification) {
+  System::Dispatcher dispatcher;
+  CryptoNote::BlockTemplateNotifier notifier{dispatcher};
+
+  const auto start = std::chrono::steady_clock::now();
+  System::Context<bool> waiter{dispatcher, [&] { return notifier.wait(std::chrono::hours{1}); }};
+  dispatcher.yield();
+
+  std::thread remote{[&notifier] { notifier.notify(); }};
+  remote.join();
+  EXPECT_TRUE(waiter.get());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::minutes{1});
+}
+
+TEST(CryptoNote_BlockTemplateNotifier, WakesUpAllWaiters) {
+  System::Dispatcher dispatcher;
+  CryptoNote::BlockTemplateNotifier notifier{dispatcher};
+
+  System::Context<bool> first{dispatcher, [&] { return notifier.wait(std::chrono::hours{1}); }};
+  System::Context<bool> second{dispatcher, [&] { return notifier.wait(std::chrono::hours{1}); }};
+  dispatcher.yield();
+
+  notifier.notify();
+  notifier.notify();
+  EXPECT_TRUE(first.get());
+  EXPECT_TRUE(second.get());
+}
+
+TEST(CryptoNote_BlockTemplateNotifier, TimesOutWithoutNotification) {
+  System::Dispatcher dispatcher;
+  CryptoNote::BlockTemplateNotifier notifier{dispatcher};
+
+  const auto timeout = std::chrono::milliseconds{50};
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(notifier.wait(timeout));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, timeout);
+}
+
+TEST(CryptoNote_BlockTemplateNotifier, StopInterruptsWaiters) {
+  System::Dispatcher dispatcher;
+  CryptoNote::BlockTemplateNotifier notifier{dispatcher};
+
+  System::Context<bool> waiter{dispatcher, [&] { return notifier.wait(std::chrono::hours{1}); }};
+  dispatcher.yield();
+
+  notifier.stop();
+  EXPECT_THROW(waiter.get(), System::InterruptedException);
+  EXPECT_THROW(notifier.wait(std::chrono::milliseconds{1}), System::InterruptedException);
+}
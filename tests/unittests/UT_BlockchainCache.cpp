@@ -34,6 +34,7 @@
 #include <CryptoNoteCore/RocksDBWrapper.h>
 #include <CryptoNoteCore/DatabaseBlockchainCache.h>
 #include <CryptoNoteCore/DatabaseBlockchainCacheFactory.h>
+#include <CryptoNoteCore/Transactions/TransactionValidatiorState.h>
 
 namespace {
 
@@ -90,6 +91,30 @@ class CryptoNote_DatabaseBlockchainCache : public ::testing::Test {
     database.release();
     ASSERT_EQ(cache, nullptr);
   }
+
+  /// A block on top of genesis, the seed changes its coinbase and thereby every hash of it.
+  CryptoNote::BlockTemplate makeChildOfGenesis(uint8_t seed) const {
+    using namespace CryptoNote;
+
+    BlockTemplate block = currency->genesisBlock();
+    block.previousBlockHash = CachedBlock{currency->genesisBlock()}.getBlockHash();
+    block.timestamp = BlockTimestampShift{60};
+    block.baseTransaction.inputs = {BaseInput{BlockHeight::fromIndex(1)}};
+    block.baseTransaction.extra.features |= Xi::Blockchain::Transaction::ExtraFeature::PublicKey;
+    block.baseTransaction.extra.publicKey.emplace();
+    block.baseTransaction.extra.publicKey->nullify();
+    block.baseTransaction.extra.publicKey->data()[0] = seed;
+    return block;
+  }
+
+  void pushChildOfGenesis(const CryptoNote::BlockTemplate& block) {
+    using namespace CryptoNote;
+
+    RawBlock raw{};
+    raw.blockTemplate = toBinaryArray(block);
+    TransactionValidatorState validatorState{};
+    cache->pushBlock(CachedBlock{block}, {}, validatorState, raw.blockTemplate.size(), 0, 1, std::move(raw));
+  }
 };
 
 }  // namespace
@@ -126,6 +151,56 @@ TEST_F(CryptoNote_DatabaseBlockchainCache, TransactionHashConsistency) {
             genesisBlock.getBlock().staticRewardHash->toString());
 }
 
+TEST_F(CryptoNote_DatabaseBlockchainCache, ServesRepeatedBlocksAndTransactions) {
+  using namespace CryptoNote;
+
+  // peers may request the same block several times within one request
+  const std::vector<BlockHeight> heights{BlockHeight::Genesis, BlockHeight::Genesis, BlockHeight::Genesis};
+  const auto blocks = cache->getBlocks(heights);
+  const auto expected = toBinaryArray(currency->genesisBlock());
+  ASSERT_EQ(blocks.size(), heights.size());
+  for (const auto& block : blocks) {
+    EXPECT_EQ(block.blockTemplate, expected);
+  }
+
+  // coinbase and static reward share the genesis block
+  const auto coinbaseHash = CachedTransaction{cache->getRawTransaction(0, 0)}.getTransactionHash();
+  const auto staticRewardHash = CachedTransaction{cache->getRawTransaction(0, 1)}.getTransactionHash();
+  const std::vector<Crypto::Hash> ids{coinbaseHash, staticRewardHash, coinbaseHash};
+  const auto transactions = cache->getTransactions(ids);
+  ASSERT_EQ(transactions.size(), ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    EXPECT_EQ(transactions[i].getTransactionHash(), ids[i]);
+  }
+}
+
+TEST_F(CryptoNote_DatabaseBlockchainCache, InvalidatesCachedEntriesOnSplitAndRepush) {
+  using namespace CryptoNote;
+
+  const auto height = BlockHeight::fromIndex(1);
+  const auto first = makeChildOfGenesis(1);
+  const auto second = makeChildOfGenesis(2);
+  const auto firstCoinbase = CachedTransaction{first.baseTransaction}.getTransactionHash();
+  const auto secondCoinbase = CachedTransaction{second.baseTransaction}.getTransactionHash();
+  ASSERT_NE(firstCoinbase, secondCoinbase);
+
+  // reading populates the raw block and transaction info caches
+  pushChildOfGenesis(first);
+  ASSERT_EQ(cache->getBlocks(Xi::makeSpan(height)).front().blockTemplate, toBinaryArray(first));
+  ASSERT_EQ(cache->getTransactions(Xi::makeSpan(firstCoinbase)).front().getTransactionHash(), firstCoinbase);
+
+  auto segment = cache->split(1);
+  ASSERT_EQ(cache->getTopBlockIndex(), 0u);
+  EXPECT_ANY_THROW(cache->getBlocks(Xi::makeSpan(height)));
+  EXPECT_ANY_THROW(cache->getTransactions(Xi::makeSpan(firstCoinbase)));
+
+  // the height is reused by another block, nothing of the former one may be served
+  pushChildOfGenesis(second);
+  EXPECT_EQ(cache->getBlocks(Xi::makeSpan(height)).front().blockTemplate, toBinaryArray(second));
+  EXPECT_EQ(cache->getTransactions(Xi::makeSpan(secondCoinbase)).front().getTransactionHash(), secondCoinbase);
+  EXPECT_ANY_THROW(cache->getTransactions(Xi::makeSpan(firstCoinbase)));
+}
+
 //TEST_F(CryptoNote_DatabaseBlockchainCache, CachedBlockInfo) {
 //  using namespace CryptoNote;
 //  using namespace Xi::Crypto::Hash;
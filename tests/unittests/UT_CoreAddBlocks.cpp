@@ -0,0 +1,213 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <System/Dispatcher.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Account.h>
+#include <CryptoNoteCore/AddBlockErrors.h>
+#include <CryptoNoteCore/CachedBlock.h>
+#include <CryptoNoteCore/Checkpoints.h>
+#include <CryptoNoteCore/Core.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/DatabaseBlockchainCache.h>
+#include <CryptoNoteCore/DatabaseBlockchainCacheFactory.h>
+#include <CryptoNoteCore/MainChainStorage.h>
+#include <CryptoNoteCore/RocksDBWrapper.h>
+
+namespace {
+/// A core on its own database, all nodes of a test share the currency and thereby the genesis block.
+struct TestNode {
+  std::string dir;
+  std::unique_ptr<CryptoNote::Checkpoints> checkpoints;
+  std::unique_ptr<CryptoNote::RocksDBWrapper> database;
+  std::unique_ptr<CryptoNote::Core> core;
+
+  TestNode(std::string directory, const CryptoNote::Currency& currency, Logging::ILogger& logger,
+           System::Dispatcher& dispatcher)
+      : dir{std::move(directory)} {
+    using namespace CryptoNote;
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+    Xi::FileSystem::ensureDirectoryExists(dir).throwOnError();
+    checkpoints = std::make_unique<Checkpoints>(logger);
+    DataBaseConfig config{};
+    config.setDataDir(dir);
+    database = std::make_unique<RocksDBWrapper>(logger);
+    database->init(config);
+    EXPECT_TRUE(DatabaseBlockchainCache::checkDBSchemeVersion(*database, logger));
+    core = std::make_unique<Core>(currency, logger, *checkpoints, dispatcher, false,
+                                  std::make_unique<DatabaseBlockchainCacheFactory>(*database, logger),
+                                  createSwappedMainChainStorage(dir, currency));
+    EXPECT_TRUE(core->load());
+  }
+
+  ~TestNode() {
+    core.reset();
+    database->shutdown();
+    database.reset();
+  }
+};
+
+class CryptoNote_CoreAddBlocks : public ::testing::Test {
+ public:
+  Logging::ConsoleLogger logger{Logging::Error};
+  System::Dispatcher dispatcher{};
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::unique_ptr<TestNode> source;
+  CryptoNote::AccountBase miner{};
+
+  void SetUp() override {
+    using namespace CryptoNote;
+    currency = std::make_unique<Currency>(CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    source = std::make_unique<TestNode>("./core_add_blocks_source", *currency, logger, dispatcher);
+    miner.generate();
+  }
+
+  void TearDown() override {
+    source.reset();
+  }
+
+  std::unique_ptr<TestNode> makeNode(const std::string& name) {
+    return std::make_unique<TestNode>("./core_add_blocks_" + name, *currency, logger, dispatcher);
+  }
+
+  /// Queries a template on top of the source chain, the template may be altered before it is mined.
+  CryptoNote::BlockTemplate nextTemplate(uint64_t& difficulty) {
+    CryptoNote::BlockTemplate block;
+    uint32_t index = 0;
+    EXPECT_TRUE(source->core->getBlockTemplate(block, miner.getAccountKeys().address, difficulty, index));
+    return block;
+  }
+
+  CryptoNote::RawBlock mine(CryptoNote::BlockTemplate block, uint64_t difficulty) {
+    using namespace CryptoNote;
+    while (!currency->checkProofOfWork(CachedBlock{block}, difficulty)) {
+      block.nonce.advance(1);
+    }
+    return RawBlock{toBinaryArray(block), {}};
+  }
+
+  /// Mines the next block and adds it to the source chain.
+  CryptoNote::RawBlock mineOnSource() {
+    using namespace CryptoNote;
+    uint64_t difficulty = 0;
+    auto block = nextTemplate(difficulty);
+    auto raw = mine(std::move(block), difficulty);
+    auto blob = raw.blockTemplate;
+    EXPECT_EQ(source->core->submitBlock(std::move(blob)), error::AddBlockErrorCode::ADDED_TO_MAIN);
+    return raw;
+  }
+};
+
+CryptoNote::CachedBlock toCachedBlock(const CryptoNote::RawBlock& raw) {
+  return CryptoNote::CachedBlock{CryptoNote::fromBinaryArray<CryptoNote::BlockTemplate>(raw.blockTemplate)};
+}
+}  // namespace
+
+TEST_F(CryptoNote_CoreAddBlocks, BatchResultsMatchSingleAdds) {
+  using namespace CryptoNote;
+
+  const auto first = mineOnSource();
+  const auto second = mineOnSource();
+
+  // a block claiming a wrong height in its coinbase and a block building on it
+  uint64_t difficulty = 0;
+  auto invalidTemplate = nextTemplate(difficulty);
+  const auto invalidIndex = CachedBlock{invalidTemplate}.getBlockIndex();
+  invalidTemplate.baseTransaction.inputs = {BaseInput{BlockHeight::fromIndex(invalidIndex + 5)}};
+  const auto invalid = mine(invalidTemplate, difficulty);
+  auto orphanTemplate = invalidTemplate;
+  orphanTemplate.previousBlockHash = toCachedBlock(invalid).getBlockHash();
+  orphanTemplate.baseTransaction.inputs = {BaseInput{BlockHeight::fromIndex(invalidIndex + 1)}};
+  const auto orphan = mine(orphanTemplate, difficulty);
+
+  const auto third = mineOnSource();
+  const auto fourth = mineOnSource();
+
+  const std::vector<RawBlock> batch{first, second, invalid, orphan, third, second, fourth};
+  std::vector<CachedBlock> cachedBatch{};
+  for (const auto& raw : batch) {
+    cachedBatch.push_back(toCachedBlock(raw));
+  }
+
+  auto single = makeNode("single");
+  std::vector<std::error_code> singleResults{};
+  for (size_t i = 0; i < batch.size(); ++i) {
+    auto raw = batch[i];
+    singleResults.push_back(single->core->addBlock(cachedBatch[i], std::move(raw)));
+  }
+  ASSERT_EQ(singleResults[0], error::AddBlockErrorCode::ADDED_TO_MAIN);
+  ASSERT_NE(singleResults[2], error::AddBlockErrorCode::ADDED_TO_MAIN);
+  ASSERT_EQ(singleResults[3], error::AddBlockErrorCode::REJECTED_AS_ORPHANED);
+  ASSERT_EQ(singleResults[5], error::AddBlockErrorCode::ALREADY_EXISTS);
+  ASSERT_EQ(singleResults[6], error::AddBlockErrorCode::ADDED_TO_MAIN);
+
+  auto batched = makeNode("batched");
+  std::vector<std::error_code> batchResults(batch.size());
+  std::vector<size_t> processedIndices{};
+  auto rawBatch = batch;
+  const auto processed =
+      batched->core->addBlocks(cachedBatch, std::move(rawBatch), [&](size_t index, const std::error_code& ec) {
+        processedIndices.push_back(index);
+        batchResults[index] = ec;
+        return true;
+      });
+
+  EXPECT_EQ(processed, batch.size());
+  EXPECT_EQ(processedIndices, (std::vector<size_t>{0, 1, 2, 3, 4, 5, 6}));
+  for (size_t i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(batchResults[i], singleResults[i]) << "block " << i << ": " << batchResults[i].message() << " vs "
+                                                 << singleResults[i].message();
+  }
+  EXPECT_EQ(batched->core->getTopBlockIndex(), single->core->getTopBlockIndex());
+  EXPECT_EQ(batched->core->getTopBlockHash(), single->core->getTopBlockHash());
+  EXPECT_EQ(batched->core->getTopBlockHash(), source->core->getTopBlockHash());
+}
+
+TEST_F(CryptoNote_CoreAddBlocks, BatchStopsWhenCallbackDeclines) {
+  using namespace CryptoNote;
+
+  std::vector<RawBlock> batch{};
+  for (size_t i = 0; i < 3; ++i) {
+    batch.push_back(mineOnSource());
+  }
+  std::vector<CachedBlock> cachedBatch{};
+  for (const auto& raw : batch) {
+    cachedBatch.push_back(toCachedBlock(raw));
+  }
+
+  auto batched = makeNode("stopped");
+  const auto initialTopIndex = batched->core->getTopBlockIndex();
+  const auto processed = batched->core->addBlocks(
+      cachedBatch, std::move(batch), [](size_t index, const std::error_code&) { return index == 0; });
+  EXPECT_EQ(processed, 2u);
+  EXPECT_EQ(batched->core->getTopBlockIndex(), initialTopIndex + 2);
+}
@@ -0,0 +1,128 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <Xi/FileSystem.h>
+#include <System/Dispatcher.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Account.h>
+#include <CryptoNoteCore/CachedBlock.h>
+#include <CryptoNoteCore/Checkpoints.h>
+#include <CryptoNoteCore/Core.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/DatabaseBlockchainCache.h>
+#include <CryptoNoteCore/DatabaseBlockchainCacheFactory.h>
+#include <CryptoNoteCore/MainChainStorage.h>
+#include <CryptoNoteCore/RocksDBWrapper.h>
+
+namespace {
+class CryptoNote_CoreLocking : public ::testing::Test {
+ public:
+  std::string dir{"./core_locking_test"};
+  Logging::ConsoleLogger logger{Logging::Error};
+  System::Dispatcher dispatcher{};
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::unique_ptr<CryptoNote::Checkpoints> checkpoints;
+  std::unique_ptr<CryptoNote::RocksDBWrapper> database;
+  std::unique_ptr<CryptoNote::Core> core;
+  CryptoNote::AccountBase miner{};
+
+  void SetUp() override {
+    using namespace CryptoNote;
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+    Xi::FileSystem::ensureDirectoryExists(dir).throwOnError();
+    currency = std::make_unique<Currency>(CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    checkpoints = std::make_unique<Checkpoints>(logger);
+    DataBaseConfig config{};
+    config.setDataDir(dir);
+    database = std::make_unique<RocksDBWrapper>(logger);
+    database->init(config);
+    ASSERT_TRUE(DatabaseBlockchainCache::checkDBSchemeVersion(*database, logger));
+    core = std::make_unique<Core>(*currency, logger, *checkpoints, dispatcher, false,
+                                  std::make_unique<DatabaseBlockchainCacheFactory>(*database, logger),
+                                  createSwappedMainChainStorage(dir, *currency));
+    ASSERT_TRUE(core->load());
+    miner.generate();
+  }
+
+  void TearDown() override {
+    core.reset();
+    database->shutdown();
+    database.reset();
+  }
+
+  CryptoNote::BinaryArray mineNextBlock() {
+    using namespace CryptoNote;
+    BlockTemplate block;
+    uint64_t difficulty = 0;
+    uint32_t index = 0;
+    EXPECT_TRUE(core->getBlockTemplate(block, miner.getAccountKeys().address, difficulty, index));
+    while (!currency->checkProofOfWork(CachedBlock{block}, difficulty)) {
+      block.nonce.advance(1);
+    }
+    return toBinaryArray(block);
+  }
+};
+}  // namespace
+
+TEST_F(CryptoNote_CoreLocking, BlockTemplateReadersDoNotBlockSubmission) {
+  using namespace CryptoNote;
+
+  const uint32_t BlocksToAdd = 16;
+
+  std::atomic_bool isSubmitting{true};
+  std::atomic<uint64_t> templatesQueried{0};
+  std::thread reader{[&]() {
+    const auto address = miner.getAccountKeys().address;
+    while (isSubmitting) {
+      BlockTemplate block;
+      uint64_t difficulty = 0;
+      uint32_t index = 0;
+      if (core->getBlockTemplate(block, address, difficulty, index)) {
+        templatesQueried += 1;
+      }
+    }
+  }};
+
+  while (templatesQueried.load() == 0) {
+    std::this_thread::yield();
+  }
+
+  const auto initialTopIndex = core->getTopBlockIndex();
+  for (uint32_t i = 0; i < BlocksToAdd; ++i) {
+    EXPECT_EQ(core->submitBlock(mineNextBlock()), error::AddBlockErrorCode::ADDED_TO_MAIN);
+  }
+
+  isSubmitting = false;
+  reader.join();
+
+  EXPECT_EQ(core->getTopBlockIndex(), initialTopIndex + BlocksToAdd);
+}
@@ -54,3 +54,50 @@ TEST(CryptoNightX, HashConsistency) {
     }
   }
 }
+
+TEST(CryptoNightX, FlatEngineMatchesTreeEngine) {
+  std::default_random_engine rng{};
+  for (const size_t insertions : {size_t{0}, size_t{1}, size_t{7}, size_t{64}, size_t{256}, size_t{1024}}) {
+    for (size_t i = 0; i < 32; ++i) {
+      std::vector<uint8_t> blob{};
+      blob.resize(rng() % 128);
+      std::generate(blob.begin(), blob.end(), [&rng]() { return static_cast<uint8_t>(rng()); });
+
+      Crypto::Hash treeHash{}, flatHash{};
+      Xi::ProofOfWork::Cnx::cnx(Xi::ConstByteSpan{blob.data(), blob.size()}, treeHash, insertions);
+      Xi::ProofOfWork::Cnx::cnxFlat(Xi::ConstByteSpan{blob.data(), blob.size()}, flatHash, insertions);
+      EXPECT_EQ(treeHash, flatHash) << "insertions: " << insertions << ", blob size: " << blob.size();
+    }
+  }
+}
+
+TEST(CryptoNightX, BatchMatchesSingleHashes) {
+  std::default_random_engine rng{};
+  const size_t nonceSize = 4;
+  const size_t count = 6;
+  for (const size_t blobSize : {size_t{4}, size_t{76}, size_t{200}}) {
+    for (size_t i = 0; i < 8; ++i) {
+      std::vector<uint8_t> blob{};
+      blob.resize(blobSize);
+      std::generate(blob.begin(), blob.end(), [&rng]() { return static_cast<uint8_t>(rng()); });
+      std::vector<uint8_t> nonces{};
+      nonces.resize(nonceSize * count);
+      std::generate(nonces.begin(), nonces.end(), [&rng]() { return static_cast<uint8_t>(rng()); });
+
+      // covers a leading nonce, a trailing nonce and a nonce in between
+      for (const size_t nonceOffset : {size_t{0}, blobSize - nonceSize, (blobSize - nonceSize) / 2}) {
+        std::array<Crypto::Hash, count> batched{};
+        HashFn{}.batch(Xi::ConstByteSpan{blob.data(), blob.size()}, nonceOffset,
+                       Xi::ConstByteSpan{nonces.data(), nonces.size()}, Xi::Span<Crypto::Hash>{batched.data(), count});
+
+        auto current = blob;
+        for (size_t j = 0; j < count; ++j) {
+          std::copy_n(nonces.begin() + j * nonceSize, nonceSize, current.begin() + nonceOffset);
+          Crypto::Hash single{};
+          HashFn{}(Xi::ConstByteSpan{current.data(), current.size()}, single);
+          EXPECT_EQ(single, batched[j]) << "blob size: " << blobSize << ", nonce offset: " << nonceOffset;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,140 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <System/DispatcherGroup.h>
+#include <System/Event.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
+namespace {
+void sleepUntilStopped(System::Dispatcher& dispatcher, size_t& interruptions) {
+  try {
+    System::Timer{dispatcher}.sleep(std::chrono::hours{1});
+  } catch (System::InterruptedException&) {
+    interruptions += 1;
+  }
+}
+}  // namespace
+
+TEST(DispatcherGroup, RunsOnPrimaryWithoutWorkers) {
+  System::Dispatcher primary;
+  System::DispatcherGroup group{primary, 0};
+  EXPECT_EQ(group.workers(), 0u);
+  EXPECT_EQ(&group.next(), &primary);
+
+  System::Event done{primary};
+  group.spawn(group.next(), [&done] { done.set(); });
+  done.wait();
+  group.stop();
+}
+
+TEST(DispatcherGroup, InvokesOnTargetThread) {
+  System::Dispatcher primary;
+  System::DispatcherGroup group{primary, 2};
+  ASSERT_EQ(group.workers(), 2u);
+
+  const auto primaryThread = std::this_thread::get_id();
+  size_t calls = 0;
+  size_t foreignCalls = 0;
+  System::Event done{primary};
+  size_t remaining = 2;
+  for (size_t i = 0; i < 2; ++i) {
+    auto& worker = group.next();
+    ASSERT_NE(&worker, &primary);
+    group.spawn(worker, [&, iWorker = &worker] {
+      for (size_t j = 0; j < 100; ++j) {
+        auto thread = System::DispatcherGroup::invoke(*iWorker, primary, [&] {
+          calls += 1;
+          return std::this_thread::get_id();
+        });
+        if (thread != primaryThread || std::this_thread::get_id() == primaryThread) {
+          foreignCalls += 1;
+        }
+      }
+      System::DispatcherGroup::invoke(*iWorker, primary, [&] {
+        if (--remaining == 0) {
+          done.set();
+        }
+      });
+    });
+  }
+  done.wait();
+  group.stop();
+
+  EXPECT_EQ(calls, 200u);
+  EXPECT_EQ(foreignCalls, 0u);
+}
+
+TEST(DispatcherGroup, RethrowsInvokeErrors) {
+  System::Dispatcher primary;
+  System::DispatcherGroup group{primary, 1};
+
+  bool caught = false;
+  System::Event done{primary};
+  auto& worker = group.next();
+  group.spawn(worker, [&, iWorker = &worker] {
+    try {
+      System::DispatcherGroup::invoke(*iWorker, primary, [] { throw std::runtime_error{"failed"}; });
+    } catch (const std::runtime_error&) {
+      System::DispatcherGroup::invoke(*iWorker, primary, [&caught] { caught = true; });
+    }
+    System::DispatcherGroup::invoke(*iWorker, primary, [&done] { done.set(); });
+  });
+  done.wait();
+  group.stop();
+
+  EXPECT_TRUE(caught);
+}
+
+TEST(DispatcherGroup, StopInterruptsSpawnedTasks) {
+  System::Dispatcher primary;
+  System::DispatcherGroup group{primary, 2};
+
+  size_t started = 0;
+  size_t interruptions = 0;
+  System::Event allStarted{primary};
+  for (size_t i = 0; i < 6; ++i) {
+    auto& dispatcher = i % 3 == 0 ? primary : group.next();
+    group.spawn(dispatcher, [&, iDispatcher = &dispatcher] {
+      System::DispatcherGroup::invoke(*iDispatcher, primary, [&] {
+        if (++started == 6) {
+          allStarted.set();
+        }
+      });
+      size_t localInterruptions = 0;
+      sleepUntilStopped(*iDispatcher, localInterruptions);
+      System::DispatcherGroup::invoke(*iDispatcher, primary, [&] { interruptions += localInterruptions; });
+    });
+  }
+  allStarted.wait();
+  group.stop();
+
+  EXPECT_EQ(interruptions, 6u);
+}
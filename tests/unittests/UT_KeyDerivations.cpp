@@ -0,0 +1,61 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <crypto/crypto.h>
+
+TEST(Crypto, KeyDerivationsMatchSingleDerivation) {
+  Crypto::PublicKey viewPublicKey{};
+  Crypto::SecretKey viewSecretKey{};
+  Crypto::generate_keys(viewPublicKey, viewSecretKey);
+
+  const size_t count = 40;
+  std::vector<Crypto::PublicKey> transactionKeys(count);
+  for (size_t i = 0; i < count; ++i) {
+    Crypto::SecretKey transactionSecretKey{};
+    Crypto::generate_keys(transactionKeys[i], transactionSecretKey);
+  }
+  // arbitrary bytes, roughly half of them do not encode a curve point and must be reported alike
+  for (size_t i = 0; i < count; i += 4) {
+    std::memset(transactionKeys[i].data(), static_cast<int>(i + 1), transactionKeys[i].size());
+  }
+
+  std::vector<Crypto::KeyDerivation> derivations(count);
+  std::unique_ptr<bool[]> isValid{new bool[count]};
+  Crypto::generate_key_derivations(transactionKeys.data(), count, viewSecretKey, derivations.data(), isValid.get());
+
+  for (size_t i = 0; i < count; ++i) {
+    Crypto::KeyDerivation expected{};
+    const bool isExpectedValid = Crypto::generate_key_derivation(transactionKeys[i], viewSecretKey, expected);
+    ASSERT_EQ(isValid[i], isExpectedValid);
+    if (isExpectedValid) {
+      EXPECT_EQ(derivations[i], expected);
+    }
+  }
+}
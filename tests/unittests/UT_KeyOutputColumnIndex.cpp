@@ -0,0 +1,94 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gtest/gtest.h>
+
+#include <CryptoNoteCore/Blockchain/KeyOutputColumnIndex.hpp>
+
+namespace {
+using Index = CryptoNote::KeyOutputColumnIndex;
+
+Index::Column makeColumn(uint32_t count) {
+  Index::Column column{};
+  for (uint32_t i = 0; i < count; ++i) {
+    column.push_back(i / 2, i % 3 == 0 ? 100 : 0);
+  }
+  return column;
+}
+}  // namespace
+
+TEST(KeyOutputColumnIndex, LoadsLazilyOnce) {
+  size_t loads = 0;
+  Index index{[&loads](Index::Amount) {
+    ++loads;
+    return makeColumn(10);
+  }};
+  EXPECT_EQ(loads, 0u);
+  EXPECT_EQ(index.visit(5, [](const Index::Column& column) { return column.size(); }), 10u);
+  EXPECT_EQ(index.visit(5, [](const Index::Column& column) { return column.unlockTimes[3]; }), 100u);
+  EXPECT_EQ(loads, 1u);
+}
+
+TEST(KeyOutputColumnIndex, CountsOutputsUntilBlock) {
+  Index index{[](Index::Amount) { return makeColumn(10); }};
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.countUntil(0); }), 2u);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.countUntil(2); }), 6u);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.countUntil(100); }), 10u);
+}
+
+TEST(KeyOutputColumnIndex, AppendsAndTruncatesLoadedColumns) {
+  size_t loads = 0;
+  Index index{[&loads](Index::Amount) {
+    ++loads;
+    return makeColumn(4);
+  }};
+
+  index.append(1, 4, 9, 0);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.size(); }), 4u);
+
+  index.append(1, 4, 9, 0);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.blockIndices.back(); }), 9u);
+
+  index.truncate(1, 2);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.size(); }), 2u);
+
+  index.append(1, 7, 10, 0);
+  EXPECT_EQ(index.visit(1, [](const Index::Column& column) { return column.size(); }), 4u);
+  EXPECT_EQ(loads, 2u);
+}
+
+TEST(KeyOutputColumnIndex, ReportsUsagePerAmount) {
+  Index index{[](Index::Amount amount) { return makeColumn(static_cast<uint32_t>(amount)); }};
+  index.visit(8, [](const Index::Column&) { return 0; });
+  index.visit(3, [](const Index::Column&) { return 0; });
+
+  const auto usage = index.usage();
+  ASSERT_EQ(usage.size(), 2u);
+  EXPECT_EQ(usage[0].amount, 3u);
+  EXPECT_EQ(usage[0].outputs, 3u);
+  EXPECT_GE(usage[0].bytes, 3u * (sizeof(uint32_t) + sizeof(uint64_t)));
+  EXPECT_EQ(usage[1].amount, 8u);
+
+  index.clear();
+  EXPECT_TRUE(index.usage().empty());
+}
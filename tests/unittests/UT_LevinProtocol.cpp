@@ -0,0 +1,87 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/TcpListener.h>
+
+#include <P2p/LevinProtocol.h>
+
+namespace {
+const uint16_t TEST_PORT = 17483;
+
+CryptoNote::BinaryArray makePayload(size_t size) {
+  CryptoNote::BinaryArray payload(size);
+  std::iota(payload.begin(), payload.end(), static_cast<uint8_t>(0));
+  return payload;
+}
+
+void exchange(const CryptoNote::BinaryArray& payload, CryptoNote::LevinProtocol::Command& received) {
+  System::Dispatcher dispatcher;
+  System::ContextGroup group{dispatcher};
+  System::TcpListener listener{dispatcher, System::Ipv4Address{"127.0.0.1"}, TEST_PORT};
+
+  bool read = false;
+  group.spawn([&] {
+    System::TcpConnection connection = listener.accept();
+    CryptoNote::LevinProtocol protocol{connection};
+    read = protocol.readCommand(received);
+  });
+
+  group.spawn([&] {
+    System::TcpConnection connection =
+        System::TcpConnector{dispatcher}.connect(System::Ipv4Address{"127.0.0.1"}, TEST_PORT);
+    CryptoNote::LevinProtocol protocol{connection};
+    protocol.sendMessage(42, payload, false);
+  });
+
+  group.wait();
+  ASSERT_TRUE(read);
+}
+}  // namespace
+
+TEST(LevinProtocol, SendsEmptyBody) {
+  CryptoNote::LevinProtocol::Command received;
+  exchange({}, received);
+  EXPECT_EQ(received.command, 42u);
+  EXPECT_TRUE(received.isNotify);
+  EXPECT_TRUE(received.buf.empty());
+}
+
+TEST(LevinProtocol, ResumesShortGatherWrites) {
+  // large enough to exceed the socket buffers, the writer is suspended and continues mid body
+  const auto payload = makePayload(16 * 1024 * 1024 + 7);
+  CryptoNote::LevinProtocol::Command received;
+  exchange(payload, received);
+  EXPECT_EQ(received.command, 42u);
+  EXPECT_FALSE(received.isResponse);
+  EXPECT_EQ(received.buf, payload);
+}
@@ -0,0 +1,309 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/MainChainStorage.h>
+#include <CryptoNoteCore/MappedMainChainStorage.h>
+
+namespace {
+
+CryptoNote::RawBlock makeBlock(uint8_t seed, size_t transactions) {
+  CryptoNote::RawBlock block{};
+  block.blockTemplate.assign(64 + seed, seed);
+  for (size_t i = 0; i < transactions; ++i) {
+    block.transactions.emplace_back(32 + i, static_cast<uint8_t>(seed + i));
+  }
+  return block;
+}
+
+/// Overwrites one byte of a stored block and marks no block durable, as if the process crashed before the next sync.
+void tearBlock(const std::string& directory, size_t blockOffset) {
+  std::fstream segment{directory + "/segment-0.bin", std::ios::in | std::ios::out | std::ios::binary};
+  segment.seekp(static_cast<std::streamoff>(blockOffset + 1));
+  segment.put('\xFF');
+  std::fstream index{directory + "/index.bin", std::ios::in | std::ios::out | std::ios::binary};
+  const uint32_t durableCount = 0;
+  index.seekp(16);
+  index.write(reinterpret_cast<const char*>(&durableCount), sizeof(durableCount));
+}
+
+uint32_t readDurableCount(const std::string& directory) {
+  std::ifstream index{directory + "/index.bin", std::ios::binary};
+  uint32_t reval = 0;
+  index.seekg(16);
+  index.read(reinterpret_cast<char*>(&reval), sizeof(reval));
+  return reval;
+}
+
+class CryptoNote_MappedMainChainStorage : public ::testing::Test {
+ public:
+  std::string dir{"./mapped_main_chain_storage_test"};
+
+  void SetUp() override {
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+  }
+
+  void TearDown() override {
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+  }
+};
+
+}  // namespace
+
+TEST_F(CryptoNote_MappedMainChainStorage, PushesPopsAndReopens) {
+  using namespace CryptoNote;
+
+  {
+    MappedMainChainStorage storage{dir};
+    EXPECT_EQ(storage.getBlockCount(), 0u);
+    for (uint8_t i = 0; i < 10; ++i) {
+      storage.pushBlock(makeBlock(i, i % 3), 100u * i);
+    }
+    storage.popBlock();
+    EXPECT_EQ(storage.getBlockCount(), 9u);
+    EXPECT_THROW(storage.getBlockByIndex(9), std::out_of_range);
+  }
+
+  MappedMainChainStorage storage{dir};
+  ASSERT_EQ(storage.getBlockCount(), 9u);
+  for (uint8_t i = 0; i < 9; ++i) {
+    const auto block = storage.getBlockByIndex(i);
+    EXPECT_EQ(block.blockTemplate, makeBlock(i, i % 3).blockTemplate);
+    EXPECT_EQ(block.transactions, makeBlock(i, i % 3).transactions);
+    EXPECT_EQ(storage.getBlobSizeByIndex(i), 100u * i);
+  }
+
+  const auto blob = storage.getBlockBlobByIndex(3);
+  ASSERT_TRUE(blob.has_value());
+  const auto expected = toBinaryArray(makeBlock(3, 0));
+  EXPECT_EQ(BinaryArray(blob->span().begin(), blob->span().end()), expected);
+}
+
+TEST_F(CryptoNote_MappedMainChainStorage, DropsTornTail) {
+  using namespace CryptoNote;
+
+  size_t tornOffset = 0;
+  {
+    MappedMainChainStorage storage{dir};
+    for (uint8_t i = 0; i < 4; ++i) {
+      storage.pushBlock(makeBlock(i, 1), i);
+      if (i < 2) {
+        tornOffset += toBinaryArray(makeBlock(i, 1)).size();
+      }
+    }
+  }
+
+  // simulates a crash before the last sync, the third block did not reach the disk completely
+  tearBlock(dir, tornOffset);
+
+  MappedMainChainStorage storage{dir};
+  EXPECT_EQ(storage.getBlockCount(), 2u);
+  storage.pushBlock(makeBlock(7, 1), 7);
+  EXPECT_EQ(storage.getBlockByIndex(2).blockTemplate, makeBlock(7, 1).blockTemplate);
+}
+
+TEST_F(CryptoNote_MappedMainChainStorage, PersistsLoweredDurableMark) {
+  using namespace CryptoNote;
+
+  MappedMainChainStorage storage{dir};
+  for (uint8_t i = 0; i < 4; ++i) {
+    storage.pushBlock(makeBlock(i, 1), i);
+  }
+  storage.sync();
+  EXPECT_EQ(readDurableCount(dir), 4u);
+
+  // blocks pushed in place of popped ones are not flushed yet, a crash must not leave them marked durable
+  storage.popBlock();
+  storage.popBlock();
+  EXPECT_EQ(readDurableCount(dir), 2u);
+}
+
+TEST_F(CryptoNote_MappedMainChainStorage, CutsTailInMissingSegment) {
+  using namespace CryptoNote;
+
+  {
+    MappedMainChainStorage storage{dir};
+    for (uint8_t i = 0; i < 3; ++i) {
+      storage.pushBlock(makeBlock(i, 1), i);
+    }
+  }
+
+  // a stale last entry, pointing into a segment that was never created, after the durable mark
+  {
+    std::fstream index{dir + "/index.bin", std::ios::in | std::ios::out | std::ios::binary};
+    const uint32_t durableCount = 2;
+    index.seekp(16);
+    index.write(reinterpret_cast<const char*>(&durableCount), sizeof(durableCount));
+    const uint32_t segment = 3;
+    index.seekp(24 + 2 * 32);
+    index.write(reinterpret_cast<const char*>(&segment), sizeof(segment));
+  }
+
+  MappedMainChainStorage storage{dir};
+  EXPECT_EQ(storage.getBlockCount(), 2u);
+  storage.pushBlock(makeBlock(7, 1), 7);
+  EXPECT_EQ(storage.getBlockByIndex(2).blockTemplate, makeBlock(7, 1).blockTemplate);
+}
+
+TEST_F(CryptoNote_MappedMainChainStorage, ClearsSegments) {
+  using namespace CryptoNote;
+
+  MappedMainChainStorage storage{dir};
+  storage.pushBlock(makeBlock(1, 1), 1);
+  storage.clear();
+  EXPECT_EQ(storage.getBlockCount(), 0u);
+  storage.pushBlock(makeBlock(2, 2), 2);
+  EXPECT_EQ(storage.getBlockByIndex(0).blockTemplate, makeBlock(2, 2).blockTemplate);
+}
+
+TEST_F(CryptoNote_MappedMainChainStorage, BlobPinsStorage) {
+  using namespace CryptoNote;
+
+  MappedMainChainStorage storage{dir};
+  storage.pushBlock(makeBlock(1, 1), 1);
+  storage.pushBlock(makeBlock(2, 2), 2);
+
+  auto blob = storage.getBlockBlobByIndex(1);
+  ASSERT_TRUE(blob.has_value());
+  const auto expected = toBinaryArray(makeBlock(2, 2));
+
+  // Popping the block and pushing another one at its place waits until the blob is released.
+  auto replace = std::async(std::launch::async, [&storage]() {
+    storage.popBlock();
+    storage.pushBlock(makeBlock(9, 1), 9);
+  });
+  EXPECT_EQ(replace.wait_for(std::chrono::milliseconds{100}), std::future_status::timeout);
+  EXPECT_EQ(BinaryArray(blob->span().begin(), blob->span().end()), expected);
+
+  blob.reset();
+  replace.get();
+  EXPECT_EQ(storage.getBlockByIndex(1).blockTemplate, makeBlock(9, 1).blockTemplate);
+}
+
+class CryptoNote_MainChainStorageMigration : public CryptoNote_MappedMainChainStorage {
+ public:
+  Logging::ConsoleLogger logger{Logging::Error};
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::vector<CryptoNote::RawBlock> blocks;
+
+  void SetUp() override {
+    CryptoNote_MappedMainChainStorage::SetUp();
+    Xi::FileSystem::ensureDirectoryExists(dir).throwOnError();
+    currency = std::make_unique<CryptoNote::Currency>(
+        CryptoNote::CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    for (uint8_t i = 0; i < 6; ++i) {
+      blocks.emplace_back(makeBlock(i, i % 3));
+    }
+  }
+
+  std::string blocksFilename() const {
+    return dir + "/" + currency->blocksFileName();
+  }
+  std::string indexesFilename() const {
+    return dir + "/" + currency->blockIndexesFileName();
+  }
+  std::string storeDirectory() const {
+    return dir + "/" + currency->blocksFileName() + "-store";
+  }
+
+  void writeLegacyStorage() {
+    CryptoNote::MainChainStorage legacy{blocksFilename(), indexesFilename()};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      legacy.pushBlock(blocks[i], 10 * i);
+    }
+  }
+
+  void expectMigrated(const CryptoNote::IMainChainStorage& storage) {
+    ASSERT_EQ(storage.getBlockCount(), blocks.size());
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+      const auto block = storage.getBlockByIndex(i);
+      EXPECT_EQ(block.blockTemplate, blocks[i].blockTemplate);
+      EXPECT_EQ(block.transactions, blocks[i].transactions);
+      EXPECT_EQ(storage.getBlobSizeByIndex(i), 10u * i);
+    }
+    EXPECT_FALSE(Xi::FileSystem::exists(blocksFilename()).takeOrThrow());
+    EXPECT_FALSE(Xi::FileSystem::exists(indexesFilename()).takeOrThrow());
+  }
+};
+
+TEST_F(CryptoNote_MainChainStorageMigration, MigratesLegacyStorage) {
+  using namespace CryptoNote;
+
+  writeLegacyStorage();
+  {
+    const auto storage = createSwappedMainChainStorage(dir, *currency);
+    expectMigrated(*storage);
+  }
+
+  EXPECT_TRUE(Xi::FileSystem::exists(storeDirectory() + "/index.bin").takeOrThrow());
+  EXPECT_TRUE(Xi::FileSystem::exists(storeDirectory() + "/segment-0.bin").takeOrThrow());
+  MappedMainChainStorage reopened{storeDirectory()};
+  expectMigrated(reopened);
+}
+
+TEST_F(CryptoNote_MainChainStorageMigration, ResumesMigrationAfterTornWrite) {
+  using namespace CryptoNote;
+
+  writeLegacyStorage();
+  size_t tornOffset = 0;
+  {
+    // A migration interrupted while the fourth block was written.
+    MappedMainChainStorage store{storeDirectory()};
+    for (uint32_t i = 0; i < 4; ++i) {
+      store.pushBlock(blocks[i], 10 * i);
+      if (i < 3) {
+        tornOffset += toBinaryArray(blocks[i]).size();
+      }
+    }
+  }
+  tearBlock(storeDirectory(), tornOffset);
+
+  const auto storage = createSwappedMainChainStorage(dir, *currency);
+  expectMigrated(*storage);
+}
+
+TEST_F(CryptoNote_MainChainStorageMigration, RestartsDivergedMigration) {
+  using namespace CryptoNote;
+
+  writeLegacyStorage();
+  {
+    MappedMainChainStorage store{storeDirectory()};
+    store.pushBlock(blocks[0], 0);
+    store.pushBlock(makeBlock(42, 1), 10);
+  }
+
+  const auto storage = createSwappedMainChainStorage(dir, *currency);
+  expectMigrated(*storage);
+}
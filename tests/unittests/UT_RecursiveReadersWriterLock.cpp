@@ -0,0 +1,112 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <Xi/Concurrent/RecursiveReadersWriterLock.h>
+
+namespace {
+using Lock = Xi::Concurrent::RecursiveReadersWriterLock;
+
+/// Tries to read from another thread, must be declared before the lock guards it is blocked by.
+class ConcurrentReader {
+ public:
+  explicit ConcurrentReader(const Lock& lock) : m_lock{lock} {
+  }
+  ~ConcurrentReader() {
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  bool canRead() {
+    m_thread = std::thread{[this]() {
+      XI_CONCURRENT_RECURSIVE_LOCK_READ(m_lock);
+      m_hasRead = true;
+    }};
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{100};
+    while (!m_hasRead && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    return m_hasRead;
+  }
+
+ private:
+  const Lock& m_lock;
+  std::atomic_bool m_hasRead{false};
+  std::thread m_thread{};
+};
+}  // namespace
+
+TEST(Xi_Concurrent_RecursiveReadersWriterLock, ReadersAreReentrantAndShared) {
+  Lock lock{};
+  ConcurrentReader reader{lock};
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(lock);
+  Lock::read_lock_t reentered{lock};
+  EXPECT_TRUE(reader.canRead());
+}
+
+TEST(Xi_Concurrent_RecursiveReadersWriterLock, PrepareWriteAllowsReaders) {
+  Lock lock{};
+  ConcurrentReader reader{lock};
+  XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(lock);
+  Lock::read_lock_t reentered{lock};
+  Lock::prepare_write_lock_t nested{lock};
+  EXPECT_TRUE(reader.canRead());
+}
+
+TEST(Xi_Concurrent_RecursiveReadersWriterLock, WriteExcludesReaders) {
+  Lock lock{};
+  ConcurrentReader reader{lock};
+  XI_CONCURRENT_RECURSIVE_LOCK_WRITE(lock);
+  Lock::read_lock_t reentered{lock};
+  Lock::prepare_write_lock_t nested{lock};
+  EXPECT_FALSE(reader.canRead());
+}
+
+TEST(Xi_Concurrent_RecursiveReadersWriterLock, WriteWithinPrepareWriteDowngradesOnRelease) {
+  Lock lock{};
+  ConcurrentReader blockedReader{lock};
+  ConcurrentReader reader{lock};
+  XI_CONCURRENT_RECURSIVE_LOCK_PREPARE_WRITE(lock);
+  {
+    XI_CONCURRENT_RECURSIVE_LOCK_WRITE(lock);
+    Lock::write_lock_t nested{lock};
+    EXPECT_FALSE(blockedReader.canRead());
+  }
+  EXPECT_TRUE(reader.canRead());
+}
+
+TEST(Xi_Concurrent_RecursiveReadersWriterLock, ReaderRequestingWriteThrows) {
+  Lock lock{};
+  ConcurrentReader reader{lock};
+  XI_CONCURRENT_RECURSIVE_LOCK_READ(lock);
+  EXPECT_ANY_THROW(Lock::prepare_write_lock_t{lock});
+  EXPECT_ANY_THROW(Lock::write_lock_t{lock});
+  EXPECT_TRUE(reader.canRead());
+}
@@ -0,0 +1,69 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <crypto/crypto.h>
+
+TEST(Crypto, RingSignatureVerifierMatchesSingleCheck) {
+  const size_t ringSize = 4;
+  const size_t poolSize = 16;
+  std::vector<Crypto::PublicKey> publicKeys(poolSize);
+  std::vector<Crypto::SecretKey> secretKeys(poolSize);
+  for (size_t i = 0; i < poolSize; ++i) {
+    Crypto::generate_keys(publicKeys[i], secretKeys[i]);
+  }
+
+  Crypto::RingSignatureVerifier verifier{};
+  for (size_t i = 0; i + 1 < poolSize; ++i) {
+    verifier.addKey(publicKeys[i]);
+  }
+  for (size_t i = 0; i < verifier.keyCount(); ++i) {
+    verifier.prepare(i);
+  }
+
+  for (size_t i = 0; i < 24; ++i) {
+    Crypto::Hash prefix = Crypto::Hash::compute(Xi::asConstByteSpan(&i, sizeof(i))).takeOrThrow();
+    std::vector<const Crypto::PublicKey*> ring{};
+    for (size_t j = 0; j < ringSize; ++j) {
+      ring.push_back(std::addressof(publicKeys[(i * 3 + j * 5) % poolSize]));
+    }
+    const size_t realIndex = i % ringSize;
+    const size_t realKey = (i * 3 + realIndex * 5) % poolSize;
+    Crypto::KeyImage image{};
+    Crypto::generate_key_image(publicKeys[realKey], secretKeys[realKey], image);
+    std::vector<Crypto::Signature> signatures(ringSize);
+    Crypto::generate_ring_signature(prefix, image, ring, secretKeys[realKey], realIndex, signatures.data());
+
+    // Every third ring is tampered with, rings including the last key are not registered and use the fallback.
+    if (i % 3 == 0) {
+      prefix.data()[0] ^= 0x01;
+    }
+
+    const bool expected = Crypto::check_ring_signature(prefix, image, ring, signatures.data());
+    EXPECT_EQ(expected, i % 3 != 0);
+    EXPECT_EQ(verifier.checkRingSignature(prefix, image, ring.data(), ring.size(), signatures.data()), expected);
+  }
+}
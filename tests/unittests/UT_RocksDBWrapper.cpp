@@ -0,0 +1,425 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/DataBaseErrors.h>
+#include <CryptoNoteCore/DBUtils.h>
+#include <CryptoNoteCore/RocksDBWrapper.h>
+
+namespace {
+
+class RawWriteBatch : public CryptoNote::IWriteBatch {
+ public:
+  std::vector<std::pair<std::string, std::string>> inserts;
+  std::vector<std::string> removals;
+
+  std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override {
+    return std::move(inserts);
+  }
+  std::vector<std::string> extractRawKeysToRemove() override {
+    return std::move(removals);
+  }
+};
+
+class RawReadBatch : public CryptoNote::IReadBatch {
+ public:
+  std::vector<std::string> keys;
+  std::vector<std::optional<std::string>> values;
+
+  std::vector<std::string> getRawKeys() const override {
+    return keys;
+  }
+  void submitRawResult(const std::vector<Xi::ConstByteSpan>& rawValues,
+                       const std::vector<bool>& resultStates) override {
+    values.clear();
+    for (size_t i = 0; i < rawValues.size(); ++i) {
+      if (resultStates[i]) {
+        values.emplace_back(std::string{reinterpret_cast<const char*>(rawValues[i].data()), rawValues[i].size()});
+      } else {
+        values.emplace_back(std::nullopt);
+      }
+    }
+  }
+};
+
+/// Holds the write behind thread inside persist on request and records the size of every persisted batch.
+class GatedRocksDBWrapper : public CryptoNote::RocksDBWrapper {
+ public:
+  using RocksDBWrapper::RocksDBWrapper;
+
+  void hold() {
+    std::lock_guard<std::mutex> lock{access};
+    isHeld = true;
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock{access};
+    isHeld = false;
+    changed.notify_all();
+  }
+
+  void fail() {
+    std::lock_guard<std::mutex> lock{access};
+    isFailing = true;
+  }
+
+  /// Waits until the writer entered persist count times in total.
+  void waitForEntered(size_t count) {
+    std::unique_lock<std::mutex> lock{access};
+    changed.wait(lock, [this, count]() { return entered >= count; });
+  }
+
+  /// Waits until count batches are persisted in total.
+  std::vector<size_t> waitForPersisted(size_t count) {
+    std::unique_lock<std::mutex> lock{access};
+    changed.wait(lock, [this, count]() { return persisted.size() >= count; });
+    return persisted;
+  }
+
+ protected:
+  rocksdb::Status persist(const rocksdb::WriteOptions& options, rocksdb::WriteBatch& batch) override {
+    std::unique_lock<std::mutex> lock{access};
+    entered += 1;
+    changed.notify_all();
+    changed.wait(lock, [this]() { return !isHeld; });
+    if (isFailing) {
+      return rocksdb::Status::IOError("injected write failure");
+    }
+    lock.unlock();
+
+    const auto status = RocksDBWrapper::persist(options, batch);
+    lock.lock();
+    persisted.push_back(batch.Count());
+    changed.notify_all();
+    return status;
+  }
+
+ private:
+  std::mutex access;
+  std::condition_variable changed;
+  bool isHeld = false;
+  bool isFailing = false;
+  size_t entered = 0;
+  std::vector<size_t> persisted;
+};
+
+class CryptoNote_RocksDBWrapper : public ::testing::Test {
+ public:
+  /// RocksDBWrapper::WRITE_BEHIND_WINDOW
+  static constexpr uint32_t WriteBehindWindow = 32;
+
+  std::string dir{"./rocksdb_wrapper_test"};
+  Logging::ConsoleLogger logger{Logging::Error};
+  std::unique_ptr<GatedRocksDBWrapper> database;
+
+  void SetUp() override {
+    Xi::FileSystem::removeDircetoryIfExists(dir).throwOnError();
+    Xi::FileSystem::ensureDirectoryExists(dir).throwOnError();
+    database = std::make_unique<GatedRocksDBWrapper>(logger);
+    database->init(config());
+  }
+
+  void TearDown() override {
+    database->release();
+    database->shutdown();
+    database.reset();
+  }
+
+  CryptoNote::DataBaseConfig config() const {
+    CryptoNote::DataBaseConfig reval{};
+    reval.setDataDir(dir);
+    return reval;
+  }
+
+  void reopen() {
+    database->shutdown();
+    database->init(config());
+  }
+
+  std::error_code writeBlockInfo(uint32_t index) {
+    using namespace CryptoNote;
+    RawWriteBatch batch{};
+    batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, index, index));
+    return database->write(batch);
+  }
+
+  std::error_code removeBlockInfo(uint32_t index) {
+    using namespace CryptoNote;
+    RawWriteBatch batch{};
+    batch.removals.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, index));
+    return database->write(batch);
+  }
+
+  std::vector<bool> readBlockInfos(const std::vector<uint32_t>& indices) {
+    using namespace CryptoNote;
+    RawReadBatch batch{};
+    for (const auto index : indices) {
+      batch.keys.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, index));
+    }
+    EXPECT_FALSE(database->read(batch));
+    std::vector<bool> reval{};
+    for (const auto& value : batch.values) {
+      reval.push_back(value.has_value());
+    }
+    return reval;
+  }
+
+  std::vector<uint32_t> iterateBlockInfos(uint32_t begin, uint32_t end, size_t limit = 0) {
+    using namespace CryptoNote;
+    std::vector<uint32_t> reval{};
+    auto ec = database->iterate(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, begin),
+                                DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, end),
+                                [&](Xi::ConstByteSpan key, Xi::ConstByteSpan) {
+                                  reval.push_back(
+                                      DB::deserializeKey<uint32_t>(key, DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX));
+                                  return limit == 0 || reval.size() < limit;
+                                });
+    EXPECT_FALSE(ec);
+    return reval;
+  }
+};
+
+}  // namespace
+
+TEST_F(CryptoNote_RocksDBWrapper, IteratesIntegerKeysAscending) {
+  using namespace CryptoNote;
+
+  RawWriteBatch batch{};
+  for (uint32_t index : {65536u, 1u, 256u, 2u, 255u}) {
+    batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, index, index));
+  }
+  // Neighbouring tables, in the same and in other column families, must not leak into the range.
+  batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, uint32_t{3}, uint32_t{3}));
+  batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, uint32_t{3}, uint32_t{3}));
+  ASSERT_FALSE(database->write(batch));
+
+  EXPECT_EQ(iterateBlockInfos(0, 100000), (std::vector<uint32_t>{1, 2, 255, 256, 65536}));
+  EXPECT_EQ(iterateBlockInfos(2, 256), (std::vector<uint32_t>{2, 255}));
+  EXPECT_EQ(iterateBlockInfos(0, 100000, 2), (std::vector<uint32_t>{1, 2}));
+  EXPECT_TRUE(iterateBlockInfos(257, 65536).empty());
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, RemovesFromColumnFamilies) {
+  using namespace CryptoNote;
+
+  RawWriteBatch insert{};
+  insert.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, uint32_t{7}, uint32_t{7}));
+  insert.inserts.emplace_back(DB::serialize(DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, uint32_t{7}, uint32_t{7}));
+  ASSERT_FALSE(database->write(insert));
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{7}));
+
+  RawWriteBatch remove{};
+  remove.removals.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, uint32_t{7}));
+  ASSERT_FALSE(database->write(remove));
+  EXPECT_TRUE(iterateBlockInfos(0, 10).empty());
+
+  size_t keyImages = 0;
+  auto ec = database->iterate(DB::serializeKey(DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, uint32_t{0}),
+                              DB::serializePrefixEnd(DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX),
+                              [&keyImages](Xi::ConstByteSpan, Xi::ConstByteSpan) {
+                                keyImages += 1;
+                                return true;
+                              });
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(keyImages, 1u);
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, CommitsWriteGroup) {
+  ASSERT_FALSE(database->beginWriteGroup());
+  for (uint32_t index = 0; index < 4; ++index) {
+    ASSERT_FALSE(writeBlockInfo(index));
+  }
+  // A nested begin has no effect, the group stays open until committed.
+  ASSERT_FALSE(database->beginWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(4));
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{0, 1, 2, 3, 4}));
+
+  ASSERT_FALSE(database->commitWriteGroup());
+  // Committing without an open group succeeds.
+  EXPECT_FALSE(database->commitWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(5));
+
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, CommitsAbandonedWriteGroupOnShutdown) {
+  ASSERT_FALSE(database->beginWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(1));
+  ASSERT_FALSE(writeBlockInfo(2));
+
+  // An import aborted without committing its group still persists the blocks it pushed.
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 2}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, SyncWriteCommitsWriteGroup) {
+  using namespace CryptoNote;
+
+  ASSERT_FALSE(database->beginWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(1));
+  RawWriteBatch batch{};
+  batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, uint32_t{2}, uint32_t{2}));
+  ASSERT_FALSE(database->writeSync(batch));
+
+  // The group is closed, the following write is queued on its own.
+  ASSERT_FALSE(writeBlockInfo(3));
+  EXPECT_FALSE(database->commitWriteGroup());
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 2, 3}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, ReadsAndIteratesPendingWrites) {
+  database->hold();
+  ASSERT_FALSE(writeBlockInfo(1));
+  database->waitForEntered(1);
+  // The first write is in flight, all following are queued behind it.
+  ASSERT_FALSE(writeBlockInfo(2));
+  ASSERT_FALSE(writeBlockInfo(3));
+  EXPECT_EQ(readBlockInfos({1, 2, 3, 4}), (std::vector<bool>{true, true, true, false}));
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 2, 3}));
+
+  ASSERT_FALSE(removeBlockInfo(2));
+  EXPECT_EQ(readBlockInfos({1, 2, 3}), (std::vector<bool>{true, false, true}));
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 3}));
+
+  database->release();
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 3}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, DrainsFullWindow) {
+  database->hold();
+  ASSERT_FALSE(writeBlockInfo(0));
+  database->waitForEntered(1);
+  for (uint32_t index = 1; index < WriteBehindWindow; ++index) {
+    ASSERT_FALSE(writeBlockInfo(index));
+  }
+
+  // The window is full, the next writer waits until all queued writes are persisted.
+  auto blocked = std::async(std::launch::async, [this]() { return writeBlockInfo(WriteBehindWindow); });
+  EXPECT_EQ(blocked.wait_for(std::chrono::milliseconds{100}), std::future_status::timeout);
+
+  database->release();
+  EXPECT_FALSE(blocked.get());
+  // Everything queued during the first write is persisted as one batch, the blocked write only afterwards.
+  EXPECT_EQ(database->waitForPersisted(3), (std::vector<size_t>{1, WriteBehindWindow - 1, 1}));
+
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 100).size(), WriteBehindWindow + 1);
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, ReportsWriteErrorToNextCaller) {
+  using namespace CryptoNote;
+
+  database->fail();
+  // The failure happens behind the first write, the write itself only queues.
+  ASSERT_FALSE(writeBlockInfo(1));
+
+  RawWriteBatch batch{};
+  batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, uint32_t{2}, uint32_t{2}));
+  const auto expected = make_error_code(error::DataBaseErrorCodes::INTERNAL_ERROR);
+  EXPECT_EQ(database->writeSync(batch), expected);
+  EXPECT_EQ(writeBlockInfo(3), expected);
+  EXPECT_EQ(database->beginWriteGroup(), expected);
+  EXPECT_EQ(database->commitWriteGroup(), expected);
+
+  // Writes accepted before the failure stay readable, they are never persisted though.
+  EXPECT_EQ(readBlockInfos({1, 3}), (std::vector<bool>{true, false}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, GroupCommitsWriteGroupWithQueuedWrites) {
+  database->hold();
+  ASSERT_FALSE(writeBlockInfo(1));
+  database->waitForEntered(1);
+
+  ASSERT_FALSE(database->beginWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(2));
+  ASSERT_FALSE(writeBlockInfo(3));
+  EXPECT_EQ(readBlockInfos({2, 3}), (std::vector<bool>{true, true}));
+  ASSERT_FALSE(database->commitWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(4));
+
+  database->release();
+  // The group is queued as a single write and committed together with the write queued behind it.
+  EXPECT_EQ(database->waitForPersisted(2), (std::vector<size_t>{1, 3}));
+
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 2, 3, 4}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, KeepsOpenWriteGroupIndexedAfterDrain) {
+  database->hold();
+  ASSERT_FALSE(writeBlockInfo(1));
+  database->waitForEntered(1);
+  ASSERT_FALSE(database->beginWriteGroup());
+  ASSERT_FALSE(writeBlockInfo(2));
+
+  // The queue drains while the group is open, the index is rebuilt from the group alone.
+  database->release();
+  database->waitForPersisted(1);
+  EXPECT_EQ(readBlockInfos({1, 2}), (std::vector<bool>{true, true}));
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{1, 2}));
+
+  // Changes of a group keep their order, the key removed in between is inserted again.
+  ASSERT_FALSE(removeBlockInfo(2));
+  ASSERT_FALSE(writeBlockInfo(2));
+  ASSERT_FALSE(removeBlockInfo(1));
+  ASSERT_FALSE(database->commitWriteGroup());
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{2}));
+
+  reopen();
+  EXPECT_EQ(iterateBlockInfos(0, 10), (std::vector<uint32_t>{2}));
+}
+
+TEST_F(CryptoNote_RocksDBWrapper, CloseDrainsQueue) {
+  const uint32_t count = 8 * WriteBehindWindow;
+  database->shutdown();
+  {
+    // Destroyed without a shutdown, the destructor persists whatever is still queued.
+    CryptoNote::RocksDBWrapper closing{logger};
+    closing.init(config());
+    for (uint32_t index = 0; index < count; ++index) {
+      using namespace CryptoNote;
+      RawWriteBatch batch{};
+      batch.inserts.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, index, index));
+      ASSERT_FALSE(closing.write(batch));
+    }
+  }
+
+  database->init(config());
+  EXPECT_EQ(iterateBlockInfos(0, count).size(), count);
+}
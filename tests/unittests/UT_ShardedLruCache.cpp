@@ -0,0 +1,84 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <CryptoNoteCore/Blockchain/ShardedLruCache.hpp>
+
+namespace {
+using StringCache = CryptoNote::ShardedLruCache<uint32_t, std::string>;
+
+size_t stringSize(const std::string& value) {
+  return value.size();
+}
+}  // namespace
+
+TEST(ShardedLruCache, CountsHitsAndMisses) {
+  StringCache cache{1024, 4, stringSize};
+  EXPECT_FALSE(cache.get(1).has_value());
+  cache.put(1, "one");
+  auto value = cache.get(1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(*value, "one");
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(cache.misses(), 1u);
+  EXPECT_EQ(cache.size(), 3u);
+}
+
+TEST(ShardedLruCache, EvictsLeastRecentlyUsed) {
+  StringCache cache{10, 1, stringSize};
+  cache.put(1, "aaaa");
+  cache.put(2, "bbbb");
+  ASSERT_TRUE(cache.get(1).has_value());
+  cache.put(3, "cccc");
+
+  EXPECT_TRUE(cache.get(1).has_value());
+  EXPECT_FALSE(cache.get(2).has_value());
+  EXPECT_TRUE(cache.get(3).has_value());
+  EXPECT_EQ(cache.size(), 8u);
+}
+
+TEST(ShardedLruCache, SkipsValuesLargerThanAShard) {
+  StringCache cache{8, 1, stringSize};
+  cache.put(1, "small");
+  cache.put(1, "much too large");
+  EXPECT_FALSE(cache.get(1).has_value());
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(ShardedLruCache, ErasesMatchingEntries) {
+  StringCache cache{1024, 4, stringSize};
+  for (uint32_t i = 0; i < 16; ++i) {
+    cache.put(i, std::to_string(i));
+  }
+  cache.eraseIf([](uint32_t key, const std::string&) { return key >= 8; });
+  for (uint32_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(cache.get(i).has_value(), i < 8);
+  }
+  cache.erase(0);
+  EXPECT_FALSE(cache.get(0).has_value());
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,186 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <CryptoNoteCore/Transactions/PendingTransactionInfo.h>
+#include <CryptoNoteCore/Transactions/TransactionPoolStateHash.h>
+#include <CryptoNoteCore/Transactions/TransactionPriortiyComparator.h>
+
+namespace {
+using PendingTransaction = std::shared_ptr<CryptoNote::PendingTransactionInfo>;
+using PriorityIndex = std::set<PendingTransaction, CryptoNote::TransactionPriorityOrder>;
+
+template <typename _BlobT>
+void randomize(_BlobT& blob, std::mt19937_64& random) {
+  for (size_t i = 0; i < blob.size(); ++i) {
+    blob.data()[i] = static_cast<uint8_t>(random());
+  }
+}
+
+/// A transfer spending one input with the given ring size, paying fee = inputAmount - outputAmount.
+CryptoNote::CachedTransaction makeTransaction(uint64_t inputAmount, uint64_t outputAmount, size_t ringSize,
+                                              uint64_t seed) {
+  using namespace Xi::Blockchain::Transaction;
+
+  std::mt19937_64 random{seed};
+  CryptoNote::Transaction transaction{};
+  transaction.version = 1;
+  transaction.type = Type::Transfer;
+  transaction.extra.features = ExtraFeature::PublicKey;
+  transaction.extra.publicKey.emplace();
+  randomize(*transaction.extra.publicKey, random);
+
+  AmountInput input{};
+  input.amount = CanonicalAmount{inputAmount};
+  randomize(input.keyImage, random);
+  for (size_t i = 0; i < ringSize; ++i) {
+    input.outputIndices.push_back(static_cast<GlobalDeltaIndex>(i + 1));
+  }
+  transaction.inputs.emplace_back(std::move(input));
+
+  RingSignature ringSignature(ringSize);
+  for (auto& signature : ringSignature) {
+    randomize(signature, random);
+  }
+  SignatureVector signatures{};
+  signatures.emplace_back(std::move(ringSignature));
+  transaction.signatures = SignatureCollection{std::move(signatures)};
+
+  KeyOutputTarget target{};
+  randomize(target.key, random);
+  transaction.outputs.emplace_back(AmountOutput{CanonicalAmount{outputAmount}, OutputTarget{target}});
+  return CryptoNote::CachedTransaction{std::move(transaction)};
+}
+
+PendingTransaction makePending(CryptoNote::CachedTransaction transaction, CryptoNote::PosixTimestamp receiveTime) {
+  return std::make_shared<CryptoNote::PendingTransactionInfo>(std::move(transaction), CryptoNote::EligibleIndex{},
+                                                              receiveTime);
+}
+
+std::vector<Crypto::Hash> order(const PriorityIndex& index) {
+  std::vector<Crypto::Hash> reval{};
+  for (const auto& transaction : index) {
+    reval.push_back(transaction->transaction().getTransactionHash());
+  }
+  return reval;
+}
+}  // namespace
+
+TEST(CryptoNote_TransactionPool, PrioritizesHigherFeePerByte) {
+  auto cheap = makePending(makeTransaction(1000000, 900000, 4, 1), 100);
+  auto expensive = makePending(makeTransaction(1000000, 500000, 8, 2), 200);
+  ASSERT_GT(expensive->transaction().getBlobSize(), cheap->transaction().getBlobSize());
+
+  PriorityIndex index{cheap, expensive};
+  EXPECT_EQ(order(index), (std::vector<Crypto::Hash>{expensive->transaction().getTransactionHash(),
+                                                     cheap->transaction().getTransactionHash()}));
+}
+
+TEST(CryptoNote_TransactionPool, PrioritizesSmallerAndOlderOnEqualPrice) {
+  auto large = makePending(makeTransaction(1000000, 1000000, 8, 1), 100);
+  auto smallYoung = makePending(makeTransaction(1000000, 1000000, 4, 2), 300);
+  auto smallOld = makePending(makeTransaction(1000000, 1000000, 4, 3), 200);
+  ASSERT_EQ(smallYoung->transaction().getBlobSize(), smallOld->transaction().getBlobSize());
+
+  PriorityIndex index{large, smallYoung, smallOld};
+  EXPECT_EQ(order(index), (std::vector<Crypto::Hash>{smallOld->transaction().getTransactionHash(),
+                                                     smallYoung->transaction().getTransactionHash(),
+                                                     large->transaction().getTransactionHash()}));
+}
+
+TEST(CryptoNote_TransactionPool, KeepsDistinctTransactionsOfEqualPriority) {
+  auto first = makePending(makeTransaction(1000000, 900000, 4, 1), 100);
+  auto second = makePending(makeTransaction(1000000, 900000, 4, 2), 100);
+  ASSERT_NE(first->transaction().getTransactionHash(), second->transaction().getTransactionHash());
+
+  PriorityIndex index{};
+  EXPECT_TRUE(index.insert(first).second);
+  EXPECT_TRUE(index.insert(second).second);
+  EXPECT_FALSE(index.insert(first).second);
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_LT(order(index)[0], order(index)[1]);
+
+  EXPECT_EQ(index.erase(first), 1u);
+  EXPECT_EQ(order(index), std::vector<Crypto::Hash>{second->transaction().getTransactionHash()});
+}
+
+TEST(CryptoNote_TransactionPool, StateHashOfEmptyPoolIsNull) {
+  CryptoNote::TransactionPoolStateHash state{};
+  EXPECT_EQ(state.compute(0), Crypto::Hash::Null);
+
+  state.toggle(makeTransaction(1000000, 900000, 4, 1).getTransactionHash());
+  state.clear();
+  EXPECT_EQ(state.compute(0), Crypto::Hash::Null);
+}
+
+TEST(CryptoNote_TransactionPool, StateHashRestoredAfterAddRemove) {
+  const auto first = makeTransaction(1000000, 900000, 4, 1).getTransactionHash();
+  const auto second = makeTransaction(1000000, 900000, 4, 2).getTransactionHash();
+
+  CryptoNote::TransactionPoolStateHash state{};
+  state.toggle(first);
+  const auto before = state.compute(1);
+  EXPECT_NE(before, Crypto::Hash::Null);
+
+  state.toggle(second);
+  const auto added = state.compute(2);
+  EXPECT_NE(added, before);
+
+  state.toggle(second);
+  EXPECT_EQ(state.compute(1), before);
+
+  state.toggle(first);
+  EXPECT_EQ(state.compute(0), Crypto::Hash::Null);
+}
+
+TEST(CryptoNote_TransactionPool, StateHashIndependentOfInsertionOrder) {
+  std::vector<Crypto::Hash> hashes{};
+  for (uint64_t i = 0; i < 8; ++i) {
+    hashes.push_back(makeTransaction(1000000, 900000, 4, i + 1).getTransactionHash());
+  }
+
+  CryptoNote::TransactionPoolStateHash forward{};
+  for (const auto& hash : hashes) {
+    forward.toggle(hash);
+  }
+
+  std::vector<Crypto::Hash> shuffled = hashes;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64{0x5eed});
+  ASSERT_NE(shuffled, hashes);
+  CryptoNote::TransactionPoolStateHash reordered{};
+  for (const auto& hash : shuffled) {
+    reordered.toggle(hash);
+  }
+
+  EXPECT_EQ(forward.compute(hashes.size()), reordered.compute(hashes.size()));
+  EXPECT_NE(forward.compute(hashes.size()), forward.compute(hashes.size() - 1));
+}
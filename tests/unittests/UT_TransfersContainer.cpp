@@ -0,0 +1,256 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/Transactions/TransactionApi.h>
+#include <Transfers/TransfersContainer.h>
+
+namespace {
+class CryptoNote_TransfersContainer : public ::testing::Test {
+ public:
+  static constexpr size_t SpendableAge = 5;
+
+  Logging::ConsoleLogger logger{Logging::Error};
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::unique_ptr<CryptoNote::TransfersContainer> container;
+  uint32_t nonce = 0;
+  uint32_t globalIndex = 0;
+
+  struct Output {
+    uint64_t amount;
+    uint64_t unlockTime;
+    Crypto::KeyImage keyImage;
+  };
+
+  void SetUp() override {
+    using namespace CryptoNote;
+    currency = std::make_unique<Currency>(CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    container = std::make_unique<TransfersContainer>(*currency, logger, SpendableAge);
+  }
+
+  Crypto::Hash nextHash() {
+    nonce += 1;
+    return Crypto::Hash::compute(Xi::asConstByteSpan(&nonce, sizeof(nonce))).takeOrThrow();
+  }
+
+  Crypto::KeyImage nextKeyImage() {
+    const auto hash = nextHash();
+    Crypto::KeyImage reval{};
+    std::copy(hash.begin(), hash.end(), reval.begin());
+    return reval;
+  }
+
+  static CryptoNote::TransactionBlockInfo blockAt(CryptoNote::BlockHeight height) {
+    CryptoNote::TransactionBlockInfo block{};
+    block.height = height;
+    block.timestamp = 0;
+    block.transactionIndex = 0;
+    return block;
+  }
+
+  /// Receives outputs of the given amounts in one transaction, unconfirmed if height is null.
+  Crypto::Hash receive(CryptoNote::BlockHeight height, std::vector<Output>& outputs, uint64_t unlockTime = 0) {
+    using namespace CryptoNote;
+    TransactionPrefix prefix{};
+    prefix.version = 1;
+    prefix.type = TransactionType::Transfer;
+    prefix.unlockTime = unlockTime;
+
+    std::vector<TransactionOutputInformationIn> transfers{};
+    for (auto& output : outputs) {
+      KeyOutput target{};
+      prefix.outputs.emplace_back(TransactionAmountOutput{CanonicalAmount{output.amount}, target});
+
+      TransactionOutputInformationIn transfer{};
+      transfer.type = TransactionTypes::OutputTargetType::Key;
+      transfer.amount = output.amount;
+      transfer.globalOutputIndex = height.isNull() ? UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX : globalIndex++;
+      transfer.outputInTransaction = static_cast<uint32_t>(prefix.outputs.size() - 1);
+      transfer.keyImage = nextKeyImage();
+      output.unlockTime = unlockTime;
+      output.keyImage = transfer.keyImage;
+      transfers.emplace_back(std::move(transfer));
+    }
+
+    const auto hash = nextHash();
+    auto tx = createTransactionPrefix(prefix, hash);
+    EXPECT_TRUE(container->addTransaction(blockAt(height), *tx, transfers));
+    return hash;
+  }
+
+  /// Spends the given outputs in one transaction without change, unconfirmed if height is null.
+  Crypto::Hash spend(CryptoNote::BlockHeight height, const std::vector<Output>& outputs) {
+    using namespace CryptoNote;
+    TransactionPrefix prefix{};
+    prefix.version = 1;
+    prefix.type = TransactionType::Transfer;
+    for (const auto& output : outputs) {
+      KeyInput input{};
+      input.amount = CanonicalAmount{output.amount};
+      input.keyImage = output.keyImage;
+      prefix.inputs.emplace_back(std::move(input));
+    }
+
+    const auto hash = nextHash();
+    auto tx = createTransactionPrefix(prefix, hash);
+    EXPECT_TRUE(container->addTransaction(blockAt(height), *tx, {}));
+    return hash;
+  }
+
+  /// Compares the running balances with a full scan of the visible outputs for every state combination.
+  void expectBalancesMatchOutputs() const {
+    using Flags = CryptoNote::ITransfersContainer::Flags;
+    for (uint32_t flags : {uint32_t{Flags::IncludeKeyUnlocked}, uint32_t{Flags::IncludeKeyNotUnlocked},
+                           uint32_t{Flags::IncludeTypeKey | Flags::IncludeStateLocked},
+                           uint32_t{Flags::IncludeTypeKey | Flags::IncludeStateSoftLocked},
+                           uint32_t{Flags::IncludeAllLocked}, uint32_t{Flags::IncludeAll}}) {
+      std::vector<CryptoNote::TransactionOutputInformation> outputs{};
+      container->getOutputs(outputs, flags);
+      uint64_t recomputed = 0;
+      for (const auto& output : outputs) {
+        recomputed += output.amount;
+      }
+      EXPECT_EQ(container->balance(flags), recomputed) << "flags " << flags;
+    }
+  }
+};
+}  // namespace
+
+TEST_F(CryptoNote_TransfersContainer, BalanceFollowsSoftLockOnAdvance) {
+  using namespace CryptoNote;
+
+  std::vector<Output> outputs{{1000, 0, {}}, {20000, 0, {}}};
+  receive(BlockHeight::fromIndex(1), outputs);
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeKeyUnlocked), 0u);
+
+  for (uint32_t index = 2; index < 2 + SpendableAge; ++index) {
+    ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(index)));
+    expectBalancesMatchOutputs();
+  }
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeKeyUnlocked), 21000u);
+}
+
+TEST_F(CryptoNote_TransfersContainer, BalanceFollowsUnlockTimes) {
+  using namespace CryptoNote;
+
+  std::vector<Output> byIndex{{3000, 0, {}}};
+  receive(BlockHeight::fromIndex(1), byIndex, 20);
+  std::vector<Output> byPastTimestamp{{4000, 0, {}}};
+  receive(BlockHeight::fromIndex(2), byPastTimestamp, currency->coin().startTimestamp());
+  std::vector<Output> byFutureTimestamp{{5000, 0, {}}};
+  receive(BlockHeight::fromIndex(3), byFutureTimestamp, static_cast<uint64_t>(std::time(nullptr)) + 3600);
+  expectBalancesMatchOutputs();
+
+  for (uint32_t index = 4; index < 30; ++index) {
+    ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(index)));
+    expectBalancesMatchOutputs();
+  }
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeKeyUnlocked), 7000u);
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeTypeKey | ITransfersContainer::IncludeStateLocked), 5000u);
+}
+
+TEST_F(CryptoNote_TransfersContainer, BalanceFollowsSpendings) {
+  using namespace CryptoNote;
+
+  std::vector<Output> outputs{{1000, 0, {}}, {20000, 0, {}}, {300, 0, {}}};
+  receive(BlockHeight::fromIndex(1), outputs);
+  ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(10)));
+  expectBalancesMatchOutputs();
+
+  // An unconfirmed spending hides the output until it is either confirmed or deleted.
+  const auto pending = spend(BlockHeight::Null, {outputs[0]});
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 20300u);
+  ASSERT_TRUE(container->deleteUnconfirmedTransaction(pending));
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 21300u);
+
+  spend(BlockHeight::fromIndex(11), {outputs[0], outputs[2]});
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 20000u);
+}
+
+TEST_F(CryptoNote_TransfersContainer, BalanceFollowsConfirmation) {
+  using namespace CryptoNote;
+
+  std::vector<Output> outputs{{1000, 0, {}}, {20000, 0, {}}};
+  const auto hash = receive(BlockHeight::Null, outputs);
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeTypeKey | ITransfersContainer::IncludeStateLocked), 21000u);
+
+  ASSERT_TRUE(container->markTransactionConfirmed(blockAt(BlockHeight::fromIndex(1)), hash, {7, 8}));
+  expectBalancesMatchOutputs();
+  ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(1 + SpendableAge)));
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeKeyUnlocked), 21000u);
+}
+
+TEST_F(CryptoNote_TransfersContainer, BalanceFollowsDetach) {
+  using namespace CryptoNote;
+
+  std::vector<Output> early{{1000, 0, {}}};
+  receive(BlockHeight::fromIndex(1), early);
+  std::vector<Output> late{{20000, 0, {}}};
+  receive(BlockHeight::fromIndex(5), late);
+  ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(8)));
+  spend(BlockHeight::fromIndex(8), {early[0]});
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 20000u);
+
+  // Detaching the spending restores the output, detaching the later receipt removes it.
+  container->detach(BlockHeight::fromIndex(8));
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 21000u);
+  container->detach(BlockHeight::fromIndex(5));
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), 1000u);
+}
+
+TEST_F(CryptoNote_TransfersContainer, BalanceSurvivesSerialization) {
+  using namespace CryptoNote;
+
+  std::vector<Output> outputs{{1000, 0, {}}, {20000, 0, {}}};
+  receive(BlockHeight::fromIndex(1), outputs);
+  std::vector<Output> pending{{300, 0, {}}};
+  receive(BlockHeight::Null, pending);
+  ASSERT_TRUE(container->advanceHeight(BlockHeight::fromIndex(3)));
+  const auto expected = container->balance(ITransfersContainer::IncludeAll);
+
+  std::stringstream stream{};
+  ASSERT_TRUE(container->save(stream));
+  container = std::make_unique<TransfersContainer>(*currency, logger, SpendableAge);
+  ASSERT_TRUE(container->load(stream));
+  expectBalancesMatchOutputs();
+  EXPECT_EQ(container->balance(ITransfersContainer::IncludeAll), expected);
+}
@@ -0,0 +1,486 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <Xi/Crypto/Chacha8.h>
+#include <Logging/ConsoleLogger.h>
+#include <System/Dispatcher.h>
+#include <Common/MemoryInputStream.h>
+#include <Common/VectorOutputStream.h>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/INode.h>
+#include <Serialization/BinaryOutputStreamSerializer.h>
+#include <Wallet/WalletCacheJournal.h>
+#include <Wallet/WalletGreen.h>
+#include <Wallet/WalletSerializationV2.h>
+
+namespace {
+using CryptoNote::WalletCacheJournal;
+
+std::vector<uint8_t> randomData(size_t size, uint32_t seed) {
+  std::mt19937 engine{seed};
+  std::uniform_int_distribution<uint32_t> byte{0, 255};
+  std::vector<uint8_t> reval(size);
+  std::generate(reval.begin(), reval.end(), [&] { return static_cast<uint8_t>(byte(engine)); });
+  return reval;
+}
+
+Crypto::chacha8_key makeKey(const std::string& password) {
+  Crypto::chacha8_key reval;
+  Xi::Crypto::Chacha8::generate_key(password, reval.data, CHACHA8_KEY_SIZE);
+  return reval;
+}
+
+class CryptoNote_WalletCacheJournal : public ::testing::Test {
+ public:
+  Crypto::chacha8_key key = makeKey("password");
+  Crypto::chacha8_iv iv{};
+  WalletCacheJournal journal;
+  std::vector<uint8_t> file;
+
+  void rewrite(const std::vector<uint8_t>& data) {
+    file = journal.rewrite(data.data(), data.size(), key, iv);
+  }
+
+  size_t append(const std::vector<uint8_t>& data) {
+    const auto records = journal.append(data.data(), data.size(), key, iv);
+    file.insert(file.end(), records.begin(), records.end());
+    return records.size();
+  }
+
+  void expectLoads(const std::vector<uint8_t>& data) {
+    WalletCacheJournal loaded;
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(loaded.load(file.data(), file.size(), key, content));
+    EXPECT_TRUE(content == data);
+    EXPECT_TRUE(loaded.isAttached());
+  }
+};
+}  // namespace
+
+TEST_F(CryptoNote_WalletCacheJournal, ChunkBoundaries) {
+  const auto data = randomData(1024 * 1024, 1);
+  const auto boundaries = WalletCacheJournal::chunk(data.data(), data.size());
+  ASSERT_FALSE(boundaries.empty());
+  EXPECT_EQ(boundaries.back(), data.size());
+
+  size_t start = 0;
+  for (size_t i = 0; i < boundaries.size(); ++i) {
+    ASSERT_GT(boundaries[i], start);
+    const size_t length = boundaries[i] - start;
+    EXPECT_LE(length, WalletCacheJournal::MaxChunkSize);
+    if (i + 1 < boundaries.size()) {
+      EXPECT_GE(length, WalletCacheJournal::MinChunkSize);
+    }
+    start = boundaries[i];
+  }
+
+  EXPECT_TRUE(WalletCacheJournal::chunk(data.data(), 0).empty());
+  EXPECT_EQ(WalletCacheJournal::chunk(data.data(), 1), std::vector<size_t>{1});
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, ChunkBoundariesSurviveInsertion) {
+  const auto data = randomData(1024 * 1024, 2);
+  auto modified = data;
+  const auto insertion = randomData(100, 3);
+  modified.insert(modified.begin() + static_cast<std::ptrdiff_t>(data.size() / 2), insertion.begin(),
+                  insertion.end());
+
+  const auto before = WalletCacheJournal::chunk(data.data(), data.size());
+  const auto after = WalletCacheJournal::chunk(modified.data(), modified.size());
+
+  // Boundaries behind the insertion resynchronize, they are only shifted by the inserted bytes.
+  size_t shared = 0;
+  for (const auto boundary : after) {
+    const size_t original = boundary > data.size() / 2 ? boundary - insertion.size() : boundary;
+    if (std::binary_search(before.begin(), before.end(), original)) {
+      shared += 1;
+    }
+  }
+  EXPECT_GE(shared + 3, before.size());
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, RoundTrip) {
+  const auto data = randomData(300 * 1024, 4);
+  rewrite(data);
+  EXPECT_TRUE(journal.isAttached());
+  expectLoads(data);
+
+  const auto empty = std::vector<uint8_t>{};
+  rewrite(empty);
+  expectLoads(empty);
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, RejectsWrongKey) {
+  const auto data = randomData(64 * 1024, 5);
+  rewrite(data);
+
+  WalletCacheJournal loaded;
+  std::vector<uint8_t> content;
+  EXPECT_FALSE(loaded.load(file.data(), file.size(), makeKey("other"), content));
+  EXPECT_FALSE(loaded.isAttached());
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, AppendsOnlyChangedChunks) {
+  auto data = randomData(1024 * 1024, 6);
+  rewrite(data);
+  const size_t initialSize = file.size();
+
+  // An unchanged save only appends the manifest.
+  const size_t chunkCount = WalletCacheJournal::chunk(data.data(), data.size()).size();
+  EXPECT_LT(append(data), chunkCount * sizeof(Crypto::Hash) + 2 * WalletCacheJournal::RecordPadding);
+  expectLoads(data);
+
+  data[data.size() / 3] ^= 0xFF;
+  const size_t appended = append(data);
+  EXPECT_LT(appended, 2 * WalletCacheJournal::MaxChunkSize);
+  EXPECT_LT(appended, initialSize / 4);
+  expectLoads(data);
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, PadsRecords) {
+  const auto data = randomData(1000 * 1024, 7);
+  rewrite(data);
+  const size_t size = file.size();
+
+  auto shrunk = data;
+  shrunk.resize(shrunk.size() - 1);
+  rewrite(shrunk);
+  // Only the last chunk shrinks by a byte, the padded records hide the difference.
+  EXPECT_EQ(file.size(), size);
+  expectLoads(shrunk);
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, RecoversFromTornTail) {
+  const auto first = randomData(200 * 1024, 8);
+  rewrite(first);
+
+  auto second = first;
+  second[second.size() / 2] ^= 0xFF;
+  const size_t firstSize = file.size();
+  append(second);
+
+  for (const size_t cut : {size_t{1}, size_t{100}, file.size() - firstSize - 1}) {
+    std::vector<uint8_t> torn{file.begin(), file.end() - static_cast<std::ptrdiff_t>(cut)};
+    WalletCacheJournal loaded;
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(loaded.load(torn.data(), torn.size(), key, content));
+    EXPECT_TRUE(content == first);
+    // Further records would follow the torn one and be ignored on load, hence the next save must rewrite.
+    EXPECT_FALSE(loaded.isAttached());
+    EXPECT_TRUE(loaded.needsCompaction(torn.size()));
+  }
+
+  file.resize(firstSize / 2);
+  WalletCacheJournal loaded;
+  std::vector<uint8_t> content;
+  EXPECT_FALSE(loaded.load(file.data(), file.size(), key, content));
+}
+
+TEST_F(CryptoNote_WalletCacheJournal, Compaction) {
+  const auto data = randomData(256 * 1024, 9);
+  rewrite(data);
+  EXPECT_FALSE(journal.needsCompaction(file.size()));
+
+  // Every save replaces the whole content, the journal grows by the full size each time.
+  for (uint32_t i = 0; i < 4 && !journal.needsCompaction(file.size()); ++i) {
+    append(randomData(data.size(), 10 + i));
+  }
+  ASSERT_TRUE(journal.needsCompaction(file.size()));
+
+  const auto latest = randomData(data.size(), 20);
+  append(latest);
+  expectLoads(latest);
+
+  rewrite(latest);
+  EXPECT_FALSE(journal.needsCompaction(file.size()));
+  EXPECT_LE(file.size(), latest.size() + latest.size() / 4);
+  expectLoads(latest);
+}
+
+namespace {
+class NodeStub : public CryptoNote::INode {
+ public:
+  explicit NodeStub(const CryptoNote::Currency& currency) : m_currency{currency} {
+  }
+
+  bool addObserver(CryptoNote::INodeObserver*) override {
+    return true;
+  }
+  bool removeObserver(CryptoNote::INodeObserver*) override {
+    return true;
+  }
+  void init(const Callback& callback) override {
+    callback(std::error_code{});
+  }
+  bool shutdown() override {
+    return true;
+  }
+  size_t getPeerCount() const override {
+    return 0;
+  }
+  CryptoNote::BlockHeight getLastLocalBlockHeight() const override {
+    return CryptoNote::BlockHeight::Genesis;
+  }
+  CryptoNote::BlockHeight getLastKnownBlockHeight() const override {
+    return CryptoNote::BlockHeight::Genesis;
+  }
+  CryptoNote::BlockVersion getLastKnownBlockVersion() const override {
+    return m_currency.genesisBlock().version;
+  }
+  uint32_t getLocalBlockCount() const override {
+    return 1;
+  }
+  uint32_t getKnownBlockCount() const override {
+    return 1;
+  }
+  uint64_t getLastLocalBlockTimestamp() const override {
+    return 0;
+  }
+  CryptoNote::BlockHeight getNodeHeight() const override {
+    return CryptoNote::BlockHeight::Genesis;
+  }
+  void getFeeInfo() override {
+  }
+  const CryptoNote::Currency& currency() const override {
+    return m_currency;
+  }
+  std::error_code ping() override {
+    return std::error_code{};
+  }
+  void getBlockHashesByTimestamps(uint64_t, size_t, std::vector<Crypto::Hash>&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getTransactionHashesByPaymentId(const CryptoNote::PaymentId&, std::vector<Crypto::Hash>&,
+                                       const Callback& callback) override {
+    callback(unsupported());
+  }
+  CryptoNote::BlockHeaderInfo getLastLocalBlockHeaderInfo() const override {
+    return CryptoNote::BlockHeaderInfo{};
+  }
+  void getLastBlockHeaderInfo(CryptoNote::BlockHeaderInfo&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void relayTransaction(const CryptoNote::Transaction&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getRandomOutsByAmounts(
+      std::map<uint64_t, uint64_t>&&,
+      std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>&,
+      const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getRequiredMixinByAmounts(std::set<uint64_t>&&, std::map<uint64_t, uint64_t>&,
+                                 const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getNewBlocks(std::vector<Crypto::Hash>&&, std::vector<CryptoNote::RawBlock>&, CryptoNote::BlockHeight&,
+                    const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getTransactionOutsGlobalIndices(const Crypto::Hash&, std::vector<uint32_t>&,
+                                       const Callback& callback) override {
+    callback(unsupported());
+  }
+  void queryBlocks(std::vector<Crypto::Hash>&&, uint64_t, std::vector<CryptoNote::BlockShortEntry>&,
+                   CryptoNote::BlockHeight&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getPoolSymmetricDifference(std::vector<Crypto::Hash>&&, Crypto::Hash, bool&,
+                                  std::vector<std::unique_ptr<CryptoNote::ITransactionReader>>&,
+                                  std::vector<Crypto::Hash>&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getBlocks(const std::vector<CryptoNote::BlockHeight>&, std::vector<std::vector<CryptoNote::BlockDetails>>&,
+                 const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getBlocks(const std::vector<Crypto::Hash>&, std::vector<CryptoNote::BlockDetails>&,
+                 const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getRawBlocksByRange(CryptoNote::BlockHeight, uint32_t, std::vector<CryptoNote::RawBlock>&,
+                           const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getBlock(const CryptoNote::BlockHeight, CryptoNote::BlockDetails&, const Callback& callback) override {
+    callback(unsupported());
+  }
+  void getTransactions(const std::vector<Crypto::Hash>&, std::vector<CryptoNote::TransactionDetails>&,
+                       const Callback& callback) override {
+    callback(unsupported());
+  }
+  void isSynchronized(bool& syncStatus, const Callback& callback) override {
+    syncStatus = true;
+    callback(std::error_code{});
+  }
+  std::optional<CryptoNote::FeeAddress> feeAddress() const override {
+    return std::nullopt;
+  }
+
+ private:
+  static std::error_code unsupported() {
+    return std::make_error_code(std::errc::operation_not_supported);
+  }
+
+  const CryptoNote::Currency& m_currency;
+};
+
+/// The wallet container is created without addresses, hence the blockchain synchronizer never queries the node.
+class CryptoNote_WalletCacheJournalContainer : public ::testing::Test {
+ public:
+  std::string path{"./wallet_cache_journal_test.wallet"};
+  std::string extra;
+  Logging::ConsoleLogger logger{Logging::Error};
+  System::Dispatcher dispatcher;
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::unique_ptr<NodeStub> node;
+
+  void SetUp() override {
+    Xi::FileSystem::removeFileIfExists(path).throwOnError();
+    currency = std::make_unique<CryptoNote::Currency>(
+        CryptoNote::CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    node = std::make_unique<NodeStub>(*currency);
+    const auto content = randomData(200 * 1024, 42);
+    extra.assign(content.begin(), content.end());
+  }
+
+  void TearDown() override {
+    Xi::FileSystem::removeFileIfExists(path).throwOnError();
+  }
+
+  std::unique_ptr<CryptoNote::WalletGreen> makeWallet() {
+    return std::make_unique<CryptoNote::WalletGreen>(dispatcher, *currency, *node, logger);
+  }
+
+  void createWallet(const std::string& password) {
+    auto wallet = makeWallet();
+    wallet->initialize(path, password);
+    wallet->save(CryptoNote::WalletSaveLevel::SAVE_ALL, extra);
+    wallet->shutdown();
+  }
+
+  void expectLoads(const std::string& password) {
+    auto wallet = makeWallet();
+    std::string loadedExtra;
+    wallet->load(path, password, loadedExtra);
+    // A corrupted cache is reset silently, the extra only survives if the cache was restored.
+    EXPECT_TRUE(loadedExtra == extra);
+    wallet->shutdown();
+  }
+
+  /// The container prefix starts with the version byte followed by the next iv.
+  static uint8_t containerVersion(const CryptoNote::ContainerStorage& storage) {
+    return storage.prefix()[0];
+  }
+
+  CryptoNote::ContainerStorage openContainer() const {
+    return CryptoNote::ContainerStorage{path, Common::FileMappedVectorOpenMode::OPEN, prefixSize()};
+  }
+
+  static uint64_t prefixSize() {
+    return sizeof(uint8_t) + sizeof(Crypto::chacha8_iv) + sizeof(CryptoNote::EncryptedWalletRecord);
+  }
+};
+}  // namespace
+
+TEST_F(CryptoNote_WalletCacheJournalContainer, ChangePasswordReencryptsJournal) {
+  createWallet("old");
+  {
+    auto wallet = makeWallet();
+    wallet->load(path, "old");
+    wallet->changePassword("old", "new");
+    wallet->shutdown();
+  }
+
+  {
+    auto storage = openContainer();
+    EXPECT_EQ(containerVersion(storage), CryptoNote::WalletSerializerV2::JOURNAL_VERSION);
+    WalletCacheJournal journal;
+    std::vector<uint8_t> content;
+    EXPECT_FALSE(journal.load(storage.suffix(), storage.suffixSize(), makeKey("old"), content));
+    EXPECT_TRUE(journal.load(storage.suffix(), storage.suffixSize(), makeKey("new"), content));
+  }
+
+  EXPECT_ANY_THROW(makeWallet()->load(path, "old"));
+  expectLoads("new");
+}
+
+TEST_F(CryptoNote_WalletCacheJournalContainer, UpgradesLegacyCache) {
+  createWallet("password");
+
+  // Rewrites the container cache in the version 6 layout, a single encrypted blob prefixed by its iv.
+  {
+    auto storage = openContainer();
+    ASSERT_EQ(containerVersion(storage), CryptoNote::WalletSerializerV2::JOURNAL_VERSION);
+    const auto key = makeKey("password");
+    WalletCacheJournal journal;
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(journal.load(storage.suffix(), storage.suffixSize(), key, content));
+
+    Crypto::chacha8_iv suffixIv;
+    std::copy_n(storage.prefix() + 1, sizeof(suffixIv.data), suffixIv.data);
+    CryptoNote::BinaryArray encryptedContainer(content.size());
+    Crypto::chacha8(content.data(), content.size(), key, suffixIv,
+                    reinterpret_cast<char*>(encryptedContainer.data()));
+
+    CryptoNote::BinaryArray suffix;
+    Common::VectorOutputStream suffixStream(suffix);
+    CryptoNote::BinaryOutputStreamSerializer suffixSerializer(suffixStream);
+    ASSERT_TRUE(suffixSerializer(suffixIv, "suffixIv"));
+    ASSERT_TRUE(suffixSerializer(encryptedContainer, "encryptedContainer"));
+
+    storage.prefix()[0] = CryptoNote::WalletSerializerV2::JOURNAL_VERSION - 1;
+    storage.resizeSuffix(suffix.size());
+    std::copy(suffix.begin(), suffix.end(), storage.suffix());
+    storage.flush();
+  }
+
+  {
+    auto wallet = makeWallet();
+    std::string loadedExtra;
+    wallet->load(path, "password", loadedExtra);
+    EXPECT_TRUE(loadedExtra == extra);
+    wallet->save(CryptoNote::WalletSaveLevel::SAVE_ALL, loadedExtra);
+    wallet->shutdown();
+  }
+
+  {
+    auto storage = openContainer();
+    EXPECT_EQ(containerVersion(storage), CryptoNote::WalletSerializerV2::JOURNAL_VERSION);
+    WalletCacheJournal journal;
+    std::vector<uint8_t> content;
+    EXPECT_TRUE(journal.load(storage.suffix(), storage.suffixSize(), makeKey("password"), content));
+  }
+  expectLoads("password");
+}
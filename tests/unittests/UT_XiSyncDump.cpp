@@ -0,0 +1,180 @@
+﻿/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Xi/FileSystem.h>
+#include <Logging/ConsoleLogger.h>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+
+#include "DumpReader.h"
+#include "DumpWriter.h"
+
+namespace {
+class XiSync_Dump : public ::testing::Test {
+ public:
+  class CollectingVisitor : public XiSync::DumpReader::Visitor {
+   public:
+    uint32_t SkipBelow = 0;
+    std::vector<XiSync::Batch> Batches;
+
+    BatchCommand onInfo(const XiSync::BatchInfo& info) override {
+      return info.StartIndex < SkipBelow ? BatchCommand::Skip : BatchCommand::Read;
+    }
+    void onBatch(XiSync::Batch batch) override {
+      Batches.emplace_back(std::move(batch));
+    }
+  };
+
+  static constexpr uint32_t BatchSize = 8;
+  static constexpr uint32_t BatchCount = 3;
+
+  std::string filename{"./xisync_dump_test"};
+  Logging::ConsoleLogger logger{Logging::Error};
+  std::unique_ptr<CryptoNote::Currency> currency;
+  std::vector<CryptoNote::RawBlock> blocks;
+
+  void SetUp() override {
+    using namespace CryptoNote;
+    Xi::FileSystem::removeFileIfExists(filename).throwOnError();
+    currency = std::make_unique<Currency>(CurrencyBuilder{logger}.network("UnitTests.Network").currency());
+    BlockTemplate block = currency->genesisBlock();
+    for (uint32_t i = 0; i < BatchSize * BatchCount; ++i) {
+      block.nonce.advance(1);
+      RawBlock raw{};
+      raw.blockTemplate = toBinaryArray(block);
+      blocks.emplace_back(std::move(raw));
+    }
+  }
+
+  void TearDown() override {
+    Xi::FileSystem::removeFileIfExists(filename).throwOnError();
+  }
+
+  void writeDump(XiSync::BatchCompression compression) {
+    auto writer = XiSync::DumpWriter::open(filename).takeOrThrow();
+    writer->setCompression(compression);
+    writeBatches(*writer);
+    ASSERT_FALSE(writer->finish().isError());
+  }
+
+  void writeBatches(XiSync::DumpWriter& writer) {
+    for (uint32_t i = 0; i < BatchCount; ++i) {
+      std::vector<CryptoNote::RawBlock> batch{blocks.begin() + i * BatchSize, blocks.begin() + (i + 1) * BatchSize};
+      ASSERT_FALSE(writer.write(i * BatchSize, std::move(batch)).isError());
+    }
+  }
+
+  std::vector<char> readFile() const {
+    std::ifstream stream{filename, std::ios::binary};
+    return std::vector<char>{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+  }
+
+  void writeFile(const std::vector<char>& content) const {
+    std::ofstream stream{filename, std::ios::binary | std::ios::trunc};
+    stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+  }
+
+  void expectBatches(const CollectingVisitor& visitor, uint32_t firstBatch) const {
+    ASSERT_EQ(visitor.Batches.size(), BatchCount - firstBatch);
+    for (uint32_t i = firstBatch; i < BatchCount; ++i) {
+      const auto& batch = visitor.Batches[i - firstBatch];
+      EXPECT_EQ(batch.Info.StartIndex, i * BatchSize);
+      ASSERT_EQ(batch.Info.Count, BatchSize);
+      ASSERT_EQ(batch.Blocks.size(), BatchSize);
+      ASSERT_EQ(batch.CachedBlocks.size(), BatchSize);
+      for (uint32_t j = 0; j < BatchSize; ++j) {
+        EXPECT_EQ(batch.Blocks[j].blockTemplate, blocks[i * BatchSize + j].blockTemplate);
+      }
+      EXPECT_EQ(batch.Info.Checkpoints.at(i * BatchSize), batch.CachedBlocks.front().getBlockHash());
+    }
+  }
+};
+}  // namespace
+
+TEST_F(XiSync_Dump, RoundTrip) {
+  using namespace XiSync;
+  for (auto compression : {BatchCompression::None, BatchCompression::LZ4}) {
+    writeDump(compression);
+    CollectingVisitor visitor{};
+    auto reader = DumpReader::open(filename, visitor).takeOrThrow();
+    reader->setConcurrency(2);
+    ASSERT_FALSE(reader->readAll().isError());
+    expectBatches(visitor, 0);
+  }
+}
+
+TEST_F(XiSync_Dump, SkipsBatchesBelowRequest) {
+  using namespace XiSync;
+  writeDump(BatchCompression::LZ4);
+  CollectingVisitor visitor{};
+  visitor.SkipBelow = BatchSize;
+  auto reader = DumpReader::open(filename, visitor).takeOrThrow();
+  ASSERT_FALSE(reader->readAll().isError());
+  expectBatches(visitor, 1);
+}
+
+TEST_F(XiSync_Dump, RejectsBadChecksum) {
+  using namespace XiSync;
+  writeDump(BatchCompression::None);
+  auto content = readFile();
+  // The header is a single version byte, the first batch payload follows it.
+  content[1 + 4] ^= 0x5A;
+  writeFile(content);
+
+  CollectingVisitor visitor{};
+  auto reader = DumpReader::open(filename, visitor).takeOrThrow();
+  EXPECT_TRUE(reader->readAll().isError());
+  EXPECT_TRUE(visitor.Batches.empty());
+}
+
+TEST_F(XiSync_Dump, RejectsTruncatedBody) {
+  using namespace XiSync;
+  writeDump(BatchCompression::None);
+  auto content = readFile();
+  content.resize(content.size() / 2);
+  writeFile(content);
+
+  CollectingVisitor visitor{};
+  EXPECT_TRUE(DumpReader::open(filename, visitor).isError());
+}
+
+TEST_F(XiSync_Dump, AbortedWriterLeavesDumpUnindexed) {
+  using namespace XiSync;
+  {
+    auto writer = DumpWriter::open(filename).takeOrThrow();
+    writeBatches(*writer);
+  }
+
+  CollectingVisitor visitor{};
+  EXPECT_TRUE(DumpReader::open(filename, visitor).isError());
+}
@@ -0,0 +1,224 @@
+/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/utility/value_init.hpp>
+
+#include <Common/MemoryInputStream.h>
+#include <Common/StringTools.h>
+#include <Logging/ConsoleLogger.h>
+#include <Serialization/BinaryInputStreamSerializer.h>
+#include <Serialization/BinarySpanInputSerializer.hpp>
+#include <CryptoNoteCore/Currency.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+
+namespace CNSerialiaztion_TestSuite {
+
+template <typename T>
+struct DecodeResult {
+  bool success = false;
+  T value = boost::value_initialized<T>();
+};
+
+/// Decodes like fromBinaryArray did before, a failure is either a failed serialization, an exception or trailing data.
+template <typename T>
+DecodeResult<T> decodeStream(const CryptoNote::BinaryArray& blob) {
+  DecodeResult<T> reval{};
+  try {
+    Common::MemoryInputStream stream(blob.data(), blob.size());
+    CryptoNote::BinaryInputStreamSerializer serializer(stream);
+    reval.success = serializer(reval.value, "") && stream.endOfStream();
+  } catch (const std::exception&) {
+    reval.success = false;
+  }
+  return reval;
+}
+
+template <typename T>
+DecodeResult<T> decodeSpan(const CryptoNote::BinaryArray& blob) {
+  DecodeResult<T> reval{};
+  try {
+    CryptoNote::BinarySpanInputSerializer serializer(Xi::ConstByteSpan{blob.data(), blob.size()});
+    reval.success = serializer(reval.value, "") && serializer.isEndOfStream();
+  } catch (const std::exception&) {
+    reval.success = false;
+  }
+  return reval;
+}
+
+template <typename T>
+void expectEquivalent(const CryptoNote::BinaryArray& blob) {
+  const auto stream = decodeStream<T>(blob);
+  const auto span = decodeSpan<T>(blob);
+  ASSERT_EQ(stream.success, span.success) << Common::toHex(blob.data(), blob.size());
+  if (stream.success) {
+    if constexpr (std::is_integral_v<T> || std::is_same_v<T, std::string>) {
+      EXPECT_EQ(stream.value, span.value) << Common::toHex(blob.data(), blob.size());
+    } else {
+      EXPECT_EQ(CryptoNote::toBinaryArray(stream.value), CryptoNote::toBinaryArray(span.value))
+          << Common::toHex(blob.data(), blob.size());
+    }
+  }
+}
+
+/// Valid blobs, every prefix and single byte substitutions keeping the varint continuation bits of the blob intact.
+template <typename T>
+void expectEquivalentMutations(const CryptoNote::BinaryArray& blob) {
+  ASSERT_TRUE(decodeSpan<T>(blob).success);
+  expectEquivalent<T>(blob);
+
+  for (size_t size = 0; size < blob.size(); ++size) {
+    expectEquivalent<T>(CryptoNote::BinaryArray{blob.begin(), blob.begin() + static_cast<std::ptrdiff_t>(size)});
+  }
+
+  for (const uint8_t trailing : {uint8_t{0x00}, uint8_t{0x80}, uint8_t{0xFF}}) {
+    auto extended = blob;
+    extended.push_back(trailing);
+    expectEquivalent<T>(extended);
+  }
+
+  // Substitutions never set a continuation bit, array sizes stay small enough to be allocated by both decoders.
+  for (size_t i = 0; i < blob.size(); ++i) {
+    for (const uint8_t substitute : {uint8_t{0x00}, uint8_t{0x7F}, static_cast<uint8_t>(blob[i] ^ 0x01),
+                                     static_cast<uint8_t>(blob[i] & 0x7F)}) {
+      auto mutated = blob;
+      mutated[i] = substitute;
+      expectEquivalent<T>(mutated);
+    }
+  }
+}
+
+template <typename _BlobT>
+void randomize(_BlobT& blob, std::mt19937_64& random) {
+  for (size_t i = 0; i < blob.size(); ++i) {
+    blob.data()[i] = static_cast<uint8_t>(random());
+  }
+}
+
+CryptoNote::Transaction makeTransfer(std::mt19937_64& random) {
+  using namespace Xi::Blockchain::Transaction;
+
+  CryptoNote::Transaction transaction{};
+  transaction.version = 1;
+  transaction.type = Type::Transfer;
+  transaction.extra.features = ExtraFeature::PublicKey;
+  transaction.extra.publicKey.emplace();
+  randomize(*transaction.extra.publicKey, random);
+
+  SignatureVector signatures{};
+  for (size_t i = 0; i < 2; ++i) {
+    AmountInput input{};
+    input.amount = CanonicalAmount{(i + 1) * 1000000};
+    randomize(input.keyImage, random);
+    for (size_t j = 0; j < 3; ++j) {
+      input.outputIndices.push_back(static_cast<GlobalDeltaIndex>(random() % (j == 0 ? 2000000 : 200) + 1));
+    }
+    transaction.inputs.emplace_back(std::move(input));
+
+    RingSignature ringSignature(3);
+    for (auto& signature : ringSignature) {
+      randomize(signature, random);
+    }
+    signatures.emplace_back(std::move(ringSignature));
+  }
+  transaction.signatures = SignatureCollection{std::move(signatures)};
+
+  for (size_t i = 0; i < 2; ++i) {
+    KeyOutputTarget target{};
+    randomize(target.key, random);
+    transaction.outputs.emplace_back(AmountOutput{CanonicalAmount{(i + 1) * 100000}, OutputTarget{target}});
+  }
+  return transaction;
+}
+
+}  // namespace CNSerialiaztion_TestSuite
+
+TEST(CryptoNote_Serialization, BinarySpanInputEquivalentTransactions) {
+  using namespace CNSerialiaztion_TestSuite;
+
+  std::mt19937_64 random{0x5eed};
+  expectEquivalentMutations<CryptoNote::Transaction>(CryptoNote::toBinaryArray(makeTransfer(random)));
+
+  Logging::ConsoleLogger logger{Logging::Error};
+  const auto currency = CryptoNote::CurrencyBuilder{logger}.network("UnitTests.Network").currency();
+  expectEquivalentMutations<CryptoNote::Transaction>(
+      CryptoNote::toBinaryArray(currency.genesisBlock().baseTransaction));
+}
+
+TEST(CryptoNote_Serialization, BinarySpanInputEquivalentBlocks) {
+  using namespace CNSerialiaztion_TestSuite;
+
+  Logging::ConsoleLogger logger{Logging::Error};
+  const auto currency = CryptoNote::CurrencyBuilder{logger}.network("UnitTests.Network").currency();
+  expectEquivalentMutations<CryptoNote::BlockTemplate>(CryptoNote::toBinaryArray(currency.genesisBlock()));
+
+  std::mt19937_64 random{0xb10c};
+  CryptoNote::RawBlock rawBlock{};
+  rawBlock.blockTemplate = CryptoNote::toBinaryArray(currency.genesisBlock());
+  rawBlock.transactions.emplace_back(CryptoNote::toBinaryArray(makeTransfer(random)));
+  expectEquivalentMutations<CryptoNote::RawBlock>(CryptoNote::toBinaryArray(rawBlock));
+}
+
+TEST(CryptoNote_Serialization, BinarySpanInputEquivalentVarints) {
+  using namespace CNSerialiaztion_TestSuite;
+  using Blob = CryptoNote::BinaryArray;
+
+  const std::vector<Blob> blobs{
+      Blob{},
+      Blob{0x00},
+      Blob{0x7F},
+      Blob{0x80},
+      Blob{0x80, 0x00},
+      Blob{0x80, 0x01},
+      Blob{0xFF, 0x01},
+      Blob{0x80, 0x02},
+      Blob{0xFF, 0xFF, 0x03},
+      Blob{0xFF, 0xFF, 0x04},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0x0F},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0x1F},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01},
+      Blob{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+      Blob{0x80, 0x80, 0x80, 0x00},
+      Blob{0x01, 0x00},
+  };
+
+  for (const auto& blob : blobs) {
+    expectEquivalent<uint16_t>(blob);
+    expectEquivalent<int16_t>(blob);
+    expectEquivalent<uint32_t>(blob);
+    expectEquivalent<int32_t>(blob);
+    expectEquivalent<uint64_t>(blob);
+    expectEquivalent<int64_t>(blob);
+    expectEquivalent<std::string>(blob);
+  }
+}
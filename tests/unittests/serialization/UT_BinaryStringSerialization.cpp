@@ -0,0 +1,258 @@
+/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gmock/gmock.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Serialization/ISerializer.h>
+#include <Serialization/SerializationOverloads.h>
+#include <Serialization/SerializationTools.h>
+#include <CryptoNoteCore/CryptoNoteTools.h>
+#include <Rpc/CoreRpcServerCommandsDefinitions.h>
+
+namespace CNSerialiaztion_TestSuite {
+
+struct BinaryStringEntry {
+  std::vector<uint64_t> heights;
+  std::string blob;
+  uint64_t timestamp;
+  std::string status;
+
+  KV_BEGIN_SERIALIZATION
+  KV_MEMBER(heights)
+  XI_RETURN_EC_IF_NOT(s.binary(blob, "blob"), false);
+  KV_MEMBER(timestamp)
+  KV_MEMBER(status)
+  KV_END_SERIALIZATION
+};
+
+/// Encodes value, decodes it back and checks the copy encodes to the same body, truncated or extended bodies fail.
+template <typename T>
+T expectBinaryRoundTrip(const T& value) {
+  std::string body;
+  EXPECT_TRUE(CryptoNote::storeToBinaryString(value, body));
+
+  T deserialized{};
+  EXPECT_TRUE(CryptoNote::loadFromBinaryString(deserialized, body));
+  std::string reencoded;
+  EXPECT_TRUE(CryptoNote::storeToBinaryString(deserialized, reencoded));
+  EXPECT_EQ(reencoded, body);
+
+  T rejected{};
+  EXPECT_FALSE(CryptoNote::loadFromBinaryString(rejected, body + std::string(1, '\0')));
+  if (!body.empty()) {
+    EXPECT_FALSE(CryptoNote::loadFromBinaryString(rejected, body.substr(0, body.size() - 1)));
+  }
+  return deserialized;
+}
+
+template <typename _BlobT>
+void randomize(_BlobT& blob, std::mt19937_64& random) {
+  for (size_t i = 0; i < blob.size(); ++i) {
+    blob.data()[i] = static_cast<uint8_t>(random());
+  }
+}
+
+CryptoNote::TransactionPrefix makeTransferPrefix(std::mt19937_64& random) {
+  using namespace Xi::Blockchain::Transaction;
+
+  CryptoNote::TransactionPrefix prefix{};
+  prefix.version = 1;
+  prefix.type = Type::Transfer;
+  prefix.extra.features = ExtraFeature::PublicKey;
+  prefix.extra.publicKey.emplace();
+  randomize(*prefix.extra.publicKey, random);
+
+  AmountInput input{};
+  input.amount = CanonicalAmount{1000000};
+  randomize(input.keyImage, random);
+  input.outputIndices = {static_cast<GlobalDeltaIndex>(1 + random() % 200000), 3, 17};
+  prefix.inputs.emplace_back(std::move(input));
+
+  KeyOutputTarget target{};
+  randomize(target.key, random);
+  prefix.outputs.emplace_back(AmountOutput{CanonicalAmount{900000}, OutputTarget{target}});
+  return prefix;
+}
+
+}  // namespace CNSerialiaztion_TestSuite
+
+TEST(CryptoNote_Serialization, BinaryStringRoundTrip) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  BinaryStringEntry value{};
+  value.heights = {1, 300, 1ULL << 40};
+  value.blob = std::string{"\x01\x00\xff", 3};
+  value.timestamp = 1554000000;
+  value.status = "OK";
+
+  std::string body;
+  ASSERT_TRUE(storeToBinaryString(value, body));
+
+  BinaryStringEntry deserialized{};
+  ASSERT_TRUE(loadFromBinaryString(deserialized, body));
+  EXPECT_EQ(deserialized.heights, value.heights);
+  EXPECT_EQ(deserialized.blob, value.blob);
+  EXPECT_EQ(deserialized.timestamp, value.timestamp);
+  EXPECT_EQ(deserialized.status, value.status);
+
+  EXPECT_FALSE(loadFromBinaryString(deserialized, body + std::string(1, '\0')));
+  EXPECT_FALSE(loadFromBinaryString(deserialized, body.substr(0, body.size() - 1)));
+}
+
+TEST(CryptoNote_Serialization, BinaryStringQueryBlocksLite) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  std::mt19937_64 random{0x1173};
+  COMMAND_RPC_QUERY_BLOCKS_LITE::request request{};
+  request.block_hashes.resize(3);
+  for (auto& hash : request.block_hashes) {
+    randomize(hash, random);
+  }
+  request.timestamp = 1554000000;
+  EXPECT_EQ(expectBinaryRoundTrip(request).block_hashes, request.block_hashes);
+
+  COMMAND_RPC_QUERY_BLOCKS_LITE::response response{};
+  response.status = CORE_RPC_STATUS_OK;
+  response.start_height = BlockHeight::fromIndex(10);
+  response.current_height = BlockHeight::fromIndex(12);
+  response.full_offset = 11;
+  for (uint32_t i = 0; i < 2; ++i) {
+    BlockShortInfo block{};
+    randomize(block.block_hash, random);
+    block.timestamp = 1554000000 + i;
+    block.block.resize(80);
+    randomize(block.block, random);
+    TransactionPrefixInfo transaction{};
+    randomize(transaction.hash, random);
+    transaction.prefix = makeTransferPrefix(random);
+    block.transaction_prefixes.emplace_back(std::move(transaction));
+    response.blocks.emplace_back(std::move(block));
+  }
+
+  const auto deserialized = expectBinaryRoundTrip(response);
+  EXPECT_EQ(deserialized.status, response.status);
+  EXPECT_EQ(deserialized.start_height, response.start_height);
+  EXPECT_EQ(deserialized.current_height, response.current_height);
+  ASSERT_EQ(deserialized.blocks.size(), response.blocks.size());
+  for (size_t i = 0; i < response.blocks.size(); ++i) {
+    EXPECT_EQ(deserialized.blocks[i].block_hash, response.blocks[i].block_hash);
+    EXPECT_EQ(deserialized.blocks[i].block, response.blocks[i].block);
+    ASSERT_EQ(deserialized.blocks[i].transaction_prefixes.size(), 1u);
+    EXPECT_EQ(deserialized.blocks[i].transaction_prefixes[0].prefix.prefixHash(),
+              response.blocks[i].transaction_prefixes[0].prefix.prefixHash());
+  }
+}
+
+TEST(CryptoNote_Serialization, BinaryStringPoolChangesLite) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  std::mt19937_64 random{0x9001};
+  COMMAND_RPC_GET_POOL_CHANGES_LITE::request request{};
+  randomize(request.tail_block_hash, random);
+  request.known_transaction_hashes.resize(2);
+  for (auto& hash : request.known_transaction_hashes) {
+    randomize(hash, random);
+  }
+  const auto deserializedRequest = expectBinaryRoundTrip(request);
+  EXPECT_EQ(deserializedRequest.tail_block_hash, request.tail_block_hash);
+  EXPECT_EQ(deserializedRequest.known_transaction_hashes, request.known_transaction_hashes);
+
+  COMMAND_RPC_GET_POOL_CHANGES_LITE::response response{};
+  response.is_current_tail_block = true;
+  TransactionPrefixInfo transaction{};
+  randomize(transaction.hash, random);
+  transaction.prefix = makeTransferPrefix(random);
+  response.added_transactions.emplace_back(std::move(transaction));
+  response.deleted_transaction_hashes.resize(1);
+  randomize(response.deleted_transaction_hashes[0], random);
+  response.status = CORE_RPC_STATUS_OK;
+
+  const auto deserialized = expectBinaryRoundTrip(response);
+  EXPECT_TRUE(deserialized.is_current_tail_block);
+  ASSERT_EQ(deserialized.added_transactions.size(), 1u);
+  EXPECT_EQ(deserialized.added_transactions[0].hash, response.added_transactions[0].hash);
+  EXPECT_EQ(deserialized.deleted_transaction_hashes, response.deleted_transaction_hashes);
+  EXPECT_EQ(deserialized.status, response.status);
+}
+
+TEST(CryptoNote_Serialization, BinaryStringRandomOutputs) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  std::mt19937_64 random{0x0075};
+  COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request request{};
+  request.amounts = {{1000000, 11}, {900000, 7}};
+  const auto deserializedRequest = expectBinaryRoundTrip(request);
+  ASSERT_EQ(deserializedRequest.amounts.size(), 2u);
+  EXPECT_EQ(deserializedRequest.amounts[1].amount, 900000u);
+  EXPECT_EQ(deserializedRequest.amounts[1].count, 7u);
+
+  COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response response{};
+  response.status = CORE_RPC_STATUS_OK;
+  for (const auto& amount : request.amounts) {
+    COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs{};
+    outs.amount = amount.amount;
+    for (uint64_t i = 0; i < amount.count; ++i) {
+      COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry entry{};
+      entry.global_amount_index = static_cast<uint32_t>(random());
+      randomize(entry.out_key, random);
+      outs.outs.push_back(entry);
+    }
+    response.outs.emplace_back(std::move(outs));
+  }
+
+  const auto deserialized = expectBinaryRoundTrip(response);
+  ASSERT_EQ(deserialized.outs.size(), response.outs.size());
+  for (size_t i = 0; i < response.outs.size(); ++i) {
+    EXPECT_EQ(deserialized.outs[i].amount, response.outs[i].amount);
+    ASSERT_EQ(deserialized.outs[i].outs.size(), response.outs[i].outs.size());
+    for (size_t j = 0; j < response.outs[i].outs.size(); ++j) {
+      EXPECT_EQ(deserialized.outs[i].outs[j].global_amount_index, response.outs[i].outs[j].global_amount_index);
+      EXPECT_EQ(deserialized.outs[i].outs[j].out_key, response.outs[i].outs[j].out_key);
+    }
+  }
+}
+
+TEST(CryptoNote_Serialization, BinaryStringGlobalOutputIndices) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  std::mt19937_64 random{0x01D5};
+  COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request request{};
+  randomize(request.transaction_hash, random);
+  EXPECT_EQ(expectBinaryRoundTrip(request).transaction_hash, request.transaction_hash);
+
+  COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response response{};
+  response.output_indices = {0, 127, 128, 1ULL << 33};
+  response.status = CORE_RPC_STATUS_OK;
+  const auto deserialized = expectBinaryRoundTrip(response);
+  EXPECT_EQ(deserialized.output_indices, response.output_indices);
+  EXPECT_EQ(deserialized.status, response.status);
+}
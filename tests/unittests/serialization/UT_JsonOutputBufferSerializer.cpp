@@ -0,0 +1,128 @@
+/* ============================================================================================== *
+ *                                                                                                *
+ *                                     Galaxia Blockchain                                         *
+ *                                                                                                *
+ * ---------------------------------------------------------------------------------------------- *
+ * This file is part of the Xi framework.                                                         *
+ * ---------------------------------------------------------------------------------------------- *
+ *                                                                                                *
+ * Copyright 2018-2019 Xi Project Developers <support.xiproject.io>                               *
+ *                                                                                                *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the *
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of   *
+ * the License, or (at your option) any later version.                                            *
+ *                                                                                                *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;      *
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.      *
+ * See the GNU General Public License for more details.                                           *
+ *                                                                                                *
+ * You should have received a copy of the GNU General Public License along with this program.     *
+ * If not, see <https://www.gnu.org/licenses/>.                                                   *
+ *                                                                                                *
+ * ============================================================================================== */
+
+#include <gmock/gmock.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <Common/JsonValue.h>
+#include <Serialization/ISerializer.h>
+#include <Serialization/SerializationOverloads.h>
+#include <Serialization/SerializationTools.h>
+
+namespace CNSerialiaztion_TestSuite {
+
+struct JsonBufferInner {
+  std::string name;
+  std::vector<uint32_t> values;
+
+  KV_BEGIN_SERIALIZATION
+  KV_MEMBER(name)
+  KV_MEMBER(values)
+  KV_END_SERIALIZATION
+};
+
+struct JsonBufferOuter {
+  uint64_t large;
+  int32_t negative;
+  uint8_t small;
+  bool enabled;
+  double ratio;
+  std::string text;
+  std::string blob;
+  std::vector<JsonBufferInner> entries;
+  JsonBufferInner single;
+
+  KV_BEGIN_SERIALIZATION
+  KV_MEMBER(large)
+  KV_MEMBER(negative)
+  KV_MEMBER(small)
+  KV_MEMBER(enabled)
+  KV_MEMBER(ratio)
+  KV_MEMBER(text)
+  XI_RETURN_EC_IF_NOT(s.binary(blob, "blob"), false);
+  KV_MEMBER(entries)
+  KV_MEMBER(single)
+  KV_END_SERIALIZATION
+};
+
+JsonBufferOuter makeJsonBufferOuter() {
+  JsonBufferOuter reval{};
+  reval.large = std::numeric_limits<uint64_t>::max() - 4;
+  reval.negative = -42;
+  reval.small = 7;
+  reval.enabled = true;
+  reval.ratio = 0.125;
+  reval.text = "quote\"backslash\\tab\tnewline\n";
+  reval.blob = std::string{"\x00\x01\xfe\xff", 4};
+  reval.entries = {JsonBufferInner{"first", {1, 2, 3}}, JsonBufferInner{"", {}}};
+  reval.single = JsonBufferInner{"single", {std::numeric_limits<uint32_t>::max()}};
+  return reval;
+}
+
+}  // namespace CNSerialiaztion_TestSuite
+
+TEST(CryptoNote_Serialization, JsonBufferMatchesJsonValue) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  const auto value = makeJsonBufferOuter();
+  std::string expected;
+  ASSERT_TRUE(storeToJson(value, expected));
+
+  std::string streamed;
+  ASSERT_TRUE(storeToJsonBuffer(value, streamed));
+  EXPECT_EQ(Common::JsonValue::fromString(streamed).toString(), expected);
+}
+
+TEST(CryptoNote_Serialization, JsonBufferIsReusable) {
+  using namespace CNSerialiaztion_TestSuite;
+  using namespace CryptoNote;
+
+  const auto value = makeJsonBufferOuter();
+  std::string buffer;
+  ASSERT_TRUE(storeToJsonBuffer(value, buffer));
+  const auto first = buffer;
+  const auto capacity = buffer.capacity();
+
+  buffer.clear();
+  ASSERT_TRUE(storeToJsonBuffer(value, buffer));
+  EXPECT_EQ(buffer, first);
+  EXPECT_EQ(buffer.capacity(), capacity);
+}
+
+TEST(CryptoNote_Serialization, JsonBufferRejectsUnbalancedScopes) {
+  using namespace CryptoNote;
+
+  std::string buffer;
+  JsonOutputBufferSerializer serializer{buffer};
+  size_t size = 0;
+  ASSERT_TRUE(serializer.beginArray(size, "values"));
+  EXPECT_FALSE(serializer.endObject());
+  EXPECT_FALSE(serializer.finish());
+  ASSERT_TRUE(serializer.endArray());
+  EXPECT_TRUE(serializer.finish());
+  EXPECT_EQ(buffer, "{\"values\":[]}");
+}